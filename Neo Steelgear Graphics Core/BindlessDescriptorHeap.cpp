@@ -0,0 +1,240 @@
+#include "BindlessDescriptorHeap.h"
+
+#include <stdexcept>
+
+std::uint32_t BindlessDescriptorHeap::GetSlot(const BindlessHandle& handle) const
+{
+	if (!IsValid(handle))
+		throw std::runtime_error("Bindless handle does not refer to a live slot");
+
+	return handle.shaderIndex - shaderIndexOffset;
+}
+
+void BindlessDescriptorHeap::CopyToSlot(std::uint32_t slot,
+	D3D12_CPU_DESCRIPTOR_HANDLE source)
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE destination = cpuStart;
+	destination.ptr += descriptorSize * slot;
+	copyFunction(1, destination, source);
+}
+
+BindlessDescriptorHeap::~BindlessDescriptorHeap()
+{
+	if (heapOwned && heap != nullptr)
+		heap->Release();
+}
+
+BindlessDescriptorHeap::BindlessDescriptorHeap(BindlessDescriptorHeap&& other) noexcept :
+	heapOwned(other.heapOwned), heap(other.heap), cpuStart(other.cpuStart),
+	gpuStart(other.gpuStart), descriptorSize(other.descriptorSize),
+	shaderIndexOffset(other.shaderIndexOffset),
+	copyFunction(std::move(other.copyFunction)), slots(std::move(other.slots)),
+	nrOfUsedSlots(other.nrOfUsedSlots), freeSlots(std::move(other.freeSlots)),
+	retiredSlots(std::move(other.retiredSlots)),
+	nrOfAllocatedSlots(other.nrOfAllocatedSlots), currentFrame(other.currentFrame),
+	framesBeforeReuse(other.framesBeforeReuse)
+{
+	other.heapOwned = false;
+	other.heap = nullptr;
+	other.nrOfUsedSlots = 0;
+	other.nrOfAllocatedSlots = 0;
+	other.currentFrame = 0;
+}
+
+BindlessDescriptorHeap& BindlessDescriptorHeap::operator=(
+	BindlessDescriptorHeap&& other) noexcept
+{
+	if (this != &other)
+	{
+		if (heapOwned && heap != nullptr)
+			heap->Release();
+
+		heapOwned = other.heapOwned;
+		heap = other.heap;
+		cpuStart = other.cpuStart;
+		gpuStart = other.gpuStart;
+		descriptorSize = other.descriptorSize;
+		shaderIndexOffset = other.shaderIndexOffset;
+		copyFunction = std::move(other.copyFunction);
+		slots = std::move(other.slots);
+		nrOfUsedSlots = other.nrOfUsedSlots;
+		freeSlots = std::move(other.freeSlots);
+		retiredSlots = std::move(other.retiredSlots);
+		nrOfAllocatedSlots = other.nrOfAllocatedSlots;
+		currentFrame = other.currentFrame;
+		framesBeforeReuse = other.framesBeforeReuse;
+
+		other.heapOwned = false;
+		other.heap = nullptr;
+		other.nrOfUsedSlots = 0;
+		other.nrOfAllocatedSlots = 0;
+		other.currentFrame = 0;
+	}
+
+	return *this;
+}
+
+void BindlessDescriptorHeap::Initialize(ID3D12Device* device, size_t nrOfDescriptors,
+	FrameType framesInFlight)
+{
+	D3D12_DESCRIPTOR_HEAP_DESC desc;
+	desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	desc.NumDescriptors = static_cast<UINT>(nrOfDescriptors);
+	desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+	desc.NodeMask = 0;
+
+	ID3D12DescriptorHeap* createdHeap = nullptr;
+	HRESULT hr = device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&createdHeap));
+
+	if (FAILED(hr))
+		throw std::runtime_error("Error: Could not create bindless descriptor heap");
+
+	Initialize(device, createdHeap, 0, nrOfDescriptors, framesInFlight);
+	heapOwned = true;
+}
+
+void BindlessDescriptorHeap::Initialize(ID3D12Device* device,
+	ID3D12DescriptorHeap* shaderVisibleHeap, size_t startIndex,
+	size_t nrOfDescriptors, FrameType framesInFlight)
+{
+	size_t sizeOfDescriptor = device->GetDescriptorHandleIncrementSize(
+		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+	Initialize(shaderVisibleHeap->GetCPUDescriptorHandleForHeapStart(),
+		shaderVisibleHeap->GetGPUDescriptorHandleForHeapStart(), sizeOfDescriptor,
+		startIndex, nrOfDescriptors, framesInFlight,
+		[device](UINT nrToCopy, D3D12_CPU_DESCRIPTOR_HANDLE destination,
+			D3D12_CPU_DESCRIPTOR_HANDLE source)
+		{
+			device->CopyDescriptorsSimple(nrToCopy, destination, source,
+				D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+		});
+	heap = shaderVisibleHeap;
+}
+
+void BindlessDescriptorHeap::Initialize(D3D12_CPU_DESCRIPTOR_HANDLE cpuHandleStart,
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuHandleStart, size_t sizeOfDescriptor,
+	size_t startIndex, size_t nrOfDescriptors, FrameType framesInFlight,
+	const DescriptorCopyFunction& copyDescriptors)
+{
+	if (startIndex + nrOfDescriptors > std::uint32_t(-1))
+		throw std::runtime_error("Bindless heap does not fit 32 bit shader indices");
+
+	cpuStart = cpuHandleStart;
+	cpuStart.ptr += sizeOfDescriptor * startIndex;
+	gpuStart = gpuHandleStart;
+	gpuStart.ptr += sizeOfDescriptor * startIndex;
+	descriptorSize = sizeOfDescriptor;
+	shaderIndexOffset = static_cast<std::uint32_t>(startIndex);
+	copyFunction = copyDescriptors;
+
+	slots.clear();
+	slots.resize(nrOfDescriptors);
+	nrOfUsedSlots = 0;
+	freeSlots.clear();
+	retiredSlots.clear();
+	nrOfAllocatedSlots = 0;
+	currentFrame = 0;
+	framesBeforeReuse = framesInFlight;
+}
+
+std::optional<BindlessHandle> BindlessDescriptorHeap::Allocate(
+	D3D12_CPU_DESCRIPTOR_HANDLE source)
+{
+	std::uint32_t slot = 0;
+
+	if (!freeSlots.empty())
+	{
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else if (nrOfUsedSlots < slots.size())
+	{
+		slot = static_cast<std::uint32_t>(nrOfUsedSlots++);
+	}
+	else
+	{
+		return std::nullopt;
+	}
+
+	slots[slot].occupied = true;
+	++nrOfAllocatedSlots;
+	CopyToSlot(slot, source);
+
+	BindlessHandle toReturn;
+	toReturn.shaderIndex = shaderIndexOffset + slot;
+	toReturn.generation = slots[slot].generation;
+	return toReturn;
+}
+
+void BindlessDescriptorHeap::Update(const BindlessHandle& handle,
+	D3D12_CPU_DESCRIPTOR_HANDLE source)
+{
+	CopyToSlot(GetSlot(handle), source);
+}
+
+void BindlessDescriptorHeap::Release(const BindlessHandle& handle)
+{
+	std::uint32_t slot = GetSlot(handle);
+	slots[slot].occupied = false;
+	++slots[slot].generation; // Any handle still around is caught from now on
+	--nrOfAllocatedSlots;
+
+	RetiredSlot toAdd;
+	toAdd.slot = slot;
+	toAdd.frameReleased = currentFrame;
+	retiredSlots.push_back(toAdd);
+}
+
+void BindlessDescriptorHeap::AdvanceFrame()
+{
+	++currentFrame;
+
+	while (!retiredSlots.empty() &&
+		retiredSlots.front().frameReleased + framesBeforeReuse <= currentFrame)
+	{
+		freeSlots.push_back(retiredSlots.front().slot);
+		retiredSlots.pop_front();
+	}
+}
+
+bool BindlessDescriptorHeap::IsValid(const BindlessHandle& handle) const
+{
+	if (handle.shaderIndex < shaderIndexOffset ||
+		handle.shaderIndex - shaderIndexOffset >= nrOfUsedSlots)
+	{
+		return false;
+	}
+
+	const Slot& slot = slots[handle.shaderIndex - shaderIndexOffset];
+	return slot.occupied && slot.generation == handle.generation;
+}
+
+std::uint32_t BindlessDescriptorHeap::GetShaderIndex(const BindlessHandle& handle) const
+{
+	GetSlot(handle);
+	return handle.shaderIndex;
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE BindlessDescriptorHeap::GetGPUHandle(
+	const BindlessHandle& handle) const
+{
+	D3D12_GPU_DESCRIPTOR_HANDLE toReturn = gpuStart;
+	toReturn.ptr += descriptorSize * GetSlot(handle);
+	return toReturn;
+}
+
+ID3D12DescriptorHeap* BindlessDescriptorHeap::GetHeap() const
+{
+	return heap;
+}
+
+size_t BindlessDescriptorHeap::GetNrOfAllocatedSlots() const
+{
+	return nrOfAllocatedSlots;
+}
+
+size_t BindlessDescriptorHeap::GetNrOfRetiredSlots() const
+{
+	return retiredSlots.size();
+}
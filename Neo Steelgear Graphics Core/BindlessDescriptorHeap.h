@@ -0,0 +1,86 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <optional>
+#include <cstdint>
+
+#include <d3d12.h>
+
+#include "FrameBased.h"
+#include "ShaderVisibleDescriptorRing.h"
+
+struct BindlessHandle
+{
+	std::uint32_t shaderIndex = std::uint32_t(-1); // Index into the whole shader visible heap
+	std::uint32_t generation = 0;
+};
+
+// Permanent shader visible slots with stable indices for bindless access,
+// where released slots are only reused once the frames that could see them are done
+class BindlessDescriptorHeap
+{
+private:
+	struct Slot
+	{
+		std::uint32_t generation = 0;
+		bool occupied = false;
+	};
+
+	struct RetiredSlot
+	{
+		std::uint32_t slot = 0;
+		std::uint64_t frameReleased = 0;
+	};
+
+	bool heapOwned = false;
+	ID3D12DescriptorHeap* heap = nullptr;
+	D3D12_CPU_DESCRIPTOR_HANDLE cpuStart = { 0 };
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuStart = { 0 };
+	size_t descriptorSize = 0;
+	std::uint32_t shaderIndexOffset = 0;
+	DescriptorCopyFunction copyFunction;
+
+	std::vector<Slot> slots;
+	size_t nrOfUsedSlots = 0; // Slots past this have never been handed out
+	std::vector<std::uint32_t> freeSlots;
+	std::deque<RetiredSlot> retiredSlots;
+	size_t nrOfAllocatedSlots = 0;
+	std::uint64_t currentFrame = 0;
+	FrameType framesBeforeReuse = 0;
+
+	std::uint32_t GetSlot(const BindlessHandle& handle) const;
+	void CopyToSlot(std::uint32_t slot, D3D12_CPU_DESCRIPTOR_HANDLE source);
+
+public:
+	BindlessDescriptorHeap() = default;
+	~BindlessDescriptorHeap();
+	BindlessDescriptorHeap(const BindlessDescriptorHeap& other) = delete;
+	BindlessDescriptorHeap& operator=(const BindlessDescriptorHeap& other) = delete;
+	BindlessDescriptorHeap(BindlessDescriptorHeap&& other) noexcept;
+	BindlessDescriptorHeap& operator=(BindlessDescriptorHeap&& other) noexcept;
+
+	void Initialize(ID3D12Device* device, size_t nrOfDescriptors,
+		FrameType framesInFlight);
+	void Initialize(ID3D12Device* device, ID3D12DescriptorHeap* shaderVisibleHeap,
+		size_t startIndex, size_t nrOfDescriptors, FrameType framesInFlight);
+	// Without a device, such as when the copies are recorded instead of performed
+	void Initialize(D3D12_CPU_DESCRIPTOR_HANDLE cpuHandleStart,
+		D3D12_GPU_DESCRIPTOR_HANDLE gpuHandleStart, size_t sizeOfDescriptor,
+		size_t startIndex, size_t nrOfDescriptors, FrameType framesInFlight,
+		const DescriptorCopyFunction& copyDescriptors);
+
+	// Copies the descriptor into a new slot, std::nullopt if every slot is taken or retired
+	std::optional<BindlessHandle> Allocate(D3D12_CPU_DESCRIPTOR_HANDLE source);
+	void Update(const BindlessHandle& handle, D3D12_CPU_DESCRIPTOR_HANDLE source);
+	void Release(const BindlessHandle& handle);
+	void AdvanceFrame();
+
+	bool IsValid(const BindlessHandle& handle) const;
+	std::uint32_t GetShaderIndex(const BindlessHandle& handle) const;
+	D3D12_GPU_DESCRIPTOR_HANDLE GetGPUHandle(const BindlessHandle& handle) const;
+
+	ID3D12DescriptorHeap* GetHeap() const;
+	size_t GetNrOfAllocatedSlots() const;
+	size_t GetNrOfRetiredSlots() const;
+};
\ No newline at end of file
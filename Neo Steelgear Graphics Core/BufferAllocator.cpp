@@ -26,25 +26,27 @@ ID3D12Resource* BufferAllocator::AllocateResource(size_t size, ID3D12Heap* heap,
 ResourceIdentifier BufferAllocator::GetAvailableHeapIndex(size_t nrOfElements)
 {
 	ResourceIdentifier toReturn;
+	size_t dataSize = nrOfElements * bufferInfo.elementSize;
+	size_t chunkIndex = freeBlocks.FindChunk(dataSize);
 
-	for (size_t i = 0; i < memoryChunks.size(); ++i)
+	while (chunkIndex != size_t(-1))
 	{
-		toReturn.internalIndex = memoryChunks[i].buffers.AllocateChunk(
-			nrOfElements * bufferInfo.elementSize, AllocationStrategy::FIRST_FIT,
-			bufferInfo.alignment);
+		toReturn.internalIndex = memoryChunks[chunkIndex].buffers.AllocateChunk(
+			dataSize, AllocationStrategy::FIRST_FIT, bufferInfo.alignment);
 
 		if (toReturn.internalIndex != size_t(-1))
 		{
-			toReturn.heapChunkIndex = i;
+			toReturn.heapChunkIndex = chunkIndex;
 			break;
 		}
+
+		chunkIndex = freeBlocks.FindChunk(dataSize, chunkIndex + 1); // Alignment did not fit
 	}
 
 	if (toReturn.heapChunkIndex == size_t(-1)) // No fit in existing chunks, need to expand
 	{
 		MemoryChunk newChunk;
-		size_t minimumSize = std::max<size_t>(additionalHeapChunksMinimumSize,
-			nrOfElements * bufferInfo.elementSize);
+		size_t minimumSize = std::max<size_t>(additionalHeapChunksMinimumSize, dataSize);
 		newChunk.heapChunk = heapAllocator->AllocateChunk(minimumSize,
 			memoryChunks[0].heapChunk.heapType, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
 
@@ -68,23 +70,56 @@ ResourceIdentifier BufferAllocator::GetAvailableHeapIndex(size_t nrOfElements)
 				throw std::runtime_error("Could not map allocated buffer");
 		}
 
-		memoryChunks.push_back(std::move(newChunk));
+		toReturn.heapChunkIndex = memoryChunks.size();
+		if (!releasedChunks.empty())
+		{
+			toReturn.heapChunkIndex = releasedChunks.back();
+			releasedChunks.pop_back();
+			memoryChunks[toReturn.heapChunkIndex] = std::move(newChunk);
+			freeBlocks.UpdateChunk(toReturn.heapChunkIndex, heapSize);
+		}
+		else
+		{
+			memoryChunks.push_back(std::move(newChunk));
+			freeBlocks.AddChunk(heapSize);
+		}
 
-		toReturn.internalIndex = memoryChunks.back().buffers.AllocateChunk(
-			nrOfElements * bufferInfo.elementSize, AllocationStrategy::FIRST_FIT,
-			bufferInfo.alignment);
-		toReturn.heapChunkIndex = memoryChunks.size() - 1;
+		toReturn.internalIndex = memoryChunks[toReturn.heapChunkIndex].buffers.AllocateChunk(
+			dataSize, AllocationStrategy::FIRST_FIT, bufferInfo.alignment);
 
 		if (toReturn.internalIndex == size_t(-1))
 			throw std::runtime_error("Failed to expand memory in buffer allocator");
 	}
 
+	memoryChunks[toReturn.heapChunkIndex].emptyTrims = 0;
+	UpdateFreeBlock(toReturn.heapChunkIndex);
 	return toReturn;
 }
 
+void BufferAllocator::UpdateFreeBlock(size_t chunkIndex)
+{
+	freeBlocks.UpdateChunk(chunkIndex,
+		memoryChunks[chunkIndex].buffers.GetLargestFreeChunkSize());
+}
+
+void BufferAllocator::ReleaseChunk(size_t chunkIndex)
+{
+	MemoryChunk& memoryChunk = memoryChunks[chunkIndex];
+	memoryChunk.resource = D3DPtr<ID3D12Resource>();
+	memoryChunk.mappedStart = nullptr;
+	memoryChunk.buffers = HeapHelper<BufferEntry>();
+	memoryChunk.emptyTrims = 0;
+	heapAllocator->DeallocateChunk(memoryChunk.heapChunk);
+	memoryChunk.heapChunk = HeapChunk(); // Marks the chunk as released
+
+	freeBlocks.UpdateChunk(chunkIndex, 0);
+	releasedChunks.push_back(chunkIndex);
+}
+
 BufferAllocator::BufferAllocator(BufferAllocator&& other) noexcept :
 	ResourceAllocator(std::move(other)), device(other.device),
-	memoryChunks(std::move(other.memoryChunks)), bufferInfo(other.bufferInfo)
+	memoryChunks(std::move(other.memoryChunks)), freeBlocks(std::move(other.freeBlocks)),
+	releasedChunks(std::move(other.releasedChunks)), bufferInfo(other.bufferInfo)
 {
 	other.device = nullptr;
 	other.bufferInfo = BufferInfo();
@@ -98,6 +133,8 @@ BufferAllocator& BufferAllocator::operator=(BufferAllocator&& other) noexcept
 		device = other.device;
 		other.device = nullptr;
 		memoryChunks = std::move(other.memoryChunks);
+		freeBlocks = std::move(other.freeBlocks);
+		releasedChunks = std::move(other.releasedChunks);
 		bufferInfo = std::move(other.bufferInfo);
 		other.bufferInfo = BufferInfo();
 	}
@@ -143,6 +180,8 @@ void BufferAllocator::Initialize(const BufferInfo& bufferInfoToUse,
 	}
 
 	memoryChunks.push_back(std::move(initialChunk));
+	freeBlocks.Clear();
+	freeBlocks.AddChunk(heapSize);
 }
 
 ResourceIdentifier BufferAllocator::AllocateBuffer(size_t nrOfElements)
@@ -159,6 +198,31 @@ void BufferAllocator::DeallocateBuffer(const ResourceIdentifier& identifier)
 {
 	auto& bufferVector = memoryChunks[identifier.heapChunkIndex].buffers;
 	bufferVector.DeallocateChunk(identifier.internalIndex);
+	UpdateFreeBlock(identifier.heapChunkIndex);
+}
+
+void BufferAllocator::TrimEmptyChunks()
+{
+	if (emptyChunkReleaseDelay == 0)
+		return;
+
+	bool released = false;
+	for (size_t i = 1; i < memoryChunks.size(); ++i) // The initial chunk is always kept
+	{
+		MemoryChunk& memoryChunk = memoryChunks[i];
+		if (memoryChunk.heapChunk.heap == nullptr)
+			continue;
+
+		if (memoryChunk.buffers.NrOfAllocatedChunks() != 0)
+		{
+			memoryChunk.emptyTrims = 0;
+		}
+		else if (++memoryChunk.emptyTrims >= emptyChunkReleaseDelay && !released)
+		{
+			ReleaseChunk(i); // One at a time, in case the load comes back
+			released = true;
+		}
+	}
 }
 
 void BufferAllocator::CreateTransitionBarrier(D3D12_RESOURCE_STATES newState,
@@ -167,6 +231,9 @@ void BufferAllocator::CreateTransitionBarrier(D3D12_RESOURCE_STATES newState,
 {
 	for (auto& memoryChunk : memoryChunks)
 	{
+		if (memoryChunk.heapChunk.heap == nullptr)
+			continue; // Released
+
 		D3D12_RESOURCE_BARRIER toAdd;
 
 		toAdd.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -237,6 +304,11 @@ D3D12_RESOURCE_STATES BufferAllocator::GetCurrentState()
 	return memoryChunks[0].currentState;
 }
 
+size_t BufferAllocator::NrOfMemoryChunks() const
+{
+	return memoryChunks.size() - releasedChunks.size();
+}
+
 void BufferAllocator::UpdateMappedBuffer(const ResourceIdentifier& identifier, void* data)
 {
 	auto& memoryChunk = memoryChunks[identifier.heapChunkIndex];
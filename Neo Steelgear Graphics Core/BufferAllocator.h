@@ -9,6 +9,7 @@
 #include "D3DPtr.h"
 #include "HeapHelper.h"
 #include "ResourceUploader.h"
+#include "FreeBlockIndex.h"
 
 struct BufferInfo
 {
@@ -39,16 +40,21 @@ private:
 		D3D12_RESOURCE_STATES currentState = D3D12_RESOURCE_STATE_COMMON;
 		D3DPtr<ID3D12Resource> resource;
 		unsigned char* mappedStart = nullptr;
+		size_t emptyTrims = 0;
 	};
 
 	ID3D12Device* device = nullptr;
 	std::vector<MemoryChunk> memoryChunks;
+	FreeBlockIndex freeBlocks;
+	std::vector<size_t> releasedChunks; // Reused before new chunks are added, so other indices stay the same
 	BufferInfo bufferInfo;
 
 	ID3D12Resource* AllocateResource(size_t size, ID3D12Heap* heap,
 		size_t startOffset, D3D12_RESOURCE_STATES initialState);
 
 	ResourceIdentifier GetAvailableHeapIndex(size_t nrOfElements);
+	void UpdateFreeBlock(size_t chunkIndex);
+	void ReleaseChunk(size_t chunkIndex);
 
 public:
 	BufferAllocator() = default;
@@ -64,6 +70,8 @@ public:
 
 	ResourceIdentifier AllocateBuffer(size_t nrOfElements);
 	void DeallocateBuffer(const ResourceIdentifier& identifier);
+	// Releases at most one expansion chunk that has been empty for long enough, call once per frame
+	void TrimEmptyChunks();
 
 	void CreateTransitionBarrier(D3D12_RESOURCE_STATES newState, 
 		std::vector<D3D12_RESOURCE_BARRIER>& barriers,
@@ -76,6 +84,7 @@ public:
 	size_t GetElementSize();
 	size_t GetElementAlignment();
 	D3D12_RESOURCE_STATES GetCurrentState();
+	size_t NrOfMemoryChunks() const; // Released chunks are not included
 
 	void UpdateMappedBuffer(const ResourceIdentifier& identifier, void* data); // Map/Unmap method
 };
\ No newline at end of file
@@ -3,7 +3,7 @@
 D3D12_CONSTANT_BUFFER_VIEW_DESC BufferComponent::CreateCBV(
 	const BufferViewDesc::ConstantBufferDesc& desc, const BufferHandle& handle)
 {
-	D3D12_CONSTANT_BUFFER_VIEW_DESC toReturn;
+	D3D12_CONSTANT_BUFFER_VIEW_DESC toReturn = {};
 	toReturn.BufferLocation = handle.resource->GetGPUVirtualAddress() + 
 		handle.startOffset + desc.byteOffset;
 	toReturn.SizeInBytes = static_cast<UINT>(handle.nrOfElements * 
@@ -15,7 +15,7 @@ D3D12_CONSTANT_BUFFER_VIEW_DESC BufferComponent::CreateCBV(
 D3D12_SHADER_RESOURCE_VIEW_DESC BufferComponent::CreateSRV(
 	const BufferViewDesc::ShaderResourceDesc& desc, const BufferHandle& handle)
 {
-	D3D12_SHADER_RESOURCE_VIEW_DESC toReturn;
+	D3D12_SHADER_RESOURCE_VIEW_DESC toReturn = {};
 
 	toReturn.Format = DXGI_FORMAT_UNKNOWN;
 	toReturn.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
@@ -34,7 +34,7 @@ D3D12_SHADER_RESOURCE_VIEW_DESC BufferComponent::CreateSRV(
 D3D12_UNORDERED_ACCESS_VIEW_DESC BufferComponent::CreateUAV(
 	const BufferViewDesc::UnorderedAccessDesc& desc, const BufferHandle& handle)
 {
-	D3D12_UNORDERED_ACCESS_VIEW_DESC toReturn;
+	D3D12_UNORDERED_ACCESS_VIEW_DESC toReturn = {};
 
 	toReturn.Format = DXGI_FORMAT_UNKNOWN;
 	toReturn.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
@@ -53,7 +53,7 @@ D3D12_UNORDERED_ACCESS_VIEW_DESC BufferComponent::CreateUAV(
 D3D12_RENDER_TARGET_VIEW_DESC BufferComponent::CreateRTV(
 	const BufferViewDesc::RenderTargetDesc& desc, const BufferHandle& handle)
 {
-	D3D12_RENDER_TARGET_VIEW_DESC toReturn;
+	D3D12_RENDER_TARGET_VIEW_DESC toReturn = {};
 
 	toReturn.Format = desc.format;
 	toReturn.ViewDimension = D3D12_RTV_DIMENSION_BUFFER;
@@ -73,7 +73,8 @@ bool BufferComponent::CreateViews(const BufferReplacementViews& replacements,
 			cbv.desc, handle);
 		resourceIndex.descriptorIndex = 
 			descriptorAllocators[cbv.index].AllocateCBV(&desc);
-		if (resourceIndex.descriptorIndex == size_t(-1))
+		if (resourceIndex.descriptorIndex == size_t(-1) ||
+			!RegisterBindlessView(ViewType::CBV, cbv.index, resourceIndex))
 		{
 			return false;
 		}
@@ -85,7 +86,8 @@ bool BufferComponent::CreateViews(const BufferReplacementViews& replacements,
 			srv.desc, handle);
 		resourceIndex.descriptorIndex = descriptorAllocators[srv.index].AllocateSRV(
 			handle.resource, &desc);
-		if (resourceIndex.descriptorIndex == size_t(-1))
+		if (resourceIndex.descriptorIndex == size_t(-1) ||
+			!RegisterBindlessView(ViewType::SRV, srv.index, resourceIndex))
 		{
 			return false;
 		}
@@ -105,7 +107,8 @@ bool BufferComponent::CreateViews(const BufferReplacementViews& replacements,
 
 		resourceIndex.descriptorIndex = descriptorAllocators[uav.index].AllocateUAV(
 			handle.resource, &desc, counterResource);
-		if (resourceIndex.descriptorIndex == size_t(-1))
+		if (resourceIndex.descriptorIndex == size_t(-1) ||
+			!RegisterBindlessView(ViewType::UAV, uav.index, resourceIndex))
 		{
 			return false;
 		}
@@ -126,6 +129,130 @@ bool BufferComponent::CreateViews(const BufferReplacementViews& replacements,
 	return true;
 }
 
+bool BufferComponent::CreateViews(const BufferReplacementViews& replacements,
+	const std::vector<BufferHandle>& handles, std::vector<ResourceIndex>& resourceIndices)
+{
+	size_t nrOfViews = handles.size();
+	std::vector<size_t> descriptorIndices(nrOfViews);
+	const size_t* placedIndices = nullptr; // Views after the first type use the same indices
+	std::vector<std::uint8_t> allocatedIn; // Allocators to roll back if a later type fails
+
+	if (cbv.index != std::uint8_t(-1))
+	{
+		std::vector<D3D12_CONSTANT_BUFFER_VIEW_DESC> descs(nrOfViews);
+		std::vector<DescriptorBatchView<D3D12_CONSTANT_BUFFER_VIEW_DESC>> views(nrOfViews);
+		for (size_t i = 0; i < nrOfViews; ++i)
+		{
+			descs[i] = CreateCBV(replacements.cb != std::nullopt ? *replacements.cb :
+				cbv.desc, handles[i]);
+			views[i].desc = &descs[i];
+		}
+
+		bool allocated = descriptorAllocators[cbv.index].AllocateCBVs(views.data(),
+			nrOfViews, descriptorIndices.data(), placedIndices);
+		if (allocated)
+			allocatedIn.push_back(cbv.index);
+
+		if (!allocated || !SetBatchDescriptorIndices(ViewType::CBV, cbv.index,
+			descriptorIndices, resourceIndices))
+		{
+			DeallocateBatchDescriptors(allocatedIn, descriptorIndices);
+			return false;
+		}
+
+		placedIndices = descriptorIndices.data();
+	}
+
+	if (srv.index != std::uint8_t(-1))
+	{
+		std::vector<D3D12_SHADER_RESOURCE_VIEW_DESC> descs(nrOfViews);
+		std::vector<DescriptorBatchView<D3D12_SHADER_RESOURCE_VIEW_DESC>> views(nrOfViews);
+		for (size_t i = 0; i < nrOfViews; ++i)
+		{
+			descs[i] = CreateSRV(replacements.sr != std::nullopt ? *replacements.sr :
+				srv.desc, handles[i]);
+			views[i].resource = handles[i].resource;
+			views[i].desc = &descs[i];
+		}
+
+		bool allocated = descriptorAllocators[srv.index].AllocateSRVs(views.data(),
+			nrOfViews, descriptorIndices.data(), placedIndices);
+		if (allocated)
+			allocatedIn.push_back(srv.index);
+
+		if (!allocated || !SetBatchDescriptorIndices(ViewType::SRV, srv.index,
+			descriptorIndices, resourceIndices))
+		{
+			DeallocateBatchDescriptors(allocatedIn, descriptorIndices);
+			return false;
+		}
+
+		placedIndices = descriptorIndices.data();
+	}
+
+	if (uav.index != std::uint8_t(-1))
+	{
+		ID3D12Resource* counterResource = uav.desc.counterResource;
+		if (replacements.ua != std::nullopt &&
+			replacements.ua->counterResource != nullptr)
+		{
+			counterResource = replacements.ua->counterResource;
+		}
+
+		std::vector<D3D12_UNORDERED_ACCESS_VIEW_DESC> descs(nrOfViews);
+		std::vector<DescriptorBatchView<D3D12_UNORDERED_ACCESS_VIEW_DESC>> views(nrOfViews);
+		for (size_t i = 0; i < nrOfViews; ++i)
+		{
+			descs[i] = CreateUAV(replacements.ua != std::nullopt ? *replacements.ua :
+				uav.desc, handles[i]);
+			views[i].resource = handles[i].resource;
+			views[i].desc = &descs[i];
+			views[i].counterResource = counterResource;
+		}
+
+		bool allocated = descriptorAllocators[uav.index].AllocateUAVs(views.data(),
+			nrOfViews, descriptorIndices.data(), placedIndices);
+		if (allocated)
+			allocatedIn.push_back(uav.index);
+
+		if (!allocated || !SetBatchDescriptorIndices(ViewType::UAV, uav.index,
+			descriptorIndices, resourceIndices))
+		{
+			DeallocateBatchDescriptors(allocatedIn, descriptorIndices);
+			return false;
+		}
+
+		placedIndices = descriptorIndices.data();
+	}
+
+	if (rtv.index != std::uint8_t(-1))
+	{
+		std::vector<D3D12_RENDER_TARGET_VIEW_DESC> descs(nrOfViews);
+		std::vector<DescriptorBatchView<D3D12_RENDER_TARGET_VIEW_DESC>> views(nrOfViews);
+		for (size_t i = 0; i < nrOfViews; ++i)
+		{
+			descs[i] = CreateRTV(replacements.rt != std::nullopt ? *replacements.rt :
+				rtv.desc, handles[i]);
+			views[i].resource = handles[i].resource;
+			views[i].desc = &descs[i];
+		}
+
+		bool allocated = descriptorAllocators[rtv.index].AllocateRTVs(views.data(),
+			nrOfViews, descriptorIndices.data(), placedIndices);
+		if (allocated)
+			allocatedIn.push_back(rtv.index);
+
+		if (!allocated || !SetBatchDescriptorIndices(ViewType::RTV, rtv.index,
+			descriptorIndices, resourceIndices))
+		{
+			DeallocateBatchDescriptors(allocatedIn, descriptorIndices);
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void BufferComponent::InitializeBufferAllocator(ID3D12Device* device,
 	const BufferComponentInfo& bufferInfo)
 {
@@ -135,6 +262,7 @@ void BufferComponent::InitializeBufferAllocator(ID3D12Device* device,
 	bufferAllocator.Initialize(bufferInfo.bufferInfo, device,
 		bufferInfo.mappedResource, views, bufferInfo.memoryInfo.initialMinimumHeapSize,
 		bufferInfo.memoryInfo.expansionMinimumSize, bufferInfo.memoryInfo.heapAllocator);
+	bufferAllocator.SetEmptyChunkReleaseDelay(bufferInfo.memoryInfo.emptyChunkReleaseDelay);
 }
 
 void BufferComponent::InitializeDescriptorAllocators(ID3D12Device* device,
@@ -243,6 +371,7 @@ ResourceIndex BufferComponent::CreateBuffer(size_t nrOfElements,
 	BufferHandle handle = bufferAllocator.GetHandle(toReturn.allocatorIdentifier);
 	if (!CreateViews(replacementViews, handle, toReturn))
 	{
+		ReleaseBindlessViews(toReturn);
 		bufferAllocator.DeallocateBuffer(toReturn.allocatorIdentifier);
 		throw std::runtime_error("Cannot create views for buffer resource");
 	}
@@ -250,30 +379,61 @@ ResourceIndex BufferComponent::CreateBuffer(size_t nrOfElements,
 	return toReturn;
 }
 
+std::vector<ResourceIndex> BufferComponent::CreateBuffers(
+	const std::vector<size_t>& nrOfElements, const BufferReplacementViews& replacementViews)
+{
+	std::vector<ResourceIndex> toReturn(nrOfElements.size());
+	std::vector<BufferHandle> handles(nrOfElements.size());
+
+	for (size_t i = 0; i < nrOfElements.size(); ++i)
+	{
+		toReturn[i].allocatorIdentifier = bufferAllocator.AllocateBuffer(nrOfElements[i]);
+		handles[i] = bufferAllocator.GetHandle(toReturn[i].allocatorIdentifier);
+	}
+
+	if (!CreateViews(replacementViews, handles, toReturn))
+	{
+		for (auto& resourceIndex : toReturn)
+		{
+			ReleaseBindlessViews(resourceIndex);
+			bufferAllocator.DeallocateBuffer(resourceIndex.allocatorIdentifier);
+		}
+
+		throw std::runtime_error("Cannot create views for buffer resources");
+	}
+
+	return toReturn;
+}
+
 void BufferComponent::RemoveComponent(const ResourceIndex& indexToRemove)
 {
 	ResourceComponent::RemoveComponent(indexToRemove);
 	bufferAllocator.DeallocateBuffer(indexToRemove.allocatorIdentifier);
 }
 
+void BufferComponent::TrimEmptyChunks()
+{
+	bufferAllocator.TrimEmptyChunks();
+}
+
 const D3D12_CPU_DESCRIPTOR_HANDLE BufferComponent::GetDescriptorHeapCBV() const
 {
-	return descriptorAllocators[cbv.index].GetDescriptorHandle(0);
+	return GetHeapStart(cbv.index);
 }
 
 const D3D12_CPU_DESCRIPTOR_HANDLE BufferComponent::GetDescriptorHeapSRV() const
 {
-	return descriptorAllocators[srv.index].GetDescriptorHandle(0);
+	return GetHeapStart(srv.index);
 }
 
 const D3D12_CPU_DESCRIPTOR_HANDLE BufferComponent::GetDescriptorHeapUAV() const
 {
-	return descriptorAllocators[uav.index].GetDescriptorHandle(0);
+	return GetHeapStart(uav.index);
 }
 
 const D3D12_CPU_DESCRIPTOR_HANDLE BufferComponent::GetDescriptorHeapRTV() const
 {
-	return descriptorAllocators[rtv.index].GetDescriptorHandle(0);
+	return GetHeapStart(rtv.index);
 }
 
 bool BufferComponent::HasDescriptorsOfType(ViewType type) const
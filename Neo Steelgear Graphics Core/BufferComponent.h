@@ -110,6 +110,9 @@ private:
 
 	bool CreateViews(const BufferReplacementViews& replacements,
 		const BufferHandle& handle, ResourceIndex& resourceIndex);
+	bool CreateViews(const BufferReplacementViews& replacements,
+		const std::vector<BufferHandle>& handles,
+		std::vector<ResourceIndex>& resourceIndices);
 
 	void InitializeBufferAllocator(ID3D12Device* device,
 		const BufferComponentInfo& bufferInfo);
@@ -129,8 +132,14 @@ public:
 
 	ResourceIndex CreateBuffer(size_t nrOfElements,
 		const BufferReplacementViews& replacementViews = BufferReplacementViews());
+	// Creates the views of each type in one batch, meant for loading many buffers at once
+	std::vector<ResourceIndex> CreateBuffers(const std::vector<size_t>& nrOfElements,
+		const BufferReplacementViews& replacementViews = BufferReplacementViews());
 
 	void RemoveComponent(const ResourceIndex& indexToRemove);
+	// Gives back expansion memory that has been empty for long enough, called once per frame
+	// by the frame components when their previous use of this component has finished
+	void TrimEmptyChunks();
 
 	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapCBV() const override;
 	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapSRV() const override;
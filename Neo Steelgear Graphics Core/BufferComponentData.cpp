@@ -50,6 +50,15 @@ void BufferComponentData::UpdateComponentData(const ResourceIndex& resourceIndex
     internalData[vectorIndex].UpdateComponentData(translatedIndex, dataPtr);
 }
 
+WritableSpan BufferComponentData::BeginUpdate(const ResourceIndex& resourceIndex,
+    BufferComponent& currentComponent, size_t offset, size_t size)
+{
+    size_t vectorIndex = resourceIndex.allocatorIdentifier.heapChunkIndex;
+    ResourceIndex translatedIndex = TranslateIndexToInternal(resourceIndex);
+    return internalData[vectorIndex].BeginUpdate(translatedIndex,
+        currentComponent, offset, size);
+}
+
 void BufferComponentData::PrepareUpdates(
     std::vector<D3D12_RESOURCE_BARRIER>& barriers, BufferComponent& componentToUpdate)
 {
@@ -64,6 +73,13 @@ void BufferComponentData::UpdateComponentResources(ID3D12GraphicsCommandList* co
         data.UpdateComponentResources(commandList, uploader, componentToUpdate, componentAlignment);
 }
 
+void BufferComponentData::UpdateComponentResources(UploadScheduler& scheduler,
+    UploadPriority priority, BufferComponent& componentToUpdate, size_t componentAlignment)
+{
+    for (auto& data : internalData)
+        data.UpdateComponentResources(scheduler, priority, componentToUpdate, componentAlignment);
+}
+
 void* BufferComponentData::GetComponentData(const ResourceIndex& resourceIndex)
 {
     size_t vectorIndex = resourceIndex.allocatorIdentifier.heapChunkIndex;
@@ -29,12 +29,18 @@ public:
 		unsigned int dataSize, void* initialData = nullptr);
 	void RemoveComponent(const ResourceIndex& resourceIndex);
 	void UpdateComponentData(const ResourceIndex& resourceIndex, void* dataPtr);
+	WritableSpan BeginUpdate(const ResourceIndex& resourceIndex,
+		BufferComponent& currentComponent, size_t offset = 0,
+		size_t size = static_cast<size_t>(-1));
 
 	void PrepareUpdates(std::vector<D3D12_RESOURCE_BARRIER>& barriers,
 		BufferComponent& componentToUpdate);
 	void UpdateComponentResources(ID3D12GraphicsCommandList* commandList,
 		ResourceUploader& uploader, BufferComponent& componentToUpdate,
 		size_t componentAlignment);
+	void UpdateComponentResources(UploadScheduler& scheduler,
+		UploadPriority priority, BufferComponent& componentToUpdate,
+		size_t componentAlignment);
 
 	void* GetComponentData(const ResourceIndex& resourceIndex);
 };
\ No newline at end of file
@@ -1,11 +1,15 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 
 #include <d3d12.h>
 
 #include "ResourceComponent.h"
+#include "HeapHelper.h"
+#include "FrameDirtyBits.h"
 #include "FrameBased.h"
+#include "UploadScheduler.h"
 
 enum class UpdateType
 {
@@ -15,6 +19,13 @@ enum class UpdateType
 	COPY_UPDATE
 };
 
+// Writable memory for a component, valid until components are added or removed
+struct WritableSpan
+{
+	unsigned char* data = nullptr;
+	size_t size = 0;
+};
+
 template<typename SpecificData>
 class ComponentData
 {
@@ -24,9 +35,12 @@ protected:
 		size_t startOffset = static_cast<size_t>(-1);
 		unsigned int dataSize = static_cast<unsigned int>(-1);
 		ResourceIndex resourceIndex;
+		size_t dataChunk = static_cast<size_t>(-1); // Chunk in dataSlots, if the data has one
 		SpecificData specifics = SpecificData();
 	};
 
+	static const size_t COMPACTION_BUDGET = 256 * 1024; // Bytes moved per compaction
+
 	ID3D12Device* device;
 	bool updateNeeded = false;
 	FrameType nrOfFrames = 0;
@@ -35,8 +49,45 @@ protected:
 	UpdateType type = UpdateType::NONE;
 	size_t usedDataSize = 0;
 
-	void UpdateExistingHeaders(size_t indexOfOriginalChange, 
-		std::int64_t sizeDifference);
+	// Descriptor index to header slot for INITIALISE_ONLY, where headers are unordered
+	std::vector<size_t> headerSlots;
+
+	// Slots for data that is not laid out by the caller, removals leave other data in place
+	HeapHelper<size_t> dataSlots;
+
+	// Descriptor indices of components with data left to upload, per frame in flight
+	FrameDirtyBits dirtyBits;
+	std::vector<size_t> dirtyIndices;
+
+	struct ScheduledResource
+	{
+		ID3D12Resource* resource = nullptr;
+		FrameType framesUntilActive = 0; // Uploads only continue while the frame of the resource is active
+		ResourceIndex resourceIndex; // Kept for transitions, the component itself may be removed
+	};
+
+	// Resources with uploads left in a scheduler
+	std::vector<ScheduledResource> scheduledResources;
+
+	// Updates through an uploader go through this scheduler, which executes right away
+	UploadScheduler directScheduler;
+
+	// The scheduler of the last update, null for the direct one so that moves keep it valid
+	UploadScheduler* lastScheduler = nullptr;
+
+	DataHeader* FindHeader(const ResourceIndex& resourceIndex);
+	DataHeader* FindHeader(size_t descriptorIndex);
+	void AddHeaderSlot(const DataHeader& header);
+	void RemoveHeaderSlot(size_t headerSlot);
+
+	void AllocateDataSlot(DataHeader& header, size_t dataSize);
+	void FreeDataSlot(DataHeader& header);
+	void CompactDataSlots(size_t byteBudget);
+
+	void UpdateScheduledResources(UploadScheduler& scheduler);
+	void AddScheduledResource(ID3D12Resource* resource,
+		const ResourceIndex& resourceIndex = ResourceIndex());
+	bool ScheduledResourceResumes(const ScheduledResource& scheduled);
 
 public:
 	ComponentData() = default;
@@ -55,26 +106,203 @@ public:
 };
 
 template<typename SpecificData>
-void ComponentData<SpecificData>::UpdateExistingHeaders(size_t indexOfOriginalChange,
-	std::int64_t sizeDifference)
+inline typename ComponentData<SpecificData>::DataHeader*
+ComponentData<SpecificData>::FindHeader(const ResourceIndex& resourceIndex)
+{
+	return FindHeader(resourceIndex.descriptorIndex);
+}
+
+template<typename SpecificData>
+inline typename ComponentData<SpecificData>::DataHeader*
+ComponentData<SpecificData>::FindHeader(size_t descriptorIndex)
+{
+	if (type != UpdateType::INITIALISE_ONLY)
+		return &headers[descriptorIndex];
+
+	if (descriptorIndex >= headerSlots.size() ||
+		headerSlots[descriptorIndex] == static_cast<size_t>(-1))
+	{
+		return nullptr;
+	}
+
+	return &headers[headerSlots[descriptorIndex]];
+}
+
+template<typename SpecificData>
+inline void ComponentData<SpecificData>::AddHeaderSlot(const DataHeader& header)
+{
+	size_t descriptorIndex = header.resourceIndex.descriptorIndex;
+	if (headerSlots.size() <= descriptorIndex)
+		headerSlots.resize(descriptorIndex + 1, static_cast<size_t>(-1));
+
+	headerSlots[descriptorIndex] = headers.size();
+	headers.push_back(header);
+}
+
+template<typename SpecificData>
+inline void ComponentData<SpecificData>::RemoveHeaderSlot(size_t headerSlot)
+{
+	headerSlots[headers[headerSlot].resourceIndex.descriptorIndex] =
+		static_cast<size_t>(-1);
+
+	if (headerSlot != headers.size() - 1)
+	{
+		headers[headerSlot] = headers.back();
+		headerSlots[headers[headerSlot].resourceIndex.descriptorIndex] = headerSlot;
+	}
+
+	headers.pop_back();
+}
+
+template<typename SpecificData>
+inline void ComponentData<SpecificData>::AllocateDataSlot(DataHeader& header,
+	size_t dataSize)
+{
+	header.startOffset = 0;
+	header.dataSize = static_cast<unsigned int>(dataSize);
+	header.dataChunk = static_cast<size_t>(-1);
+	if (dataSize == 0)
+		return;
+
+	if (dataSlots.GetCurrentMaxIndex() == 0)
+		dataSlots.Initialize(data.size());
+
+	size_t chunkIndex = dataSlots.AllocateChunk(dataSize,
+		AllocationStrategy::FIRST_FIT, 1);
+
+	// Enough memory is free in total, it is just spread out
+	if (chunkIndex == static_cast<size_t>(-1) &&
+		data.size() - usedDataSize >= dataSize)
+	{
+		CompactDataSlots(COMPACTION_BUDGET);
+		chunkIndex = dataSlots.AllocateChunk(dataSize,
+			AllocationStrategy::FIRST_FIT, 1);
+	}
+
+	if (chunkIndex == static_cast<size_t>(-1))
+	{
+		size_t oldSize = data.size();
+		data.resize(oldSize * 2 > oldSize + dataSize ? oldSize * 2 : oldSize + dataSize);
+		dataSlots.AddChunk(data.size() - oldSize, true);
+		chunkIndex = dataSlots.AllocateChunk(dataSize,
+			AllocationStrategy::FIRST_FIT, 1);
+	}
+
+	dataSlots[chunkIndex] = header.resourceIndex.descriptorIndex;
+	header.startOffset = dataSlots.GetStartOfChunk(chunkIndex);
+	header.dataChunk = chunkIndex;
+	usedDataSize += dataSize;
+}
+
+template<typename SpecificData>
+inline void ComponentData<SpecificData>::FreeDataSlot(DataHeader& header)
+{
+	if (header.dataChunk != static_cast<size_t>(-1))
+	{
+		dataSlots.DeallocateChunk(header.dataChunk);
+		usedDataSize -= header.dataSize;
+	}
+
+	header.dataChunk = static_cast<size_t>(-1);
+	header.dataSize = 0;
+}
+
+template<typename SpecificData>
+inline void ComponentData<SpecificData>::CompactDataSlots(size_t byteBudget)
 {
-	size_t jointSize = 0;
-	for (size_t i = indexOfOriginalChange + 1; i < headers.size(); ++i)
+	std::vector<size_t> headersToMove;
+	for (size_t i = 0; i < headers.size(); ++i)
 	{
-		headers[i].startOffset = sizeDifference >= 0 ?
-			headers[i].startOffset + static_cast<size_t>(sizeDifference) :
-			headers[i].startOffset - static_cast<size_t>(-sizeDifference);
-		jointSize += headers[i].dataSize;
+		if (headers[i].dataChunk != static_cast<size_t>(-1))
+			headersToMove.push_back(i);
 	}
 
-	unsigned char* destination = data.data();
-	destination += headers[indexOfOriginalChange].startOffset;
-	destination += headers[indexOfOriginalChange].dataSize;
-	unsigned char* source = destination;
-	destination = sizeDifference >= 0 ?
-		destination + static_cast<size_t>(sizeDifference) :
-		destination - static_cast<size_t>(-sizeDifference);
-	std::memmove(destination, source, jointSize);
+	// Data at the end is moved first, so the free memory gathers there
+	std::sort(headersToMove.begin(), headersToMove.end(),
+		[this](size_t first, size_t second)
+		{
+			return headers[first].startOffset > headers[second].startOffset;
+		});
+
+	for (size_t headerIndex : headersToMove)
+	{
+		DataHeader& header = headers[headerIndex];
+		if (header.dataSize > byteBudget)
+			continue;
+
+		size_t newChunk = dataSlots.AllocateChunk(header.dataSize,
+			AllocationStrategy::FIRST_FIT, 1);
+		if (newChunk == static_cast<size_t>(-1))
+			continue;
+
+		size_t newOffset = dataSlots.GetStartOfChunk(newChunk);
+		if (newOffset > header.startOffset)
+		{
+			dataSlots.DeallocateChunk(newChunk);
+			continue;
+		}
+
+		std::memcpy(data.data() + newOffset, data.data() + header.startOffset,
+			header.dataSize);
+		dataSlots.DeallocateChunk(header.dataChunk);
+		dataSlots[newChunk] = header.resourceIndex.descriptorIndex;
+		header.startOffset = newOffset;
+		header.dataChunk = newChunk;
+		byteBudget -= header.dataSize;
+	}
+}
+
+template<typename SpecificData>
+inline void ComponentData<SpecificData>::UpdateScheduledResources(
+	UploadScheduler& scheduler)
+{
+	lastScheduler = &scheduler != &directScheduler ? &scheduler : nullptr;
+	scheduledResources.erase(std::remove_if(scheduledResources.begin(),
+		scheduledResources.end(), [&scheduler](const ScheduledResource& scheduled)
+		{
+			return !scheduler.HasScheduledUploads(scheduled.resource);
+		}), scheduledResources.end());
+
+	// The resources of other frames are not prepared for copies, and may still be in use
+	for (auto& scheduled : scheduledResources)
+	{
+		scheduled.framesUntilActive = static_cast<FrameType>(
+			scheduled.framesUntilActive == 0 ? nrOfFrames - 1 : scheduled.framesUntilActive - 1);
+
+		if (scheduled.framesUntilActive == 0)
+			scheduler.ResumeUploads(scheduled.resource);
+		else
+			scheduler.PauseUploads(scheduled.resource);
+	}
+}
+
+template<typename SpecificData>
+inline void ComponentData<SpecificData>::AddScheduledResource(
+	ID3D12Resource* resource, const ResourceIndex& resourceIndex)
+{
+	for (auto& scheduled : scheduledResources)
+	{
+		if (scheduled.resource == resource)
+		{
+			scheduled.framesUntilActive = 0;
+			return;
+		}
+	}
+
+	scheduledResources.push_back({ resource, 0, resourceIndex });
+}
+
+template<typename SpecificData>
+inline bool ComponentData<SpecificData>::ScheduledResourceResumes(
+	const ScheduledResource& scheduled)
+{
+	// Whether the next update makes the frame of the resource active with uploads left to it
+	UploadScheduler& scheduler = lastScheduler != nullptr ? *lastScheduler : directScheduler;
+	if (!scheduler.HasScheduledUploads(scheduled.resource))
+		return false;
+
+	return scheduled.framesUntilActive == 1 ||
+		(scheduled.framesUntilActive == 0 && nrOfFrames == 1);
 }
 
 template<typename SpecificData>
@@ -85,6 +313,7 @@ void ComponentData<SpecificData>::Initialize(ID3D12Device* deviceToUse,
 	device = deviceToUse;
 	nrOfFrames = totalNrOfFrames;
 	type = componentUpdateType;
+	dirtyBits.Initialize(totalNrOfFrames);
 	if (type != UpdateType::INITIALISE_ONLY && type != UpdateType::NONE)
 		data.resize(initialSize);
 }
@@ -100,16 +329,10 @@ inline void* ComponentData<SpecificData>::GetComponentData(
 	{
 		toReturn = data.data() + headers[resourceIndex.descriptorIndex].startOffset;
 	}
-	else
+	else if (type == UpdateType::INITIALISE_ONLY)
 	{
-		for (auto& header : headers)
-		{
-			if (header.resourceIndex.descriptorIndex == resourceIndex.descriptorIndex)
-			{
-				toReturn = data.data() + header.startOffset;
-				break;
-			}
-		}
+		DataHeader* header = FindHeader(resourceIndex);
+		toReturn = header != nullptr ? data.data() + header->startOffset : nullptr;
 	}
 
 	return toReturn;
@@ -0,0 +1,427 @@
+#include "ConcurrentDescriptorAllocator.h"
+
+#include <stdexcept>
+
+DescriptorThreadCache::DescriptorThreadCache(
+	ConcurrentDescriptorAllocator* owningAllocator) : allocator(owningAllocator)
+{
+	freeIndices.reserve(allocator->batchSize * 2);
+}
+
+void DescriptorThreadCache::ReturnBatch(size_t nrOfIndices)
+{
+	// The oldest indices are returned, the most recently freed ones are kept
+	for (size_t i = 0; i + 1 < nrOfIndices; ++i)
+		allocator->nextInBatch[freeIndices[i]] = freeIndices[i + 1];
+
+	std::uint32_t firstIndex = freeIndices[0];
+	allocator->batchLengths[firstIndex] = static_cast<std::uint32_t>(nrOfIndices);
+	freeIndices.erase(freeIndices.begin(), freeIndices.begin() + nrOfIndices);
+	allocator->nrOfPooledIndices.fetch_add(nrOfIndices, std::memory_order_relaxed);
+	allocator->PushBatch(firstIndex);
+}
+
+DescriptorThreadCache::~DescriptorThreadCache()
+{
+	Flush();
+}
+
+DescriptorThreadCache::DescriptorThreadCache(DescriptorThreadCache&& other) noexcept :
+	allocator(other.allocator), freeIndices(std::move(other.freeIndices))
+{
+	other.allocator = nullptr;
+	other.freeIndices.clear();
+}
+
+DescriptorThreadCache& DescriptorThreadCache::operator=(
+	DescriptorThreadCache&& other) noexcept
+{
+	if (this != &other)
+	{
+		Flush();
+
+		allocator = other.allocator;
+		freeIndices = std::move(other.freeIndices);
+
+		other.allocator = nullptr;
+		other.freeIndices.clear();
+	}
+
+	return *this;
+}
+
+size_t DescriptorThreadCache::AllocateIndex()
+{
+	if (allocator == nullptr)
+		return size_t(-1);
+
+	if (freeIndices.empty())
+	{
+		std::uint32_t firstIndex = allocator->PopBatch();
+		if (firstIndex == ConcurrentDescriptorAllocator::NO_BATCH)
+			return size_t(-1);
+
+		size_t batchLength = allocator->batchLengths[firstIndex];
+		allocator->nrOfPooledIndices.fetch_sub(batchLength, std::memory_order_relaxed);
+
+		// Filled from the back so the batch is handed out in the order it was linked
+		freeIndices.resize(batchLength);
+		std::uint32_t currentIndex = firstIndex;
+		for (size_t i = 0; i < batchLength; ++i)
+		{
+			freeIndices[batchLength - 1 - i] = currentIndex;
+			currentIndex = allocator->nextInBatch[currentIndex];
+		}
+	}
+
+	size_t toReturn = allocator->indexOffset + freeIndices.back();
+	freeIndices.pop_back();
+	return toReturn;
+}
+
+void DescriptorThreadCache::DeallocateIndex(size_t index)
+{
+	if (allocator == nullptr || index < allocator->indexOffset ||
+		index - allocator->indexOffset >= allocator->totalDescriptors)
+	{
+		throw std::runtime_error("Cannot deallocate descriptor outside of the allocator");
+	}
+
+	freeIndices.push_back(static_cast<std::uint32_t>(index - allocator->indexOffset));
+
+	if (freeIndices.size() >= allocator->batchSize * 2)
+		ReturnBatch(allocator->batchSize);
+}
+
+size_t DescriptorThreadCache::AllocateSRV(ID3D12Resource* resource,
+	const D3D12_SHADER_RESOURCE_VIEW_DESC* desc)
+{
+	size_t toReturn = AllocateIndex();
+	if (toReturn != size_t(-1))
+	{
+		allocator->device->CreateShaderResourceView(resource, desc,
+			GetDescriptorHandle(toReturn));
+	}
+
+	return toReturn;
+}
+
+size_t DescriptorThreadCache::AllocateUAV(ID3D12Resource* resource,
+	const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc, ID3D12Resource* counterResource)
+{
+	size_t toReturn = AllocateIndex();
+	if (toReturn != size_t(-1))
+	{
+		allocator->device->CreateUnorderedAccessView(resource, counterResource, desc,
+			GetDescriptorHandle(toReturn));
+	}
+
+	return toReturn;
+}
+
+size_t DescriptorThreadCache::AllocateRTV(ID3D12Resource* resource,
+	const D3D12_RENDER_TARGET_VIEW_DESC* desc)
+{
+	size_t toReturn = AllocateIndex();
+	if (toReturn != size_t(-1))
+	{
+		allocator->device->CreateRenderTargetView(resource, desc,
+			GetDescriptorHandle(toReturn));
+	}
+
+	return toReturn;
+}
+
+size_t DescriptorThreadCache::AllocateDSV(ID3D12Resource* resource,
+	const D3D12_DEPTH_STENCIL_VIEW_DESC* desc)
+{
+	size_t toReturn = AllocateIndex();
+	if (toReturn != size_t(-1))
+	{
+		allocator->device->CreateDepthStencilView(resource, desc,
+			GetDescriptorHandle(toReturn));
+	}
+
+	return toReturn;
+}
+
+size_t DescriptorThreadCache::AllocateCBV(const D3D12_CONSTANT_BUFFER_VIEW_DESC* desc)
+{
+	size_t toReturn = AllocateIndex();
+	if (toReturn != size_t(-1))
+		allocator->device->CreateConstantBufferView(desc, GetDescriptorHandle(toReturn));
+
+	return toReturn;
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE DescriptorThreadCache::GetDescriptorHandle(size_t index) const
+{
+	if (allocator == nullptr)
+		throw std::runtime_error("Cannot fetch descriptor handle without an allocator");
+
+	return allocator->GetDescriptorHandle(index);
+}
+
+void DescriptorThreadCache::Rebalance()
+{
+	if (allocator == nullptr)
+		return;
+
+	while (freeIndices.size() > allocator->batchSize)
+		ReturnBatch(allocator->batchSize);
+}
+
+void DescriptorThreadCache::Flush()
+{
+	if (allocator == nullptr)
+		return;
+
+	while (!freeIndices.empty())
+	{
+		ReturnBatch(freeIndices.size() < allocator->batchSize ?
+			freeIndices.size() : allocator->batchSize);
+	}
+}
+
+size_t DescriptorThreadCache::NrOfCachedIndices() const
+{
+	return freeIndices.size();
+}
+
+void ConcurrentDescriptorAllocator::InitializeBatches(size_t nrOfDescriptors,
+	size_t descriptorsPerBatch)
+{
+	if (nrOfDescriptors >= NO_BATCH)
+		throw std::runtime_error("Too many descriptors for concurrent descriptor allocator");
+	if (descriptorsPerBatch == 0)
+		throw std::runtime_error("Descriptor batches cannot be empty");
+
+	totalDescriptors = nrOfDescriptors;
+	batchSize = descriptorsPerBatch;
+	nextInBatch = std::make_unique<std::uint32_t[]>(nrOfDescriptors);
+	batchLengths = std::make_unique<std::uint32_t[]>(nrOfDescriptors);
+	nextBatch = std::make_unique<std::atomic<std::uint32_t>[]>(nrOfDescriptors);
+	poolHead.store(0, std::memory_order_relaxed);
+	nrOfPooledIndices.store(nrOfDescriptors, std::memory_order_relaxed);
+
+	for (size_t i = 0; i < nrOfDescriptors; ++i)
+		nextInBatch[i] = static_cast<std::uint32_t>(i + 1);
+
+	// Pushed in reverse so the lowest indices are handed out first
+	size_t nrOfBatches = (nrOfDescriptors + batchSize - 1) / batchSize;
+	for (size_t i = nrOfBatches; i > 0; --i)
+	{
+		size_t firstIndex = (i - 1) * batchSize;
+		size_t lastIndex = firstIndex + batchSize;
+		batchLengths[firstIndex] = static_cast<std::uint32_t>(
+			(lastIndex < nrOfDescriptors ? lastIndex : nrOfDescriptors) - firstIndex);
+		PushBatch(static_cast<std::uint32_t>(firstIndex));
+	}
+}
+
+std::uint32_t ConcurrentDescriptorAllocator::PopBatch()
+{
+	std::uint64_t head = poolHead.load(std::memory_order_acquire);
+
+	while (true)
+	{
+		std::uint32_t top = static_cast<std::uint32_t>(head);
+		if (top == 0)
+			return NO_BATCH;
+
+		// May be stale if another thread pops the batch first, the tag then makes the exchange fail
+		std::uint32_t below = nextBatch[top - 1].load(std::memory_order_relaxed);
+		std::uint64_t newHead = (((head >> 32) + 1) << 32) | below;
+		if (poolHead.compare_exchange_weak(head, newHead,
+			std::memory_order_acquire, std::memory_order_acquire))
+		{
+			return top - 1;
+		}
+	}
+}
+
+void ConcurrentDescriptorAllocator::PushBatch(std::uint32_t firstIndex)
+{
+	std::uint64_t head = poolHead.load(std::memory_order_relaxed);
+	std::uint64_t newHead = 0;
+
+	do
+	{
+		nextBatch[firstIndex].store(static_cast<std::uint32_t>(head),
+			std::memory_order_relaxed);
+		newHead = (((head >> 32) + 1) << 32) | (firstIndex + 1);
+	} while (!poolHead.compare_exchange_weak(head, newHead,
+		std::memory_order_release, std::memory_order_relaxed));
+}
+
+void ConcurrentDescriptorAllocator::ReleaseDescriptors()
+{
+	if (heapOwned && heap != nullptr)
+		heap->Release();
+
+	if (backingAllocator != nullptr)
+		backingAllocator->DeallocateRange(indexOffset);
+
+	heapOwned = false;
+	heap = nullptr;
+	backingAllocator = nullptr;
+	indexOffset = 0;
+}
+
+ConcurrentDescriptorAllocator::~ConcurrentDescriptorAllocator()
+{
+	ReleaseDescriptors();
+}
+
+ConcurrentDescriptorAllocator::ConcurrentDescriptorAllocator(
+	ConcurrentDescriptorAllocator&& other) noexcept : heapOwned(other.heapOwned),
+	device(other.device), heap(other.heap), heapStart(other.heapStart),
+	backingAllocator(other.backingAllocator), indexOffset(other.indexOffset),
+	descriptorSize(other.descriptorSize), totalDescriptors(other.totalDescriptors),
+	batchSize(other.batchSize), nextInBatch(std::move(other.nextInBatch)),
+	batchLengths(std::move(other.batchLengths)), nextBatch(std::move(other.nextBatch)),
+	poolHead(other.poolHead.load()), nrOfPooledIndices(other.nrOfPooledIndices.load())
+{
+	other.heapOwned = false;
+	other.device = nullptr;
+	other.heap = nullptr;
+	other.backingAllocator = nullptr;
+	other.indexOffset = 0;
+	other.descriptorSize = 0;
+	other.totalDescriptors = 0;
+	other.batchSize = 0;
+	other.poolHead.store(0);
+	other.nrOfPooledIndices.store(0);
+}
+
+ConcurrentDescriptorAllocator& ConcurrentDescriptorAllocator::operator=(
+	ConcurrentDescriptorAllocator&& other) noexcept
+{
+	if (this != &other)
+	{
+		ReleaseDescriptors();
+
+		heapOwned = other.heapOwned;
+		device = other.device;
+		heap = other.heap;
+		heapStart = other.heapStart;
+		backingAllocator = other.backingAllocator;
+		indexOffset = other.indexOffset;
+		descriptorSize = other.descriptorSize;
+		totalDescriptors = other.totalDescriptors;
+		batchSize = other.batchSize;
+		nextInBatch = std::move(other.nextInBatch);
+		batchLengths = std::move(other.batchLengths);
+		nextBatch = std::move(other.nextBatch);
+		poolHead.store(other.poolHead.load());
+		nrOfPooledIndices.store(other.nrOfPooledIndices.load());
+
+		other.heapOwned = false;
+		other.device = nullptr;
+		other.heap = nullptr;
+		other.backingAllocator = nullptr;
+		other.indexOffset = 0;
+		other.descriptorSize = 0;
+		other.totalDescriptors = 0;
+		other.batchSize = 0;
+		other.poolHead.store(0);
+		other.nrOfPooledIndices.store(0);
+	}
+
+	return *this;
+}
+
+void ConcurrentDescriptorAllocator::Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType,
+	ID3D12Device* deviceToUse, DescriptorAllocator& descriptorAllocator,
+	size_t nrOfDescriptors, size_t descriptorsPerBatch)
+{
+	ReleaseDescriptors();
+	size_t rangeStart = descriptorAllocator.AllocateRange(nrOfDescriptors);
+	if (rangeStart == size_t(-1))
+		throw std::runtime_error("Could not reserve descriptors for concurrent allocation");
+
+	// A range never crosses a page, so its handles can be stepped through from the start
+	device = deviceToUse;
+	heapStart = descriptorAllocator.GetDescriptorHandle(rangeStart);
+	backingAllocator = &descriptorAllocator;
+	indexOffset = rangeStart;
+	descriptorSize = deviceToUse->GetDescriptorHandleIncrementSize(descriptorType);
+	InitializeBatches(nrOfDescriptors, descriptorsPerBatch);
+}
+
+void ConcurrentDescriptorAllocator::Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType,
+	ID3D12Device* deviceToUse, size_t nrOfDescriptors, size_t descriptorsPerBatch)
+{
+	D3D12_DESCRIPTOR_HEAP_DESC desc;
+	desc.Type = descriptorType;
+	desc.NumDescriptors = static_cast<UINT>(nrOfDescriptors);
+	desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+	desc.NodeMask = 0;
+
+	ID3D12DescriptorHeap* createdHeap = nullptr;
+	HRESULT hr = deviceToUse->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&createdHeap));
+
+	if (FAILED(hr))
+		throw std::runtime_error("Error: Could not create descriptor heap");
+
+	Initialize(descriptorType, deviceToUse, createdHeap, 0, nrOfDescriptors,
+		descriptorsPerBatch);
+	heapOwned = true;
+}
+
+void ConcurrentDescriptorAllocator::Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType,
+	ID3D12Device* deviceToUse, ID3D12DescriptorHeap* heapToUse, size_t startIndex,
+	size_t nrOfDescriptors, size_t descriptorsPerBatch)
+{
+	size_t sizeOfDescriptor = deviceToUse->GetDescriptorHandleIncrementSize(descriptorType);
+	D3D12_CPU_DESCRIPTOR_HANDLE heapStartHandle =
+		heapToUse->GetCPUDescriptorHandleForHeapStart();
+	heapStartHandle.ptr += sizeOfDescriptor * startIndex;
+
+	Initialize(heapStartHandle, sizeOfDescriptor, nrOfDescriptors, descriptorsPerBatch);
+	device = deviceToUse;
+	heap = heapToUse;
+}
+
+void ConcurrentDescriptorAllocator::Initialize(D3D12_CPU_DESCRIPTOR_HANDLE heapStartHandle,
+	size_t sizeOfDescriptor, size_t nrOfDescriptors, size_t descriptorsPerBatch)
+{
+	ReleaseDescriptors();
+	device = nullptr;
+	heapStart = heapStartHandle;
+	descriptorSize = sizeOfDescriptor;
+	InitializeBatches(nrOfDescriptors, descriptorsPerBatch);
+}
+
+DescriptorThreadCache ConcurrentDescriptorAllocator::CreateThreadCache()
+{
+	return DescriptorThreadCache(this);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE ConcurrentDescriptorAllocator::GetDescriptorHandle(
+	size_t index) const
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE toReturn = heapStart;
+	toReturn.ptr += descriptorSize * (index - indexOffset);
+	return toReturn;
+}
+
+ID3D12DescriptorHeap* ConcurrentDescriptorAllocator::GetHeap() const
+{
+	return heap;
+}
+
+size_t ConcurrentDescriptorAllocator::GetTotalDescriptors() const
+{
+	return totalDescriptors;
+}
+
+size_t ConcurrentDescriptorAllocator::GetBatchSize() const
+{
+	return batchSize;
+}
+
+size_t ConcurrentDescriptorAllocator::NrOfPooledIndices() const
+{
+	return nrOfPooledIndices.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#include <d3d12.h>
+
+#include "DescriptorAllocator.h"
+
+class ConcurrentDescriptorAllocator;
+
+// Owned by a single recording thread, and refilled from or drained to the shared pool a batch at a time
+class DescriptorThreadCache
+{
+private:
+	ConcurrentDescriptorAllocator* allocator = nullptr;
+	std::vector<std::uint32_t> freeIndices; // Allocated from the back
+
+	friend class ConcurrentDescriptorAllocator;
+	explicit DescriptorThreadCache(ConcurrentDescriptorAllocator* owningAllocator);
+
+	void ReturnBatch(size_t nrOfIndices);
+
+public:
+	DescriptorThreadCache() = default;
+	~DescriptorThreadCache();
+	DescriptorThreadCache(const DescriptorThreadCache& other) = delete;
+	DescriptorThreadCache& operator=(const DescriptorThreadCache& other) = delete;
+	DescriptorThreadCache(DescriptorThreadCache&& other) noexcept;
+	DescriptorThreadCache& operator=(DescriptorThreadCache&& other) noexcept;
+
+	// size_t(-1) if neither this cache nor the shared pool has any free indices left,
+	// or if the cache was default constructed or moved from
+	size_t AllocateIndex();
+	void DeallocateIndex(size_t index);
+
+	size_t AllocateSRV(ID3D12Resource* resource,
+		const D3D12_SHADER_RESOURCE_VIEW_DESC* desc = nullptr);
+	size_t AllocateUAV(ID3D12Resource* resource,
+		const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc = nullptr,
+		ID3D12Resource* counterResource = nullptr);
+	size_t AllocateRTV(ID3D12Resource* resource,
+		const D3D12_RENDER_TARGET_VIEW_DESC* desc = nullptr);
+	size_t AllocateDSV(ID3D12Resource* resource,
+		const D3D12_DEPTH_STENCIL_VIEW_DESC* desc = nullptr);
+	size_t AllocateCBV(const D3D12_CONSTANT_BUFFER_VIEW_DESC* desc);
+
+	D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHandle(size_t index) const;
+
+	// Keeps at most one batch, meant to be called once per frame by threads that free more than they allocate
+	void Rebalance();
+	// Returns every cached index to the shared pool, also done on destruction
+	void Flush();
+
+	size_t NrOfCachedIndices() const;
+};
+
+// Thread safe front end for a fixed range of a descriptor heap, intended for transient views.
+// The range is normally reserved from a DescriptorAllocator, so the indices handed out are
+// indices of that allocator and its handles, ranges and bindless heap can be used with them
+class ConcurrentDescriptorAllocator
+{
+private:
+	friend class DescriptorThreadCache;
+
+	static const std::uint32_t NO_BATCH = std::uint32_t(-1);
+
+	bool heapOwned = false;
+	ID3D12Device* device = nullptr;
+	ID3D12DescriptorHeap* heap = nullptr;
+	D3D12_CPU_DESCRIPTOR_HANDLE heapStart = { 0 };
+	DescriptorAllocator* backingAllocator = nullptr;
+	size_t indexOffset = 0; // Start of the backing range, added to the indices handed out
+	size_t descriptorSize = 0;
+	size_t totalDescriptors = 0;
+	size_t batchSize = 0;
+
+	// Free indices in the shared pool are linked into batches, and the batches form a lock free stack.
+	// The lower half of the head is the first index of the top batch + 1, the upper half is a tag against ABA
+	std::unique_ptr<std::uint32_t[]> nextInBatch;
+	std::unique_ptr<std::uint32_t[]> batchLengths; // Only valid for the first index of a batch
+	std::unique_ptr<std::atomic<std::uint32_t>[]> nextBatch;
+	std::atomic<std::uint64_t> poolHead = { 0 };
+	std::atomic<size_t> nrOfPooledIndices = { 0 };
+
+	void InitializeBatches(size_t nrOfDescriptors, size_t descriptorsPerBatch);
+	std::uint32_t PopBatch();
+	void PushBatch(std::uint32_t firstIndex);
+	void ReleaseDescriptors();
+
+public:
+	ConcurrentDescriptorAllocator() = default;
+	~ConcurrentDescriptorAllocator();
+	ConcurrentDescriptorAllocator(const ConcurrentDescriptorAllocator& other) = delete;
+	ConcurrentDescriptorAllocator& operator=(const ConcurrentDescriptorAllocator& other) = delete;
+	// Not thread safe, no thread caches may be alive
+	ConcurrentDescriptorAllocator(ConcurrentDescriptorAllocator&& other) noexcept;
+	ConcurrentDescriptorAllocator& operator=(ConcurrentDescriptorAllocator&& other) noexcept;
+
+	// Reserves a range of the descriptor allocator, which must outlive this allocator.
+	// The range must fit in one page if the descriptor allocator grows by pages
+	void Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType, ID3D12Device* deviceToUse,
+		DescriptorAllocator& descriptorAllocator, size_t nrOfDescriptors,
+		size_t descriptorsPerBatch = 64);
+	void Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType, ID3D12Device* deviceToUse,
+		size_t nrOfDescriptors, size_t descriptorsPerBatch = 64);
+	void Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType, ID3D12Device* deviceToUse,
+		ID3D12DescriptorHeap* heapToUse, size_t startIndex, size_t nrOfDescriptors,
+		size_t descriptorsPerBatch = 64);
+	// Without a device only indices and handles are handed out, views cannot be created
+	void Initialize(D3D12_CPU_DESCRIPTOR_HANDLE heapStartHandle, size_t sizeOfDescriptor,
+		size_t nrOfDescriptors, size_t descriptorsPerBatch = 64);
+
+	// One per thread, and they must be destroyed before the allocator
+	DescriptorThreadCache CreateThreadCache();
+
+	D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHandle(size_t index) const;
+	ID3D12DescriptorHeap* GetHeap() const;
+	size_t GetTotalDescriptors() const;
+	size_t GetBatchSize() const;
+	// Indices held in thread caches are not included
+	size_t NrOfPooledIndices() const;
+};
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "ContentHash.h"
+
+#include <cstring>
+
+namespace
+{
+	const std::uint64_t PRIME1 = 11400714785074694791ULL;
+	const std::uint64_t PRIME2 = 14029467366897019727ULL;
+	const std::uint64_t PRIME3 = 1609587929392839161ULL;
+	const std::uint64_t PRIME4 = 9650029242287828579ULL;
+	const std::uint64_t PRIME5 = 2870177450012600261ULL;
+
+	std::uint64_t RotateLeft(std::uint64_t value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	std::uint64_t Read64(const unsigned char* data)
+	{
+		std::uint64_t toReturn;
+		std::memcpy(&toReturn, data, sizeof(toReturn));
+		return toReturn;
+	}
+
+	std::uint32_t Read32(const unsigned char* data)
+	{
+		std::uint32_t toReturn;
+		std::memcpy(&toReturn, data, sizeof(toReturn));
+		return toReturn;
+	}
+
+	std::uint64_t Round(std::uint64_t accumulator, std::uint64_t input)
+	{
+		accumulator += input * PRIME2;
+		accumulator = RotateLeft(accumulator, 31);
+		return accumulator * PRIME1;
+	}
+
+	std::uint64_t MergeRound(std::uint64_t accumulator, std::uint64_t value)
+	{
+		accumulator ^= Round(0, value);
+		return accumulator * PRIME1 + PRIME4;
+	}
+}
+
+std::uint64_t HashContent(const void* data, size_t dataSize, std::uint64_t seed)
+{
+	const unsigned char* current = static_cast<const unsigned char*>(data);
+	const unsigned char* end = current + dataSize;
+	std::uint64_t toReturn = 0;
+
+	if (dataSize >= 32)
+	{
+		std::uint64_t lanes[4] = { seed + PRIME1 + PRIME2, seed + PRIME2,
+			seed, seed - PRIME1 };
+
+		// Four independent lanes so the multiplications can overlap
+		for (; current + 32 <= end; current += 32)
+		{
+			lanes[0] = Round(lanes[0], Read64(current));
+			lanes[1] = Round(lanes[1], Read64(current + 8));
+			lanes[2] = Round(lanes[2], Read64(current + 16));
+			lanes[3] = Round(lanes[3], Read64(current + 24));
+		}
+
+		toReturn = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) +
+			RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+
+		for (auto lane : lanes)
+			toReturn = MergeRound(toReturn, lane);
+	}
+	else
+	{
+		toReturn = seed + PRIME5;
+	}
+
+	toReturn += static_cast<std::uint64_t>(dataSize);
+
+	for (; current + 8 <= end; current += 8)
+	{
+		toReturn ^= Round(0, Read64(current));
+		toReturn = RotateLeft(toReturn, 27) * PRIME1 + PRIME4;
+	}
+
+	if (current + 4 <= end)
+	{
+		toReturn ^= static_cast<std::uint64_t>(Read32(current)) * PRIME1;
+		toReturn = RotateLeft(toReturn, 23) * PRIME2 + PRIME3;
+		current += 4;
+	}
+
+	for (; current < end; ++current)
+	{
+		toReturn ^= (*current) * PRIME5;
+		toReturn = RotateLeft(toReturn, 11) * PRIME1;
+	}
+
+	toReturn ^= toReturn >> 33;
+	toReturn *= PRIME2;
+	toReturn ^= toReturn >> 29;
+	toReturn *= PRIME3;
+	toReturn ^= toReturn >> 32;
+
+	return toReturn;
+}
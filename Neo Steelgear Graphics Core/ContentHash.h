@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Fast non-cryptographic 64 bit hash (XXH64) for finding identical upload data
+std::uint64_t HashContent(const void* data, size_t dataSize,
+	std::uint64_t seed = 0);
\ No newline at end of file
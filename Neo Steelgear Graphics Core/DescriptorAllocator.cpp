@@ -1,6 +1,10 @@
 #include "DescriptorAllocator.h"
 
 #include <stdexcept>
+#include <cstring>
+#include <algorithm>
+
+#include "ContentHash.h"
 
 ID3D12DescriptorHeap* DescriptorAllocator::AllocateHeap(size_t nrOfDescriptors)
 {
@@ -20,6 +24,46 @@ ID3D12DescriptorHeap* DescriptorAllocator::AllocateHeap(size_t nrOfDescriptors)
 	return toReturn;
 }
 
+void DescriptorAllocator::ExpandHeap(size_t newNrOfDescriptors)
+{
+	ID3D12DescriptorHeap* newHeap = AllocateHeap(newNrOfDescriptors);
+	device->CopyDescriptorsSimple(static_cast<UINT>(heapData.endIndex),
+		newHeap->GetCPUDescriptorHandleForHeapStart(),
+		heapData.heap->GetCPUDescriptorHandleForHeapStart(),
+		heapData.descriptorType);
+	heapData.heap->Release();
+	heapData.heap = newHeap;
+	heapData.endIndex = newNrOfDescriptors;
+}
+
+void DescriptorAllocator::AddHeapPage()
+{
+	ID3D12DescriptorHeap* page = AllocateHeap(heapData.descriptorsPerPage);
+	heapData.pages.push_back(page);
+	heapData.pageStarts.push_back(page->GetCPUDescriptorHandleForHeapStart().ptr);
+	heapData.endIndex += heapData.descriptorsPerPage;
+
+	if (heapData.heap == nullptr)
+		heapData.heap = page;
+}
+
+void DescriptorAllocator::GrowHeap(size_t minimumNrOfDescriptors)
+{
+	if (heapData.descriptorsPerPage != 0)
+	{
+		while (heapData.endIndex < minimumNrOfDescriptors)
+			AddHeapPage();
+
+		return;
+	}
+
+	size_t newSize = heapData.endIndex == 0 ? 1 : heapData.endIndex * 2;
+	while (newSize < minimumNrOfDescriptors)
+		newSize *= 2;
+
+	ExpandHeap(newSize);
+}
+
 size_t DescriptorAllocator::GetFreeDescriptorIndex(size_t indexInHeap)
 {
 	if (descriptors.ActiveSize() >= heapData.endIndex - heapData.startIndex ||
@@ -52,16 +96,7 @@ bool DescriptorAllocator::AllocationHelper(size_t& index,
 	{
 		if (heapData.heapOwned)
 		{
-			size_t newSize = heapData.endIndex * 2;
-			ID3D12DescriptorHeap* newHeap = AllocateHeap(newSize);
-			device->CopyDescriptorsSimple(static_cast<UINT>(heapData.endIndex),
-				newHeap->GetCPUDescriptorHandleForHeapStart(),
-				heapData.heap->GetCPUDescriptorHandleForHeapStart(),
-				heapData.descriptorType);
-			heapData.heap->Release();
-			heapData.heap = newHeap;
-			heapData.endIndex = newSize;
-
+			GrowHeap(heapData.endIndex + 1);
 			index = GetFreeDescriptorIndex(indexInHeap);
 
 			if (index == size_t(-1))
@@ -75,24 +110,428 @@ bool DescriptorAllocator::AllocationHelper(size_t& index,
 		}
 	}
 		
-	handle = heapData.heap->GetCPUDescriptorHandleForHeapStart();
-	handle.ptr += heapData.descriptorSize * (heapData.startIndex + index);
+	handle = GetDescriptorHandle(index);
+
+	return true;
+}
+
+size_t DescriptorAllocator::FindFreeRange(size_t nrOfDescriptors,
+	AllocationStrategy strategy) const
+{
+	size_t capacity = heapData.endIndex - heapData.startIndex;
+	size_t usedEnd = min(descriptors.TotalSize(), capacity);
+	size_t toReturn = size_t(-1);
+	size_t chosenSize = 0;
+	size_t runStart = 0;
+
+	// Free indices form runs between active ones, everything past the stored ones is a single run
+	for (size_t i = 0; i <= usedEnd; ++i)
+	{
+		if (i < usedEnd && !descriptors.CheckIfActive(i))
+			continue;
+
+		size_t currentStart = runStart;
+		size_t runSize = (i < usedEnd ? i : capacity) - currentStart;
+		runStart = i + 1;
+
+		// Ranges cannot cross a page boundary, so the run may have to start at the next page
+		size_t perPage = heapData.descriptorsPerPage;
+		if (perPage != 0 && currentStart % perPage + nrOfDescriptors > perPage)
+		{
+			size_t skipped = perPage - currentStart % perPage;
+			if (skipped >= runSize)
+				continue;
+
+			currentStart += skipped;
+			runSize -= skipped;
+		}
+
+		if (runSize < nrOfDescriptors)
+			continue;
+
+		if (strategy == AllocationStrategy::FIRST_FIT)
+			return currentStart;
+
+		if (toReturn == size_t(-1) ||
+			(strategy == AllocationStrategy::BEST_FIT && runSize < chosenSize) ||
+			(strategy == AllocationStrategy::WORST_FIT && runSize > chosenSize))
+		{
+			toReturn = currentStart;
+			chosenSize = runSize;
+		}
+	}
+
+	return toReturn;
+}
+
+std::uint64_t DescriptorAllocator::HashView(const ViewIdentity& identity,
+	const void* description, size_t descriptionSize)
+{
+	// The identity is hashed member by member as it has padding, the description is
+	// hashed as raw bytes and is therefore expected to be value initialised
+	std::uint64_t toReturn = HashContent(&identity.resource, sizeof(identity.resource));
+	toReturn = HashContent(&identity.counterResource,
+		sizeof(identity.counterResource), toReturn);
+	toReturn = HashContent(&identity.type, sizeof(identity.type), toReturn);
+
+	if (description != nullptr)
+		toReturn = HashContent(description, descriptionSize, toReturn);
+
+	return toReturn;
+}
+
+template<typename Description>
+std::uint32_t DescriptorAllocator::StoreDescription(
+	DescriptionPool<Description>& pool, const Description* description)
+{
+	if (description == nullptr)
+		return NO_DESCRIPTION;
+	else if (!storeDescriptions)
+		return DESCRIPTION_NOT_STORED;
+
+	if (pool.freeIndices.empty())
+	{
+		pool.descriptions.push_back(*description);
+		return static_cast<std::uint32_t>(pool.descriptions.size() - 1);
+	}
+
+	std::uint32_t toReturn = pool.freeIndices.back();
+	pool.freeIndices.pop_back();
+	pool.descriptions[toReturn] = *description;
+	return toReturn;
+}
+
+template<typename Description>
+Description* DescriptorAllocator::GetDescription(
+	DescriptionPool<Description>& pool, std::uint32_t descriptionIndex)
+{
+	if (descriptionIndex == NO_DESCRIPTION || descriptionIndex == DESCRIPTION_NOT_STORED)
+		return nullptr;
+
+	return &pool.descriptions[descriptionIndex];
+}
+
+const void* DescriptorAllocator::GetStoredDescription(
+	const StoredDescriptor& descriptor)
+{
+	std::uint32_t index = descriptor.descriptionIndex;
+
+	switch (descriptor.type)
+	{
+	case DescriptorType::CBV:
+		return GetDescription(cbvDescriptions, index);
+	case DescriptorType::SRV:
+		return GetDescription(srvDescriptions, index);
+	case DescriptorType::UAV:
+		return GetDescription(uavDescriptions, index);
+	case DescriptorType::RTV:
+		return GetDescription(rtvDescriptions, index);
+	case DescriptorType::DSV:
+		return GetDescription(dsvDescriptions, index);
+	default:
+		return nullptr;
+	}
+}
+
+void DescriptorAllocator::ReleaseDescription(const StoredDescriptor& descriptor)
+{
+	std::uint32_t index = descriptor.descriptionIndex;
+	if (index == NO_DESCRIPTION || index == DESCRIPTION_NOT_STORED)
+		return;
+
+	switch (descriptor.type)
+	{
+	case DescriptorType::CBV:
+		cbvDescriptions.freeIndices.push_back(index);
+		break;
+	case DescriptorType::SRV:
+		srvDescriptions.freeIndices.push_back(index);
+		break;
+	case DescriptorType::UAV:
+		uavDescriptions.freeIndices.push_back(index);
+		break;
+	case DescriptorType::RTV:
+		rtvDescriptions.freeIndices.push_back(index);
+		break;
+	case DescriptorType::DSV:
+		dsvDescriptions.freeIndices.push_back(index);
+		break;
+	default:
+		break;
+	}
+}
+
+size_t DescriptorAllocator::FindCachedView(const ViewIdentity& identity,
+	const void* description, size_t descriptionSize, std::uint64_t viewHash)
+{
+	auto candidates = cachedViews.equal_range(viewHash);
+
+	for (auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+	{
+		const CachedView& cachedView = candidate->second;
+		if (cachedView.identity.resource != identity.resource ||
+			cachedView.identity.counterResource != identity.counterResource ||
+			cachedView.identity.type != identity.type)
+		{
+			continue;
+		}
+
+		// Descriptions are compared bytewise, so differing padding or unused union bytes
+		// of otherwise equal descriptions cause a miss but never a false match
+		const StoredDescriptor& stored = descriptors[cachedView.descriptorIndex];
+		const void* storedDescription = GetStoredDescription(stored);
+		if (stored.descriptionIndex == DESCRIPTION_NOT_STORED ||
+			(storedDescription == nullptr) != (description == nullptr) ||
+			(description != nullptr &&
+				std::memcmp(storedDescription, description, descriptionSize) != 0))
+		{
+			continue;
+		}
+
+		++viewReferences[cachedView.descriptorIndex].referenceCount;
+		return cachedView.descriptorIndex;
+	}
+
+	return size_t(-1);
+}
+
+void DescriptorAllocator::CacheView(const ViewIdentity& identity,
+	std::uint64_t viewHash, size_t index)
+{
+	CachedView toCache;
+	toCache.identity = identity;
+	toCache.descriptorIndex = index;
+	cachedViews.insert(std::make_pair(viewHash, toCache));
+
+	ViewReference& reference = viewReferences[index];
+	reference.viewHash = viewHash;
+	reference.referenceCount = 1;
+}
+
+void DescriptorAllocator::UncacheView(size_t index)
+{
+	auto reference = viewReferences.find(index);
+	if (reference == viewReferences.end())
+		return;
+
+	auto candidates = cachedViews.equal_range(reference->second.viewHash);
+	for (auto candidate = candidates.first; candidate != candidates.second; ++candidate)
+	{
+		if (candidate->second.descriptorIndex == index)
+		{
+			cachedViews.erase(candidate);
+			break;
+		}
+	}
+}
+
+template<typename Description, typename CreateFunction>
+size_t DescriptorAllocator::AllocateView(const ViewIdentity& identity,
+	DescriptionPool<Description>& pool, const Description* description,
+	size_t indexInHeap, CreateFunction createView)
+{
+	bool deduplicate = deduplicateViews && indexInHeap == size_t(-1);
+	std::uint64_t viewHash = 0;
+
+	if (deduplicate)
+	{
+		viewHash = HashView(identity, description, sizeof(Description));
+		size_t cachedIndex = FindCachedView(identity, description,
+			sizeof(Description), viewHash);
+		if (cachedIndex != size_t(-1))
+			return cachedIndex;
+	}
+
+	size_t index = 0;
+	D3D12_CPU_DESCRIPTOR_HANDLE handle;
+
+	if (AllocationHelper(index, handle, indexInHeap))
+	{
+		createView(handle);
+		descriptors[index].type = identity.type;
+		descriptors[index].descriptionIndex = StoreDescription(pool, description);
+
+		if (deduplicate && descriptors[index].descriptionIndex != DESCRIPTION_NOT_STORED)
+			CacheView(identity, viewHash, index);
+	}
+
+	return index;
+}
+
+bool DescriptorAllocator::ReserveBatchIndices(size_t nrOfViews, size_t* indices,
+	const size_t* indicesInHeap)
+{
+	if (indicesInHeap != nullptr)
+	{
+		// Each index can only be reserved once
+		std::vector<size_t> sortedIndices(indicesInHeap, indicesInHeap + nrOfViews);
+		std::sort(sortedIndices.begin(), sortedIndices.end());
+		if (std::adjacent_find(sortedIndices.begin(), sortedIndices.end()) !=
+			sortedIndices.end())
+		{
+			return false;
+		}
+
+		size_t endIndex = 0;
+		for (size_t i = 0; i < nrOfViews; ++i)
+		{
+			size_t index = indicesInHeap[i];
+			if (index < descriptors.TotalSize() && descriptors.CheckIfActive(index))
+				return false;
+
+			endIndex = max(endIndex, index + 1);
+		}
+
+		if (endIndex > heapData.endIndex - heapData.startIndex)
+		{
+			if (!heapData.heapOwned)
+				return false;
+
+			GrowHeap(endIndex);
+		}
+
+		descriptors.AddIndices(StoredDescriptor(), indicesInHeap, nrOfViews);
+		for (size_t i = 0; i < nrOfViews; ++i)
+			indices[i] = indicesInHeap[i];
+
+		return true;
+	}
+
+	// A single run keeps the handles consecutive, otherwise free indices are gathered
+	size_t perPage = heapData.descriptorsPerPage;
+	size_t startIndex = perPage == 0 || nrOfViews <= perPage ?
+		FindFreeRange(nrOfViews, AllocationStrategy::FIRST_FIT) : size_t(-1);
+
+	if (startIndex != size_t(-1))
+	{
+		descriptors.AddRange(StoredDescriptor(), startIndex, nrOfViews);
+		for (size_t i = 0; i < nrOfViews; ++i)
+			indices[i] = startIndex + i;
+
+		return true;
+	}
+
+	if (heapData.endIndex - heapData.startIndex - descriptors.ActiveSize() < nrOfViews)
+	{
+		if (!heapData.heapOwned)
+			return false;
+
+		GrowHeap(descriptors.ActiveSize() + nrOfViews);
+	}
+
+	size_t capacity = heapData.endIndex - heapData.startIndex;
+	size_t nrOfFound = 0;
+	for (size_t i = 0; i < capacity && nrOfFound < nrOfViews; ++i)
+	{
+		if (i >= descriptors.TotalSize() || !descriptors.CheckIfActive(i))
+			indices[nrOfFound++] = i;
+	}
+
+	descriptors.AddIndices(StoredDescriptor(), indices, nrOfViews);
+	return true;
+}
+
+template<typename Description, typename CreateFunction>
+bool DescriptorAllocator::AllocateViewBatch(DescriptorType type,
+	DescriptionPool<Description>& pool, const DescriptorBatchView<Description>* views,
+	size_t nrOfViews, size_t* indices, const size_t* indicesInHeap,
+	CreateFunction createView)
+{
+	if (nrOfViews == 0)
+		return true;
+
+	if (!ReserveBatchIndices(nrOfViews, indices, indicesInHeap))
+		return false;
+
+	size_t perPage = heapData.descriptorsPerPage;
+	D3D12_CPU_DESCRIPTOR_HANDLE handle = GetDescriptorHandle(indices[0]);
+
+	for (size_t i = 0; i < nrOfViews; ++i)
+	{
+		// Consecutive indices only need the handle to be stepped forward
+		if (i != 0)
+		{
+			if (indices[i] == indices[i - 1] + 1 && (perPage == 0 || indices[i] % perPage != 0))
+				handle.ptr += heapData.descriptorSize;
+			else
+				handle = GetDescriptorHandle(indices[i]);
+		}
+
+		createView(views[i], handle);
+		StoredDescriptor& stored = descriptors[indices[i]];
+		stored.type = type;
+		stored.descriptionIndex = StoreDescription(pool, views[i].desc);
+	}
+
+	return true;
+}
+
+bool DescriptorAllocator::ReleaseViewReference(size_t index)
+{
+	auto reference = viewReferences.find(index);
+	if (reference == viewReferences.end())
+		return true;
 
+	if (--reference->second.referenceCount > 0)
+		return false;
+
+	UncacheView(index);
+	viewReferences.erase(reference);
 	return true;
 }
 
+void DescriptorAllocator::FreeRetiredDescriptors(std::vector<size_t>& indices)
+{
+	for (size_t index : indices)
+		ReleaseDescription(descriptors[index]);
+
+	descriptors.RemoveIndices(indices.data(), indices.size());
+
+	if (indices.capacity() > spareRetirementStorage.capacity())
+	{
+		indices.clear();
+		spareRetirementStorage = std::move(indices);
+	}
+}
+
 DescriptorAllocator::~DescriptorAllocator()
 {
-	if (heapData.heapOwned == true && heapData.heap != nullptr)
-		heapData.heap->Release();
+	if (heapData.heapOwned == true)
+	{
+		if (heapData.descriptorsPerPage != 0)
+		{
+			for (auto& page : heapData.pages)
+				page->Release();
+		}
+		else if (heapData.heap != nullptr)
+		{
+			heapData.heap->Release();
+		}
+	}
 }
 
 DescriptorAllocator::DescriptorAllocator(DescriptorAllocator&& other) noexcept :
-	heapData(other.heapData), device(other.device), 
-	descriptors(std::move(other.descriptors))
+	heapData(std::move(other.heapData)), device(other.device), 
+	descriptors(std::move(other.descriptors)), ranges(std::move(other.ranges)),
+	storeDescriptions(other.storeDescriptions),
+	cbvDescriptions(std::move(other.cbvDescriptions)),
+	srvDescriptions(std::move(other.srvDescriptions)),
+	uavDescriptions(std::move(other.uavDescriptions)),
+	rtvDescriptions(std::move(other.rtvDescriptions)),
+	dsvDescriptions(std::move(other.dsvDescriptions)),
+	deduplicateViews(other.deduplicateViews),
+	cachedViews(std::move(other.cachedViews)),
+	viewReferences(std::move(other.viewReferences)),
+	unsubmittedRetirements(std::move(other.unsubmittedRetirements)),
+	submittedRetirements(std::move(other.submittedRetirements)),
+	spareRetirementStorage(std::move(other.spareRetirementStorage)),
+	completedValue(other.completedValue)
 {
 	other.heapData = DescriptorHeapData();
 	other.device = nullptr;
+	other.storeDescriptions = true;
+	other.deduplicateViews = false;
+	other.completedValue = 0;
 }
 
 DescriptorAllocator& 
@@ -100,11 +539,28 @@ DescriptorAllocator::operator=(DescriptorAllocator&& other) noexcept
 {
 	if (this != &other)
 	{
-		heapData = other.heapData;
+		heapData = std::move(other.heapData);
 		other.heapData = DescriptorHeapData();
 		device = other.device;
 		other.device = nullptr;
-		descriptors = std::move(descriptors);
+		descriptors = std::move(other.descriptors);
+		ranges = std::move(other.ranges);
+		storeDescriptions = other.storeDescriptions;
+		other.storeDescriptions = true;
+		cbvDescriptions = std::move(other.cbvDescriptions);
+		srvDescriptions = std::move(other.srvDescriptions);
+		uavDescriptions = std::move(other.uavDescriptions);
+		rtvDescriptions = std::move(other.rtvDescriptions);
+		dsvDescriptions = std::move(other.dsvDescriptions);
+		deduplicateViews = other.deduplicateViews;
+		other.deduplicateViews = false;
+		cachedViews = std::move(other.cachedViews);
+		viewReferences = std::move(other.viewReferences);
+		unsubmittedRetirements = std::move(other.unsubmittedRetirements);
+		submittedRetirements = std::move(other.submittedRetirements);
+		spareRetirementStorage = std::move(other.spareRetirementStorage);
+		completedValue = other.completedValue;
+		other.completedValue = 0;
 	}
 
 	return *this;
@@ -125,132 +581,248 @@ void DescriptorAllocator::Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType,
 }
 
 void DescriptorAllocator::Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType,
-	ID3D12Device* deviceToUse, size_t startNrOfDescriptors)
+	ID3D12Device* deviceToUse, size_t startNrOfDescriptors, size_t descriptorsPerPage)
 {
 	device = deviceToUse;
 	heapData.heapOwned = true;
 	heapData.descriptorType = descriptorType;
 	heapData.descriptorSize = device->GetDescriptorHandleIncrementSize(descriptorType);
 	heapData.startIndex = 0;
-	heapData.endIndex = startNrOfDescriptors;
-	heapData.heap = AllocateHeap(startNrOfDescriptors);
+
+	if (descriptorsPerPage != 0)
+	{
+		heapData.descriptorsPerPage = descriptorsPerPage;
+		heapData.endIndex = 0;
+
+		do
+		{
+			AddHeapPage();
+		} while (heapData.endIndex < startNrOfDescriptors);
+	}
+	else
+	{
+		heapData.endIndex = startNrOfDescriptors;
+		heapData.heap = AllocateHeap(startNrOfDescriptors);
+	}
 }
 
 size_t DescriptorAllocator::AllocateSRV(ID3D12Resource* resource, 
 	const D3D12_SHADER_RESOURCE_VIEW_DESC* desc, size_t indexInHeap)
 {
-	size_t index = 0;
-	D3D12_CPU_DESCRIPTOR_HANDLE handle;
-
-	if (AllocationHelper(index, handle, indexInHeap))
-	{
-		device->CreateShaderResourceView(resource, desc, handle);
-		descriptors[index].type = DescriptorType::SRV;
-		descriptors[index].description.srv = desc != nullptr ?
-			std::make_optional(*desc) : std::nullopt;
-	}
+	ViewIdentity identity;
+	identity.resource = resource;
+	identity.type = DescriptorType::SRV;
 
-	return index;
+	return AllocateView(identity, srvDescriptions, desc, indexInHeap,
+		[&](D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			device->CreateShaderResourceView(resource, desc, handle);
+		});
 }
 
 size_t DescriptorAllocator::AllocateDSV(ID3D12Resource* resource, 
 	const D3D12_DEPTH_STENCIL_VIEW_DESC* desc, size_t indexInHeap)
 {
-	size_t index = 0;
-	D3D12_CPU_DESCRIPTOR_HANDLE handle;
-
-	if(AllocationHelper(index, handle, indexInHeap))
-	{
-		device->CreateDepthStencilView(resource, desc, handle);
-		descriptors[index].type = DescriptorType::DSV;
-		descriptors[index].description.dsv = desc != nullptr ?
-			std::make_optional(*desc) : std::nullopt;
-	}
+	ViewIdentity identity;
+	identity.resource = resource;
+	identity.type = DescriptorType::DSV;
 
-	return index;
+	return AllocateView(identity, dsvDescriptions, desc, indexInHeap,
+		[&](D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			device->CreateDepthStencilView(resource, desc, handle);
+		});
 }
 
 size_t DescriptorAllocator::AllocateRTV(ID3D12Resource* resource, 
 	const D3D12_RENDER_TARGET_VIEW_DESC* desc, size_t indexInHeap)
 {
-	size_t index = 0;
-	D3D12_CPU_DESCRIPTOR_HANDLE handle;
-
-	if (AllocationHelper(index, handle, indexInHeap))
-	{
-		device->CreateRenderTargetView(resource, desc, handle);
-		descriptors[index].type = DescriptorType::RTV;
-		descriptors[index].description.rtv = desc != nullptr ?
-			std::make_optional(*desc) : std::nullopt;
-	}
+	ViewIdentity identity;
+	identity.resource = resource;
+	identity.type = DescriptorType::RTV;
 
-	return index;
+	return AllocateView(identity, rtvDescriptions, desc, indexInHeap,
+		[&](D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			device->CreateRenderTargetView(resource, desc, handle);
+		});
 }
 
 size_t DescriptorAllocator::AllocateUAV(ID3D12Resource* resource, 
 	const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc, ID3D12Resource* counterResource,
 	size_t indexInHeap)
 {
-	size_t index = 0;
-	D3D12_CPU_DESCRIPTOR_HANDLE handle;
+	ViewIdentity identity;
+	identity.resource = resource;
+	identity.counterResource = counterResource;
+	identity.type = DescriptorType::UAV;
 
-	if (AllocationHelper(index, handle, indexInHeap))
-	{
-		device->CreateUnorderedAccessView(resource, counterResource, desc, handle);
-		descriptors[index].type = DescriptorType::UAV;
-		descriptors[index].description.uav = desc != nullptr ?
-			std::make_optional(*desc) : std::nullopt;
-	}
-
-	return index;
+	return AllocateView(identity, uavDescriptions, desc, indexInHeap,
+		[&](D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			device->CreateUnorderedAccessView(resource, counterResource, desc, handle);
+		});
 }
 
 size_t DescriptorAllocator::AllocateCBV(
 	const D3D12_CONSTANT_BUFFER_VIEW_DESC* desc, size_t indexInHeap)
 {
-	size_t index = 0;
-	D3D12_CPU_DESCRIPTOR_HANDLE handle;
+	ViewIdentity identity;
+	identity.type = DescriptorType::CBV;
 
-	if (AllocationHelper(index, handle, indexInHeap))
+	return AllocateView(identity, cbvDescriptions, desc, indexInHeap,
+		[&](D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			device->CreateConstantBufferView(desc, handle);
+		});
+}
+
+bool DescriptorAllocator::AllocateSRVs(
+	const DescriptorBatchView<D3D12_SHADER_RESOURCE_VIEW_DESC>* views,
+	size_t nrOfViews, size_t* indices, const size_t* indicesInHeap)
+{
+	return AllocateViewBatch(DescriptorType::SRV, srvDescriptions, views, nrOfViews,
+		indices, indicesInHeap, [this](const auto& view, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			device->CreateShaderResourceView(view.resource, view.desc, handle);
+		});
+}
+
+bool DescriptorAllocator::AllocateDSVs(
+	const DescriptorBatchView<D3D12_DEPTH_STENCIL_VIEW_DESC>* views,
+	size_t nrOfViews, size_t* indices, const size_t* indicesInHeap)
+{
+	return AllocateViewBatch(DescriptorType::DSV, dsvDescriptions, views, nrOfViews,
+		indices, indicesInHeap, [this](const auto& view, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			device->CreateDepthStencilView(view.resource, view.desc, handle);
+		});
+}
+
+bool DescriptorAllocator::AllocateRTVs(
+	const DescriptorBatchView<D3D12_RENDER_TARGET_VIEW_DESC>* views,
+	size_t nrOfViews, size_t* indices, const size_t* indicesInHeap)
+{
+	return AllocateViewBatch(DescriptorType::RTV, rtvDescriptions, views, nrOfViews,
+		indices, indicesInHeap, [this](const auto& view, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			device->CreateRenderTargetView(view.resource, view.desc, handle);
+		});
+}
+
+bool DescriptorAllocator::AllocateUAVs(
+	const DescriptorBatchView<D3D12_UNORDERED_ACCESS_VIEW_DESC>* views,
+	size_t nrOfViews, size_t* indices, const size_t* indicesInHeap)
+{
+	return AllocateViewBatch(DescriptorType::UAV, uavDescriptions, views, nrOfViews,
+		indices, indicesInHeap, [this](const auto& view, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			device->CreateUnorderedAccessView(view.resource, view.counterResource,
+				view.desc, handle);
+		});
+}
+
+bool DescriptorAllocator::AllocateCBVs(
+	const DescriptorBatchView<D3D12_CONSTANT_BUFFER_VIEW_DESC>* views,
+	size_t nrOfViews, size_t* indices, const size_t* indicesInHeap)
+{
+	return AllocateViewBatch(DescriptorType::CBV, cbvDescriptions, views, nrOfViews,
+		indices, indicesInHeap, [this](const auto& view, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			device->CreateConstantBufferView(view.desc, handle);
+		});
+}
+
+size_t DescriptorAllocator::AllocateRange(size_t nrOfDescriptors,
+	AllocationStrategy strategy)
+{
+	if (nrOfDescriptors == 0)
+		throw std::runtime_error("Cannot allocate an empty descriptor range");
+
+	if (heapData.descriptorsPerPage != 0 && nrOfDescriptors > heapData.descriptorsPerPage)
+		throw std::runtime_error("Cannot allocate a descriptor range larger than a heap page");
+
+	size_t startIndex = FindFreeRange(nrOfDescriptors, strategy);
+
+	if (startIndex == size_t(-1))
 	{
-		device->CreateConstantBufferView(desc, handle);
-		descriptors[index].type = DescriptorType::CBV;
-		descriptors[index].description.cbv = desc != nullptr ?
-			std::make_optional(*desc) : std::nullopt;
+		if (!heapData.heapOwned)
+			return size_t(-1);
+
+		// The new descriptors join any free run at the end of the old heap
+		GrowHeap(heapData.endIndex + nrOfDescriptors);
+		startIndex = FindFreeRange(nrOfDescriptors, strategy);
 	}
 
-	return index;
+	descriptors.AddRange(StoredDescriptor(), startIndex, nrOfDescriptors);
+	ranges[startIndex] = nrOfDescriptors;
+
+	return startIndex;
+}
+
+void DescriptorAllocator::CopyToRange(size_t startIndex,
+	const D3D12_CPU_DESCRIPTOR_HANDLE* sourceHandles, size_t nrOfDescriptors,
+	size_t offsetInRange)
+{
+	auto range = ranges.find(startIndex);
+	if (range == ranges.end() || offsetInRange + nrOfDescriptors > range->second)
+		throw std::runtime_error("Cannot copy outside of an allocated descriptor range");
+
+	D3D12_CPU_DESCRIPTOR_HANDLE destination = GetDescriptorHandle(startIndex + offsetInRange);
+	UINT destinationSize = static_cast<UINT>(nrOfDescriptors);
+	device->CopyDescriptors(1, &destination, &destinationSize, destinationSize,
+		sourceHandles, nullptr, heapData.descriptorType);
+}
+
+void DescriptorAllocator::DeallocateRange(size_t startIndex)
+{
+	auto range = ranges.find(startIndex);
+	if (range == ranges.end())
+		throw std::runtime_error("Cannot deallocate a descriptor range that does not exist");
+
+	for (size_t i = startIndex; i < startIndex + range->second; ++i)
+		descriptors.Remove(i);
+
+	ranges.erase(range);
 }
 
 void DescriptorAllocator::ReallocateView(size_t indexInHeap, ID3D12Resource* resource)
 {
-	StoredDescriptor& descriptorInfo = descriptors[indexInHeap];
-	D3D12_CPU_DESCRIPTOR_HANDLE handle = 
-		heapData.heap->GetCPUDescriptorHandleForHeapStart();
-	handle.ptr += heapData.descriptorSize * (heapData.startIndex + indexInHeap);
+	UncacheView(indexInHeap); // Still shared, but no longer identical to new requests
+
+	const StoredDescriptor& descriptorInfo = descriptors[indexInHeap];
+	D3D12_CPU_DESCRIPTOR_HANDLE handle = GetDescriptorHandle(indexInHeap);
+	std::uint32_t descriptionIndex = descriptorInfo.descriptionIndex;
+
+	if (descriptionIndex == DESCRIPTION_NOT_STORED)
+		throw std::runtime_error("Cannot reallocate a view without a stored description");
 
 	switch (descriptorInfo.type)
 	{
 	case DescriptorAllocator::DescriptorType::CBV:
-		(*descriptorInfo.description.cbv).BufferLocation = 
-			resource->GetGPUVirtualAddress();
-		device->CreateConstantBufferView(&(*descriptorInfo.description.cbv), handle);
+	{
+		D3D12_CONSTANT_BUFFER_VIEW_DESC* cbv =
+			GetDescription(cbvDescriptions, descriptionIndex);
+		if (cbv != nullptr)
+			cbv->BufferLocation = resource->GetGPUVirtualAddress();
+		device->CreateConstantBufferView(cbv, handle);
 		break;
+	}
 	case DescriptorAllocator::DescriptorType::SRV:
-		device->CreateShaderResourceView(resource, descriptorInfo.description.srv.has_value() ?
-			&(*descriptorInfo.description.srv) : nullptr, handle);
+		device->CreateShaderResourceView(resource,
+			GetDescription(srvDescriptions, descriptionIndex), handle);
 		break;
 	case DescriptorAllocator::DescriptorType::UAV:
-		device->CreateUnorderedAccessView(resource, nullptr, descriptorInfo.description.uav.has_value() ?
-			&(*descriptorInfo.description.uav) : nullptr, handle);
+		device->CreateUnorderedAccessView(resource, nullptr,
+			GetDescription(uavDescriptions, descriptionIndex), handle);
 		break;
 	case DescriptorAllocator::DescriptorType::RTV:
-		device->CreateRenderTargetView(resource, descriptorInfo.description.rtv.has_value() ?
-			&(*descriptorInfo.description.rtv) : nullptr, handle);
+		device->CreateRenderTargetView(resource,
+			GetDescription(rtvDescriptions, descriptionIndex), handle);
 		break;
 	case DescriptorAllocator::DescriptorType::DSV:
-		device->CreateShaderResourceView(resource, descriptorInfo.description.srv.has_value() ?
-			&(*descriptorInfo.description.srv) : nullptr, handle);
+		device->CreateDepthStencilView(resource,
+			GetDescription(dsvDescriptions, descriptionIndex), handle);
 		break;
 	default:
 		break;
@@ -259,13 +831,72 @@ void DescriptorAllocator::ReallocateView(size_t indexInHeap, ID3D12Resource* res
 
 void DescriptorAllocator::DeallocateDescriptor(size_t index)
 {
+	if (!ReleaseViewReference(index))
+		return;
+
+	ReleaseDescription(descriptors[index]);
 	descriptors.Remove(index);
 }
 
+void DescriptorAllocator::RetireDescriptor(size_t index)
+{
+	// Shared views are only retired by their last reference
+	if (ReleaseViewReference(index))
+		unsubmittedRetirements.push_back(index);
+}
+
+void DescriptorAllocator::SubmitRetirements(std::uint64_t completionValue)
+{
+	if (unsubmittedRetirements.empty())
+		return;
+
+	RetirementBatch batch;
+	batch.completionValue = completionValue;
+	batch.indices = std::move(unsubmittedRetirements);
+	submittedRetirements.push_back(std::move(batch));
+
+	unsubmittedRetirements = std::move(spareRetirementStorage);
+	unsubmittedRetirements.clear();
+}
+
+void DescriptorAllocator::UpdateCompletedValue(std::uint64_t newCompletedValue)
+{
+	completedValue = newCompletedValue;
+
+	while (!submittedRetirements.empty() &&
+		submittedRetirements.front().completionValue <= completedValue)
+	{
+		FreeRetiredDescriptors(submittedRetirements.front().indices);
+		submittedRetirements.pop_front();
+	}
+}
+
+void DescriptorAllocator::UpdateCompletedValue(ID3D12Fence* fence)
+{
+	UpdateCompletedValue(fence->GetCompletedValue());
+}
+
+size_t DescriptorAllocator::NrOfRetiredDescriptors() const
+{
+	size_t toReturn = unsubmittedRetirements.size();
+	for (const auto& batch : submittedRetirements)
+		toReturn += batch.indices.size();
+
+	return toReturn;
+}
+
 const D3D12_CPU_DESCRIPTOR_HANDLE DescriptorAllocator::GetDescriptorHandle(
 	size_t index) const
 {
 	D3D12_CPU_DESCRIPTOR_HANDLE toReturn;
+
+	if (heapData.descriptorsPerPage != 0)
+	{
+		toReturn.ptr = heapData.pageStarts[index / heapData.descriptorsPerPage] +
+			heapData.descriptorSize * (index % heapData.descriptorsPerPage);
+		return toReturn;
+	}
+
 	toReturn = heapData.heap->GetCPUDescriptorHandleForHeapStart();
 
 	toReturn.ptr += heapData.descriptorSize * (heapData.startIndex + index);
@@ -273,12 +904,60 @@ const D3D12_CPU_DESCRIPTOR_HANDLE DescriptorAllocator::GetDescriptorHandle(
 	return toReturn;
 }
 
+bool DescriptorAllocator::DescriptorsArePaged() const
+{
+	return heapData.descriptorsPerPage != 0;
+}
+
 size_t DescriptorAllocator::NrOfStoredDescriptors() const
 {
 	return descriptors.TotalSize();
 }
 
+void DescriptorAllocator::SetDescriptionStorage(bool enabled)
+{
+	storeDescriptions = enabled;
+}
+
+bool DescriptorAllocator::DescriptionStorageEnabled() const
+{
+	return storeDescriptions;
+}
+
+void DescriptorAllocator::SetViewDeduplication(bool enabled)
+{
+	deduplicateViews = enabled;
+
+	// Already shared views keep counting references until they are released
+	if (!enabled)
+		cachedViews.clear();
+}
+
+bool DescriptorAllocator::ViewDeduplicationEnabled() const
+{
+	return deduplicateViews;
+}
+
+size_t DescriptorAllocator::NrOfViewReferences(size_t index) const
+{
+	if (index >= descriptors.TotalSize() || !descriptors.CheckIfActive(index))
+		return 0;
+
+	auto reference = viewReferences.find(index);
+	return reference != viewReferences.end() ? reference->second.referenceCount : 1;
+}
+
 void DescriptorAllocator::Reset()
 {
 	descriptors.Clear();
+	ranges.clear();
+	cbvDescriptions = DescriptionPool<D3D12_CONSTANT_BUFFER_VIEW_DESC>();
+	srvDescriptions = DescriptionPool<D3D12_SHADER_RESOURCE_VIEW_DESC>();
+	uavDescriptions = DescriptionPool<D3D12_UNORDERED_ACCESS_VIEW_DESC>();
+	rtvDescriptions = DescriptionPool<D3D12_RENDER_TARGET_VIEW_DESC>();
+	dsvDescriptions = DescriptionPool<D3D12_DEPTH_STENCIL_VIEW_DESC>();
+	cachedViews.clear();
+	viewReferences.clear();
+	unsubmittedRetirements.clear();
+	submittedRetirements.clear();
 }
@@ -1,11 +1,24 @@
 #pragma once
 
+#include <deque>
+#include <vector>
 #include <optional>
+#include <cstdint>
+#include <unordered_map>
 
 #include <d3d12.h>
 #include <dxgi1_6.h>
 
 #include "StableVector.h"
+#include "HeapHelper.h"
+
+template<typename Description>
+struct DescriptorBatchView
+{
+	ID3D12Resource* resource = nullptr; // Not used by CBVs
+	const Description* desc = nullptr;
+	ID3D12Resource* counterResource = nullptr; // Only used by UAVs
+};
 
 class DescriptorAllocator
 {
@@ -19,9 +32,12 @@ private:
 		size_t descriptorSize = 0;
 		size_t startIndex = size_t(-1);
 		size_t endIndex = size_t(-1);
+		size_t descriptorsPerPage = 0; // Only set for owned heaps that grow by pages
+		std::vector<ID3D12DescriptorHeap*> pages; // The first page is also the heap
+		std::vector<SIZE_T> pageStarts;
 	} heapData;
 
-	enum class DescriptorType
+	enum class DescriptorType : std::uint8_t
 	{
 		NONE,
 		CBV,
@@ -31,39 +47,105 @@ private:
 		DSV
 	};
 
+	static const std::uint32_t NO_DESCRIPTION = std::uint32_t(-1); // Created from nullptr
+	static const std::uint32_t DESCRIPTION_NOT_STORED = std::uint32_t(-2);
+
+	// Descriptions live in pools per view type, so each descriptor only stores an index
 	struct StoredDescriptor
 	{
-		DescriptorType type;
-
-		union DescriptorDescription
-		{
-			std::optional<D3D12_CONSTANT_BUFFER_VIEW_DESC> cbv;
-			std::optional<D3D12_SHADER_RESOURCE_VIEW_DESC> srv;
-			std::optional<D3D12_UNORDERED_ACCESS_VIEW_DESC> uav;
-			std::optional<D3D12_RENDER_TARGET_VIEW_DESC> rtv;
-			std::optional<D3D12_DEPTH_STENCIL_VIEW_DESC> dsv;
-
-			DescriptorDescription() : cbv(std::nullopt)
-			{
-				// EMPTY
-			}
-
-		} description;
-
-		StoredDescriptor() : type(DescriptorType::NONE)
-		{
-			// EMPTY
-		}
+		DescriptorType type = DescriptorType::NONE;
+		std::uint32_t descriptionIndex = NO_DESCRIPTION;
+	};
+
+	template<typename Description>
+	struct DescriptionPool
+	{
+		std::vector<Description> descriptions;
+		std::vector<std::uint32_t> freeIndices;
+	};
+
+	struct ViewIdentity
+	{
+		ID3D12Resource* resource = nullptr;
+		ID3D12Resource* counterResource = nullptr;
+		DescriptorType type = DescriptorType::NONE;
+	};
+
+	struct CachedView
+	{
+		ViewIdentity identity;
+		size_t descriptorIndex = size_t(-1);
+	};
+
+	struct ViewReference
+	{
+		std::uint64_t viewHash = 0;
+		size_t referenceCount = 0;
+	};
+
+	struct RetirementBatch
+	{
+		std::uint64_t completionValue = 0;
+		std::vector<size_t> indices;
 	};
 
 	ID3D12Device* device = nullptr;
 	StableVector<StoredDescriptor> descriptors;
+	std::unordered_map<size_t, size_t> ranges; // Start index to number of descriptors
+
+	bool storeDescriptions = true;
+	DescriptionPool<D3D12_CONSTANT_BUFFER_VIEW_DESC> cbvDescriptions;
+	DescriptionPool<D3D12_SHADER_RESOURCE_VIEW_DESC> srvDescriptions;
+	DescriptionPool<D3D12_UNORDERED_ACCESS_VIEW_DESC> uavDescriptions;
+	DescriptionPool<D3D12_RENDER_TARGET_VIEW_DESC> rtvDescriptions;
+	DescriptionPool<D3D12_DEPTH_STENCIL_VIEW_DESC> dsvDescriptions;
+
+	// Views by the hash of their resource, type and description
+	bool deduplicateViews = false;
+	std::unordered_multimap<std::uint64_t, CachedView> cachedViews;
+	std::unordered_map<size_t, ViewReference> viewReferences; // By descriptor index
+
+	std::vector<size_t> unsubmittedRetirements;
+	std::deque<RetirementBatch> submittedRetirements;
+	std::vector<size_t> spareRetirementStorage; // Reused so that batches rarely allocate
+	std::uint64_t completedValue = 0;
 
 	ID3D12DescriptorHeap* AllocateHeap(size_t nrOfDescriptors);
+	void ExpandHeap(size_t newNrOfDescriptors);
+	void AddHeapPage();
+	void GrowHeap(size_t minimumNrOfDescriptors);
 	size_t GetFreeDescriptorIndex(size_t indexInHeap);
+	size_t FindFreeRange(size_t nrOfDescriptors, AllocationStrategy strategy) const;
 	bool AllocationHelper(size_t& index, D3D12_CPU_DESCRIPTOR_HANDLE& handle,
 		size_t indexInHeap);
 
+	static std::uint64_t HashView(const ViewIdentity& identity,
+		const void* description, size_t descriptionSize);
+	template<typename Description>
+	std::uint32_t StoreDescription(DescriptionPool<Description>& pool,
+		const Description* description);
+	template<typename Description>
+	static Description* GetDescription(DescriptionPool<Description>& pool,
+		std::uint32_t descriptionIndex);
+	const void* GetStoredDescription(const StoredDescriptor& descriptor);
+	void ReleaseDescription(const StoredDescriptor& descriptor);
+	size_t FindCachedView(const ViewIdentity& identity, const void* description,
+		size_t descriptionSize, std::uint64_t viewHash);
+	void CacheView(const ViewIdentity& identity, std::uint64_t viewHash, size_t index);
+	void UncacheView(size_t index);
+	bool ReleaseViewReference(size_t index);
+	void FreeRetiredDescriptors(std::vector<size_t>& indices);
+
+	template<typename Description, typename CreateFunction>
+	size_t AllocateView(const ViewIdentity& identity, DescriptionPool<Description>& pool,
+		const Description* description, size_t indexInHeap, CreateFunction createView);
+	bool ReserveBatchIndices(size_t nrOfViews, size_t* indices,
+		const size_t* indicesInHeap);
+	template<typename Description, typename CreateFunction>
+	bool AllocateViewBatch(DescriptorType type, DescriptionPool<Description>& pool,
+		const DescriptorBatchView<Description>* views, size_t nrOfViews,
+		size_t* indices, const size_t* indicesInHeap, CreateFunction createView);
+
 public:
 	DescriptorAllocator() = default;
 	~DescriptorAllocator();
@@ -74,9 +156,16 @@ public:
 
 	void Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType, ID3D12Device* deviceToUse,
 		ID3D12DescriptorHeap* heap, size_t startIndex, size_t nrOfDescriptors);
+	// With descriptorsPerPage set the heap grows by adding pages of that size instead
+	// of copying every descriptor to a heap twice as large. Ranges cannot cross pages
 	void Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType,
-		ID3D12Device* deviceToUse, size_t startNrOfDescriptors);
+		ID3D12Device* deviceToUse, size_t startNrOfDescriptors,
+		size_t descriptorsPerPage = 0);
 
+	// With deduplication enabled, a view identical to one that is already allocated
+	// returns the existing index, and it is released once deallocated as many times.
+	// Views placed at a specific index in the heap are never shared. Descriptions are
+	// compared bytewise, so they should be value initialised to be found as identical
 	size_t AllocateSRV(ID3D12Resource* resource,
 		const D3D12_SHADER_RESOURCE_VIEW_DESC* desc = nullptr, 
 		size_t indexInHeap = size_t(-1));
@@ -94,12 +183,55 @@ public:
 		const D3D12_CONSTANT_BUFFER_VIEW_DESC* desc = nullptr,
 		size_t indexInHeap = size_t(-1));
 
+	// Creates a batch of views with one reservation of indices, which are written to
+	// indices. With indicesInHeap set, which may be the same array, the views are
+	// placed there instead and those indices must be free. Batches are never
+	// deduplicated, and nothing is created if the batch does not fit
+	bool AllocateSRVs(const DescriptorBatchView<D3D12_SHADER_RESOURCE_VIEW_DESC>* views,
+		size_t nrOfViews, size_t* indices, const size_t* indicesInHeap = nullptr);
+	bool AllocateDSVs(const DescriptorBatchView<D3D12_DEPTH_STENCIL_VIEW_DESC>* views,
+		size_t nrOfViews, size_t* indices, const size_t* indicesInHeap = nullptr);
+	bool AllocateRTVs(const DescriptorBatchView<D3D12_RENDER_TARGET_VIEW_DESC>* views,
+		size_t nrOfViews, size_t* indices, const size_t* indicesInHeap = nullptr);
+	bool AllocateUAVs(const DescriptorBatchView<D3D12_UNORDERED_ACCESS_VIEW_DESC>* views,
+		size_t nrOfViews, size_t* indices, const size_t* indicesInHeap = nullptr);
+	bool AllocateCBVs(const DescriptorBatchView<D3D12_CONSTANT_BUFFER_VIEW_DESC>* views,
+		size_t nrOfViews, size_t* indices, const size_t* indicesInHeap = nullptr);
+
+	// Contiguous indices for descriptor tables, size_t(-1) if the range does not fit
+	size_t AllocateRange(size_t nrOfDescriptors,
+		AllocationStrategy strategy = AllocationStrategy::FIRST_FIT);
+	// Fills part of a range with one copy, the sources can be spread over other heaps
+	void CopyToRange(size_t startIndex, const D3D12_CPU_DESCRIPTOR_HANDLE* sourceHandles,
+		size_t nrOfDescriptors, size_t offsetInRange = 0);
+	void DeallocateRange(size_t startIndex);
+
 	void ReallocateView(size_t indexInHeap, ID3D12Resource* resource);
 
 	void DeallocateDescriptor(size_t index);
 
+	// Retired descriptors stay valid until the completed value reaches the value
+	// they were submitted with. Frame numbers work just as well as fence values
+	void RetireDescriptor(size_t index);
+	void SubmitRetirements(std::uint64_t completionValue);
+	void UpdateCompletedValue(std::uint64_t newCompletedValue);
+	void UpdateCompletedValue(ID3D12Fence* fence);
+	size_t NrOfRetiredDescriptors() const;
+
 	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHandle(size_t index) const;
+	// Descriptors in different pages are not contiguous, so the handle of the first
+	// descriptor cannot be offset to reach the others
+	bool DescriptorsArePaged() const;
 	size_t NrOfStoredDescriptors() const;
 
+	// Without stored descriptions views take less memory, but cannot be reallocated
+	// or shared through deduplication. Only affects views allocated afterwards
+	void SetDescriptionStorage(bool enabled);
+	bool DescriptionStorageEnabled() const;
+
+	void SetViewDeduplication(bool enabled);
+	bool ViewDeduplicationEnabled() const;
+	size_t NrOfViewReferences(size_t index) const;
+
 	void Reset();
 };
\ No newline at end of file
@@ -45,10 +45,17 @@ public:
 
 	void RemoveComponent(const ResourceIndex& indexToRemove) override;
 
+	// Safe to call from several threads for different buffers, but not while buffers are created or removed
 	void SetUpdateData(const ResourceIndex& resourceIndex, void* dataAdress);
+	// Write into the span instead of passing a copy, it is valid until components change
+	WritableSpan BeginUpdate(const ResourceIndex& resourceIndex, size_t offset = 0,
+		size_t size = static_cast<size_t>(-1));
 	void PrepareResourcesForUpdates(std::vector<D3D12_RESOURCE_BARRIER>& barriers);
 	void PerformUpdates(ID3D12GraphicsCommandList* commandList,
-		ResourceUploader& uploader);
+		ResourceUploader& uploader); // Schedules as critical and records right away
+	// Unfinished uploads to the resource of a frame continue when that frame is active again
+	void PerformUpdates(UploadScheduler& scheduler,
+		UploadPriority priority = UploadPriority::NORMAL);
 
 	D3D12_RESOURCE_STATES GetCurrentState();
 	void ChangeToState(std::vector<D3D12_RESOURCE_BARRIER>& barriers,
@@ -191,6 +198,14 @@ inline void FrameBufferComponent<Frames>::SetUpdateData(
 	this->componentData.UpdateComponentData(resourceIndex, dataAdress);
 }
 
+template<short Frames>
+inline WritableSpan FrameBufferComponent<Frames>::BeginUpdate(
+	const ResourceIndex& resourceIndex, size_t offset, size_t size)
+{
+	return this->componentData.BeginUpdate(resourceIndex,
+		this->resourceComponents[this->activeFrame], offset, size);
+}
+
 template<short Frames>
 inline void FrameBufferComponent<Frames>::PrepareResourcesForUpdates(
 	std::vector<D3D12_RESOURCE_BARRIER>& barriers)
@@ -207,6 +222,14 @@ inline void FrameBufferComponent<Frames>::PerformUpdates(
 		this->resourceComponents[this->activeFrame], bufferAlignment);
 }
 
+template<short Frames>
+inline void FrameBufferComponent<Frames>::PerformUpdates(UploadScheduler& scheduler,
+	UploadPriority priority)
+{
+	this->componentData.UpdateComponentResources(scheduler, priority,
+		this->resourceComponents[this->activeFrame], bufferAlignment);
+}
+
 template<short Frames>
 inline D3D12_RESOURCE_STATES FrameBufferComponent<Frames>::GetCurrentState()
 {
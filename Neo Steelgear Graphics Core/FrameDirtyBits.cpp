@@ -0,0 +1,225 @@
+#include "FrameDirtyBits.h"
+
+#include <intrin.h>
+#include <immintrin.h>
+
+#include "InstructionSet.h"
+
+// The scan reads several words at once without atomics, which needs them to be laid out as plain words
+static_assert(sizeof(std::atomic<std::uint64_t>) == sizeof(std::uint64_t),
+	"Dirty bit words must have the same layout as plain words");
+
+FrameDirtyBits::Word* FrameDirtyBits::GetFrameWords(FrameType frameOffset)
+{
+	size_t frame = static_cast<size_t>(currentFrame + frameOffset) % nrOfFrames;
+	return words.get() + frame * wordsPerFrame;
+}
+
+const FrameDirtyBits::Word* FrameDirtyBits::GetFrameWords(FrameType frameOffset) const
+{
+	size_t frame = static_cast<size_t>(currentFrame + frameOffset) % nrOfFrames;
+	return words.get() + frame * wordsPerFrame;
+}
+
+void FrameDirtyBits::SetBit(FrameType frameOffset, size_t index)
+{
+	std::uint64_t mask = std::uint64_t(1) << (index % 64);
+	std::uint64_t previous = GetFrameWords(frameOffset)[index / 64].fetch_or(
+		mask, std::memory_order_relaxed);
+
+	if ((previous & mask) == 0)
+		nrOfSetBits.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t FrameDirtyBits::FindNonEmptyWord(const Word* frameWords,
+	size_t wordIndex) const
+{
+	bool avx = GetSupportedInstructionSet() == InstructionSet::AVX2;
+
+	while (wordIndex < wordsPerFrame)
+	{
+		// Mostly static data leaves long runs of empty words that can be skipped four at a time
+		if (avx && wordIndex + 4 <= wordsPerFrame)
+		{
+			__m256i block = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(frameWords + wordIndex));
+			if (_mm256_testz_si256(block, block))
+			{
+				wordIndex += 4;
+				continue;
+			}
+		}
+
+		if (frameWords[wordIndex].load(std::memory_order_relaxed) != 0)
+			return wordIndex;
+
+		++wordIndex;
+	}
+
+	return wordsPerFrame;
+}
+
+void FrameDirtyBits::AppendIndices(std::uint64_t word, size_t wordIndex,
+	std::vector<size_t>& indices)
+{
+	while (word != 0)
+	{
+		unsigned long bit = 0;
+		_BitScanForward64(&bit, word);
+		indices.push_back(wordIndex * 64 + bit);
+		word &= word - 1;
+	}
+}
+
+FrameDirtyBits::FrameDirtyBits(FrameDirtyBits&& other) noexcept :
+	words(std::move(other.words)), wordsPerFrame(other.wordsPerFrame),
+	nrOfSetBits(other.nrOfSetBits.load()), nrOfFrames(other.nrOfFrames),
+	currentFrame(other.currentFrame)
+{
+	other.wordsPerFrame = 0;
+	other.nrOfSetBits = 0;
+	other.nrOfFrames = 0;
+	other.currentFrame = 0;
+}
+
+FrameDirtyBits& FrameDirtyBits::operator=(FrameDirtyBits&& other) noexcept
+{
+	if (this != &other)
+	{
+		words = std::move(other.words);
+		wordsPerFrame = other.wordsPerFrame;
+		nrOfSetBits = other.nrOfSetBits.load();
+		nrOfFrames = other.nrOfFrames;
+		currentFrame = other.currentFrame;
+
+		other.wordsPerFrame = 0;
+		other.nrOfSetBits = 0;
+		other.nrOfFrames = 0;
+		other.currentFrame = 0;
+	}
+
+	return *this;
+}
+
+void FrameDirtyBits::Initialize(FrameType totalNrOfFrames)
+{
+	nrOfFrames = totalNrOfFrames;
+	currentFrame = 0;
+	nrOfSetBits = 0;
+	wordsPerFrame = 0;
+	words.reset();
+}
+
+void FrameDirtyBits::Reserve(size_t nrOfBits)
+{
+	size_t neededWords = (nrOfBits + 63) / 64;
+	if (neededWords <= wordsPerFrame)
+		return;
+
+	size_t newWordsPerFrame = wordsPerFrame * 2 > neededWords ?
+		wordsPerFrame * 2 : neededWords;
+	std::unique_ptr<Word[]> newWords =
+		std::make_unique<Word[]>(newWordsPerFrame * nrOfFrames);
+
+	for (size_t frame = 0; frame < nrOfFrames; ++frame)
+	{
+		for (size_t i = 0; i < newWordsPerFrame; ++i)
+		{
+			std::uint64_t value = i < wordsPerFrame ?
+				words[frame * wordsPerFrame + i].load(std::memory_order_relaxed) : 0;
+			newWords[frame * newWordsPerFrame + i].store(value, std::memory_order_relaxed);
+		}
+	}
+
+	words = std::move(newWords);
+	wordsPerFrame = newWordsPerFrame;
+}
+
+void FrameDirtyBits::Mark(size_t index, FrameType nrOfFramesToMark)
+{
+	Reserve(index + 1);
+	nrOfFramesToMark = nrOfFramesToMark < nrOfFrames ? nrOfFramesToMark : nrOfFrames;
+
+	for (FrameType frameOffset = 0; frameOffset < nrOfFramesToMark; ++frameOffset)
+		SetBit(frameOffset, index);
+}
+
+void FrameDirtyBits::MarkNextFrame(size_t index)
+{
+	Reserve(index + 1);
+	SetBit(1, index);
+}
+
+void FrameDirtyBits::Clear(size_t index)
+{
+	if (index / 64 >= wordsPerFrame)
+		return;
+
+	std::uint64_t mask = std::uint64_t(1) << (index % 64);
+	for (size_t frame = 0; frame < nrOfFrames; ++frame)
+	{
+		std::uint64_t previous = words[frame * wordsPerFrame + index / 64].fetch_and(
+			~mask, std::memory_order_relaxed);
+
+		if ((previous & mask) != 0)
+			nrOfSetBits.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+bool FrameDirtyBits::Marked(size_t index) const
+{
+	if (index / 64 >= wordsPerFrame)
+		return false;
+
+	std::uint64_t mask = std::uint64_t(1) << (index % 64);
+	for (size_t frame = 0; frame < nrOfFrames; ++frame)
+	{
+		if ((words[frame * wordsPerFrame + index / 64].load(
+			std::memory_order_relaxed) & mask) != 0)
+			return true;
+	}
+
+	return false;
+}
+
+bool FrameDirtyBits::Empty() const
+{
+	return nrOfSetBits.load(std::memory_order_relaxed) == 0;
+}
+
+void FrameDirtyBits::GetCurrentFrame(std::vector<size_t>& indices) const
+{
+	if (Empty())
+		return;
+
+	const Word* frameWords = GetFrameWords(0);
+	for (size_t i = FindNonEmptyWord(frameWords, 0); i < wordsPerFrame;
+		i = FindNonEmptyWord(frameWords, i + 1))
+	{
+		AppendIndices(frameWords[i].load(std::memory_order_relaxed), i, indices);
+	}
+}
+
+void FrameDirtyBits::TakeCurrentFrame(std::vector<size_t>& indices)
+{
+	if (Empty())
+		return;
+
+	size_t sizeBefore = indices.size();
+	Word* frameWords = GetFrameWords(0);
+
+	// Each word is cleared once, and only the bits that were gathered from it
+	for (size_t i = FindNonEmptyWord(frameWords, 0); i < wordsPerFrame;
+		i = FindNonEmptyWord(frameWords, i + 1))
+	{
+		AppendIndices(frameWords[i].exchange(0, std::memory_order_relaxed), i, indices);
+	}
+
+	nrOfSetBits.fetch_sub(indices.size() - sizeBefore, std::memory_order_relaxed);
+}
+
+void FrameDirtyBits::AdvanceFrame()
+{
+	if (nrOfFrames != 0)
+		currentFrame = (currentFrame + 1) % nrOfFrames;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+#include "FrameBased.h"
+
+// One bitset per frame in flight, where moving to the next frame rotates which bitset is current.
+// Marking, clearing and checking bits that are already reserved is safe from several threads,
+// everything else must not overlap with them. Getting and taking a frame skip empty words with
+// plain vector loads, which is why they may not run while bits are marked or cleared.
+class FrameDirtyBits
+{
+private:
+	using Word = std::atomic<std::uint64_t>;
+
+	std::unique_ptr<Word[]> words; // Frame major, wordsPerFrame words for each frame
+	size_t wordsPerFrame = 0;
+	std::atomic<size_t> nrOfSetBits = 0;
+	FrameType nrOfFrames = 0;
+	FrameType currentFrame = 0;
+
+	Word* GetFrameWords(FrameType frameOffset);
+	const Word* GetFrameWords(FrameType frameOffset) const;
+	void SetBit(FrameType frameOffset, size_t index);
+	size_t FindNonEmptyWord(const Word* frameWords, size_t wordIndex) const;
+	static void AppendIndices(std::uint64_t word, size_t wordIndex,
+		std::vector<size_t>& indices);
+
+public:
+	FrameDirtyBits() = default;
+	~FrameDirtyBits() = default;
+	FrameDirtyBits(const FrameDirtyBits& other) = delete;
+	FrameDirtyBits& operator=(const FrameDirtyBits& other) = delete;
+	FrameDirtyBits(FrameDirtyBits&& other) noexcept;
+	FrameDirtyBits& operator=(FrameDirtyBits&& other) noexcept;
+
+	void Initialize(FrameType totalNrOfFrames);
+	void Reserve(size_t nrOfBits);
+
+	// Marks the index for the current frame and the frames after it
+	void Mark(size_t index, FrameType nrOfFramesToMark = 1);
+	void MarkNextFrame(size_t index);
+	void Clear(size_t index);
+
+	bool Marked(size_t index) const;
+	bool Empty() const;
+
+	void GetCurrentFrame(std::vector<size_t>& indices) const;
+	void TakeCurrentFrame(std::vector<size_t>& indices); // Clears what is returned
+	void AdvanceFrame();
+};
\ No newline at end of file
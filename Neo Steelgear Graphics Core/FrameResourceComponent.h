@@ -212,4 +212,7 @@ FrameResourceComponent<Component, Frames, CreationOperation>::SwapFrame()
 {
 	FrameBased<Frames>::SwapFrame();
 	HandleStoredOperations();
+
+	// The frame that becomes active is no longer used by the GPU
+	resourceComponents[this->activeFrame].TrimEmptyChunks();
 }
\ No newline at end of file
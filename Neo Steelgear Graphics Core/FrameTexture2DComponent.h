@@ -56,9 +56,18 @@ public:
 
 	void SetUpdateData(const ResourceIndex& resourceIndex, void* dataAdress,
 		std::uint8_t subresource);
+	// The remaining mips of the chain starting at the subresource are generated
+	void SetUpdateData(const ResourceIndex& resourceIndex, void* dataAdress,
+		MipFilter mipFilter, std::uint8_t subresource = 0);
+	void SetUpdateRegion(const ResourceIndex& resourceIndex, void* dataAdress,
+		const TextureRegion& region, std::uint8_t subresource = 0,
+		size_t sourceRowPitch = 0);
 	void PrepareResourcesForUpdates(std::vector<D3D12_RESOURCE_BARRIER>& barriers);
 	void PerformUpdates(ID3D12GraphicsCommandList* commandList,
-		ResourceUploader& uploader);
+		ResourceUploader& uploader); // Schedules as critical and records right away
+	// Unfinished uploads to the resource of a frame continue when that frame is active again
+	void PerformUpdates(UploadScheduler& scheduler,
+		UploadPriority priority = UploadPriority::NORMAL);
 
 	D3D12_RESOURCE_STATES GetCurrentState(const ResourceIndex& resourceIndex);
 	void ChangeToState(const ResourceIndex& resourceIndex,
@@ -249,6 +258,24 @@ inline void FrameTexture2DComponent<Frames>::SetUpdateData(
 		texelSize, subresource);
 }
 
+template<FrameType Frames>
+inline void FrameTexture2DComponent<Frames>::SetUpdateData(
+	const ResourceIndex& resourceIndex, void* dataAdress, MipFilter mipFilter,
+	std::uint8_t subresource)
+{
+	this->componentData.UpdateComponentData(resourceIndex, dataAdress,
+		texelSize, textureFormat, mipFilter, subresource);
+}
+
+template<FrameType Frames>
+inline void FrameTexture2DComponent<Frames>::SetUpdateRegion(
+	const ResourceIndex& resourceIndex, void* dataAdress,
+	const TextureRegion& region, std::uint8_t subresource, size_t sourceRowPitch)
+{
+	this->componentData.UpdateComponentRegion(resourceIndex, dataAdress,
+		texelSize, region, subresource, sourceRowPitch);
+}
+
 template<FrameType Frames>
 inline void FrameTexture2DComponent<Frames>::PrepareResourcesForUpdates(
 	std::vector<D3D12_RESOURCE_BARRIER>& barriers)
@@ -265,6 +292,14 @@ inline void FrameTexture2DComponent<Frames>::PerformUpdates(
 		this->resourceComponents[this->activeFrame], texelSize, textureFormat);
 }
 
+template<FrameType Frames>
+inline void FrameTexture2DComponent<Frames>::PerformUpdates(UploadScheduler& scheduler,
+	UploadPriority priority)
+{
+	this->componentData.UpdateComponentResources(scheduler, priority,
+		this->resourceComponents[this->activeFrame], texelSize, textureFormat);
+}
+
 template<FrameType Frames>
 inline D3D12_RESOURCE_STATES FrameTexture2DComponent<Frames>::GetCurrentState(
 	const ResourceIndex& resourceIndex)
@@ -0,0 +1,130 @@
+#include "FreeBlockIndex.h"
+
+#include <stdexcept>
+
+void FreeBlockIndex::Grow()
+{
+	size_t newNrOfLeaves = nrOfLeaves == 0 ? 1 : nrOfLeaves * 2;
+	std::vector<size_t> newTree(newNrOfLeaves * 2, 0);
+
+	for (size_t i = 0; i < nrOfChunks; ++i)
+		newTree[newNrOfLeaves + i] = tree[nrOfLeaves + i];
+
+	for (size_t i = newNrOfLeaves - 1; i > 0; --i)
+	{
+		newTree[i] = newTree[i * 2] > newTree[i * 2 + 1] ?
+			newTree[i * 2] : newTree[i * 2 + 1];
+	}
+
+	tree = std::move(newTree);
+	nrOfLeaves = newNrOfLeaves;
+}
+
+size_t FreeBlockIndex::FindInSubtree(size_t node, size_t firstChunkInNode,
+	size_t chunksInNode, size_t blockSize, size_t startChunk) const
+{
+	if (tree[node] < blockSize || firstChunkInNode + chunksInNode <= startChunk)
+		return size_t(-1);
+
+	if (node >= nrOfLeaves)
+		return firstChunkInNode;
+
+	size_t halfSize = chunksInNode / 2;
+	size_t toReturn = FindInSubtree(node * 2, firstChunkInNode, halfSize,
+		blockSize, startChunk);
+
+	if (toReturn == size_t(-1))
+	{
+		toReturn = FindInSubtree(node * 2 + 1, firstChunkInNode + halfSize, halfSize,
+			blockSize, startChunk);
+	}
+
+	return toReturn;
+}
+
+FreeBlockIndex::FreeBlockIndex(FreeBlockIndex&& other) noexcept :
+	tree(std::move(other.tree)), nrOfLeaves(other.nrOfLeaves),
+	nrOfChunks(other.nrOfChunks)
+{
+	other.nrOfLeaves = 0;
+	other.nrOfChunks = 0;
+}
+
+FreeBlockIndex& FreeBlockIndex::operator=(FreeBlockIndex&& other) noexcept
+{
+	if (this != &other)
+	{
+		tree = std::move(other.tree);
+		nrOfLeaves = other.nrOfLeaves;
+		nrOfChunks = other.nrOfChunks;
+
+		other.nrOfLeaves = 0;
+		other.nrOfChunks = 0;
+	}
+
+	return *this;
+}
+
+void FreeBlockIndex::AddChunk(size_t largestFreeBlock)
+{
+	if (nrOfChunks == nrOfLeaves)
+		Grow();
+
+	++nrOfChunks;
+	UpdateChunk(nrOfChunks - 1, largestFreeBlock);
+}
+
+void FreeBlockIndex::UpdateChunk(size_t chunkIndex, size_t largestFreeBlock)
+{
+	if (chunkIndex >= nrOfChunks)
+		throw std::runtime_error("Cannot update free block of chunk that does not exist");
+
+	size_t node = nrOfLeaves + chunkIndex;
+	tree[node] = largestFreeBlock;
+
+	for (node /= 2; node > 0; node /= 2)
+	{
+		size_t largest = tree[node * 2] > tree[node * 2 + 1] ?
+			tree[node * 2] : tree[node * 2 + 1];
+
+		if (tree[node] == largest)
+			break; // Nothing above can change either
+
+		tree[node] = largest;
+	}
+}
+
+void FreeBlockIndex::Truncate(size_t nrOfChunksToKeep)
+{
+	while (nrOfChunks > nrOfChunksToKeep)
+	{
+		UpdateChunk(nrOfChunks - 1, 0);
+		--nrOfChunks;
+	}
+}
+
+void FreeBlockIndex::Clear()
+{
+	tree.clear();
+	nrOfLeaves = 0;
+	nrOfChunks = 0;
+}
+
+size_t FreeBlockIndex::FindChunk(size_t blockSize, size_t startChunk) const
+{
+	if (startChunk >= nrOfChunks)
+		return size_t(-1);
+
+	size_t toReturn = FindInSubtree(1, 0, nrOfLeaves, blockSize, startChunk);
+	return toReturn < nrOfChunks ? toReturn : size_t(-1); // Unused leaves match empty requests
+}
+
+size_t FreeBlockIndex::GetLargestFreeBlock(size_t chunkIndex) const
+{
+	return tree[nrOfLeaves + chunkIndex];
+}
+
+size_t FreeBlockIndex::NrOfChunks() const
+{
+	return nrOfChunks;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// The largest free block of every memory chunk of an allocator, kept in a max tree
+// so chunks that are too full can be skipped without searching their free lists
+class FreeBlockIndex
+{
+private:
+	std::vector<size_t> tree; // Node i has children 2i and 2i + 1, the leaves start at nrOfLeaves
+	size_t nrOfLeaves = 0;
+	size_t nrOfChunks = 0;
+
+	void Grow();
+	size_t FindInSubtree(size_t node, size_t firstChunkInNode, size_t chunksInNode,
+		size_t blockSize, size_t startChunk) const;
+
+public:
+	FreeBlockIndex() = default;
+	~FreeBlockIndex() = default;
+	FreeBlockIndex(const FreeBlockIndex& other) = default;
+	FreeBlockIndex& operator=(const FreeBlockIndex& other) = default;
+	FreeBlockIndex(FreeBlockIndex&& other) noexcept;
+	FreeBlockIndex& operator=(FreeBlockIndex&& other) noexcept;
+
+	void AddChunk(size_t largestFreeBlock);
+	void UpdateChunk(size_t chunkIndex, size_t largestFreeBlock);
+	// Only the first chunks are kept
+	void Truncate(size_t nrOfChunksToKeep);
+	void Clear();
+
+	// First chunk from startChunk and on with a free block of at least the size, size_t(-1) if there is none.
+	// Alignment is not accounted for, so the chunk can still fail to fit the allocation
+	size_t FindChunk(size_t blockSize, size_t startChunk = 0) const;
+
+	size_t GetLargestFreeBlock(size_t chunkIndex) const;
+	size_t NrOfChunks() const;
+};
\ No newline at end of file
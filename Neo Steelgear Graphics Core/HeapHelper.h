@@ -35,8 +35,10 @@ private:
 	StableVector<Chunk> chunks;
 	size_t currentSize = 0;
 	size_t currentlyActiveChunks = 0;
+	size_t largestFreeChunk = 0; // Only rescanned when the largest free chunk is allocated from
 
-	void CombineAdjacentChunks(size_t chunkIndex);
+	size_t CombineAdjacentChunks(size_t chunkIndex);
+	void RescanLargestFreeChunk();
 
 	size_t FindFirstFit(size_t dataSize, size_t alignment);
 	size_t FindBestFit(size_t dataSize, size_t alignment);
@@ -46,7 +48,7 @@ private:
 
 	void SplitChunk(size_t dataSize, size_t alignment, size_t chunkIndex);
 
-	size_t Align(size_t number, size_t alignment);
+	static size_t Align(size_t number, size_t alignment);
 
 public:
 	HeapHelper() = default;
@@ -72,6 +74,9 @@ public:
 	size_t TotalSize() const;
 	size_t NrOfAllocatedChunks() const;
 	size_t GetCurrentMaxIndex() const;
+	size_t GetLargestAvailableSize(size_t alignment) const;
+	// Same as the largest available size without alignment, but without searching
+	size_t GetLargestFreeChunkSize() const;
 
 	bool ChunkActive(size_t index) const;
 
@@ -80,7 +85,7 @@ public:
 };
 
 template<typename T>
-inline void HeapHelper<T>::CombineAdjacentChunks(size_t chunkIndex)
+inline size_t HeapHelper<T>::CombineAdjacentChunks(size_t chunkIndex)
 {
 	size_t defragStart = chunks[chunkIndex].startOffset;
 	size_t defragNext = defragStart + chunks[chunkIndex].chunkSize;
@@ -102,11 +107,27 @@ inline void HeapHelper<T>::CombineAdjacentChunks(size_t chunkIndex)
 				chunks[indexOfSecond].chunkSize = 0;
 				chunks.Remove(indexOfSecond);
 
-				CombineAdjacentChunks(indexOfFirst);
-				return;
+				return CombineAdjacentChunks(indexOfFirst);
 			}
 		}
 	}
+
+	return chunkIndex;
+}
+
+template<typename T>
+inline void HeapHelper<T>::RescanLargestFreeChunk()
+{
+	largestFreeChunk = 0;
+
+	for (size_t i = 0; i < chunks.TotalSize(); ++i)
+	{
+		if (chunks.CheckIfActive(i) && chunks[i].status == ChunkStatus::AVAILABLE &&
+			chunks[i].chunkSize > largestFreeChunk)
+		{
+			largestFreeChunk = chunks[i].chunkSize;
+		}
+	}
 }
 
 template<typename T>
@@ -273,10 +294,12 @@ inline size_t HeapHelper<T>::Align(size_t number, size_t alignment)
 template<typename T>
 inline HeapHelper<T>::HeapHelper(HeapHelper&& other) : 
 	chunks(std::move(other.chunks)), currentSize(other.currentSize),
-	currentlyActiveChunks(other.currentlyActiveChunks)
+	currentlyActiveChunks(other.currentlyActiveChunks),
+	largestFreeChunk(other.largestFreeChunk)
 {
 	other.currentSize = 0;
 	other.currentlyActiveChunks = 0;
+	other.largestFreeChunk = 0;
 }
 
 template<typename T>
@@ -287,8 +310,10 @@ inline HeapHelper<T>& HeapHelper<T>::operator=(HeapHelper&& other)
 		chunks = std::move(other.chunks);
 		currentSize = other.currentSize;
 		currentlyActiveChunks = other.currentlyActiveChunks;
+		largestFreeChunk = other.largestFreeChunk;
 		other.currentSize = 0;
 		other.currentlyActiveChunks = 0;
+		other.largestFreeChunk = 0;
 	}
 
 	return *this;
@@ -302,6 +327,7 @@ inline void HeapHelper<T>::Initialize(size_t heapSize, size_t heapStartOffset)
 	initialChunk.chunkSize = heapSize;
 	initialChunk.specificData = T();
 	currentSize = heapSize;
+	largestFreeChunk = heapSize;
 	chunks.Add(std::move(initialChunk));
 }
 
@@ -314,6 +340,7 @@ inline void HeapHelper<T>::Initialize(size_t heapSize, const T& specifics,
 	initialChunk.chunkSize = heapSize;
 	initialChunk.specificData = specifics;
 	currentSize = heapSize;
+	largestFreeChunk = heapSize;
 	chunks.Add(std::move(initialChunk));
 }
 
@@ -325,9 +352,13 @@ inline size_t HeapHelper<T>::AllocateChunk(size_t chunkSize,
 
 	if (chunkIndex != size_t(-1))
 	{
+		bool wasLargest = chunks[chunkIndex].chunkSize == largestFreeChunk;
 		SplitChunk(chunkSize, alignment, chunkIndex);
 		chunks[chunkIndex].status = ChunkStatus::OCCUPIED;
 		++currentlyActiveChunks;
+
+		if (wasLargest)
+			RescanLargestFreeChunk();
 	}
 
 	return chunkIndex;
@@ -340,7 +371,9 @@ inline void HeapHelper<T>::DeallocateChunk(size_t chunkIndex)
 	chunks[chunkIndex].specificData = T();
 	--currentlyActiveChunks;
 
-	CombineAdjacentChunks(chunkIndex);
+	size_t combinedIndex = CombineAdjacentChunks(chunkIndex);
+	if (chunks[combinedIndex].chunkSize > largestFreeChunk)
+		largestFreeChunk = chunks[combinedIndex].chunkSize;
 }
 
 template<typename T>
@@ -351,11 +384,14 @@ inline void HeapHelper<T>::AddChunk(size_t chunkSize, bool combine)
 	toAdd.chunkSize = chunkSize;
 	toAdd.startOffset = currentSize;
 
-	chunks.Add(std::move(toAdd));
+	size_t addedIndex = chunks.Add(std::move(toAdd));
 	currentSize += chunkSize;
 
 	if (combine)
-		CombineAdjacentChunks(chunks.TotalSize() - 1);
+		addedIndex = CombineAdjacentChunks(addedIndex);
+
+	if (chunks[addedIndex].chunkSize > largestFreeChunk)
+		largestFreeChunk = chunks[addedIndex].chunkSize;
 }
 
 template<typename T>
@@ -394,6 +430,39 @@ inline size_t HeapHelper<T>::GetCurrentMaxIndex() const
 	return chunks.TotalSize();
 }
 
+template<typename T>
+inline size_t HeapHelper<T>::GetLargestAvailableSize(size_t alignment) const
+{
+	size_t largestSize = 0;
+
+	for (size_t i = 0; i < chunks.TotalSize(); ++i)
+	{
+		if (chunks.CheckIfActive(i) && chunks[i].status == ChunkStatus::AVAILABLE)
+		{
+			size_t alignedAdress = Align(chunks[i].startOffset, alignment);
+
+			if (alignedAdress - chunks[i].startOffset >=
+				chunks[i].chunkSize)
+			{
+				continue;
+			}
+
+			size_t alignedSize = chunks[i].chunkSize -
+				(alignedAdress - chunks[i].startOffset);
+			if (alignedSize > largestSize)
+				largestSize = alignedSize;
+		}
+	}
+
+	return largestSize;
+}
+
+template<typename T>
+inline size_t HeapHelper<T>::GetLargestFreeChunkSize() const
+{
+	return largestFreeChunk;
+}
+
 template<typename T>
 inline bool HeapHelper<T>::ChunkActive(size_t index) const
 {
@@ -425,4 +494,5 @@ inline void HeapHelper<T>::ClearHeap(size_t newSize)
 	newTotalChunk.chunkSize = currentSize;
 	newTotalChunk.specificData = T();
 	chunks.Add(std::move(newTotalChunk));
+	largestFreeChunk = currentSize;
 }
@@ -0,0 +1,39 @@
+#include "InstructionSet.h"
+
+#include <intrin.h>
+
+namespace
+{
+	InstructionSet DetectInstructionSet()
+	{
+		int cpuInfo[4] = {};
+		__cpuid(cpuInfo, 0);
+		int highestLeaf = cpuInfo[0];
+
+		__cpuid(cpuInfo, 1);
+		bool ssse3 = (cpuInfo[2] & (1 << 9)) != 0;
+		bool f16c = (cpuInfo[2] & (1 << 29)) != 0;
+		bool osxsave = (cpuInfo[2] & (1 << 27)) != 0;
+		bool avx = (cpuInfo[2] & (1 << 28)) != 0;
+
+		// The OS also has to save the upper halves of the ymm registers
+		bool ymmEnabled = osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+		bool avx2 = false;
+		if (highestLeaf >= 7)
+		{
+			__cpuidex(cpuInfo, 7, 0);
+			avx2 = (cpuInfo[1] & (1 << 5)) != 0;
+		}
+
+		if (ymmEnabled && avx2 && f16c)
+			return InstructionSet::AVX2;
+
+		return ssse3 ? InstructionSet::SSE : InstructionSet::SCALAR;
+	}
+}
+
+InstructionSet GetSupportedInstructionSet()
+{
+	static const InstructionSet supported = DetectInstructionSet();
+	return supported;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+enum class InstructionSet
+{
+	SCALAR,
+	SSE, // SSSE3 shuffles
+	AVX2 // AVX2 shuffles and F16C conversions
+};
+
+// Detected once, including whether the OS saves the ymm registers
+InstructionSet GetSupportedInstructionSet();
\ No newline at end of file
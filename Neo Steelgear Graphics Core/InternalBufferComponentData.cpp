@@ -1,99 +1,140 @@
 #include "InternalBufferComponentData.h"
 
-void InternalBufferComponentData::HandleInitializeOnlyUpdate(
-	ID3D12GraphicsCommandList* commandList, ResourceUploader& uploader,
-	BufferComponent& componentToUpdate, size_t componentAlignment)
+#include <stdexcept>
+
+void InternalBufferComponentData::MarkDirty(DataHeader& header, size_t offset,
+	size_t size)
 {
-	for (size_t i = 0; i < headers.size(); ++i)
+	size_t descriptorIndex = header.resourceIndex.descriptorIndex;
+	if (!dirtyBits.Marked(descriptorIndex) ||
+		header.specifics.dirtyStart >= header.specifics.dirtyEnd)
 	{
-		if (headers[i].specifics.framesLeft == 0)
-			continue;
-		else if (headers[i].specifics.framesLeft > 1)
-			updateNeeded = true; // At least one update left for next frame
+		header.specifics.dirtyStart = offset;
+		header.specifics.dirtyEnd = offset + size;
+	}
+	else
+	{
+		header.specifics.dirtyStart = min(header.specifics.dirtyStart, offset);
+		header.specifics.dirtyEnd = max(header.specifics.dirtyEnd, offset + size);
+	}
 
-		auto handle = componentToUpdate.GetBufferHandle(
-			headers[i].resourceIndex);
-		unsigned char* source = data.data();
-		source += headers[i].startOffset;
+	// Only touches state owned by the component, so different components can be marked concurrently
+	dirtyBits.Mark(descriptorIndex, nrOfFrames);
+	header.specifics.contentHashed = false;
+}
+
+void InternalBufferComponentData::FinishFrameUpdate(DataHeader& header)
+{
+	if (!dirtyBits.Marked(header.resourceIndex.descriptorIndex))
+		header.specifics.dirtyStart = header.specifics.dirtyEnd = 0;
+}
 
-		bool result = uploader.UploadBufferResourceData(handle.resource,
-			commandList, source, handle.startOffset, headers[i].dataSize,
-			componentAlignment);
+void InternalBufferComponentData::ResetSpecifics(DataHeader& header)
+{
+	header.specifics.contentHashed = false;
+	header.specifics.dirtyStart = header.specifics.dirtyEnd = 0;
+	header.specifics.mappedData = nullptr;
+	header.specifics.staleStart = header.specifics.staleEnd = 0;
+}
 
-		if (!result)
-		{
-			updateNeeded = true;
-			headers[i].specifics.framesLeft += nrOfFrames;
-		}
+void InternalBufferComponentData::SyncStaleStaging(DataHeader& header)
+{
+	if (header.specifics.staleStart >= header.specifics.staleEnd)
+		return;
 
-		--headers[i].specifics.framesLeft;
+	std::memcpy(data.data() + header.startOffset + header.specifics.staleStart,
+		header.specifics.mappedData + header.specifics.staleStart,
+		header.specifics.staleEnd - header.specifics.staleStart);
+	header.specifics.staleStart = header.specifics.staleEnd = 0;
+}
 
-		// If INITIALISE_ONLY is used and all frames are updated then we are finished with this one
-		if (headers[i].specifics.framesLeft == 0)
+void InternalBufferComponentData::HandleMapUpdate(BufferComponent& componentToUpdate)
+{
+	dirtyIndices.clear();
+	dirtyBits.TakeCurrentFrame(dirtyIndices);
+
+	// Ranges are copied one by one, as what lies between them may be newer in the buffer than in staging
+	for (size_t descriptorIndex : dirtyIndices)
+	{
+		DataHeader& header = headers[descriptorIndex];
+		if (header.specifics.dirtyStart < header.specifics.dirtyEnd)
 		{
-			RemoveComponent(headers[i].resourceIndex);
-			--i;
+			unsigned char* mapped = componentToUpdate.GetMappedPtr(header.resourceIndex);
+			std::memcpy(mapped + header.specifics.dirtyStart,
+				data.data() + header.startOffset + header.specifics.dirtyStart,
+				header.specifics.dirtyEnd - header.specifics.dirtyStart);
 		}
+
+		FinishFrameUpdate(header);
 	}
 }
 
-void InternalBufferComponentData::HandleCopyUpdate(
-	ID3D12GraphicsCommandList* commandList, ResourceUploader& uploader,
+void InternalBufferComponentData::HandleInitializeOnlyUpdate(
+	UploadScheduler& scheduler, UploadPriority priority,
 	BufferComponent& componentToUpdate, size_t componentAlignment)
 {
-	size_t earliestOffset = static_cast<size_t>(-1);
-	size_t latestEnd = 0;
-	ID3D12Resource* resource = nullptr;
+	dirtyIndices.clear();
+	dirtyBits.TakeCurrentFrame(dirtyIndices);
 
-	for (auto& header : headers)
+	for (size_t descriptorIndex : dirtyIndices)
 	{
-		if (header.specifics.framesLeft == 0)
-			continue;
-		else if (header.specifics.framesLeft > 1)
-			updateNeeded = true; // At least one update left for next frame
-
-		earliestOffset = min(header.startOffset, earliestOffset);
-		latestEnd = max(header.startOffset + header.dataSize, latestEnd);
-		--header.specifics.framesLeft;
-		resource =
-			componentToUpdate.GetBufferHandle(header.resourceIndex).resource;
-	}
+		DataHeader& header = *FindHeader(descriptorIndex);
+		auto handle = componentToUpdate.GetBufferHandle(header.resourceIndex);
+		unsigned char* source = data.data();
+		source += header.startOffset;
 
-	if (resource != nullptr)
-	{
-		bool result = uploader.UploadBufferResourceData(resource, commandList,
-			data.data() + earliestOffset, earliestOffset,
-			latestEnd - earliestOffset, componentAlignment);
+		std::optional<std::uint64_t> contentHash;
+		if (scheduler.ContentDeduplicationEnabled())
+		{
+			if (!header.specifics.contentHashed)
+			{
+				header.specifics.contentHash =
+					HashContent(source, header.dataSize);
+				header.specifics.contentHashed = true;
+			}
+
+			contentHash = header.specifics.contentHash;
+		}
 
-		if (result == false)
-			throw std::runtime_error("Could not update data for buffer component");
+		scheduler.ScheduleBufferUpload(handle.resource, source,
+			handle.startOffset, header.dataSize, componentAlignment, priority,
+			contentHash);
+		AddScheduledResource(handle.resource);
+
+		// The scheduler has its own copy, so once every frame is updated we are finished with this one
+		if (!dirtyBits.Marked(descriptorIndex))
+			RemoveComponent(header.resourceIndex);
 	}
 }
 
-void InternalBufferComponentData::HandleMapUpdate(BufferComponent& componentToUpdate)
+void InternalBufferComponentData::HandleCopyUpdate(UploadScheduler& scheduler,
+	UploadPriority priority, BufferComponent& componentToUpdate,
+	size_t componentAlignment)
 {
-	ResourceIndex earliestResourcIndex;
 	size_t earliestOffset = static_cast<size_t>(-1);
 	size_t latestEnd = 0;
+	ID3D12Resource* resource = nullptr;
 
-	for (auto& header : headers)
+	dirtyIndices.clear();
+	dirtyBits.TakeCurrentFrame(dirtyIndices);
+
+	for (size_t descriptorIndex : dirtyIndices)
 	{
-		if (header.specifics.framesLeft == 0)
-			continue;
-		else if (header.specifics.framesLeft > 1)
-			updateNeeded = true; // At least one update left for next frame
-
-		earliestOffset = min(header.startOffset, earliestOffset);
-		earliestResourcIndex = header.startOffset == earliestOffset ?
-			header.resourceIndex : earliestResourcIndex;
-		latestEnd = max(header.startOffset + header.dataSize, latestEnd);
-		--header.specifics.framesLeft;
+		DataHeader& header = headers[descriptorIndex];
+		earliestOffset = min(header.startOffset + header.specifics.dirtyStart,
+			earliestOffset);
+		latestEnd = max(header.startOffset + header.specifics.dirtyEnd, latestEnd);
+		FinishFrameUpdate(header);
+		resource =
+			componentToUpdate.GetBufferHandle(header.resourceIndex).resource;
 	}
 
-	if (latestEnd != 0)
+	if (resource != nullptr)
 	{
-		unsigned char* mapped = componentToUpdate.GetMappedPtr(earliestResourcIndex);
-		memcpy(mapped, data.data() + earliestOffset, latestEnd - earliestOffset);
+		scheduler.ScheduleBufferUpload(resource, data.data() + earliestOffset,
+			earliestOffset, latestEnd - earliestOffset, componentAlignment,
+			priority);
+		AddScheduledResource(resource);
 	}
 }
 
@@ -103,34 +144,33 @@ void InternalBufferComponentData::AddComponent(const ResourceIndex& resourceInde
 	if (type == UpdateType::NONE)
 		return;
 
-	if (usedDataSize + dataSize > data.capacity())
-	{
-		data.reserve(usedDataSize + dataSize);
-		data.resize(usedDataSize + dataSize); // Resize so new data fits
-	}
-
 	if (type != UpdateType::INITIALISE_ONLY)
 	{
+		// Staging mirrors the layout of the buffer, which the buffer allocator already manages
+		if (startOffset + dataSize > data.size())
+			data.resize(startOffset + dataSize); // Resize so new data fits, growing geometrically
+
 		if(headers.size() <= resourceIndex.descriptorIndex)
 			headers.resize(resourceIndex.descriptorIndex + 1);
 
 		headers[resourceIndex.descriptorIndex].startOffset = startOffset;
 		headers[resourceIndex.descriptorIndex].dataSize = dataSize;
 		headers[resourceIndex.descriptorIndex].resourceIndex = resourceIndex;
-		headers[resourceIndex.descriptorIndex].specifics.framesLeft = 0;
+		ResetSpecifics(headers[resourceIndex.descriptorIndex]);
+		usedDataSize += dataSize;
 	}
 	else
 	{
+		// Uploaded components free their slot, so staging is reused instead of only growing
 		DataHeader toAdd;
-		toAdd.specifics.framesLeft = 0;
-		toAdd.startOffset = headers.size() == 0 ? 0 :
-			headers.back().startOffset + headers.back().dataSize;
-		toAdd.dataSize = dataSize;
+		ResetSpecifics(toAdd);
 		toAdd.resourceIndex = resourceIndex;
-		headers.push_back(toAdd);
+		AllocateDataSlot(toAdd, dataSize);
+		AddHeaderSlot(toAdd);
 	}
 
-	usedDataSize += dataSize;
+	dirtyBits.Clear(resourceIndex.descriptorIndex);
+	dirtyBits.Reserve(resourceIndex.descriptorIndex + 1);
 
 	if (initialData != nullptr)
 		UpdateComponentData(resourceIndex, initialData);
@@ -141,33 +181,24 @@ void InternalBufferComponentData::RemoveComponent(const ResourceIndex& resourceI
 	if (type == UpdateType::NONE)
 		return;
 
+	dirtyBits.Clear(resourceIndex.descriptorIndex);
+
 	if (type != UpdateType::INITIALISE_ONLY)
 	{
-		std::int64_t difference = headers[resourceIndex.descriptorIndex].dataSize;
-		difference = -difference;
-		UpdateExistingHeaders(resourceIndex.descriptorIndex, difference);
-		usedDataSize -= static_cast<size_t>(-difference);
+		usedDataSize -= headers[resourceIndex.descriptorIndex].dataSize;
 
 		headers[resourceIndex.descriptorIndex].startOffset = static_cast<size_t>(-1);
 		headers[resourceIndex.descriptorIndex].dataSize = 0;
 		headers[resourceIndex.descriptorIndex].resourceIndex = ResourceIndex();
-		headers[resourceIndex.descriptorIndex].specifics.framesLeft = 0;
+		ResetSpecifics(headers[resourceIndex.descriptorIndex]);
 	}
 	else
 	{
-		for (size_t i = 0; i < headers.size(); ++i)
+		DataHeader* header = FindHeader(resourceIndex);
+		if (header != nullptr)
 		{
-			if (headers[i].resourceIndex.descriptorIndex != resourceIndex.descriptorIndex)
-				continue;
-
-			std::int64_t difference = headers[i].dataSize;
-			difference = -difference;
-			UpdateExistingHeaders(i, difference);
-			usedDataSize -= static_cast<size_t>(-difference);
-			size_t moveSize = sizeof(DataHeader) * (headers.size() - i - 1);
-			std::memmove(headers.data() + i, headers.data() + i + 1, moveSize);
-			headers.pop_back();
-			return;
+			FreeDataSlot(*header);
+			RemoveHeaderSlot(static_cast<size_t>(header - headers.data()));
 		}
 	}
 }
@@ -178,29 +209,84 @@ void InternalBufferComponentData::UpdateComponentData(const ResourceIndex& resou
 	if (type == UpdateType::NONE)
 		return;
 
-	if (type != UpdateType::INITIALISE_ONLY)
-	{
-		unsigned char* destination = data.data();
-		destination += headers[resourceIndex.descriptorIndex].startOffset;
-		std::memcpy(destination, dataPtr, headers[resourceIndex.descriptorIndex].dataSize);
-		headers[resourceIndex.descriptorIndex].specifics.framesLeft = nrOfFrames;
-		updateNeeded = true;
-	}
-	else
+	DataHeader* header = FindHeader(resourceIndex);
+	if (header == nullptr)
+		return;
+
+	unsigned char* destination = data.data();
+	destination += header->startOffset;
+	std::memcpy(destination, dataPtr, header->dataSize);
+	header->specifics.staleStart = header->specifics.staleEnd = 0;
+	MarkDirty(*header, 0, header->dataSize);
+}
+
+WritableSpan InternalBufferComponentData::BeginUpdate(
+	const ResourceIndex& resourceIndex, BufferComponent& currentComponent,
+	size_t offset, size_t size)
+{
+	WritableSpan toReturn;
+	if (type == UpdateType::NONE)
+		return toReturn;
+
+	DataHeader* header = FindHeader(resourceIndex);
+	if (header == nullptr || header->startOffset == static_cast<size_t>(-1))
+		throw std::runtime_error("Cannot begin update of a component that does not exist");
+
+	if (size == static_cast<size_t>(-1))
+		size = offset <= header->dataSize ? header->dataSize - offset : 0;
+
+	if (offset + size > header->dataSize)
+		throw std::runtime_error("Update range is outside of the component");
+
+	toReturn.size = size;
+
+	// With a single frame there is no other buffer to keep in sync, so writes can bypass staging
+	if (type == UpdateType::MAP_UPDATE && nrOfFrames == 1)
 	{
-		for (auto& header : headers)
+		unsigned char* mapped = currentComponent.GetMappedPtr(resourceIndex);
+
+		if (dirtyBits.Marked(resourceIndex.descriptorIndex) &&
+			header->specifics.dirtyStart < header->specifics.dirtyEnd)
+		{
+			std::memcpy(mapped + header->specifics.dirtyStart,
+				data.data() + header->startOffset + header->specifics.dirtyStart,
+				header->specifics.dirtyEnd - header->specifics.dirtyStart);
+		}
+
+		dirtyBits.Clear(resourceIndex.descriptorIndex);
+		header->specifics.dirtyStart = header->specifics.dirtyEnd = 0;
+
+		// Staging is only brought up to date if it is read, to not read back from the upload heap every frame
+		if (header->specifics.staleStart >= header->specifics.staleEnd)
 		{
-			if (header.resourceIndex.descriptorIndex != resourceIndex.descriptorIndex)
-				continue;
-
-			unsigned char* destination = data.data();
-			destination += header.startOffset;
-			std::memcpy(destination, dataPtr, header.dataSize);
-			header.specifics.framesLeft = nrOfFrames;
-			updateNeeded = true;
-			break;
+			header->specifics.staleStart = offset;
+			header->specifics.staleEnd = offset + size;
 		}
+		else
+		{
+			header->specifics.staleStart = min(header->specifics.staleStart, offset);
+			header->specifics.staleEnd = max(header->specifics.staleEnd, offset + size);
+		}
+
+		header->specifics.mappedData = mapped;
+		toReturn.data = mapped + offset;
+		return toReturn;
 	}
+
+	MarkDirty(*header, offset, size);
+	toReturn.data = data.data() + header->startOffset + offset;
+	return toReturn;
+}
+
+void* InternalBufferComponentData::GetComponentData(const ResourceIndex& resourceIndex)
+{
+	if (type == UpdateType::MAP_UPDATE &&
+		resourceIndex.descriptorIndex < headers.size())
+	{
+		SyncStaleStaging(headers[resourceIndex.descriptorIndex]);
+	}
+
+	return ComponentData<BufferSpecific>::GetComponentData(resourceIndex);
 }
 
 void InternalBufferComponentData::PrepareUpdates(
@@ -208,7 +294,7 @@ void InternalBufferComponentData::PrepareUpdates(
 	BufferComponent& componentToUpdate)
 {
 	// A mapped resource is in an upload heap which needs to be generic read state
-	if (updateNeeded == false || type == UpdateType::MAP_UPDATE)
+	if ((updateNeeded == false && dirtyBits.Empty()) || type == UpdateType::MAP_UPDATE)
 		return;
 
 	if (componentToUpdate.GetCurrentState() != D3D12_RESOURCE_STATE_COMMON &&
@@ -223,23 +309,38 @@ void InternalBufferComponentData::UpdateComponentResources(
 	ID3D12GraphicsCommandList* commandList, ResourceUploader& uploader,
 	BufferComponent& componentToUpdate, size_t componentAlignment)
 {
-	if (updateNeeded == false)
+	directScheduler.Initialize(&uploader, 0);
+	UpdateComponentResources(directScheduler, UploadPriority::CRITICAL,
+		componentToUpdate, componentAlignment);
+	directScheduler.ExecuteUploads(commandList);
+}
+
+void InternalBufferComponentData::UpdateComponentResources(
+	UploadScheduler& scheduler, UploadPriority priority,
+	BufferComponent& componentToUpdate, size_t componentAlignment)
+{
+	if (updateNeeded == false && dirtyBits.Empty())
 		return;
 
 	updateNeeded = false;
+	UpdateScheduledResources(scheduler);
 
 	switch (type)
 	{
 	case UpdateType::INITIALISE_ONLY:
-		HandleInitializeOnlyUpdate(commandList, uploader,
+		HandleInitializeOnlyUpdate(scheduler, priority,
 			componentToUpdate, componentAlignment);
 		break;
 	case UpdateType::MAP_UPDATE:
 		HandleMapUpdate(componentToUpdate);
 		break;
 	case UpdateType::COPY_UPDATE:
-		HandleCopyUpdate(commandList, uploader,
+		HandleCopyUpdate(scheduler, priority,
 			componentToUpdate, componentAlignment);
 		break;
 	}
+
+	dirtyBits.AdvanceFrame();
+	updateNeeded = updateNeeded || !dirtyBits.Empty() ||
+		!scheduledResources.empty();
 }
\ No newline at end of file
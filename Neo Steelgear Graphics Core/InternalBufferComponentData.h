@@ -3,21 +3,33 @@
 #include "ComponentData.h"
 #include "BufferComponent.h"
 #include "ResourceUploader.h"
+#include "UploadScheduler.h"
+#include "ContentHash.h"
 
 struct BufferSpecific
 {
-	FrameType framesLeft;
+	bool contentHashed; // Hashed once per update, and only if the uploader deduplicates
+	std::uint64_t contentHash;
+	size_t dirtyStart; // Relative to the component, empty if start >= end
+	size_t dirtyEnd;
+	unsigned char* mappedData; // Target of writes that bypassed staging, which is behind in the stale range
+	size_t staleStart;
+	size_t staleEnd;
 };
 
 class InternalBufferComponentData : public ComponentData<BufferSpecific>
 {
 private:
-	void HandleInitializeOnlyUpdate(ID3D12GraphicsCommandList* commandList,
-		ResourceUploader& uploader, BufferComponent& componentToUpdate,
-		size_t componentAlignment);
-	void HandleCopyUpdate(ID3D12GraphicsCommandList* commandList,
-		ResourceUploader& uploader, BufferComponent& componentToUpdate,
+	void MarkDirty(DataHeader& header, size_t offset, size_t size);
+	void FinishFrameUpdate(DataHeader& header);
+	void ResetSpecifics(DataHeader& header);
+	void SyncStaleStaging(DataHeader& header);
+
+	void HandleInitializeOnlyUpdate(UploadScheduler& scheduler,
+		UploadPriority priority, BufferComponent& componentToUpdate,
 		size_t componentAlignment);
+	void HandleCopyUpdate(UploadScheduler& scheduler, UploadPriority priority,
+		BufferComponent& componentToUpdate, size_t componentAlignment);
 	void HandleMapUpdate(BufferComponent& componentToUpdate);
 
 public:
@@ -32,11 +44,23 @@ public:
 	void AddComponent(const ResourceIndex& resourceIndex, size_t startOffset,
 		unsigned int dataSize, void* initialData = nullptr);
 	void RemoveComponent(const ResourceIndex& resourceIndex) override;
+	// Different components can be updated from several threads, as long as none are added or removed
 	void UpdateComponentData(const ResourceIndex& resourceIndex, void* dataPtr);
+	// Only the range is uploaded, a MAP_UPDATE span with a single frame points into the mapped buffer
+	WritableSpan BeginUpdate(const ResourceIndex& resourceIndex,
+		BufferComponent& currentComponent, size_t offset = 0,
+		size_t size = static_cast<size_t>(-1));
+	// Staging behind writes that went straight to the mapped buffer is read back first, which is slow
+	void* GetComponentData(const ResourceIndex& resourceIndex);
 
 	void PrepareUpdates(std::vector<D3D12_RESOURCE_BARRIER>& barriers,
 		BufferComponent& componentToUpdate);
+	// Uploads are scheduled as critical and recorded right away. What does not fit in
+	// the uploader continues in later calls, and a component should not mix both overloads
 	void UpdateComponentResources(ID3D12GraphicsCommandList* commandList,
 		ResourceUploader& uploader, BufferComponent& componentToUpdate,
 		size_t componentAlignment);
+	void UpdateComponentResources(UploadScheduler& scheduler,
+		UploadPriority priority, BufferComponent& componentToUpdate,
+		size_t componentAlignment);
 };
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : file(other.file),
+	mapping(other.mapping), view(other.view), size(other.size)
+{
+	other.file = INVALID_HANDLE_VALUE;
+	other.mapping = nullptr;
+	other.view = nullptr;
+	other.size = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		file = other.file;
+		mapping = other.mapping;
+		view = other.view;
+		size = other.size;
+
+		other.file = INVALID_HANDLE_VALUE;
+		other.mapping = nullptr;
+		other.view = nullptr;
+		other.size = 0;
+	}
+
+	return *this;
+}
+
+void MappedFile::Open(const std::wstring& path)
+{
+	Close();
+
+	file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Could not open file for mapping");
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		Close();
+		throw std::runtime_error("Could not get size of file to map");
+	}
+
+	size = static_cast<size_t>(fileSize.QuadPart);
+
+	// Empty files cannot be mapped, but are still valid to open
+	if (size == 0)
+		return;
+
+	mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (mapping == nullptr)
+	{
+		Close();
+		throw std::runtime_error("Could not create file mapping");
+	}
+
+	view = static_cast<const unsigned char*>(
+		MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+	if (view == nullptr)
+	{
+		Close();
+		throw std::runtime_error("Could not map view of file");
+	}
+}
+
+void MappedFile::Close()
+{
+	if (view != nullptr)
+		UnmapViewOfFile(view);
+
+	if (mapping != nullptr)
+		CloseHandle(mapping);
+
+	if (file != INVALID_HANDLE_VALUE)
+		CloseHandle(file);
+
+	file = INVALID_HANDLE_VALUE;
+	mapping = nullptr;
+	view = nullptr;
+	size = 0;
+}
+
+bool MappedFile::IsOpen() const
+{
+	return file != INVALID_HANDLE_VALUE;
+}
+
+const unsigned char* MappedFile::GetData(size_t offset) const
+{
+	if (offset > size)
+		throw std::runtime_error("Offset is outside of the mapped file");
+
+	return view == nullptr ? nullptr : view + offset;
+}
+
+size_t MappedFile::GetSize() const
+{
+	return size;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+#include <windows.h>
+
+class MappedFile
+{
+private:
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+	const unsigned char* view = nullptr;
+	size_t size = 0;
+
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile& other) = delete;
+	MappedFile& operator=(const MappedFile& other) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	// The file is mapped read only, pages are only read in as they are accessed
+	void Open(const std::wstring& path);
+	void Close();
+
+	bool IsOpen() const;
+	const unsigned char* GetData(size_t offset = 0) const;
+	size_t GetSize() const;
+};
\ No newline at end of file
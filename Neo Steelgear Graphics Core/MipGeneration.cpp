@@ -0,0 +1,508 @@
+#include "MipGeneration.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+#include <immintrin.h>
+
+#include "InstructionSet.h"
+
+namespace
+{
+	const double PI = 3.14159265358979323846;
+	const double KAISER_WIDTH = 3.0; // In destination texels on each side
+	const double KAISER_ALPHA = 4.0;
+	const size_t ROWS_PER_JOB = 8;
+	const size_t MIN_TEXELS_FOR_THREADING = 128 * 128;
+
+	// Source texels and weights for every destination texel along one axis
+	struct AxisWeights
+	{
+		size_t tapsPerTexel = 0;
+		std::vector<unsigned int> indices;
+		std::vector<float> weights;
+	};
+
+	double BesselI0(double x)
+	{
+		double toReturn = 1.0;
+		double term = 1.0;
+		double halfX = x * 0.5;
+
+		for (int k = 1; term > toReturn * 1e-12; ++k)
+		{
+			double factor = halfX / k;
+			term *= factor * factor;
+			toReturn += term;
+		}
+
+		return toReturn;
+	}
+
+	double Sinc(double x)
+	{
+		if (std::abs(x) < 1e-9)
+			return 1.0;
+
+		return std::sin(PI * x) / (PI * x);
+	}
+
+	double KaiserWeight(double x)
+	{
+		double relative = x / KAISER_WIDTH;
+		if (relative <= -1.0 || relative >= 1.0)
+			return 0.0;
+
+		double window = BesselI0(KAISER_ALPHA * std::sqrt(1.0 - relative * relative)) /
+			BesselI0(KAISER_ALPHA);
+		return Sinc(x) * window;
+	}
+
+	AxisWeights CalculateAxisWeights(unsigned int sourceSize,
+		unsigned int destinationSize, MipFilter filter)
+	{
+		double scale = static_cast<double>(sourceSize) / destinationSize;
+		double radius = filter == MipFilter::BOX ? scale * 0.5 : KAISER_WIDTH * scale;
+
+		AxisWeights toReturn;
+		toReturn.tapsPerTexel = static_cast<size_t>(std::ceil(radius * 2.0)) + 1;
+		toReturn.indices.resize(toReturn.tapsPerTexel * destinationSize);
+		toReturn.weights.resize(toReturn.tapsPerTexel * destinationSize);
+		std::vector<double> weights(toReturn.tapsPerTexel);
+
+		for (unsigned int i = 0; i < destinationSize; ++i)
+		{
+			double center = (i + 0.5) * scale;
+			long long firstTap = static_cast<long long>(std::floor(center - radius));
+			double weightSum = 0.0;
+
+			for (size_t tap = 0; tap < toReturn.tapsPerTexel; ++tap)
+			{
+				long long sourceIndex = firstTap + static_cast<long long>(tap);
+				double weight = 0.0;
+
+				if (filter == MipFilter::BOX)
+				{
+					double overlapStart = max(static_cast<double>(sourceIndex), center - radius);
+					double overlapEnd = min(static_cast<double>(sourceIndex + 1), center + radius);
+					weight = max(overlapEnd - overlapStart, 0.0);
+				}
+				else
+				{
+					weight = KaiserWeight((sourceIndex + 0.5 - center) / scale);
+				}
+
+				// Texels outside the source repeat the edge
+				long long clampedIndex = min(max(sourceIndex, 0LL),
+					static_cast<long long>(sourceSize) - 1);
+				toReturn.indices[i * toReturn.tapsPerTexel + tap] =
+					static_cast<unsigned int>(clampedIndex);
+				weights[tap] = weight;
+				weightSum += weight;
+			}
+
+			for (size_t tap = 0; tap < toReturn.tapsPerTexel; ++tap)
+			{
+				toReturn.weights[i * toReturn.tapsPerTexel + tap] =
+					static_cast<float>(weights[tap] / weightSum);
+			}
+		}
+
+		return toReturn;
+	}
+
+	float SRGBToLinear(double value)
+	{
+		return static_cast<float>(value <= 0.04045 ? value / 12.92 :
+			std::pow((value + 0.055) / 1.055, 2.4));
+	}
+
+	const float* GetSRGBDecodeTable()
+	{
+		static const std::vector<float> table = []()
+		{
+			std::vector<float> toReturn(256);
+			for (size_t i = 0; i < toReturn.size(); ++i)
+				toReturn[i] = SRGBToLinear(i / 255.0);
+
+			return toReturn;
+		}();
+
+		return table.data();
+	}
+
+	// Linear values where the rounded sRGB encoding steps from one value to the next
+	const float* GetSRGBEncodeThresholds()
+	{
+		static const std::vector<float> thresholds = []()
+		{
+			std::vector<float> toReturn(255);
+			for (size_t i = 0; i < toReturn.size(); ++i)
+				toReturn[i] = SRGBToLinear((i + 0.5) / 255.0);
+
+			return toReturn;
+		}();
+
+		return thresholds.data();
+	}
+
+	void AccumulateRowSSE(float* destination, const float* source,
+		float weight, size_t nrOfElements)
+	{
+		__m128 weights = _mm_set1_ps(weight);
+		size_t i = 0;
+		for (; i + 4 <= nrOfElements; i += 4)
+		{
+			__m128 weighted = _mm_mul_ps(_mm_loadu_ps(source + i), weights);
+			_mm_storeu_ps(destination + i,
+				_mm_add_ps(_mm_loadu_ps(destination + i), weighted));
+		}
+
+		for (; i < nrOfElements; ++i)
+			destination[i] += source[i] * weight;
+	}
+
+	void AccumulateRowAVX(float* destination, const float* source,
+		float weight, size_t nrOfElements)
+	{
+		__m256 weights = _mm256_set1_ps(weight);
+		size_t i = 0;
+		for (; i + 8 <= nrOfElements; i += 8)
+		{
+			__m256 weighted = _mm256_mul_ps(_mm256_loadu_ps(source + i), weights);
+			_mm256_storeu_ps(destination + i,
+				_mm256_add_ps(_mm256_loadu_ps(destination + i), weighted));
+		}
+
+		AccumulateRowSSE(destination + i, source + i, weight, nrOfElements - i);
+	}
+
+	void FilterRowHorizontally(float* destination, const float* source,
+		const AxisWeights& weights, size_t destinationWidth, size_t nrOfChannels)
+	{
+		for (size_t x = 0; x < destinationWidth; ++x)
+		{
+			const unsigned int* indices = weights.indices.data() + x * weights.tapsPerTexel;
+			const float* texelWeights = weights.weights.data() + x * weights.tapsPerTexel;
+
+			if (nrOfChannels == 4)
+			{
+				__m128 sum = _mm_setzero_ps();
+				for (size_t tap = 0; tap < weights.tapsPerTexel; ++tap)
+				{
+					__m128 texel = _mm_loadu_ps(source + indices[tap] * 4);
+					sum = _mm_add_ps(sum, _mm_mul_ps(texel, _mm_set1_ps(texelWeights[tap])));
+				}
+
+				_mm_storeu_ps(destination + x * 4, sum);
+				continue;
+			}
+
+			for (size_t channel = 0; channel < nrOfChannels; ++channel)
+			{
+				float sum = 0.0f;
+				for (size_t tap = 0; tap < weights.tapsPerTexel; ++tap)
+					sum += source[indices[tap] * nrOfChannels + channel] * texelWeights[tap];
+
+				destination[x * nrOfChannels + channel] = sum;
+			}
+		}
+	}
+
+	// Helper threads are kept between calls, as every level is its own parallel loop
+	class WorkerPool
+	{
+	private:
+		std::vector<std::thread> workers;
+		std::mutex mutex;
+		std::condition_variable workAvailable;
+		std::condition_variable workFinished;
+		std::mutex runMutex; // Only one loop uses the helpers at a time
+
+		const std::function<void(size_t)>* job = nullptr;
+		std::atomic<size_t> nextJob = 0;
+		size_t nrOfJobs = 0;
+		size_t helpersWanted = 0;
+		size_t helpersWorking = 0;
+		std::uint64_t generation = 0;
+		bool stopping = false;
+
+		void RunJobs()
+		{
+			for (size_t i = nextJob++; i < nrOfJobs; i = nextJob++)
+				(*job)(i);
+		}
+
+		void WorkerLoop()
+		{
+			std::uint64_t lastGeneration = 0;
+			std::unique_lock<std::mutex> lock(mutex);
+
+			while (true)
+			{
+				workAvailable.wait(lock, [this, &lastGeneration]()
+					{
+						return stopping || (helpersWanted > 0 && generation != lastGeneration);
+					});
+
+				if (stopping)
+					return;
+
+				lastGeneration = generation;
+				--helpersWanted;
+				++helpersWorking;
+				lock.unlock();
+				RunJobs();
+				lock.lock();
+
+				if (--helpersWorking == 0)
+					workFinished.notify_one();
+			}
+		}
+
+	public:
+		WorkerPool() = default;
+		WorkerPool(const WorkerPool& other) = delete;
+		WorkerPool& operator=(const WorkerPool& other) = delete;
+
+		~WorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+
+			workAvailable.notify_all();
+			for (auto& worker : workers)
+				worker.join();
+		}
+
+		void Run(size_t jobCount, unsigned int nrOfThreads,
+			const std::function<void(size_t)>& jobToRun)
+		{
+			size_t nrOfHelpers = min(static_cast<size_t>(nrOfThreads), jobCount);
+			std::unique_lock<std::mutex> runLock(runMutex, std::defer_lock);
+
+			// Loops started while the helpers are busy run on the calling thread alone
+			if (nrOfHelpers <= 1 || !runLock.try_lock())
+			{
+				for (size_t i = 0; i < jobCount; ++i)
+					jobToRun(i);
+
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				while (workers.size() < nrOfHelpers - 1)
+					workers.emplace_back(&WorkerPool::WorkerLoop, this);
+
+				job = &jobToRun;
+				nrOfJobs = jobCount;
+				nextJob = 0;
+				helpersWanted = nrOfHelpers - 1;
+				++generation;
+			}
+
+			workAvailable.notify_all();
+			RunJobs();
+
+			// Helpers that have not started yet are no longer needed
+			std::unique_lock<std::mutex> lock(mutex);
+			helpersWanted = 0;
+			workFinished.wait(lock, [this]() { return helpersWorking == 0; });
+		}
+	};
+
+	void ParallelFor(size_t nrOfJobs, unsigned int nrOfThreads,
+		const std::function<void(size_t)>& job)
+	{
+		static WorkerPool pool;
+		pool.Run(nrOfJobs, nrOfThreads, job);
+	}
+}
+
+void MipGenerator::DecodeRow(float* destination, const unsigned char* source,
+	size_t nrOfTexels) const
+{
+	size_t nrOfElements = nrOfTexels * nrOfChannels;
+	if (componentType == ComponentType::FLOAT32)
+	{
+		std::memcpy(destination, source, nrOfElements * sizeof(float));
+		return;
+	}
+
+	const float* decodeTable = GetSRGBDecodeTable();
+	for (size_t i = 0; i < nrOfElements; ++i)
+	{
+		bool alpha = nrOfChannels == 4 && i % 4 == 3;
+		destination[i] = sRGB && !alpha ? decodeTable[source[i]] : source[i] / 255.0f;
+	}
+}
+
+void MipGenerator::EncodeRow(unsigned char* destination, const float* source,
+	size_t nrOfTexels) const
+{
+	size_t nrOfElements = nrOfTexels * nrOfChannels;
+	if (componentType == ComponentType::FLOAT32)
+	{
+		std::memcpy(destination, source, nrOfElements * sizeof(float));
+		return;
+	}
+
+	const float* thresholds = GetSRGBEncodeThresholds();
+	for (size_t i = 0; i < nrOfElements; ++i)
+	{
+		bool alpha = nrOfChannels == 4 && i % 4 == 3;
+		if (sRGB && !alpha)
+		{
+			destination[i] = static_cast<unsigned char>(
+				std::upper_bound(thresholds, thresholds + 255, source[i]) - thresholds);
+		}
+		else
+		{
+			float clamped = min(max(source[i], 0.0f), 1.0f);
+			destination[i] = static_cast<unsigned char>(clamped * 255.0f + 0.5f);
+		}
+	}
+}
+
+MipGenerator::MipGenerator(DXGI_FORMAT format, MipFilter filterToUse,
+	unsigned int maxNrOfThreads) : filter(filterToUse)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R8_UNORM:
+		nrOfChannels = 1;
+		break;
+	case DXGI_FORMAT_R8G8_UNORM:
+		nrOfChannels = 2;
+		break;
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		sRGB = true;
+		nrOfChannels = 4;
+		break;
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+		nrOfChannels = 4;
+		break;
+	case DXGI_FORMAT_R32_FLOAT:
+		componentType = ComponentType::FLOAT32;
+		nrOfChannels = 1;
+		break;
+	case DXGI_FORMAT_R32G32_FLOAT:
+		componentType = ComponentType::FLOAT32;
+		nrOfChannels = 2;
+		break;
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		componentType = ComponentType::FLOAT32;
+		nrOfChannels = 4;
+		break;
+	default:
+		throw std::runtime_error("Mips cannot be generated for the texture format");
+	}
+
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	nrOfThreads = maxNrOfThreads == 0 ? hardwareThreads : maxNrOfThreads;
+	nrOfThreads = max(nrOfThreads, 1u);
+}
+
+bool MipGenerator::FormatSupported(DXGI_FORMAT format)
+{
+	try
+	{
+		MipGenerator generator(format, MipFilter::BOX);
+		return true;
+	}
+	catch (const std::runtime_error&)
+	{
+		return false;
+	}
+}
+
+size_t MipGenerator::GetTexelSize() const
+{
+	return nrOfChannels *
+		(componentType == ComponentType::FLOAT32 ? sizeof(float) : 1);
+}
+
+void MipGenerator::GenerateMips(const unsigned char* source, unsigned int width,
+	unsigned int height, const std::vector<MipLevel>& levels) const
+{
+	if (nrOfChannels == 0)
+		throw std::runtime_error("Cannot generate mips without a format");
+
+	size_t texelSize = GetTexelSize();
+	unsigned int sourceWidth = width;
+	unsigned int sourceHeight = height;
+	size_t sourceRowElements = static_cast<size_t>(width) * nrOfChannels;
+	unsigned int threadsToUse = static_cast<size_t>(width) * height <
+		MIN_TEXELS_FOR_THREADING ? 1 : nrOfThreads;
+
+	std::vector<float> linearSource(sourceRowElements * height);
+	ParallelFor(height, threadsToUse, [&](size_t y)
+		{
+			DecodeRow(linearSource.data() + y * sourceRowElements,
+				source + y * width * texelSize, width);
+		});
+
+	bool avx = GetSupportedInstructionSet() == InstructionSet::AVX2;
+	auto accumulateRow = avx ? AccumulateRowAVX : AccumulateRowSSE;
+	std::vector<float> linearLevel;
+
+	// Every level is filtered from the one before it, which is kept linear and unrounded
+	for (auto& level : levels)
+	{
+		AxisWeights horizontal = CalculateAxisWeights(sourceWidth, level.width, filter);
+		AxisWeights vertical = CalculateAxisWeights(sourceHeight, level.height, filter);
+		size_t levelRowElements = static_cast<size_t>(level.width) * nrOfChannels;
+		linearLevel.resize(levelRowElements * level.height);
+		threadsToUse = static_cast<size_t>(sourceWidth) * sourceHeight <
+			MIN_TEXELS_FOR_THREADING ? 1 : nrOfThreads;
+
+		size_t nrOfJobs = (level.height + ROWS_PER_JOB - 1) / ROWS_PER_JOB;
+		ParallelFor(nrOfJobs, threadsToUse, [&](size_t job)
+			{
+				std::vector<float> filteredColumns(sourceRowElements);
+				size_t firstRow = job * ROWS_PER_JOB;
+				size_t lastRow = min(firstRow + ROWS_PER_JOB, static_cast<size_t>(level.height));
+
+				for (size_t y = firstRow; y < lastRow; ++y)
+				{
+					std::fill(filteredColumns.begin(), filteredColumns.end(), 0.0f);
+					for (size_t tap = 0; tap < vertical.tapsPerTexel; ++tap)
+					{
+						float weight = vertical.weights[y * vertical.tapsPerTexel + tap];
+						if (weight == 0.0f)
+							continue;
+
+						size_t sourceRow = vertical.indices[y * vertical.tapsPerTexel + tap];
+						accumulateRow(filteredColumns.data(), linearSource.data() +
+							sourceRow * sourceRowElements, weight, sourceRowElements);
+					}
+
+					float* filteredRow = linearLevel.data() + y * levelRowElements;
+					FilterRowHorizontally(filteredRow, filteredColumns.data(),
+						horizontal, level.width, nrOfChannels);
+					EncodeRow(level.data + y * level.width * texelSize,
+						filteredRow, level.width);
+				}
+			});
+
+		linearSource.swap(linearLevel);
+		sourceWidth = level.width;
+		sourceHeight = level.height;
+		sourceRowElements = levelRowElements;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include <d3d12.h>
+
+enum class MipFilter
+{
+	BOX,
+	KAISER // Windowed sinc, sharper than the box filter
+};
+
+struct MipLevel
+{
+	unsigned char* data = nullptr; // Tightly packed rows
+	unsigned int width = 0;
+	unsigned int height = 0;
+};
+
+class MipGenerator
+{
+private:
+	enum class ComponentType
+	{
+		UNORM8,
+		FLOAT32
+	};
+
+	ComponentType componentType = ComponentType::UNORM8;
+	size_t nrOfChannels = 0;
+	bool sRGB = false;
+	MipFilter filter = MipFilter::BOX;
+	unsigned int nrOfThreads = 1;
+
+	void DecodeRow(float* destination, const unsigned char* source,
+		size_t nrOfTexels) const;
+	void EncodeRow(unsigned char* destination, const float* source,
+		size_t nrOfTexels) const;
+
+public:
+	MipGenerator() = default;
+	MipGenerator(DXGI_FORMAT format, MipFilter filterToUse,
+		unsigned int maxNrOfThreads = 0); // 0 uses all hardware threads
+	~MipGenerator() = default;
+	MipGenerator(const MipGenerator& other) = default;
+	MipGenerator& operator=(const MipGenerator& other) = default;
+
+	static bool FormatSupported(DXGI_FORMAT format);
+
+	size_t GetTexelSize() const;
+
+	// Every level is filtered from the one before it, so levels should be ordered from most to least detailed
+	void GenerateMips(const unsigned char* source, unsigned int width,
+		unsigned int height, const std::vector<MipLevel>& levels) const;
+};
\ No newline at end of file
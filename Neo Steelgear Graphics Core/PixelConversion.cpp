@@ -0,0 +1,389 @@
+#include "PixelConversion.h"
+
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+
+#include <intrin.h>
+#include <immintrin.h>
+
+namespace
+{
+	const std::uint32_t OPAQUE_ALPHA = 0xFF000000;
+
+	bool IsRGBA8(DXGI_FORMAT format)
+	{
+		return format == DXGI_FORMAT_R8G8B8A8_TYPELESS ||
+			format == DXGI_FORMAT_R8G8B8A8_UNORM ||
+			format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB ||
+			format == DXGI_FORMAT_R8G8B8A8_UINT ||
+			format == DXGI_FORMAT_R8G8B8A8_SNORM ||
+			format == DXGI_FORMAT_R8G8B8A8_SINT;
+	}
+
+	bool IsBGRA8(DXGI_FORMAT format)
+	{
+		return format == DXGI_FORMAT_B8G8R8A8_TYPELESS ||
+			format == DXGI_FORMAT_B8G8R8A8_UNORM ||
+			format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
+			format == DXGI_FORMAT_B8G8R8X8_TYPELESS ||
+			format == DXGI_FORMAT_B8G8R8X8_UNORM ||
+			format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+	}
+
+	bool IsFloat16(DXGI_FORMAT format)
+	{
+		return format == DXGI_FORMAT_R16G16B16A16_FLOAT ||
+			format == DXGI_FORMAT_R16G16_FLOAT || format == DXGI_FORMAT_R16_FLOAT;
+	}
+
+	// Scalar fallbacks, also used for the tails of the vectorized loops
+
+	void SwapRedBlueScalar(unsigned char* destination,
+		const unsigned char* source, size_t nrOfTexels)
+	{
+		for (size_t i = 0; i < nrOfTexels; ++i)
+		{
+			destination[i * 4 + 0] = source[i * 4 + 2];
+			destination[i * 4 + 1] = source[i * 4 + 1];
+			destination[i * 4 + 2] = source[i * 4 + 0];
+			destination[i * 4 + 3] = source[i * 4 + 3];
+		}
+	}
+
+	void ExpandRGBScalar(unsigned char* destination,
+		const unsigned char* source, size_t nrOfTexels)
+	{
+		for (size_t i = 0; i < nrOfTexels; ++i)
+		{
+			destination[i * 4 + 0] = source[i * 3 + 0];
+			destination[i * 4 + 1] = source[i * 3 + 1];
+			destination[i * 4 + 2] = source[i * 3 + 2];
+			destination[i * 4 + 3] = 0xFF;
+		}
+	}
+
+	void ExpandRGBSwappedScalar(unsigned char* destination,
+		const unsigned char* source, size_t nrOfTexels)
+	{
+		for (size_t i = 0; i < nrOfTexels; ++i)
+		{
+			destination[i * 4 + 0] = source[i * 3 + 2];
+			destination[i * 4 + 1] = source[i * 3 + 1];
+			destination[i * 4 + 2] = source[i * 3 + 0];
+			destination[i * 4 + 3] = 0xFF;
+		}
+	}
+
+	// Round to nearest even, NaN becomes a quiet NaN and overflow becomes infinity
+	std::uint16_t FloatToHalf(float value)
+	{
+		const std::uint32_t FLOAT_INFINITY = 255 << 23;
+		const std::uint32_t HALF_MAX = (127 + 16) << 23;
+		const std::uint32_t DENORMAL_MAGIC = ((127 - 15) + (23 - 10) + 1) << 23;
+
+		std::uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		std::uint32_t sign = bits & 0x80000000;
+		bits ^= sign;
+		std::uint32_t toReturn = 0;
+
+		if (bits >= HALF_MAX)
+		{
+			toReturn = bits > FLOAT_INFINITY ? 0x7E00 : 0x7C00;
+		}
+		else if (bits < (113 << 23))
+		{
+			float magic;
+			std::memcpy(&magic, &DENORMAL_MAGIC, sizeof(magic));
+			float absolute;
+			std::memcpy(&absolute, &bits, sizeof(absolute));
+			absolute += magic;
+			std::memcpy(&bits, &absolute, sizeof(bits));
+			toReturn = bits - DENORMAL_MAGIC;
+		}
+		else
+		{
+			std::uint32_t mantissaOdd = (bits >> 13) & 1;
+			bits += (static_cast<std::uint32_t>(15 - 127) << 23) + 0xFFF;
+			bits += mantissaOdd;
+			toReturn = bits >> 13;
+		}
+
+		return static_cast<std::uint16_t>(toReturn | (sign >> 16));
+	}
+
+	void FloatToHalfScalar(unsigned char* destination,
+		const unsigned char* source, size_t nrOfFloats)
+	{
+		for (size_t i = 0; i < nrOfFloats; ++i)
+		{
+			float value;
+			std::memcpy(&value, source + i * 4, sizeof(value));
+			std::uint16_t half = FloatToHalf(value);
+			std::memcpy(destination + i * 2, &half, sizeof(half));
+		}
+	}
+
+	// SSE paths
+
+	void ShuffleTexelsSSE(unsigned char* destination,
+		const unsigned char* source, size_t nrOfTexels)
+	{
+		const __m128i shuffleMask = _mm_setr_epi8(
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+		size_t i = 0;
+		for (; i + 4 <= nrOfTexels; i += 4)
+		{
+			__m128i texels = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(source + i * 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4),
+				_mm_shuffle_epi8(texels, shuffleMask));
+		}
+
+		SwapRedBlueScalar(destination + i * 4, source + i * 4, nrOfTexels - i);
+	}
+
+	template<bool Swapped>
+	void ExpandRGBSSE(unsigned char* destination,
+		const unsigned char* source, size_t nrOfTexels)
+	{
+		const __m128i shuffleMask = Swapped ?
+			_mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1) :
+			_mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m128i alpha = _mm_set1_epi32(static_cast<int>(OPAQUE_ALPHA));
+
+		// Each load reads 16 bytes but only uses 12, so stop before the end of the row
+		size_t i = 0;
+		for (; i + 6 <= nrOfTexels; i += 4)
+		{
+			__m128i texels = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(source + i * 3));
+			texels = _mm_or_si128(_mm_shuffle_epi8(texels, shuffleMask), alpha);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), texels);
+		}
+
+		if constexpr (Swapped)
+			ExpandRGBSwappedScalar(destination + i * 4, source + i * 3, nrOfTexels - i);
+		else
+			ExpandRGBScalar(destination + i * 4, source + i * 3, nrOfTexels - i);
+	}
+
+	// Same rounding as FloatToHalf, for four floats at a time with SSE2
+	__m128i FloatToHalfVectorSSE(__m128 values)
+	{
+		const __m128i signMask = _mm_set1_epi32(static_cast<int>(0x80000000));
+		const __m128i halfMax = _mm_set1_epi32((127 + 16) << 23);
+		const __m128i nanBit = _mm_set1_epi32(0x200);
+		const __m128i halfInfinity = _mm_set1_epi32(0x7C00);
+		const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+		const __m128i denormalMagic = _mm_set1_epi32(
+			((127 - 15) + (23 - 10) + 1) << 23);
+		const __m128i normalBias = _mm_set1_epi32(0xFFF - ((127 - 15) << 23));
+
+		__m128 sign = _mm_and_ps(_mm_castsi128_ps(signMask), values);
+		__m128 absolute = _mm_xor_ps(values, sign);
+		__m128i absoluteBits = _mm_castps_si128(absolute);
+
+		__m128 isNan = _mm_cmpunord_ps(absolute, absolute);
+		__m128i isRegular = _mm_cmpgt_epi32(halfMax, absoluteBits);
+		__m128i special = _mm_or_si128(
+			_mm_and_si128(_mm_castps_si128(isNan), nanBit), halfInfinity);
+
+		__m128i isDenormal = _mm_cmpgt_epi32(minNormal, absoluteBits);
+		__m128 denormalSum = _mm_add_ps(absolute, _mm_castsi128_ps(denormalMagic));
+		__m128i denormal = _mm_sub_epi32(_mm_castps_si128(denormalSum), denormalMagic);
+
+		__m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(absoluteBits, 31 - 13), 31);
+		__m128i normal = _mm_add_epi32(absoluteBits, normalBias);
+		normal = _mm_srli_epi32(_mm_sub_epi32(normal, mantissaOdd), 13);
+
+		__m128i toReturn = _mm_or_si128(_mm_and_si128(denormal, isDenormal),
+			_mm_andnot_si128(isDenormal, normal));
+		toReturn = _mm_or_si128(_mm_and_si128(toReturn, isRegular),
+			_mm_andnot_si128(isRegular, special));
+		toReturn = _mm_or_si128(toReturn,
+			_mm_srai_epi32(_mm_castps_si128(sign), 16));
+
+		// Sign extend the low halves so they survive the saturating pack
+		return _mm_srai_epi32(_mm_slli_epi32(toReturn, 16), 16);
+	}
+
+	void FloatToHalfSSE(unsigned char* destination,
+		const unsigned char* source, size_t nrOfFloats)
+	{
+		size_t i = 0;
+		for (; i + 8 <= nrOfFloats; i += 8)
+		{
+			__m128i low = FloatToHalfVectorSSE(_mm_loadu_ps(
+				reinterpret_cast<const float*>(source + i * 4)));
+			__m128i high = FloatToHalfVectorSSE(_mm_loadu_ps(
+				reinterpret_cast<const float*>(source + i * 4 + 16)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 2),
+				_mm_packs_epi32(low, high));
+		}
+
+		FloatToHalfScalar(destination + i * 2, source + i * 4, nrOfFloats - i);
+	}
+
+	// AVX2 paths
+
+	void ShuffleTexelsAVX2(unsigned char* destination,
+		const unsigned char* source, size_t nrOfTexels)
+	{
+		const __m256i shuffleMask = _mm256_setr_epi8(
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+		size_t i = 0;
+		for (; i + 8 <= nrOfTexels; i += 8)
+		{
+			__m256i texels = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(source + i * 4));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i * 4),
+				_mm256_shuffle_epi8(texels, shuffleMask));
+		}
+
+		ShuffleTexelsSSE(destination + i * 4, source + i * 4, nrOfTexels - i);
+	}
+
+	template<bool Swapped>
+	void ExpandRGBAVX2(unsigned char* destination,
+		const unsigned char* source, size_t nrOfTexels)
+	{
+		const __m256i shuffleMask = Swapped ?
+			_mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+				2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1) :
+			_mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+				0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m256i alpha = _mm256_set1_epi32(static_cast<int>(OPAQUE_ALPHA));
+
+		// Four texels per lane, the second lane starts 12 bytes into the source
+		size_t i = 0;
+		for (; i + 10 <= nrOfTexels; i += 8)
+		{
+			__m128i low = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(source + i * 3));
+			__m128i high = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(source + i * 3 + 12));
+			__m256i texels = _mm256_inserti128_si256(
+				_mm256_castsi128_si256(low), high, 1);
+			texels = _mm256_or_si256(_mm256_shuffle_epi8(texels, shuffleMask), alpha);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i * 4),
+				texels);
+		}
+
+		ExpandRGBSSE<Swapped>(destination + i * 4, source + i * 3, nrOfTexels - i);
+	}
+
+	void FloatToHalfAVX2(unsigned char* destination,
+		const unsigned char* source, size_t nrOfFloats)
+	{
+		size_t i = 0;
+		for (; i + 8 <= nrOfFloats; i += 8)
+		{
+			__m256 values = _mm256_loadu_ps(
+				reinterpret_cast<const float*>(source + i * 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 2),
+				_mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT));
+		}
+
+		FloatToHalfScalar(destination + i * 2, source + i * 4, nrOfFloats - i);
+	}
+}
+
+size_t GetSourceTexelSize(SourceFormat sourceFormat, size_t destinationTexelSize)
+{
+	switch (sourceFormat)
+	{
+	case SourceFormat::R8G8B8A8:
+	case SourceFormat::B8G8R8A8:
+		return 4;
+	case SourceFormat::R8G8B8:
+		return 3;
+	case SourceFormat::FLOAT32:
+		return destinationTexelSize * 2;
+	default:
+		return destinationTexelSize;
+	}
+}
+
+void PixelConverter::SelectConversion(SourceFormat sourceFormat,
+	DXGI_FORMAT destinationFormat, size_t destinationTexelSize,
+	InstructionSet instructionSet)
+{
+	bool sse = instructionSet != InstructionSet::SCALAR;
+	bool avx2 = instructionSet == InstructionSet::AVX2;
+
+	switch (sourceFormat)
+	{
+	case SourceFormat::SAME_AS_DESTINATION:
+		return;
+	case SourceFormat::R8G8B8A8:
+	case SourceFormat::B8G8R8A8:
+	{
+		bool sourceIsRGBA = sourceFormat == SourceFormat::R8G8B8A8;
+		if ((sourceIsRGBA && IsRGBA8(destinationFormat)) ||
+			(!sourceIsRGBA && IsBGRA8(destinationFormat)))
+		{
+			return;
+		}
+
+		if (!IsRGBA8(destinationFormat) && !IsBGRA8(destinationFormat))
+			break;
+
+		conversionFunction = avx2 ? ShuffleTexelsAVX2 :
+			(sse ? ShuffleTexelsSSE : SwapRedBlueScalar);
+		return;
+	}
+	case SourceFormat::R8G8B8:
+		if (IsRGBA8(destinationFormat))
+		{
+			conversionFunction = avx2 ? ExpandRGBAVX2<false> :
+				(sse ? ExpandRGBSSE<false> : ExpandRGBScalar);
+			return;
+		}
+		else if (IsBGRA8(destinationFormat))
+		{
+			conversionFunction = avx2 ? ExpandRGBAVX2<true> :
+				(sse ? ExpandRGBSSE<true> : ExpandRGBSwappedScalar);
+			return;
+		}
+
+		break;
+	case SourceFormat::FLOAT32:
+		if (!IsFloat16(destinationFormat))
+			break;
+
+		conversionFunction = avx2 ? FloatToHalfAVX2 :
+			(sse ? FloatToHalfSSE : FloatToHalfScalar);
+		elementsPerTexel = destinationTexelSize / 2;
+		return;
+	}
+
+	throw std::runtime_error("Source format cannot be converted to the texture format");
+}
+
+PixelConverter::PixelConverter(SourceFormat sourceFormat,
+	DXGI_FORMAT destinationFormat, size_t destinationTexelSize,
+	InstructionSet maxInstructionSet)
+{
+	InstructionSet supported = GetSupportedInstructionSet();
+	InstructionSet instructionSet = static_cast<int>(maxInstructionSet) <
+		static_cast<int>(supported) ? maxInstructionSet : supported;
+
+	SelectConversion(sourceFormat, destinationFormat, destinationTexelSize,
+		instructionSet);
+}
+
+bool PixelConverter::ConversionNeeded() const
+{
+	return conversionFunction != nullptr;
+}
+
+void PixelConverter::ConvertRow(unsigned char* destination,
+	const unsigned char* source, size_t nrOfTexels) const
+{
+	conversionFunction(destination, source, nrOfTexels * elementsPerTexel);
+}
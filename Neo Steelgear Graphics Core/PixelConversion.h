@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+
+#include <d3d12.h>
+
+#include "InstructionSet.h"
+
+enum class SourceFormat
+{
+	SAME_AS_DESTINATION,
+	R8G8B8A8,
+	B8G8R8A8,
+	R8G8B8, // Expanded with an opaque alpha
+	FLOAT32 // 32 bit floats for each component of a 16 bit float destination
+};
+
+size_t GetSourceTexelSize(SourceFormat sourceFormat, size_t destinationTexelSize);
+
+class PixelConverter
+{
+private:
+	typedef void (*ConversionFunction)(unsigned char* destination,
+		const unsigned char* source, size_t nrOfElements);
+
+	ConversionFunction conversionFunction = nullptr;
+	size_t elementsPerTexel = 1;
+
+	void SelectConversion(SourceFormat sourceFormat,
+		DXGI_FORMAT destinationFormat, size_t destinationTexelSize,
+		InstructionSet instructionSet);
+
+public:
+	PixelConverter() = default;
+	PixelConverter(SourceFormat sourceFormat, DXGI_FORMAT destinationFormat,
+		size_t destinationTexelSize,
+		InstructionSet maxInstructionSet = InstructionSet::AVX2);
+	~PixelConverter() = default;
+	PixelConverter(const PixelConverter& other) = default;
+	PixelConverter& operator=(const PixelConverter& other) = default;
+
+	bool ConversionNeeded() const;
+	void ConvertRow(unsigned char* destination, const unsigned char* source,
+		size_t nrOfTexels) const;
+};
\ No newline at end of file
@@ -91,11 +91,13 @@ ResourceAllocator::~ResourceAllocator()
 
 ResourceAllocator::ResourceAllocator(ResourceAllocator&& other) noexcept :
 	views(other.views), heapAllocator(other.heapAllocator),
-	additionalHeapChunksMinimumSize(other.additionalHeapChunksMinimumSize)
+	additionalHeapChunksMinimumSize(other.additionalHeapChunksMinimumSize),
+	emptyChunkReleaseDelay(other.emptyChunkReleaseDelay)
 {
 	other.views = AllowedViews();
 	other.heapAllocator = nullptr;
 	other.additionalHeapChunksMinimumSize = 0;
+	other.emptyChunkReleaseDelay = 0;
 }
 
 ResourceAllocator& ResourceAllocator::operator=(ResourceAllocator&& other) noexcept
@@ -108,6 +110,8 @@ ResourceAllocator& ResourceAllocator::operator=(ResourceAllocator&& other) noexc
 		other.heapAllocator = nullptr;
 		additionalHeapChunksMinimumSize = other.additionalHeapChunksMinimumSize;
 		other.additionalHeapChunksMinimumSize = 0;
+		emptyChunkReleaseDelay = other.emptyChunkReleaseDelay;
+		other.emptyChunkReleaseDelay = 0;
 	}
 
 	return *this;
@@ -119,4 +123,14 @@ void ResourceAllocator::Initialize(const AllowedViews& allowedViews,
 	views = allowedViews;
 	heapAllocator = heapAllocatorToUse;
 	additionalHeapChunksMinimumSize = minimumExpansionMemoryRequest;
+}
+
+void ResourceAllocator::SetEmptyChunkReleaseDelay(size_t nrOfTrims)
+{
+	emptyChunkReleaseDelay = nrOfTrims;
+}
+
+size_t ResourceAllocator::EmptyChunkReleaseDelay() const
+{
+	return emptyChunkReleaseDelay;
 }
\ No newline at end of file
@@ -35,6 +35,7 @@ protected:
 	AllowedViews views;
 	HeapAllocatorGPU* heapAllocator;
 	size_t additionalHeapChunksMinimumSize = 0;
+	size_t emptyChunkReleaseDelay = 0; // 0 keeps expansion chunks until the allocator is destroyed
 
 public:
 	ResourceAllocator() = default;
@@ -47,4 +48,9 @@ public:
 	void Initialize(const AllowedViews& allowedViews, 
 		HeapAllocatorGPU* heapAllocatorToUse, 
 		size_t minimumExpansionMemoryRequest);
+
+	// Expansion chunks that stay empty for this many trims in a row are given back to the heap allocator.
+	// Trimming is meant to happen once per frame, so the delay should cover the frames in flight
+	void SetEmptyChunkReleaseDelay(size_t nrOfTrims);
+	size_t EmptyChunkReleaseDelay() const;
 };
\ No newline at end of file
@@ -1,23 +1,97 @@
 #include "ResourceComponent.h"
 
+bool ResourceComponent::RegisterBindlessView(ViewType type,
+	std::uint8_t allocatorIndex, ResourceIndex& resourceIndex)
+{
+	if (bindlessHeap == nullptr || type == ViewType::RTV || type == ViewType::DSV)
+		return true;
+
+	auto handle = bindlessHeap->Allocate(descriptorAllocators[allocatorIndex].GetDescriptorHandle(
+		resourceIndex.descriptorIndex));
+	if (!handle.has_value())
+		return false;
+
+	resourceIndex.bindlessHandles[static_cast<size_t>(type)] = *handle;
+	return true;
+}
+
+bool ResourceComponent::SetBatchDescriptorIndices(ViewType type,
+	std::uint8_t allocatorIndex, const std::vector<size_t>& descriptorIndices,
+	std::vector<ResourceIndex>& resourceIndices)
+{
+	for (size_t i = 0; i < resourceIndices.size(); ++i)
+	{
+		resourceIndices[i].descriptorIndex = descriptorIndices[i];
+		if (!RegisterBindlessView(type, allocatorIndex, resourceIndices[i]))
+			return false;
+	}
+
+	return true;
+}
+
+void ResourceComponent::ReleaseBindlessViews(const ResourceIndex& resourceIndex)
+{
+	if (bindlessHeap == nullptr)
+		return;
+
+	for (auto& handle : resourceIndex.bindlessHandles)
+	{
+		if (handle.shaderIndex != std::uint32_t(-1))
+			bindlessHeap->Release(handle);
+	}
+}
+
+void ResourceComponent::DeallocateBatchDescriptors(
+	const std::vector<std::uint8_t>& allocatorIndices,
+	const std::vector<size_t>& descriptorIndices)
+{
+	for (std::uint8_t allocatorIndex : allocatorIndices)
+	{
+		for (size_t descriptorIndex : descriptorIndices)
+			descriptorAllocators[allocatorIndex].DeallocateDescriptor(descriptorIndex);
+	}
+}
+
 ResourceComponent::ResourceComponent(ResourceComponent&& other) noexcept : 
-	descriptorAllocators(std::move(other.descriptorAllocators))
+	descriptorAllocators(std::move(other.descriptorAllocators)),
+	bindlessHeap(other.bindlessHeap)
 {
-	// Empty
+	other.bindlessHeap = nullptr;
 }
 
 ResourceComponent& ResourceComponent::operator=(ResourceComponent&& other) noexcept
 {
 	if (this != &other)
+	{
 		descriptorAllocators = std::move(other.descriptorAllocators);
+		bindlessHeap = other.bindlessHeap;
+		other.bindlessHeap = nullptr;
+	}
 
 	return *this;
 }
 
+void ResourceComponent::SetBindlessHeap(BindlessDescriptorHeap* heapToUse)
+{
+	bindlessHeap = heapToUse;
+}
+
 void ResourceComponent::RemoveComponent(const ResourceIndex& indexToRemove)
 {
 	for (auto& descriptorAllocator : descriptorAllocators)
 		descriptorAllocator.DeallocateDescriptor(indexToRemove.descriptorIndex);
+
+	ReleaseBindlessViews(indexToRemove);
+}
+
+const D3D12_CPU_DESCRIPTOR_HANDLE ResourceComponent::GetHeapStart(
+	std::uint8_t allocatorIndex) const
+{
+	const DescriptorAllocator& allocator = descriptorAllocators[allocatorIndex];
+	if (allocator.DescriptorsArePaged())
+		throw std::runtime_error("Attempting to fetch heap start of paged descriptors");
+
+	return allocator.GetDescriptorHandle(0);
 }
 
 const D3D12_CPU_DESCRIPTOR_HANDLE ResourceComponent::GetDescriptorHeapCBV() const
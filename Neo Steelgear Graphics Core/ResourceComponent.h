@@ -4,6 +4,7 @@
 #include <dxgi1_6.h>
 
 #include "DescriptorAllocator.h"
+#include "BindlessDescriptorHeap.h"
 #include "ResourceUploader.h"
 #include "HeapAllocatorGPU.h"
 #include "ResourceAllocator.h"
@@ -13,6 +14,7 @@ struct ResourceComponentMemoryInfo
 	size_t initialMinimumHeapSize = size_t(-1);
 	size_t expansionMinimumSize = size_t(-1);
 	HeapAllocatorGPU* heapAllocator = nullptr;
+	size_t emptyChunkReleaseDelay = 0; // In trims, 0 keeps expansion chunks until destruction
 };
 
 enum class ViewType
@@ -73,12 +75,26 @@ struct ResourceIndex
 {
 	ResourceIdentifier allocatorIdentifier;
 	size_t descriptorIndex = size_t(-1);
+	BindlessHandle bindlessHandles[3]; // Indexed by CBV, SRV and UAV view type, set if registered
 };
 
 class ResourceComponent
 {
 protected:
 	std::vector<DescriptorAllocator> descriptorAllocators;
+	BindlessDescriptorHeap* bindlessHeap = nullptr;
+
+	bool RegisterBindlessView(ViewType type, std::uint8_t allocatorIndex,
+		ResourceIndex& resourceIndex);
+	bool SetBatchDescriptorIndices(ViewType type, std::uint8_t allocatorIndex,
+		const std::vector<size_t>& descriptorIndices,
+		std::vector<ResourceIndex>& resourceIndices);
+	// Also used to roll back the slots claimed before view creation failed
+	void ReleaseBindlessViews(const ResourceIndex& resourceIndex);
+	// Rolls back the views of a batch from the allocators that did create them
+	void DeallocateBatchDescriptors(const std::vector<std::uint8_t>& allocatorIndices,
+		const std::vector<size_t>& descriptorIndices);
+	const D3D12_CPU_DESCRIPTOR_HANDLE GetHeapStart(std::uint8_t allocatorIndex) const;
 
 public:
 	ResourceComponent() = default;
@@ -88,8 +104,13 @@ public:
 	ResourceComponent(ResourceComponent&& other) noexcept;
 	ResourceComponent& operator=(ResourceComponent&& other) noexcept;
 
+	// Views created from now on also get a permanent slot in the heap, not meant for frame components
+	void SetBindlessHeap(BindlessDescriptorHeap* heapToUse);
+
 	virtual void RemoveComponent(const ResourceIndex& indexToRemove) = 0;
 
+	// Start of the descriptors of a view type. Throws if the descriptors grow by pages,
+	// as they are then not contiguous and have to be fetched by index instead
 	virtual const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapCBV() const;
 	virtual const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapSRV() const;
 	virtual const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapUAV() const;
@@ -0,0 +1,262 @@
+#include "ResourceReadback.h"
+
+#include <stdexcept>
+
+void ResourceReadback::AllocateBuffer(ID3D12Heap* heap, size_t heapOffset)
+{
+	D3D12_RESOURCE_DESC desc;
+
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	desc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	desc.Width = totalMemory;
+	desc.Height = 1;
+	desc.DepthOrArraySize = 1;
+	desc.MipLevels = 1;
+	desc.Format = DXGI_FORMAT_UNKNOWN;
+	desc.SampleDesc.Count = 1;
+	desc.SampleDesc.Quality = 0;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	HRESULT hr = device->CreatePlacedResource(heap, heapOffset, &desc,
+		D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&buffer));
+
+	if (FAILED(hr))
+		throw std::runtime_error("Could not create placed readback resource");
+}
+
+void ResourceReadback::AllocateBuffer()
+{
+	D3D12_HEAP_PROPERTIES heapProperties;
+	heapProperties.Type = D3D12_HEAP_TYPE_READBACK;
+	heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	heapProperties.CreationNodeMask = 0;
+	heapProperties.VisibleNodeMask = 0;
+
+	D3D12_RESOURCE_DESC desc;
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	desc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	desc.Width = totalMemory;
+	desc.Height = 1;
+	desc.DepthOrArraySize = 1;
+	desc.MipLevels = 1;
+	desc.Format = DXGI_FORMAT_UNKNOWN;
+	desc.SampleDesc.Count = 1;
+	desc.SampleDesc.Quality = 0;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	HRESULT hr = device->CreateCommittedResource(&heapProperties,
+		D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COPY_DEST,
+		nullptr, IID_PPV_ARGS(&buffer));
+
+	if (FAILED(hr))
+		throw std::runtime_error("Could not create committed readback resource");
+}
+
+std::optional<size_t> ResourceReadback::AllocateReadback(
+	const ReadbackFootprint& footprint)
+{
+	auto allocation = ring.Allocate(footprint.totalSize, footprint.alignment);
+	if (!allocation.has_value())
+		return std::nullopt;
+
+	Readback toAdd;
+	toAdd.offset = allocation->offset;
+	toAdd.footprint = footprint;
+	readbacks[allocation->allocationId] = toAdd;
+
+	return allocation->allocationId;
+}
+
+ResourceReadback::ResourceReadback(ResourceReadback&& other) noexcept :
+	device(other.device), buffer(std::move(other.buffer)),
+	mappedPtr(other.mappedPtr), totalMemory(other.totalMemory),
+	ring(std::move(other.ring)), readbacks(std::move(other.readbacks)),
+	completedValue(other.completedValue)
+{
+	other.device = nullptr;
+	other.mappedPtr = nullptr;
+	other.totalMemory = 0;
+	other.completedValue = 0;
+}
+
+ResourceReadback& ResourceReadback::operator=(ResourceReadback&& other) noexcept
+{
+	if (this != &other)
+	{
+		device = other.device;
+		buffer = std::move(other.buffer);
+		mappedPtr = other.mappedPtr;
+		totalMemory = other.totalMemory;
+		ring = std::move(other.ring);
+		readbacks = std::move(other.readbacks);
+		completedValue = other.completedValue;
+
+		other.device = nullptr;
+		other.mappedPtr = nullptr;
+		other.totalMemory = 0;
+		other.completedValue = 0;
+	}
+
+	return *this;
+}
+
+void ResourceReadback::Initialize(ID3D12Device* deviceToUse, ID3D12Heap* heap,
+	size_t startOffset, size_t endOffset)
+{
+	device = deviceToUse;
+	totalMemory = endOffset - startOffset;
+	ring.Initialize(totalMemory);
+	AllocateBuffer(heap, startOffset);
+	D3D12_RANGE everything = { 0, totalMemory }; // Stays mapped, the CPU only reads
+	buffer->Map(0, &everything, reinterpret_cast<void**>(&mappedPtr));
+}
+
+void ResourceReadback::Initialize(ID3D12Device* deviceToUse, size_t heapSize)
+{
+	device = deviceToUse;
+	totalMemory = heapSize;
+	ring.Initialize(totalMemory);
+	AllocateBuffer();
+	D3D12_RANGE everything = { 0, totalMemory }; // Stays mapped, the CPU only reads
+	buffer->Map(0, &everything, reinterpret_cast<void**>(&mappedPtr));
+}
+
+ReadbackFootprint ResourceReadback::CalculateBufferFootprint(size_t dataSize)
+{
+	ReadbackFootprint toReturn;
+	toReturn.rowSize = dataSize;
+	toReturn.rowPitch = dataSize;
+	toReturn.slicePitch = dataSize;
+	toReturn.totalSize = dataSize;
+	toReturn.alignment = 16; // Enough for any element that is read back
+	return toReturn;
+}
+
+ReadbackFootprint ResourceReadback::CalculateTextureFootprint(
+	const TextureReadbackInfo& readbackInfo)
+{
+	ReadbackFootprint toReturn;
+	toReturn.rowSize = readbackInfo.width * readbackInfo.texelSizeInBytes;
+	toReturn.rowPitch = ((toReturn.rowSize + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) /
+		D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
+	toReturn.slicePitch = toReturn.rowPitch * readbackInfo.height;
+	toReturn.totalSize = toReturn.slicePitch * (readbackInfo.depth - 1) +
+		toReturn.rowPitch * (readbackInfo.height - 1) + toReturn.rowSize;
+	toReturn.alignment = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+	return toReturn;
+}
+
+std::optional<size_t> ResourceReadback::ReadbackBufferData(
+	ID3D12Resource* toReadFrom, ID3D12GraphicsCommandList* commandList,
+	size_t offsetFromStart, size_t dataSize)
+{
+	auto readbackId = AllocateReadback(CalculateBufferFootprint(dataSize));
+	if (!readbackId.has_value())
+		return std::nullopt;
+
+	commandList->CopyBufferRegion(buffer, readbacks[*readbackId].offset,
+		toReadFrom, offsetFromStart, dataSize);
+
+	return readbackId;
+}
+
+std::optional<size_t> ResourceReadback::ReadbackTextureData(
+	ID3D12Resource* toReadFrom, ID3D12GraphicsCommandList* commandList,
+	const TextureReadbackInfo& readbackInfo, unsigned int subresourceIndex)
+{
+	ReadbackFootprint footprint = CalculateTextureFootprint(readbackInfo);
+	auto readbackId = AllocateReadback(footprint);
+	if (!readbackId.has_value())
+		return std::nullopt;
+
+	D3D12_TEXTURE_COPY_LOCATION destination;
+	destination.pResource = buffer;
+	destination.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+	destination.PlacedFootprint.Offset = readbacks[*readbackId].offset;
+	destination.PlacedFootprint.Footprint.Format = readbackInfo.format;
+	destination.PlacedFootprint.Footprint.Width = readbackInfo.width;
+	destination.PlacedFootprint.Footprint.Height = readbackInfo.height;
+	destination.PlacedFootprint.Footprint.Depth = readbackInfo.depth;
+	destination.PlacedFootprint.Footprint.RowPitch =
+		static_cast<UINT>(footprint.rowPitch);
+
+	D3D12_TEXTURE_COPY_LOCATION source;
+	source.pResource = toReadFrom;
+	source.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+	source.SubresourceIndex = subresourceIndex;
+
+	D3D12_BOX sourceBox;
+	sourceBox.left = readbackInfo.offsetWidth;
+	sourceBox.top = readbackInfo.offsetHeight;
+	sourceBox.front = readbackInfo.offsetDepth;
+	sourceBox.right = readbackInfo.offsetWidth + readbackInfo.width;
+	sourceBox.bottom = readbackInfo.offsetHeight + readbackInfo.height;
+	sourceBox.back = readbackInfo.offsetDepth + readbackInfo.depth;
+
+	commandList->CopyTextureRegion(&destination, 0, 0, 0, &source, &sourceBox);
+
+	return readbackId;
+}
+
+void ResourceReadback::SubmitReadbacks(std::uint64_t completionValue)
+{
+	for (auto& readback : readbacks)
+	{
+		if (!readback.second.submitted)
+		{
+			readback.second.submitted = true;
+			readback.second.completionValue = completionValue;
+		}
+	}
+}
+
+void ResourceReadback::UpdateCompletedValue(std::uint64_t newCompletedValue)
+{
+	completedValue = newCompletedValue;
+}
+
+void ResourceReadback::UpdateCompletedValue(ID3D12Fence* fence)
+{
+	completedValue = fence->GetCompletedValue();
+}
+
+bool ResourceReadback::ReadbackFinished(size_t readbackId) const
+{
+	auto readback = readbacks.find(readbackId);
+	if (readback == readbacks.end())
+		return false;
+
+	return readback->second.submitted &&
+		readback->second.completionValue <= completedValue;
+}
+
+std::optional<ReadbackData> ResourceReadback::GetReadbackData(
+	size_t readbackId) const
+{
+	if (!ReadbackFinished(readbackId))
+		return std::nullopt;
+
+	const Readback& readback = readbacks.at(readbackId);
+	ReadbackData toReturn;
+	toReturn.data = mappedPtr + readback.offset;
+	toReturn.size = readback.footprint.totalSize;
+	toReturn.rowPitch = readback.footprint.rowPitch;
+	toReturn.slicePitch = readback.footprint.slicePitch;
+	return toReturn;
+}
+
+void ResourceReadback::ReleaseReadback(size_t readbackId)
+{
+	if (readbacks.erase(readbackId) == 0)
+		throw std::runtime_error("Cannot release a readback that does not exist");
+
+	ring.Free(readbackId);
+}
+
+size_t ResourceReadback::GetUsedMemory() const
+{
+	return ring.GetUsedSize();
+}
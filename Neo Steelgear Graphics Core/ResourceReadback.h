@@ -0,0 +1,106 @@
+#pragma once
+
+#include <d3d12.h>
+#include <optional>
+#include <cstdint>
+#include <unordered_map>
+
+#include "D3DPtr.h"
+#include "RingAllocator.h"
+
+struct TextureReadbackInfo
+{
+	unsigned int width = 1;
+	unsigned int height = 1;
+	unsigned int depth = 1;
+	size_t texelSizeInBytes = 0;
+
+	unsigned int offsetWidth = 0;
+	unsigned int offsetHeight = 0;
+	unsigned int offsetDepth = 0;
+
+	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+};
+
+struct ReadbackFootprint
+{
+	size_t rowSize = 0;
+	size_t rowPitch = 0;
+	size_t slicePitch = 0;
+	size_t totalSize = 0; // The last row does not extend to a full pitch
+	size_t alignment = 1;
+};
+
+// Points straight into the mapped readback memory, valid until the readback is released
+struct ReadbackData
+{
+	const unsigned char* data = nullptr;
+	size_t size = 0;
+	size_t rowPitch = 0;
+	size_t slicePitch = 0;
+};
+
+class ResourceReadback
+{
+private:
+	ID3D12Device* device = nullptr;
+	D3DPtr<ID3D12Resource> buffer;
+	unsigned char* mappedPtr = nullptr;
+	size_t totalMemory = 0;
+
+	struct Readback
+	{
+		size_t offset = 0;
+		ReadbackFootprint footprint;
+		bool submitted = false;
+		std::uint64_t completionValue = 0;
+	};
+
+	RingAllocator ring;
+	std::unordered_map<size_t, Readback> readbacks;
+	std::uint64_t completedValue = 0;
+
+	void AllocateBuffer(ID3D12Heap* heap, size_t heapOffset);
+	void AllocateBuffer();
+
+	std::optional<size_t> AllocateReadback(const ReadbackFootprint& footprint);
+
+public:
+	ResourceReadback() = default;
+	~ResourceReadback() = default;
+
+	ResourceReadback(const ResourceReadback& other) = delete;
+	ResourceReadback& operator=(const ResourceReadback& other) = delete;
+	ResourceReadback(ResourceReadback&& other) noexcept;
+	ResourceReadback& operator=(ResourceReadback&& other) noexcept;
+
+	void Initialize(ID3D12Device* deviceToUse, ID3D12Heap* heap,
+		size_t startOffset, size_t endOffset);
+	void Initialize(ID3D12Device* deviceToUse, size_t heapSize);
+
+	static ReadbackFootprint CalculateBufferFootprint(size_t dataSize);
+	static ReadbackFootprint CalculateTextureFootprint(
+		const TextureReadbackInfo& readbackInfo);
+
+	// Sources must be in a state they can be copied from. Returns the id of the
+	// readback, or nothing if there is not enough free readback memory left
+	std::optional<size_t> ReadbackBufferData(ID3D12Resource* toReadFrom,
+		ID3D12GraphicsCommandList* commandList, size_t offsetFromStart,
+		size_t dataSize);
+	std::optional<size_t> ReadbackTextureData(ID3D12Resource* toReadFrom,
+		ID3D12GraphicsCommandList* commandList,
+		const TextureReadbackInfo& readbackInfo, unsigned int subresourceIndex = 0);
+
+	// Readbacks recorded since the last submit are done once the completed
+	// value reaches the given value, which can be a frame number or fence value
+	void SubmitReadbacks(std::uint64_t completionValue);
+	void UpdateCompletedValue(std::uint64_t newCompletedValue);
+	void UpdateCompletedValue(ID3D12Fence* fence);
+
+	bool ReadbackFinished(size_t readbackId) const;
+	std::optional<ReadbackData> GetReadbackData(size_t readbackId) const;
+	// The memory is reused afterwards, so unfinished readbacks must not be released
+	void ReleaseReadback(size_t readbackId);
+
+	size_t GetUsedMemory() const;
+};
\ No newline at end of file
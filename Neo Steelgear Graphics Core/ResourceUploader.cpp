@@ -1,6 +1,8 @@
 #include "ResourceUploader.h"
 
 #include <stdexcept>
+#include <algorithm>
+#include <cstring>
 
 void ResourceUploader::AllocateBuffer(ID3D12Heap* heap, size_t heapOffset)
 {
@@ -55,7 +57,7 @@ void ResourceUploader::AllocateBuffer()
 		throw std::runtime_error("Could not create committed upload resource");
 }
 
-size_t ResourceUploader::AlignAdress(size_t adress, size_t alignment)
+size_t ResourceUploader::AlignAdress(size_t adress, size_t alignment) const
 {
 	if ((0 == alignment) || (alignment & (alignment - 1)))
 		throw std::runtime_error("Error: non-pow2 alignment");
@@ -64,7 +66,7 @@ size_t ResourceUploader::AlignAdress(size_t adress, size_t alignment)
 }
 
 void ResourceUploader::CopyBufferRegionToResource(ID3D12Resource* toUploadTo,
-	ID3D12GraphicsCommandList* commandList, void* data, size_t offsetFromStart,
+	ID3D12GraphicsCommandList* commandList, const void* data, size_t offsetFromStart,
 	size_t dataSize, size_t alignment, size_t freeChunkIndex)
 {
 	size_t alignedOffset = AlignAdress(
@@ -75,14 +77,15 @@ void ResourceUploader::CopyBufferRegionToResource(ID3D12Resource* toUploadTo,
 }
 
 void ResourceUploader::MemcpyTextureData(unsigned char* destinationStart,
-	unsigned char* sourceStart, const TextureUploadInfo& uploadInfo)
+	const unsigned char* sourceStart, const TextureUploadInfo& uploadInfo)
 {
 	size_t rowPitch = AlignAdress(uploadInfo.width * uploadInfo.texelSizeInBytes,
 		D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
 
-	size_t sliceSize = static_cast<size_t>(uploadInfo.width) * uploadInfo.height *
-		uploadInfo.texelSizeInBytes;
-	size_t rowSize = uploadInfo.width * uploadInfo.texelSizeInBytes;
+	size_t sourceRowPitch = GetSourceRowPitch(uploadInfo);
+	size_t sourceSlicePitch = GetSourceSlicePitch(uploadInfo);
+	PixelConverter converter(uploadInfo.sourceFormat, uploadInfo.format,
+		uploadInfo.texelSizeInBytes);
 
 	for (size_t z = 0; z < uploadInfo.depth; ++z)
 	{
@@ -92,17 +95,25 @@ void ResourceUploader::MemcpyTextureData(unsigned char* destinationStart,
 			currentDestination += z * rowPitch * uploadInfo.height;
 			currentDestination += y * rowPitch;
 
-			unsigned char* currentSource = sourceStart;
-			currentSource += z * sliceSize + y * rowSize;
-
-			memcpy(currentDestination, currentSource,
-				uploadInfo.width * uploadInfo.texelSizeInBytes);
+			const unsigned char* currentSource = sourceStart;
+			currentSource += z * sourceSlicePitch + y * sourceRowPitch;
+
+			if (converter.ConversionNeeded())
+			{
+				converter.ConvertRow(currentDestination, currentSource,
+					uploadInfo.width);
+			}
+			else
+			{
+				memcpy(currentDestination, currentSource,
+					uploadInfo.width * uploadInfo.texelSizeInBytes);
+			}
 		}
 	}
 }
 
 void ResourceUploader::CopyTextureRegionToResource(ID3D12Resource* toUploadTo,
-	ID3D12GraphicsCommandList* commandList, void* data,
+	ID3D12GraphicsCommandList* commandList, const void* data,
 	const TextureUploadInfo& uploadInfo, unsigned int subresourceIndex,
 	size_t freeChunkIndex)
 {
@@ -126,18 +137,429 @@ void ResourceUploader::CopyTextureRegionToResource(ID3D12Resource* toUploadTo,
 	source.PlacedFootprint.Footprint.RowPitch = static_cast<unsigned int>(rowPitch);
 	source.PlacedFootprint.Footprint.Format = uploadInfo.format;
 
-	MemcpyTextureData(mappedPtr + alignedOffset, static_cast<unsigned char*>(data),
-		uploadInfo);
+	MemcpyTextureData(mappedPtr + alignedOffset,
+		static_cast<const unsigned char*>(data), uploadInfo);
 
 	commandList->CopyTextureRegion(&destination, uploadInfo.offsetWidth,
 		uploadInfo.offsetHeight, uploadInfo.offsetDepth, &source, nullptr);
 }
 
+size_t ResourceUploader::UploadBufferParts(ID3D12Resource* toUploadTo,
+	ID3D12GraphicsCommandList* commandList, const unsigned char* data,
+	size_t offsetFromStart, size_t dataSize, size_t alignment,
+	std::optional<std::uint64_t> contentHash)
+{
+	bool deduplicate = deduplicateContent && contentHash.has_value();
+	if (deduplicate && CopyStagedBufferContent(toUploadTo, commandList,
+		data, *contentHash, offsetFromStart, dataSize, alignment))
+	{
+		return dataSize;
+	}
+
+	size_t uploadedSize = 0;
+
+	while (uploadedSize < dataSize)
+	{
+		size_t availableSize = uploadChunks.GetLargestAvailableSize(alignment);
+
+		if (availableSize == 0)
+			break;
+
+		size_t partSize = min(dataSize - uploadedSize, availableSize);
+		size_t chunkIndex = uploadChunks.AllocateChunk(partSize,
+			allocationStrategy, alignment);
+		CopyBufferRegionToResource(toUploadTo, commandList, data + uploadedSize,
+			offsetFromStart + uploadedSize, partSize, alignment, chunkIndex);
+
+		if (deduplicate && partSize == dataSize)
+		{
+			StagedContent staged;
+			staged.stagingOffset = AlignAdress(
+				uploadChunks.GetStartOfChunk(chunkIndex), alignment);
+			staged.dataSize = dataSize;
+			stagedContent.insert({ *contentHash, staged });
+		}
+
+		uploadedSize += partSize;
+	}
+
+	return uploadedSize;
+}
+
+unsigned int ResourceUploader::UploadTextureParts(ID3D12Resource* toUploadTo,
+	ID3D12GraphicsCommandList* commandList, const unsigned char* data,
+	const TextureUploadInfo& uploadInfo, unsigned int subresourceIndex,
+	std::optional<std::uint64_t> contentHash)
+{
+	// Textures are split into bands of rows, or of slices if there is depth
+	bool splitOnRows = uploadInfo.depth == 1;
+	size_t rowPitch = AlignAdress(uploadInfo.width * uploadInfo.texelSizeInBytes,
+		D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+	size_t bandSize = splitOnRows ? rowPitch : rowPitch * uploadInfo.height;
+	size_t sourceBandSize = splitOnRows ? GetSourceRowPitch(uploadInfo) :
+		GetSourceSlicePitch(uploadInfo);
+	unsigned int totalBands = splitOnRows ? uploadInfo.height : uploadInfo.depth;
+	unsigned int uploadedBands = 0;
+
+	// A band larger than the whole staging memory would never be recorded
+	if (splitOnRows && bandSize > totalMemory)
+		throw std::runtime_error("Texture row is larger than the staging memory");
+	else if (bandSize > totalMemory)
+		throw std::runtime_error("Texture slice is larger than the staging memory");
+
+	bool deduplicate = deduplicateContent && contentHash.has_value();
+	if (deduplicate && CopyStagedTextureContent(toUploadTo, commandList,
+		data, *contentHash, uploadInfo, subresourceIndex))
+	{
+		return totalBands;
+	}
+
+	while (uploadedBands < totalBands)
+	{
+		size_t availableSize = uploadChunks.GetLargestAvailableSize(
+			D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+		unsigned int nrOfBands = static_cast<unsigned int>(min(
+			static_cast<size_t>(totalBands - uploadedBands), availableSize / bandSize));
+
+		if (nrOfBands == 0)
+			break;
+
+		TextureUploadInfo partInfo = uploadInfo;
+		if (splitOnRows)
+		{
+			partInfo.height = nrOfBands;
+			partInfo.offsetHeight += uploadedBands;
+		}
+		else
+		{
+			partInfo.depth = nrOfBands;
+			partInfo.offsetDepth += uploadedBands;
+		}
+
+		size_t chunkIndex = uploadChunks.AllocateChunk(bandSize * nrOfBands,
+			allocationStrategy, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+		CopyTextureRegionToResource(toUploadTo, commandList,
+			data + sourceBandSize * uploadedBands, partInfo, subresourceIndex,
+			chunkIndex);
+
+		if (deduplicate && nrOfBands == totalBands)
+		{
+			StagedContent staged;
+			staged.stagingOffset = AlignAdress(
+				uploadChunks.GetStartOfChunk(chunkIndex),
+				D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+			staged.dataSize = bandSize * nrOfBands;
+			staged.isTexture = true;
+			staged.uploadInfo = uploadInfo;
+			stagedContent.insert({ *contentHash, staged });
+		}
+
+		uploadedBands += nrOfBands;
+	}
+
+	return uploadedBands;
+}
+
+bool ResourceUploader::TextureSlicesFit(const TextureUploadInfo& uploadInfo) const
+{
+	size_t rowPitch = AlignAdress(uploadInfo.width * uploadInfo.texelSizeInBytes,
+		D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+
+	return rowPitch * uploadInfo.height <= totalMemory;
+}
+
+size_t ResourceUploader::GetSourceRowSize(const TextureUploadInfo& uploadInfo)
+{
+	return uploadInfo.width * GetSourceTexelSize(uploadInfo.sourceFormat,
+		uploadInfo.texelSizeInBytes);
+}
+
+size_t ResourceUploader::GetSourceRowPitch(const TextureUploadInfo& uploadInfo)
+{
+	return uploadInfo.sourceRowPitch != 0 ? uploadInfo.sourceRowPitch :
+		GetSourceRowSize(uploadInfo);
+}
+
+size_t ResourceUploader::GetSourceSlicePitch(const TextureUploadInfo& uploadInfo)
+{
+	return uploadInfo.sourceSlicePitch != 0 ? uploadInfo.sourceSlicePitch :
+		GetSourceRowPitch(uploadInfo) * uploadInfo.height;
+}
+
+size_t ResourceUploader::GetSourceSize(const TextureUploadInfo& uploadInfo)
+{
+	if (uploadInfo.width == 0 || uploadInfo.height == 0 || uploadInfo.depth == 0)
+		return 0;
+
+	// The last row of the last slice does not extend to a full pitch
+	return GetSourceSlicePitch(uploadInfo) * (uploadInfo.depth - 1) +
+		GetSourceRowPitch(uploadInfo) * (uploadInfo.height - 1) +
+		GetSourceRowSize(uploadInfo);
+}
+
+void ResourceUploader::QueueBufferUpload(ID3D12Resource* toUploadTo,
+	unsigned char* data, size_t offsetFromStart, size_t dataSize, size_t alignment)
+{
+	PendingUpload toQueue;
+	toQueue.destination = toUploadTo;
+	toQueue.data.assign(data, data + dataSize);
+	toQueue.offsetFromStart = offsetFromStart;
+	toQueue.alignment = alignment;
+	pendingUploads.push_back(std::move(toQueue));
+}
+
+void ResourceUploader::QueueTextureUpload(ID3D12Resource* toUploadTo,
+	unsigned char* data, const TextureUploadInfo& uploadInfo,
+	unsigned int subresourceIndex)
+{
+	size_t rowSize = GetSourceRowSize(uploadInfo);
+	size_t sourceRowPitch = GetSourceRowPitch(uploadInfo);
+	size_t sourceSlicePitch = GetSourceSlicePitch(uploadInfo);
+
+	// Slices that do not fit are continued on rows, which needs one upload per slice
+	if (uploadInfo.depth > 1 && !TextureSlicesFit(uploadInfo))
+	{
+		TextureUploadInfo sliceInfo = uploadInfo;
+		sliceInfo.depth = 1;
+		sliceInfo.sourceSlicePitch = 0;
+
+		for (unsigned int z = 0; z < uploadInfo.depth; ++z)
+		{
+			sliceInfo.offsetDepth = uploadInfo.offsetDepth + z;
+			QueueTextureUpload(toUploadTo, data + z * sourceSlicePitch, sliceInfo,
+				subresourceIndex);
+		}
+
+		return;
+	}
+
+	// Queued data is stored tightly packed so it can be split on whole rows and slices
+	PendingUpload toQueue;
+	toQueue.destination = toUploadTo;
+	toQueue.data.resize(rowSize * uploadInfo.height * uploadInfo.depth);
+	toQueue.isTexture = true;
+	toQueue.uploadInfo = uploadInfo;
+	toQueue.uploadInfo.sourceRowPitch = 0;
+	toQueue.uploadInfo.sourceSlicePitch = 0;
+	toQueue.subresourceIndex = subresourceIndex;
+
+	unsigned char* destination = toQueue.data.data();
+	for (size_t z = 0; z < uploadInfo.depth; ++z)
+	{
+		for (size_t y = 0; y < uploadInfo.height; ++y)
+		{
+			memcpy(destination, data + z * sourceSlicePitch + y * sourceRowPitch,
+				rowSize);
+			destination += rowSize;
+		}
+	}
+
+	pendingUploads.push_back(std::move(toQueue));
+}
+
+bool ResourceUploader::ContinuePendingUpload(PendingUpload& pendingUpload,
+	ID3D12GraphicsCommandList* commandList)
+{
+	unsigned char* source = pendingUpload.data.data();
+	source += pendingUpload.processedBytes;
+
+	if (pendingUpload.isTexture == false)
+	{
+		pendingUpload.processedBytes += UploadBufferParts(
+			pendingUpload.destination, commandList, source,
+			pendingUpload.offsetFromStart + pendingUpload.processedBytes,
+			pendingUpload.data.size() - pendingUpload.processedBytes,
+			pendingUpload.alignment);
+
+		return pendingUpload.processedBytes == pendingUpload.data.size();
+	}
+
+	TextureUploadInfo& uploadInfo = pendingUpload.uploadInfo;
+	unsigned int uploadedBands = UploadTextureParts(pendingUpload.destination,
+		commandList, source, uploadInfo, pendingUpload.subresourceIndex);
+	size_t rowSize = GetSourceRowSize(uploadInfo);
+
+	if (uploadInfo.depth == 1)
+	{
+		uploadInfo.height -= uploadedBands;
+		uploadInfo.offsetHeight += uploadedBands;
+		pendingUpload.processedBytes += rowSize * uploadedBands;
+	}
+	else
+	{
+		uploadInfo.depth -= uploadedBands;
+		uploadInfo.offsetDepth += uploadedBands;
+		pendingUpload.processedBytes += rowSize * uploadInfo.height * uploadedBands;
+	}
+
+	return pendingUpload.processedBytes == pendingUpload.data.size();
+}
+
+bool ResourceUploader::UploadTextureSlices(ID3D12Resource* toUploadTo,
+	ID3D12GraphicsCommandList* commandList, unsigned char* data,
+	const TextureUploadInfo& uploadInfo, unsigned int subresourceIndex)
+{
+	size_t sourceSlicePitch = GetSourceSlicePitch(uploadInfo);
+	TextureUploadInfo sliceInfo = uploadInfo;
+	sliceInfo.depth = 1;
+	sliceInfo.sourceSlicePitch = 0;
+
+	for (unsigned int z = 0; z < uploadInfo.depth; ++z)
+	{
+		unsigned char* sliceSource = data + z * sourceSlicePitch;
+		sliceInfo.offsetDepth = uploadInfo.offsetDepth + z;
+		unsigned int uploadedRows = UploadTextureParts(toUploadTo, commandList,
+			sliceSource, sliceInfo, subresourceIndex);
+
+		if (z == 0 && uploadedRows == 0)
+			return false;
+		else if (uploadedRows == sliceInfo.height)
+			continue;
+
+		// The rest of this slice is queued first, later slices have to wait for it
+		TextureUploadInfo remainingInfo = sliceInfo;
+		remainingInfo.height -= uploadedRows;
+		remainingInfo.offsetHeight += uploadedRows;
+		QueueTextureUpload(toUploadTo, sliceSource + GetSourceRowPitch(sliceInfo) *
+			uploadedRows, remainingInfo, subresourceIndex);
+
+		if (z + 1 < uploadInfo.depth)
+		{
+			TextureUploadInfo laterInfo = uploadInfo;
+			laterInfo.depth -= z + 1;
+			laterInfo.offsetDepth += z + 1;
+			QueueTextureUpload(toUploadTo, sliceSource + sourceSlicePitch, laterInfo,
+				subresourceIndex);
+		}
+
+		break;
+	}
+
+	return true;
+}
+
+bool ResourceUploader::StagedTextureMatches(const StagedContent& staged,
+	const unsigned char* data, const TextureUploadInfo& uploadInfo)
+{
+	size_t rowPitch = AlignAdress(uploadInfo.width * uploadInfo.texelSizeInBytes,
+		D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+	size_t rowSize = uploadInfo.width * uploadInfo.texelSizeInBytes;
+	size_t sourceRowPitch = GetSourceRowPitch(uploadInfo);
+	size_t sourceSlicePitch = GetSourceSlicePitch(uploadInfo);
+	PixelConverter converter(uploadInfo.sourceFormat, uploadInfo.format,
+		uploadInfo.texelSizeInBytes);
+	std::vector<unsigned char> convertedRow(converter.ConversionNeeded() ? rowSize : 0);
+
+	for (size_t z = 0; z < uploadInfo.depth; ++z)
+	{
+		for (size_t y = 0; y < uploadInfo.height; ++y)
+		{
+			const unsigned char* stagedRow = mappedPtr + staged.stagingOffset;
+			stagedRow += (z * uploadInfo.height + y) * rowPitch;
+
+			const unsigned char* sourceRow = data;
+			sourceRow += z * sourceSlicePitch + y * sourceRowPitch;
+
+			if (converter.ConversionNeeded())
+			{
+				converter.ConvertRow(convertedRow.data(), sourceRow, uploadInfo.width);
+				sourceRow = convertedRow.data();
+			}
+
+			if (std::memcmp(stagedRow, sourceRow, rowSize) != 0)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool ResourceUploader::CopyStagedBufferContent(ID3D12Resource* toUploadTo,
+	ID3D12GraphicsCommandList* commandList, const unsigned char* data,
+	std::uint64_t contentHash, size_t offsetFromStart, size_t dataSize,
+	size_t alignment)
+{
+	++statistics.deduplicationLookups;
+	auto range = stagedContent.equal_range(contentHash);
+
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		const StagedContent& staged = it->second;
+		if (staged.isTexture || staged.dataSize != dataSize ||
+			staged.stagingOffset % alignment != 0 ||
+			std::memcmp(mappedPtr + staged.stagingOffset, data, dataSize) != 0)
+		{
+			continue;
+		}
+
+		commandList->CopyBufferRegion(toUploadTo, offsetFromStart, buffer,
+			staged.stagingOffset, dataSize);
+		++statistics.deduplicationHits;
+		statistics.bytesSaved += dataSize;
+		return true;
+	}
+
+	return false;
+}
+
+bool ResourceUploader::CopyStagedTextureContent(ID3D12Resource* toUploadTo,
+	ID3D12GraphicsCommandList* commandList, const unsigned char* data,
+	std::uint64_t contentHash, const TextureUploadInfo& uploadInfo,
+	unsigned int subresourceIndex)
+{
+	++statistics.deduplicationLookups;
+	auto range = stagedContent.equal_range(contentHash);
+
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		const StagedContent& staged = it->second;
+		const TextureUploadInfo& stagedInfo = staged.uploadInfo;
+		if (!staged.isTexture || stagedInfo.width != uploadInfo.width ||
+			stagedInfo.height != uploadInfo.height ||
+			stagedInfo.depth != uploadInfo.depth ||
+			stagedInfo.texelSizeInBytes != uploadInfo.texelSizeInBytes ||
+			stagedInfo.format != uploadInfo.format ||
+			stagedInfo.sourceFormat != uploadInfo.sourceFormat ||
+			!StagedTextureMatches(staged, data, uploadInfo))
+		{
+			continue;
+		}
+
+		D3D12_TEXTURE_COPY_LOCATION destination;
+		destination.pResource = toUploadTo;
+		destination.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+		destination.SubresourceIndex = subresourceIndex;
+
+		D3D12_TEXTURE_COPY_LOCATION source;
+		source.pResource = buffer;
+		source.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+		source.PlacedFootprint.Offset = staged.stagingOffset;
+		source.PlacedFootprint.Footprint.Width = uploadInfo.width;
+		source.PlacedFootprint.Footprint.Height = uploadInfo.height;
+		source.PlacedFootprint.Footprint.Depth = uploadInfo.depth;
+		source.PlacedFootprint.Footprint.RowPitch = static_cast<unsigned int>(
+			AlignAdress(uploadInfo.width * uploadInfo.texelSizeInBytes,
+				D3D12_TEXTURE_DATA_PITCH_ALIGNMENT));
+		source.PlacedFootprint.Footprint.Format = uploadInfo.format;
+
+		commandList->CopyTextureRegion(&destination, uploadInfo.offsetWidth,
+			uploadInfo.offsetHeight, uploadInfo.offsetDepth, &source, nullptr);
+		++statistics.deduplicationHits;
+		statistics.bytesSaved += staged.dataSize;
+		return true;
+	}
+
+	return false;
+}
+
 ResourceUploader::ResourceUploader(ResourceUploader&& other) noexcept : 
 	device(other.device), buffer(std::move(other.buffer)), 
 	mappedPtr(other.mappedPtr), latestUploadId(other.latestUploadId),
 	totalMemory(other.totalMemory), allocationStrategy(other.allocationStrategy), 
-	uploadChunks(std::move(other.uploadChunks))
+	uploadChunks(std::move(other.uploadChunks)),
+	pendingUploads(std::move(other.pendingUploads)),
+	deduplicateContent(other.deduplicateContent),
+	stagedContent(std::move(other.stagedContent)), statistics(other.statistics)
 {
 	other.device = nullptr;
 	other.mappedPtr = nullptr;
@@ -156,6 +578,10 @@ ResourceUploader& ResourceUploader::operator=(ResourceUploader&& other) noexcept
 		totalMemory = other.totalMemory;
 		allocationStrategy = other.allocationStrategy;
 		uploadChunks = std::move(other.uploadChunks);
+		pendingUploads = std::move(other.pendingUploads);
+		deduplicateContent = other.deduplicateContent;
+		stagedContent = std::move(other.stagedContent);
+		statistics = other.statistics;
 
 		other.device = nullptr;
 		other.mappedPtr = nullptr;
@@ -192,40 +618,238 @@ void ResourceUploader::Initialize(ID3D12Device* deviceToUse, size_t heapSize,
 
 bool ResourceUploader::UploadBufferResourceData(ID3D12Resource* toUploadTo,
 	ID3D12GraphicsCommandList* commandList, void* data, size_t offsetFromStart,
-	size_t dataSize, size_t alignment)
+	size_t dataSize, size_t alignment, std::optional<std::uint64_t> contentHash)
 {
+	unsigned char* source = static_cast<unsigned char*>(data);
+
+	// Earlier data for the same destination has to be copied first
+	if (!UploadPendingData(commandList, toUploadTo))
+	{
+		QueueBufferUpload(toUploadTo, source, offsetFromStart, dataSize, alignment);
+		return true;
+	}
+
+	bool deduplicate = deduplicateContent && contentHash.has_value();
+	if (deduplicate && CopyStagedBufferContent(toUploadTo, commandList,
+		source, *contentHash, offsetFromStart, dataSize, alignment))
+	{
+		return true;
+	}
+
 	size_t chunkIndex = uploadChunks.AllocateChunk(dataSize, allocationStrategy,
 		alignment);
 
-	if (chunkIndex == size_t(-1))
+	if (chunkIndex != size_t(-1))
+	{
+		CopyBufferRegionToResource(toUploadTo, commandList, data, offsetFromStart,
+			dataSize, alignment, chunkIndex);
+
+		if (deduplicate)
+		{
+			StagedContent staged;
+			staged.stagingOffset = AlignAdress(
+				uploadChunks.GetStartOfChunk(chunkIndex), alignment);
+			staged.dataSize = dataSize;
+			stagedContent.insert({ *contentHash, staged });
+		}
+
+		return true;
+	}
+
+	// Data that fits the staging memory as a whole is retried once it is restored
+	if (dataSize <= totalMemory)
 		return false;
 
-	CopyBufferRegionToResource(toUploadTo, commandList, data, offsetFromStart,
-		dataSize, alignment, chunkIndex);
+	size_t uploadedSize = UploadBufferParts(toUploadTo, commandList, source,
+		offsetFromStart, dataSize, alignment);
+
+	if (uploadedSize == 0)
+		return false;
+
+	if (uploadedSize != dataSize)
+	{
+		QueueBufferUpload(toUploadTo, source + uploadedSize,
+			offsetFromStart + uploadedSize, dataSize - uploadedSize, alignment);
+	}
 
 	return true;
 }
 
 bool ResourceUploader::UploadTextureResourceData(ID3D12Resource* toUploadTo,
 	ID3D12GraphicsCommandList* commandList, void* data,
-	const TextureUploadInfo& uploadInfo, unsigned int subresourceIndex)
+	const TextureUploadInfo& uploadInfo, unsigned int subresourceIndex,
+	std::optional<std::uint64_t> contentHash)
 {
+	unsigned char* source = static_cast<unsigned char*>(data);
+
+	// Earlier data for the same destination has to be copied first
+	if (!UploadPendingData(commandList, toUploadTo))
+	{
+		QueueTextureUpload(toUploadTo, source, uploadInfo, subresourceIndex);
+		return true;
+	}
+
+	bool deduplicate = deduplicateContent && contentHash.has_value();
+	if (deduplicate && CopyStagedTextureContent(toUploadTo, commandList,
+		source, *contentHash, uploadInfo, subresourceIndex))
+	{
+		return true;
+	}
+
 	size_t totalSize = AlignAdress(uploadInfo.width * uploadInfo.texelSizeInBytes,
 		D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
 	totalSize *= static_cast<size_t>(uploadInfo.height) * uploadInfo.depth;
 	size_t chunkIndex = uploadChunks.AllocateChunk(totalSize, allocationStrategy,
 		D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
 
-	if (chunkIndex == size_t(-1))
+	if (chunkIndex != size_t(-1))
+	{
+		CopyTextureRegionToResource(toUploadTo, commandList, data, uploadInfo,
+			subresourceIndex, chunkIndex);
+
+		if (deduplicate)
+		{
+			StagedContent staged;
+			staged.stagingOffset = AlignAdress(
+				uploadChunks.GetStartOfChunk(chunkIndex),
+				D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+			staged.dataSize = totalSize;
+			staged.isTexture = true;
+			staged.uploadInfo = uploadInfo;
+			stagedContent.insert({ *contentHash, staged });
+		}
+
+		return true;
+	}
+
+	// Data that fits the staging memory as a whole is retried once it is restored
+	if (totalSize <= totalMemory)
 		return false;
 
-	CopyTextureRegionToResource(toUploadTo, commandList, data, uploadInfo,
-		subresourceIndex, chunkIndex);
+	if (uploadInfo.depth > 1 && !TextureSlicesFit(uploadInfo))
+	{
+		return UploadTextureSlices(toUploadTo, commandList, source, uploadInfo,
+			subresourceIndex);
+	}
+
+	unsigned int uploadedBands = UploadTextureParts(toUploadTo, commandList,
+		source, uploadInfo, subresourceIndex);
+
+	if (uploadedBands == 0)
+		return false;
+
+	TextureUploadInfo remainingInfo = uploadInfo;
+	size_t uploadedSize = 0;
+
+	if (uploadInfo.depth == 1)
+	{
+		remainingInfo.height -= uploadedBands;
+		remainingInfo.offsetHeight += uploadedBands;
+		uploadedSize = GetSourceRowPitch(uploadInfo) * uploadedBands;
+	}
+	else
+	{
+		remainingInfo.depth -= uploadedBands;
+		remainingInfo.offsetDepth += uploadedBands;
+		uploadedSize = GetSourceSlicePitch(uploadInfo) * uploadedBands;
+	}
+
+	if (remainingInfo.height != 0 && remainingInfo.depth != 0)
+	{
+		QueueTextureUpload(toUploadTo, source + uploadedSize, remainingInfo,
+			subresourceIndex);
+	}
 
 	return true;
 }
 
+bool ResourceUploader::HasPendingUploads(ID3D12Resource* resource) const
+{
+	if (resource == nullptr)
+		return !pendingUploads.empty();
+
+	for (auto& pendingUpload : pendingUploads)
+	{
+		if (pendingUpload.destination == resource)
+			return true;
+	}
+
+	return false;
+}
+
+bool ResourceUploader::UploadPendingData(ID3D12GraphicsCommandList* commandList,
+	ID3D12Resource* resource)
+{
+	std::vector<ID3D12Resource*> blockedDestinations;
+
+	for (size_t i = 0; i < pendingUploads.size();)
+	{
+		PendingUpload& pendingUpload = pendingUploads[i];
+		bool skip = resource != nullptr && pendingUpload.destination != resource;
+		skip = skip || std::find(blockedDestinations.begin(),
+			blockedDestinations.end(), pendingUpload.destination) !=
+			blockedDestinations.end();
+
+		if (!skip && ContinuePendingUpload(pendingUpload, commandList))
+		{
+			pendingUploads.erase(pendingUploads.begin() + i);
+			continue;
+		}
+		else if (!skip)
+		{
+			// Later data for the same destination must wait for this one
+			blockedDestinations.push_back(pendingUpload.destination);
+		}
+
+		++i;
+	}
+
+	return !HasPendingUploads(resource);
+}
+
+void ResourceUploader::DiscardPendingUploads(ID3D12Resource* resource)
+{
+	pendingUploads.erase(std::remove_if(pendingUploads.begin(),
+		pendingUploads.end(), [resource](const PendingUpload& pendingUpload)
+		{
+			return resource == nullptr || pendingUpload.destination == resource;
+		}), pendingUploads.end());
+}
+
 void ResourceUploader::RestoreUsedMemory()
 {
 	uploadChunks.ClearHeap();
+	stagedContent.clear();
+}
+
+void ResourceUploader::SetContentDeduplication(bool enabled)
+{
+	deduplicateContent = enabled;
+
+	if (!enabled)
+		stagedContent.clear();
+}
+
+bool ResourceUploader::ContentDeduplicationEnabled() const
+{
+	return deduplicateContent;
+}
+
+const UploadStatistics& ResourceUploader::GetStatistics() const
+{
+	return statistics;
+}
+
+float ResourceUploader::GetDeduplicationHitRate() const
+{
+	if (statistics.deduplicationLookups == 0)
+		return 0.0f;
+
+	return static_cast<float>(statistics.deduplicationHits) /
+		statistics.deduplicationLookups;
+}
+
+void ResourceUploader::ResetStatistics()
+{
+	statistics = UploadStatistics();
 }
@@ -4,9 +4,13 @@
 #include <dxgi1_6.h>
 #include <vector>
 #include <utility>
+#include <optional>
+#include <cstdint>
+#include <unordered_map>
 
 #include "D3DPtr.h"
 #include "HeapHelper.h"
+#include "PixelConversion.h"
 
 struct TextureUploadInfo
 {
@@ -20,6 +24,17 @@ struct TextureUploadInfo
 	unsigned int offsetDepth = 0;
 
 	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+
+	SourceFormat sourceFormat = SourceFormat::SAME_AS_DESTINATION; // Converted while staging
+	size_t sourceRowPitch = 0; // 0 if the source rows are tightly packed
+	size_t sourceSlicePitch = 0; // 0 if the source slices are tightly packed
+};
+
+struct UploadStatistics
+{
+	size_t deduplicationLookups = 0;
+	size_t deduplicationHits = 0;
+	size_t bytesSaved = 0;
 };
 
 class ResourceUploader
@@ -37,24 +52,74 @@ private:
 		// EMPTY
 	};
 
+	struct PendingUpload
+	{
+		ID3D12Resource* destination = nullptr;
+		std::vector<unsigned char> data;
+		size_t processedBytes = 0;
+
+		bool isTexture = false;
+		size_t offsetFromStart = 0;
+		size_t alignment = 1;
+		TextureUploadInfo uploadInfo;
+		unsigned int subresourceIndex = 0;
+	};
+
+	struct StagedContent
+	{
+		size_t stagingOffset = 0;
+		size_t dataSize = 0;
+		bool isTexture = false;
+		TextureUploadInfo uploadInfo;
+	};
+
 	HeapHelper<UploadChunk> uploadChunks;
+	std::vector<PendingUpload> pendingUploads;
+
+	// Content staged since the last restore, by the hash of its source data
+	bool deduplicateContent = false;
+	std::unordered_multimap<std::uint64_t, StagedContent> stagedContent;
+	UploadStatistics statistics;
 
 	void AllocateBuffer(ID3D12Heap* heap, size_t heapOffset);
 	void AllocateBuffer();
 
-	size_t AlignAdress(size_t dataSize, size_t alignment);
+	size_t AlignAdress(size_t dataSize, size_t alignment) const;
 
 	void CopyBufferRegionToResource(ID3D12Resource* toUploadTo, 
-		ID3D12GraphicsCommandList* commandList, void* data, size_t offsetFromStart,
+		ID3D12GraphicsCommandList* commandList, const void* data, size_t offsetFromStart,
 		size_t dataSize, size_t alignment, size_t freeChunkIndex);
 
 	void MemcpyTextureData(unsigned char* destinationStart,
-		unsigned char* sourceStart, const TextureUploadInfo& uploadInfo);
+		const unsigned char* sourceStart, const TextureUploadInfo& uploadInfo);
 	void CopyTextureRegionToResource(ID3D12Resource* toUploadTo, 
-		ID3D12GraphicsCommandList* commandList, void* data,
+		ID3D12GraphicsCommandList* commandList, const void* data,
 		const TextureUploadInfo& uploadInfo, unsigned int subresourceIndex,
 		size_t freeChunkIndex);
 
+	void QueueBufferUpload(ID3D12Resource* toUploadTo, unsigned char* data,
+		size_t offsetFromStart, size_t dataSize, size_t alignment);
+	void QueueTextureUpload(ID3D12Resource* toUploadTo, unsigned char* data,
+		const TextureUploadInfo& uploadInfo, unsigned int subresourceIndex);
+	bool ContinuePendingUpload(PendingUpload& pendingUpload,
+		ID3D12GraphicsCommandList* commandList);
+	bool UploadTextureSlices(ID3D12Resource* toUploadTo,
+		ID3D12GraphicsCommandList* commandList, unsigned char* data,
+		const TextureUploadInfo& uploadInfo, unsigned int subresourceIndex);
+
+	// Equal hashes do not guarantee equal content, so staged data is compared before it is reused.
+	// Reading staging memory back is slow, but only happens when the hash matches
+	bool StagedTextureMatches(const StagedContent& staged, const unsigned char* data,
+		const TextureUploadInfo& uploadInfo);
+	bool CopyStagedBufferContent(ID3D12Resource* toUploadTo,
+		ID3D12GraphicsCommandList* commandList, const unsigned char* data,
+		std::uint64_t contentHash, size_t offsetFromStart, size_t dataSize,
+		size_t alignment);
+	bool CopyStagedTextureContent(ID3D12Resource* toUploadTo,
+		ID3D12GraphicsCommandList* commandList, const unsigned char* data,
+		std::uint64_t contentHash, const TextureUploadInfo& uploadInfo,
+		unsigned int subresourceIndex);
+
 public:
 	ResourceUploader() = default;
 	~ResourceUploader() = default;
@@ -69,14 +134,48 @@ public:
 	void Initialize(ID3D12Device* deviceToUse, size_t heapSize,
 		AllocationStrategy strategy);
 
+	// With deduplication enabled, data with a content hash that has already been
+	// staged since the last restore is copied from the existing staging memory
 	bool UploadBufferResourceData(ID3D12Resource* toUploadTo, 
 		ID3D12GraphicsCommandList* commandList, void* data,
-		size_t offsetFromStart, size_t dataSize, size_t alignment);
+		size_t offsetFromStart, size_t dataSize, size_t alignment,
+		std::optional<std::uint64_t> contentHash = std::nullopt);
 
 	bool UploadTextureResourceData(ID3D12Resource* toUploadTo,
 		ID3D12GraphicsCommandList* commandList, void* data,
 		const TextureUploadInfo& TextureUploadInfo, 
-		unsigned int subresourceIndex = 0);
+		unsigned int subresourceIndex = 0,
+		std::optional<std::uint64_t> contentHash = std::nullopt);
+
+	// Records as much as fits in the free staging memory without queueing the rest.
+	// Returns the number of bytes, or rows (slices if depth > 1), that were recorded.
+	// Content is only deduplicated if it is staged in one piece. Throws if a single
+	// row, or a slice if depth > 1, can never fit the staging memory
+	size_t UploadBufferParts(ID3D12Resource* toUploadTo,
+		ID3D12GraphicsCommandList* commandList, const unsigned char* data,
+		size_t offsetFromStart, size_t dataSize, size_t alignment,
+		std::optional<std::uint64_t> contentHash = std::nullopt);
+	unsigned int UploadTextureParts(ID3D12Resource* toUploadTo,
+		ID3D12GraphicsCommandList* commandList, const unsigned char* data,
+		const TextureUploadInfo& uploadInfo, unsigned int subresourceIndex,
+		std::optional<std::uint64_t> contentHash = std::nullopt);
+
+	// Slices that do not fit have to be uploaded one at a time, split on rows
+	bool TextureSlicesFit(const TextureUploadInfo& uploadInfo) const;
+
+	static size_t GetSourceRowSize(const TextureUploadInfo& uploadInfo);
+	static size_t GetSourceRowPitch(const TextureUploadInfo& uploadInfo);
+	static size_t GetSourceSlicePitch(const TextureUploadInfo& uploadInfo);
+	static size_t GetSourceSize(const TextureUploadInfo& uploadInfo);
+
+	// Uploads larger than the whole staging memory are split across what is free, and
+	// whatever does not fit is queued until UploadPendingData is called. Smaller uploads
+	// return false when they do not fit, and can be retried after RestoreUsedMemory.
+	// Pending data must be uploaded or discarded before its destination is released.
+	bool HasPendingUploads(ID3D12Resource* resource = nullptr) const;
+	bool UploadPendingData(ID3D12GraphicsCommandList* commandList,
+		ID3D12Resource* resource = nullptr);
+	void DiscardPendingUploads(ID3D12Resource* resource = nullptr);
 
 	//bool UploadResource(ID3D12Resource* toUploadTo,
 	//	ID3D12GraphicsCommandList* commandList, void* dataPtr, size_t dataSize,
@@ -84,4 +183,11 @@ public:
 	//	unsigned int zOffset = 0, unsigned int subresource = 0);
 
 	void RestoreUsedMemory();
+
+	void SetContentDeduplication(bool enabled);
+	bool ContentDeduplicationEnabled() const;
+
+	const UploadStatistics& GetStatistics() const;
+	float GetDeduplicationHitRate() const;
+	void ResetStatistics();
 };
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "RingAllocator.h"
+
+#include <stdexcept>
+
+size_t RingAllocator::AlignOffset(size_t offset, size_t alignment) const
+{
+	if ((0 == alignment) || (alignment & (alignment - 1)))
+		throw std::runtime_error("Error: non-pow2 alignment");
+
+	return ((offset + (alignment - 1)) & ~(alignment - 1));
+}
+
+size_t RingAllocator::GetAllocationSize(const Allocation& allocation) const
+{
+	return allocation.end > allocation.start ? allocation.end - allocation.start :
+		totalSize - allocation.start + allocation.end;
+}
+
+RingAllocator::RingAllocator(RingAllocator&& other) noexcept :
+	totalSize(other.totalSize), usedSize(other.usedSize), head(other.head),
+	firstAllocationId(other.firstAllocationId),
+	allocations(std::move(other.allocations))
+{
+	other.totalSize = 0;
+	other.usedSize = 0;
+	other.head = 0;
+	other.firstAllocationId = 0;
+}
+
+RingAllocator& RingAllocator::operator=(RingAllocator&& other) noexcept
+{
+	if (this != &other)
+	{
+		totalSize = other.totalSize;
+		usedSize = other.usedSize;
+		head = other.head;
+		firstAllocationId = other.firstAllocationId;
+		allocations = std::move(other.allocations);
+
+		other.totalSize = 0;
+		other.usedSize = 0;
+		other.head = 0;
+		other.firstAllocationId = 0;
+	}
+
+	return *this;
+}
+
+void RingAllocator::Initialize(size_t size)
+{
+	totalSize = size;
+	Clear();
+}
+
+std::optional<RingAllocation> RingAllocator::Allocate(size_t size,
+	size_t alignment)
+{
+	if (size == 0 || size > totalSize || usedSize == totalSize)
+		return std::nullopt;
+
+	Allocation toAdd;
+	toAdd.start = head;
+	size_t offset = AlignOffset(head, alignment);
+
+	if (allocations.empty())
+	{
+		offset = 0;
+		toAdd.start = 0;
+	}
+	else if (head > allocations.front().start)
+	{
+		// Memory after the head is free until the end, then until the tail
+		if (offset + size > totalSize)
+		{
+			offset = 0;
+			if (size > allocations.front().start)
+				return std::nullopt;
+		}
+	}
+	else if (offset + size > allocations.front().start)
+	{
+		return std::nullopt;
+	}
+
+	toAdd.end = offset + size;
+	usedSize += GetAllocationSize(toAdd);
+	head = toAdd.end;
+	allocations.push_back(toAdd);
+
+	RingAllocation toReturn;
+	toReturn.allocationId = firstAllocationId + allocations.size() - 1;
+	toReturn.offset = offset;
+	return toReturn;
+}
+
+void RingAllocator::Free(size_t allocationId)
+{
+	if (allocationId < firstAllocationId ||
+		allocationId - firstAllocationId >= allocations.size())
+	{
+		throw std::runtime_error("Ring allocation is not live");
+	}
+
+	allocations[allocationId - firstAllocationId].freed = true;
+
+	while (!allocations.empty() && allocations.front().freed)
+	{
+		usedSize -= GetAllocationSize(allocations.front());
+		allocations.pop_front();
+		++firstAllocationId;
+	}
+
+	if (allocations.empty())
+		head = 0;
+}
+
+void RingAllocator::Clear()
+{
+	firstAllocationId += allocations.size();
+	allocations.clear();
+	usedSize = 0;
+	head = 0;
+}
+
+size_t RingAllocator::GetTotalSize() const
+{
+	return totalSize;
+}
+
+size_t RingAllocator::GetUsedSize() const
+{
+	return usedSize;
+}
+
+bool RingAllocator::Empty() const
+{
+	return allocations.empty();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <cstddef>
+
+struct RingAllocation
+{
+	size_t allocationId = size_t(-1);
+	size_t offset = 0;
+};
+
+// Hands out memory in order and reclaims it in the same order,
+// so memory freed out of order is reused once everything before it is freed
+class RingAllocator
+{
+private:
+	struct Allocation
+	{
+		size_t start = 0; // Includes any padding skipped before the allocation
+		size_t end = 0;
+		bool freed = false;
+	};
+
+	size_t totalSize = 0;
+	size_t usedSize = 0;
+	size_t head = 0;
+	size_t firstAllocationId = 0;
+	std::deque<Allocation> allocations;
+
+	size_t AlignOffset(size_t offset, size_t alignment) const;
+	size_t GetAllocationSize(const Allocation& allocation) const;
+
+public:
+	RingAllocator() = default;
+	~RingAllocator() = default;
+	RingAllocator(const RingAllocator& other) = delete;
+	RingAllocator& operator=(const RingAllocator& other) = delete;
+	RingAllocator(RingAllocator&& other) noexcept;
+	RingAllocator& operator=(RingAllocator&& other) noexcept;
+
+	void Initialize(size_t size);
+
+	std::optional<RingAllocation> Allocate(size_t size, size_t alignment);
+	void Free(size_t allocationId);
+	void Clear();
+
+	size_t GetTotalSize() const;
+	size_t GetUsedSize() const;
+	bool Empty() const;
+};
\ No newline at end of file
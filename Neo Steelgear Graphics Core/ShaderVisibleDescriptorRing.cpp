@@ -0,0 +1,250 @@
+#include "ShaderVisibleDescriptorRing.h"
+
+#include <stdexcept>
+
+void ShaderVisibleDescriptorRing::RetireCompletedFrames()
+{
+	while (!submittedFrames.empty() &&
+		submittedFrames.front().completionValue <= completedValue)
+	{
+		usedDescriptors -= submittedFrames.front().nrOfDescriptors;
+		submittedFrames.pop_front();
+	}
+
+	if (usedDescriptors == 0)
+		head = 0; // Nothing left in flight, so the next frame can start without wrapping
+}
+
+ShaderVisibleDescriptorRing::~ShaderVisibleDescriptorRing()
+{
+	if (heapOwned && heap != nullptr)
+		heap->Release();
+}
+
+ShaderVisibleDescriptorRing::ShaderVisibleDescriptorRing(
+	ShaderVisibleDescriptorRing&& other) noexcept : heapOwned(other.heapOwned),
+	heap(other.heap), cpuStart(other.cpuStart), gpuStart(other.gpuStart),
+	descriptorSize(other.descriptorSize), totalDescriptors(other.totalDescriptors),
+	copyFunction(std::move(other.copyFunction)), head(other.head),
+	usedDescriptors(other.usedDescriptors),
+	currentFrameDescriptors(other.currentFrameDescriptors),
+	submittedFrames(std::move(other.submittedFrames)),
+	completedValue(other.completedValue),
+	pendingCopies(std::move(other.pendingCopies))
+{
+	other.heapOwned = false;
+	other.heap = nullptr;
+	other.totalDescriptors = 0;
+	other.head = 0;
+	other.usedDescriptors = 0;
+	other.currentFrameDescriptors = 0;
+	other.completedValue = 0;
+}
+
+ShaderVisibleDescriptorRing& ShaderVisibleDescriptorRing::operator=(
+	ShaderVisibleDescriptorRing&& other) noexcept
+{
+	if (this != &other)
+	{
+		if (heapOwned && heap != nullptr)
+			heap->Release();
+
+		heapOwned = other.heapOwned;
+		heap = other.heap;
+		cpuStart = other.cpuStart;
+		gpuStart = other.gpuStart;
+		descriptorSize = other.descriptorSize;
+		totalDescriptors = other.totalDescriptors;
+		copyFunction = std::move(other.copyFunction);
+		head = other.head;
+		usedDescriptors = other.usedDescriptors;
+		currentFrameDescriptors = other.currentFrameDescriptors;
+		submittedFrames = std::move(other.submittedFrames);
+		completedValue = other.completedValue;
+		pendingCopies = std::move(other.pendingCopies);
+
+		other.heapOwned = false;
+		other.heap = nullptr;
+		other.totalDescriptors = 0;
+		other.head = 0;
+		other.usedDescriptors = 0;
+		other.currentFrameDescriptors = 0;
+		other.completedValue = 0;
+	}
+
+	return *this;
+}
+
+void ShaderVisibleDescriptorRing::Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType,
+	ID3D12Device* device, size_t nrOfDescriptors)
+{
+	D3D12_DESCRIPTOR_HEAP_DESC desc;
+	desc.Type = descriptorType;
+	desc.NumDescriptors = static_cast<UINT>(nrOfDescriptors);
+	desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+	desc.NodeMask = 0;
+
+	ID3D12DescriptorHeap* createdHeap = nullptr;
+	HRESULT hr = device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&createdHeap));
+
+	if (FAILED(hr))
+		throw std::runtime_error("Error: Could not create shader visible descriptor heap");
+
+	Initialize(descriptorType, device, createdHeap, 0, nrOfDescriptors);
+	heapOwned = true;
+}
+
+void ShaderVisibleDescriptorRing::Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType,
+	ID3D12Device* device, ID3D12DescriptorHeap* shaderVisibleHeap, size_t startIndex,
+	size_t nrOfDescriptors)
+{
+	size_t sizeOfDescriptor = device->GetDescriptorHandleIncrementSize(descriptorType);
+	D3D12_CPU_DESCRIPTOR_HANDLE cpuHandleStart =
+		shaderVisibleHeap->GetCPUDescriptorHandleForHeapStart();
+	cpuHandleStart.ptr += sizeOfDescriptor * startIndex;
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuHandleStart =
+		shaderVisibleHeap->GetGPUDescriptorHandleForHeapStart();
+	gpuHandleStart.ptr += sizeOfDescriptor * startIndex;
+
+	Initialize(cpuHandleStart, gpuHandleStart, sizeOfDescriptor, nrOfDescriptors,
+		[device, descriptorType](UINT nrToCopy, D3D12_CPU_DESCRIPTOR_HANDLE destination,
+			D3D12_CPU_DESCRIPTOR_HANDLE source)
+		{
+			device->CopyDescriptorsSimple(nrToCopy, destination, source, descriptorType);
+		});
+	heap = shaderVisibleHeap;
+}
+
+void ShaderVisibleDescriptorRing::Initialize(D3D12_CPU_DESCRIPTOR_HANDLE cpuHandleStart,
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuHandleStart, size_t sizeOfDescriptor,
+	size_t nrOfDescriptors, const DescriptorCopyFunction& copyDescriptors)
+{
+	cpuStart = cpuHandleStart;
+	gpuStart = gpuHandleStart;
+	descriptorSize = sizeOfDescriptor;
+	totalDescriptors = nrOfDescriptors;
+	copyFunction = copyDescriptors;
+
+	head = 0;
+	usedDescriptors = 0;
+	currentFrameDescriptors = 0;
+	submittedFrames.clear();
+	completedValue = 0;
+	pendingCopies.clear();
+}
+
+std::optional<DescriptorRingAllocation> ShaderVisibleDescriptorRing::Allocate(
+	size_t nrOfDescriptors)
+{
+	if (nrOfDescriptors == 0 || nrOfDescriptors > totalDescriptors)
+		return std::nullopt;
+
+	// A table cannot wrap around, so the descriptors left at the end are skipped instead
+	size_t startIndex = head;
+	size_t skipped = 0;
+	if (head + nrOfDescriptors > totalDescriptors)
+	{
+		skipped = totalDescriptors - head;
+		startIndex = 0;
+	}
+
+	if (usedDescriptors + skipped + nrOfDescriptors > totalDescriptors)
+		return std::nullopt;
+
+	usedDescriptors += skipped + nrOfDescriptors;
+	currentFrameDescriptors += skipped + nrOfDescriptors;
+	head = (startIndex + nrOfDescriptors) % totalDescriptors;
+
+	DescriptorRingAllocation toReturn;
+	toReturn.startIndex = startIndex;
+	toReturn.nrOfDescriptors = nrOfDescriptors;
+	toReturn.cpuHandle = cpuStart;
+	toReturn.cpuHandle.ptr += descriptorSize * startIndex;
+	toReturn.gpuHandle = gpuStart;
+	toReturn.gpuHandle.ptr += descriptorSize * startIndex;
+	return toReturn;
+}
+
+void ShaderVisibleDescriptorRing::QueueCopy(const DescriptorRingAllocation& destination,
+	size_t offsetInAllocation, D3D12_CPU_DESCRIPTOR_HANDLE source,
+	size_t nrOfDescriptors)
+{
+	if (offsetInAllocation + nrOfDescriptors > destination.nrOfDescriptors)
+		throw std::runtime_error("Cannot copy descriptors outside of the ring allocation");
+
+	size_t destinationIndex = destination.startIndex + offsetInAllocation;
+
+	if (!pendingCopies.empty())
+	{
+		PendingCopy& previous = pendingCopies.back();
+		if (previous.destinationIndex + previous.nrOfDescriptors == destinationIndex &&
+			previous.source.ptr + previous.nrOfDescriptors * descriptorSize == source.ptr)
+		{
+			previous.nrOfDescriptors += nrOfDescriptors;
+			return;
+		}
+	}
+
+	PendingCopy toAdd;
+	toAdd.destinationIndex = destinationIndex;
+	toAdd.source = source;
+	toAdd.nrOfDescriptors = nrOfDescriptors;
+	pendingCopies.push_back(toAdd);
+}
+
+void ShaderVisibleDescriptorRing::FlushCopies()
+{
+	for (auto& copy : pendingCopies)
+	{
+		D3D12_CPU_DESCRIPTOR_HANDLE destination = cpuStart;
+		destination.ptr += descriptorSize * copy.destinationIndex;
+		copyFunction(static_cast<UINT>(copy.nrOfDescriptors), destination, copy.source);
+	}
+
+	pendingCopies.clear();
+}
+
+void ShaderVisibleDescriptorRing::SubmitFrame(std::uint64_t completionValue)
+{
+	if (currentFrameDescriptors != 0)
+	{
+		FrameRecord toAdd;
+		toAdd.nrOfDescriptors = currentFrameDescriptors;
+		toAdd.completionValue = completionValue;
+		submittedFrames.push_back(toAdd);
+		currentFrameDescriptors = 0;
+	}
+
+	RetireCompletedFrames();
+}
+
+void ShaderVisibleDescriptorRing::UpdateCompletedValue(std::uint64_t newCompletedValue)
+{
+	completedValue = newCompletedValue;
+	RetireCompletedFrames();
+}
+
+void ShaderVisibleDescriptorRing::UpdateCompletedValue(ID3D12Fence* fence)
+{
+	UpdateCompletedValue(fence->GetCompletedValue());
+}
+
+ID3D12DescriptorHeap* ShaderVisibleDescriptorRing::GetHeap() const
+{
+	return heap;
+}
+
+size_t ShaderVisibleDescriptorRing::GetTotalDescriptors() const
+{
+	return totalDescriptors;
+}
+
+size_t ShaderVisibleDescriptorRing::GetUsedDescriptors() const
+{
+	return usedDescriptors;
+}
+
+size_t ShaderVisibleDescriptorRing::GetNrOfPendingCopies() const
+{
+	return pendingCopies.size();
+}
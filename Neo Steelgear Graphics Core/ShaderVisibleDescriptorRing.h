@@ -0,0 +1,92 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <functional>
+
+#include <d3d12.h>
+
+struct DescriptorRingAllocation
+{
+	size_t startIndex = size_t(-1);
+	size_t nrOfDescriptors = 0;
+	D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = { 0 };
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = { 0 };
+};
+
+// Called with the number of descriptors, the destination and the source, like CopyDescriptorsSimple
+using DescriptorCopyFunction = std::function<void(UINT,
+	D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE)>;
+
+// Shader visible descriptors handed out linearly each frame,
+// and reclaimed once the frame or fence value they were submitted with has completed
+class ShaderVisibleDescriptorRing
+{
+private:
+	struct FrameRecord
+	{
+		size_t nrOfDescriptors = 0; // Includes descriptors skipped when wrapping around
+		std::uint64_t completionValue = 0;
+	};
+
+	struct PendingCopy
+	{
+		size_t destinationIndex = 0;
+		D3D12_CPU_DESCRIPTOR_HANDLE source = { 0 };
+		size_t nrOfDescriptors = 0;
+	};
+
+	bool heapOwned = false;
+	ID3D12DescriptorHeap* heap = nullptr;
+	D3D12_CPU_DESCRIPTOR_HANDLE cpuStart = { 0 };
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuStart = { 0 };
+	size_t descriptorSize = 0;
+	size_t totalDescriptors = 0;
+	DescriptorCopyFunction copyFunction;
+
+	size_t head = 0;
+	size_t usedDescriptors = 0;
+	size_t currentFrameDescriptors = 0;
+	std::deque<FrameRecord> submittedFrames;
+	std::uint64_t completedValue = 0;
+
+	std::vector<PendingCopy> pendingCopies;
+
+	void RetireCompletedFrames();
+
+public:
+	ShaderVisibleDescriptorRing() = default;
+	~ShaderVisibleDescriptorRing();
+	ShaderVisibleDescriptorRing(const ShaderVisibleDescriptorRing& other) = delete;
+	ShaderVisibleDescriptorRing& operator=(const ShaderVisibleDescriptorRing& other) = delete;
+	ShaderVisibleDescriptorRing(ShaderVisibleDescriptorRing&& other) noexcept;
+	ShaderVisibleDescriptorRing& operator=(ShaderVisibleDescriptorRing&& other) noexcept;
+
+	void Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType,
+		ID3D12Device* device, size_t nrOfDescriptors);
+	void Initialize(D3D12_DESCRIPTOR_HEAP_TYPE descriptorType, ID3D12Device* device,
+		ID3D12DescriptorHeap* shaderVisibleHeap, size_t startIndex, size_t nrOfDescriptors);
+	// Without a device, such as when the copies are recorded instead of performed
+	void Initialize(D3D12_CPU_DESCRIPTOR_HANDLE cpuHandleStart,
+		D3D12_GPU_DESCRIPTOR_HANDLE gpuHandleStart, size_t sizeOfDescriptor,
+		size_t nrOfDescriptors, const DescriptorCopyFunction& copyDescriptors);
+
+	std::optional<DescriptorRingAllocation> Allocate(size_t nrOfDescriptors);
+	// Copies that continue the previous one in both heaps are merged into a single copy
+	void QueueCopy(const DescriptorRingAllocation& destination,
+		size_t offsetInAllocation, D3D12_CPU_DESCRIPTOR_HANDLE source,
+		size_t nrOfDescriptors = 1);
+	void FlushCopies();
+
+	// Everything allocated since the last submit is reclaimed once the value has completed
+	void SubmitFrame(std::uint64_t completionValue);
+	void UpdateCompletedValue(std::uint64_t newCompletedValue);
+	void UpdateCompletedValue(ID3D12Fence* fence);
+
+	ID3D12DescriptorHeap* GetHeap() const;
+	size_t GetTotalDescriptors() const;
+	size_t GetUsedDescriptors() const;
+	size_t GetNrOfPendingCopies() const;
+};
\ No newline at end of file
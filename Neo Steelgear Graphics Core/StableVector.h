@@ -29,7 +29,10 @@ public:
 	size_t Add(T&& element);
 	size_t AddAt(const T& element, size_t index);
 	size_t AddAt(T&& element, size_t index);
+	void AddRange(const T& element, size_t startIndex, size_t count); // Indices must be free
+	void AddIndices(const T& element, const size_t* indices, size_t count); // Indices must be free and unique
 	void Remove(size_t index);
+	void RemoveIndices(const size_t* indices, size_t count); // Indices must be active and unique
 
 	T& operator[](size_t index);
 	const T& operator[](size_t index) const;
@@ -184,6 +187,65 @@ inline size_t StableVector<T>::AddAt(T&& element, size_t index)
 	return toReturn;
 }
 
+template<typename T>
+inline void StableVector<T>::AddRange(const T& element, size_t startIndex,
+	size_t count)
+{
+	size_t endIndex = startIndex + count;
+	Expand(endIndex);
+
+	// One pass over the free list unlinks the whole range
+	size_t* next = &firstFree;
+	while (*next != size_t(-1))
+	{
+		if (*next >= startIndex && *next < endIndex)
+			*next = elements[*next].nextFree;
+		else
+			next = &elements[*next].nextFree;
+	}
+
+	for (size_t i = startIndex; i < endIndex; ++i)
+	{
+		elements[i].active = true;
+		elements[i].nextFree = size_t(-1);
+		elements[i].data = element;
+	}
+
+	nrOfActive += count;
+}
+
+template<typename T>
+inline void StableVector<T>::AddIndices(const T& element, const size_t* indices,
+	size_t count)
+{
+	size_t endIndex = 0;
+	for (size_t i = 0; i < count; ++i)
+		endIndex = indices[i] + 1 > endIndex ? indices[i] + 1 : endIndex;
+
+	Expand(endIndex);
+
+	for (size_t i = 0; i < count; ++i)
+		elements[indices[i]].active = true;
+
+	// Marked first so that one pass over the free list unlinks every index
+	size_t* next = &firstFree;
+	while (*next != size_t(-1))
+	{
+		if (elements[*next].active)
+			*next = elements[*next].nextFree;
+		else
+			next = &elements[*next].nextFree;
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		elements[indices[i]].nextFree = size_t(-1);
+		elements[indices[i]].data = element;
+	}
+
+	nrOfActive += count;
+}
+
 template<typename T>
 inline void StableVector<T>::Remove(size_t index)
 {
@@ -193,6 +255,23 @@ inline void StableVector<T>::Remove(size_t index)
 	--nrOfActive;
 }
 
+template<typename T>
+inline void StableVector<T>::RemoveIndices(const size_t* indices, size_t count)
+{
+	if (count == 0)
+		return;
+
+	// Chained together first so that the free list is only relinked once
+	for (size_t i = 0; i < count; ++i)
+	{
+		elements[indices[i]].active = false;
+		elements[indices[i]].nextFree = i + 1 < count ? indices[i + 1] : firstFree;
+	}
+
+	firstFree = indices[0];
+	nrOfActive -= count;
+}
+
 template<typename T>
 inline T& StableVector<T>::operator[](size_t index)
 {
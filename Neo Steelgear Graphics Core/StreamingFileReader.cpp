@@ -0,0 +1,199 @@
+#include "StreamingFileReader.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+bool StreamingFileReader::ContinueBufferRegion(FileRegion& region,
+	ResourceUploader& uploader, ID3D12GraphicsCommandList* commandList)
+{
+	size_t uploadedSize = uploader.UploadBufferParts(region.destination,
+		commandList, region.file->GetData(region.fileOffset + region.processedBytes),
+		region.offsetFromStart + region.processedBytes,
+		region.totalSize - region.processedBytes, region.alignment);
+
+	region.processedBytes += uploadedSize;
+	streamedBytes += uploadedSize;
+
+	return region.processedBytes == region.totalSize;
+}
+
+bool StreamingFileReader::ContinueTextureRegion(FileRegion& region,
+	ResourceUploader& uploader, ID3D12GraphicsCommandList* commandList)
+{
+	TextureUploadInfo& uploadInfo = region.uploadInfo;
+	bool splitOnRows = uploadInfo.depth == 1;
+	size_t sourceBandSize = splitOnRows ?
+		ResourceUploader::GetSourceRowPitch(uploadInfo) :
+		ResourceUploader::GetSourceSlicePitch(uploadInfo);
+
+	unsigned int uploadedBands = uploader.UploadTextureParts(region.destination,
+		commandList, region.file->GetData(region.fileOffset + region.processedBytes),
+		uploadInfo, region.subresourceIndex);
+
+	if (splitOnRows)
+	{
+		uploadInfo.height -= uploadedBands;
+		uploadInfo.offsetHeight += uploadedBands;
+		streamedBytes += ResourceUploader::GetSourceRowSize(uploadInfo) *
+			uploadedBands;
+	}
+	else
+	{
+		uploadInfo.depth -= uploadedBands;
+		uploadInfo.offsetDepth += uploadedBands;
+		streamedBytes += ResourceUploader::GetSourceRowSize(uploadInfo) *
+			uploadInfo.height * uploadedBands;
+	}
+
+	region.processedBytes += sourceBandSize * uploadedBands;
+	if (uploadInfo.height == 0 || uploadInfo.depth == 0)
+		region.processedBytes = region.totalSize;
+
+	return region.processedBytes == region.totalSize;
+}
+
+void StreamingFileReader::SplitTextureSlices(size_t regionIndex)
+{
+	FileRegion sliceRegion = regions[regionIndex];
+	const TextureUploadInfo uploadInfo = sliceRegion.uploadInfo;
+	size_t sourceSlicePitch = ResourceUploader::GetSourceSlicePitch(uploadInfo);
+	size_t sliceOffset = sliceRegion.fileOffset + sliceRegion.processedBytes;
+
+	sliceRegion.processedBytes = 0;
+	sliceRegion.uploadInfo.depth = 1;
+	sliceRegion.uploadInfo.sourceSlicePitch = 0;
+	sliceRegion.totalSize = ResourceUploader::GetSourceSize(sliceRegion.uploadInfo);
+
+	std::vector<FileRegion> slices(uploadInfo.depth, sliceRegion);
+	for (unsigned int z = 0; z < uploadInfo.depth; ++z)
+	{
+		slices[z].fileOffset = sliceOffset + z * sourceSlicePitch;
+		slices[z].uploadInfo.offsetDepth = uploadInfo.offsetDepth + z;
+	}
+
+	regions[regionIndex] = slices.front();
+	regions.insert(regions.begin() + regionIndex + 1, slices.begin() + 1,
+		slices.end());
+}
+
+StreamingFileReader::StreamingFileReader(StreamingFileReader&& other) noexcept :
+	regions(std::move(other.regions)), streamedBytes(other.streamedBytes)
+{
+	other.streamedBytes = 0;
+}
+
+StreamingFileReader& StreamingFileReader::operator=(
+	StreamingFileReader&& other) noexcept
+{
+	if (this != &other)
+	{
+		regions = std::move(other.regions);
+		streamedBytes = other.streamedBytes;
+
+		other.streamedBytes = 0;
+	}
+
+	return *this;
+}
+
+void StreamingFileReader::AddBufferRegion(const MappedFile& file,
+	size_t fileOffset, size_t dataSize, ID3D12Resource* toUploadTo,
+	size_t offsetFromStart, size_t alignment)
+{
+	if (fileOffset + dataSize > file.GetSize())
+		throw std::runtime_error("Buffer region is outside of the mapped file");
+
+	FileRegion toAdd;
+	toAdd.file = &file;
+	toAdd.fileOffset = fileOffset;
+	toAdd.totalSize = dataSize;
+	toAdd.destination = toUploadTo;
+	toAdd.offsetFromStart = offsetFromStart;
+	toAdd.alignment = alignment;
+	regions.push_back(toAdd);
+}
+
+void StreamingFileReader::AddTextureRegion(const MappedFile& file,
+	size_t fileOffset, ID3D12Resource* toUploadTo,
+	const TextureUploadInfo& uploadInfo, unsigned int subresourceIndex)
+{
+	size_t dataSize = ResourceUploader::GetSourceSize(uploadInfo);
+	if (fileOffset + dataSize > file.GetSize())
+		throw std::runtime_error("Texture region is outside of the mapped file");
+
+	FileRegion toAdd;
+	toAdd.file = &file;
+	toAdd.fileOffset = fileOffset;
+	toAdd.totalSize = dataSize;
+	toAdd.destination = toUploadTo;
+	toAdd.isTexture = true;
+	toAdd.uploadInfo = uploadInfo;
+	toAdd.subresourceIndex = subresourceIndex;
+	regions.push_back(toAdd);
+}
+
+bool StreamingFileReader::StreamRegions(ResourceUploader& uploader,
+	ID3D12GraphicsCommandList* commandList)
+{
+	std::vector<ID3D12Resource*> blockedDestinations;
+
+	for (size_t i = 0; i < regions.size(); ++i)
+	{
+		// Slices that do not fit the staging memory are streamed on rows, one at a time
+		if (regions[i].isTexture && regions[i].uploadInfo.depth > 1 &&
+			!uploader.TextureSlicesFit(regions[i].uploadInfo))
+		{
+			SplitTextureSlices(i);
+		}
+
+		FileRegion& region = regions[i];
+		bool blocked = std::find(blockedDestinations.begin(),
+			blockedDestinations.end(), region.destination) !=
+			blockedDestinations.end();
+
+		// Data the uploader has queued for the destination has to be copied first
+		blocked = blocked || !uploader.UploadPendingData(commandList,
+			region.destination);
+
+		bool finished = !blocked && (region.isTexture ?
+			ContinueTextureRegion(region, uploader, commandList) :
+			ContinueBufferRegion(region, uploader, commandList));
+
+		// Later regions for the same destination have to wait for this one
+		if (!finished)
+			blockedDestinations.push_back(region.destination);
+	}
+
+	regions.erase(std::remove_if(regions.begin(), regions.end(),
+		[](const FileRegion& region)
+		{
+			return region.processedBytes == region.totalSize;
+		}), regions.end());
+
+	return regions.empty();
+}
+
+void StreamingFileReader::DiscardRegions(ID3D12Resource* resource)
+{
+	regions.erase(std::remove_if(regions.begin(), regions.end(),
+		[resource](const FileRegion& region)
+		{
+			return resource == nullptr || region.destination == resource;
+		}), regions.end());
+}
+
+bool StreamingFileReader::HasRegions(ID3D12Resource* resource) const
+{
+	for (auto& region : regions)
+	{
+		if (resource == nullptr || region.destination == resource)
+			return true;
+	}
+
+	return false;
+}
+
+size_t StreamingFileReader::GetStreamedBytes() const
+{
+	return streamedBytes;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+#include <d3d12.h>
+
+#include "MappedFile.h"
+#include "ResourceUploader.h"
+
+class StreamingFileReader
+{
+private:
+	struct FileRegion
+	{
+		const MappedFile* file = nullptr;
+		size_t fileOffset = 0;
+		size_t processedBytes = 0;
+		size_t totalSize = 0;
+		ID3D12Resource* destination = nullptr;
+
+		bool isTexture = false;
+		size_t offsetFromStart = 0;
+		size_t alignment = 1;
+		TextureUploadInfo uploadInfo;
+		unsigned int subresourceIndex = 0;
+	};
+
+	std::vector<FileRegion> regions;
+	size_t streamedBytes = 0;
+
+	bool ContinueBufferRegion(FileRegion& region, ResourceUploader& uploader,
+		ID3D12GraphicsCommandList* commandList);
+	bool ContinueTextureRegion(FileRegion& region, ResourceUploader& uploader,
+		ID3D12GraphicsCommandList* commandList);
+	void SplitTextureSlices(size_t regionIndex);
+
+public:
+	StreamingFileReader() = default;
+	~StreamingFileReader() = default;
+	StreamingFileReader(const StreamingFileReader& other) = delete;
+	StreamingFileReader& operator=(const StreamingFileReader& other) = delete;
+	StreamingFileReader(StreamingFileReader&& other) noexcept;
+	StreamingFileReader& operator=(StreamingFileReader&& other) noexcept;
+
+	// The file must stay open until its regions have been streamed or discarded
+	void AddBufferRegion(const MappedFile& file, size_t fileOffset,
+		size_t dataSize, ID3D12Resource* toUploadTo, size_t offsetFromStart,
+		size_t alignment);
+	void AddTextureRegion(const MappedFile& file, size_t fileOffset,
+		ID3D12Resource* toUploadTo, const TextureUploadInfo& uploadInfo,
+		unsigned int subresourceIndex = 0);
+
+	// Copies directly from the mapped file into as much free staging memory as there is.
+	// Returns true once every region has been recorded
+	bool StreamRegions(ResourceUploader& uploader,
+		ID3D12GraphicsCommandList* commandList);
+	void DiscardRegions(ID3D12Resource* resource = nullptr);
+
+	bool HasRegions(ID3D12Resource* resource = nullptr) const;
+	size_t GetStreamedBytes() const;
+};
\ No newline at end of file
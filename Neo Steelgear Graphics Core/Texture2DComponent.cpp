@@ -3,7 +3,7 @@
 D3D12_SHADER_RESOURCE_VIEW_DESC Texture2DComponent::CreateSRV(
 	const Texture2DShaderResourceDesc& desc, const TextureHandle& handle)
 {
-	D3D12_SHADER_RESOURCE_VIEW_DESC toReturn;
+	D3D12_SHADER_RESOURCE_VIEW_DESC toReturn = {};
 
 	toReturn.Format = desc.viewFormat == DXGI_FORMAT_UNKNOWN ? 
 		handle.resource->GetDesc().Format : desc.viewFormat;
@@ -52,7 +52,7 @@ D3D12_SHADER_RESOURCE_VIEW_DESC Texture2DComponent::CreateSRV(
 D3D12_UNORDERED_ACCESS_VIEW_DESC Texture2DComponent::CreateUAV(
 	const Texture2DUnorderedAccessDesc& desc, const TextureHandle& handle)
 {
-	D3D12_UNORDERED_ACCESS_VIEW_DESC toReturn;
+	D3D12_UNORDERED_ACCESS_VIEW_DESC toReturn = {};
 
 	toReturn.Format = desc.viewFormat == DXGI_FORMAT_UNKNOWN ?
 		handle.resource->GetDesc().Format : desc.viewFormat;
@@ -80,7 +80,7 @@ D3D12_UNORDERED_ACCESS_VIEW_DESC Texture2DComponent::CreateUAV(
 D3D12_RENDER_TARGET_VIEW_DESC Texture2DComponent::CreateRTV(
 	const Texture2DRenderTargetDesc& desc, const TextureHandle& handle)
 {
-	D3D12_RENDER_TARGET_VIEW_DESC toReturn;
+	D3D12_RENDER_TARGET_VIEW_DESC toReturn = {};
 
 	toReturn.Format = desc.viewFormat == DXGI_FORMAT_UNKNOWN ?
 		handle.resource->GetDesc().Format : desc.viewFormat;
@@ -108,7 +108,7 @@ D3D12_RENDER_TARGET_VIEW_DESC Texture2DComponent::CreateRTV(
 D3D12_DEPTH_STENCIL_VIEW_DESC Texture2DComponent::CreateDSV(
 	const Texture2DDepthStencilDesc& desc, const TextureHandle& handle)
 {
-	D3D12_DEPTH_STENCIL_VIEW_DESC toReturn;
+	D3D12_DEPTH_STENCIL_VIEW_DESC toReturn = {};
 
 	toReturn.Format = desc.viewFormat == DXGI_FORMAT_UNKNOWN ?
 		handle.resource->GetDesc().Format : desc.viewFormat;
@@ -142,7 +142,8 @@ bool Texture2DComponent::CreateViews(
 			srv.desc, handle);
 		resourceIndex.descriptorIndex = descriptorAllocators[srv.index].AllocateSRV(
 			handle.resource, &desc, resourceIndex.descriptorIndex);
-		if (resourceIndex.descriptorIndex == size_t(-1))
+		if (resourceIndex.descriptorIndex == size_t(-1) ||
+			!RegisterBindlessView(ViewType::SRV, srv.index, resourceIndex))
 		{
 			return false;
 		}
@@ -154,7 +155,8 @@ bool Texture2DComponent::CreateViews(
 			uav.desc, handle);
 		resourceIndex.descriptorIndex = descriptorAllocators[uav.index].AllocateUAV(
 			handle.resource, &desc, nullptr, resourceIndex.descriptorIndex);
-		if (resourceIndex.descriptorIndex == size_t(-1))
+		if (resourceIndex.descriptorIndex == size_t(-1) ||
+			!RegisterBindlessView(ViewType::UAV, uav.index, resourceIndex))
 		{
 			return false;
 		}
@@ -187,6 +189,124 @@ bool Texture2DComponent::CreateViews(
 	return true;
 }
 
+bool Texture2DComponent::CreateViews(
+	const Texture2DComponentTemplate::TextureReplacementViews& replacements,
+	const std::vector<TextureHandle>& handles, std::vector<ResourceIndex>& resourceIndices)
+{
+	size_t nrOfViews = handles.size();
+	std::vector<size_t> descriptorIndices(nrOfViews);
+	const size_t* placedIndices = nullptr; // Views after the first type use the same indices
+	std::vector<std::uint8_t> allocatedIn; // Allocators to roll back if a later type fails
+
+	if (srv.index != std::uint8_t(-1))
+	{
+		std::vector<D3D12_SHADER_RESOURCE_VIEW_DESC> descs(nrOfViews);
+		std::vector<DescriptorBatchView<D3D12_SHADER_RESOURCE_VIEW_DESC>> views(nrOfViews);
+		for (size_t i = 0; i < nrOfViews; ++i)
+		{
+			descs[i] = CreateSRV(replacements.sr != std::nullopt ? *replacements.sr :
+				srv.desc, handles[i]);
+			views[i].resource = handles[i].resource;
+			views[i].desc = &descs[i];
+		}
+
+		bool allocated = descriptorAllocators[srv.index].AllocateSRVs(views.data(),
+			nrOfViews, descriptorIndices.data(), placedIndices);
+		if (allocated)
+			allocatedIn.push_back(srv.index);
+
+		if (!allocated || !SetBatchDescriptorIndices(ViewType::SRV, srv.index,
+			descriptorIndices, resourceIndices))
+		{
+			DeallocateBatchDescriptors(allocatedIn, descriptorIndices);
+			return false;
+		}
+
+		placedIndices = descriptorIndices.data();
+	}
+
+	if (uav.index != std::uint8_t(-1))
+	{
+		std::vector<D3D12_UNORDERED_ACCESS_VIEW_DESC> descs(nrOfViews);
+		std::vector<DescriptorBatchView<D3D12_UNORDERED_ACCESS_VIEW_DESC>> views(nrOfViews);
+		for (size_t i = 0; i < nrOfViews; ++i)
+		{
+			descs[i] = CreateUAV(replacements.ua != std::nullopt ? *replacements.ua :
+				uav.desc, handles[i]);
+			views[i].resource = handles[i].resource;
+			views[i].desc = &descs[i];
+		}
+
+		bool allocated = descriptorAllocators[uav.index].AllocateUAVs(views.data(),
+			nrOfViews, descriptorIndices.data(), placedIndices);
+		if (allocated)
+			allocatedIn.push_back(uav.index);
+
+		if (!allocated || !SetBatchDescriptorIndices(ViewType::UAV, uav.index,
+			descriptorIndices, resourceIndices))
+		{
+			DeallocateBatchDescriptors(allocatedIn, descriptorIndices);
+			return false;
+		}
+
+		placedIndices = descriptorIndices.data();
+	}
+
+	if (rtv.index != std::uint8_t(-1))
+	{
+		std::vector<D3D12_RENDER_TARGET_VIEW_DESC> descs(nrOfViews);
+		std::vector<DescriptorBatchView<D3D12_RENDER_TARGET_VIEW_DESC>> views(nrOfViews);
+		for (size_t i = 0; i < nrOfViews; ++i)
+		{
+			descs[i] = CreateRTV(replacements.rt != std::nullopt ? *replacements.rt :
+				rtv.desc, handles[i]);
+			views[i].resource = handles[i].resource;
+			views[i].desc = &descs[i];
+		}
+
+		bool allocated = descriptorAllocators[rtv.index].AllocateRTVs(views.data(),
+			nrOfViews, descriptorIndices.data(), placedIndices);
+		if (allocated)
+			allocatedIn.push_back(rtv.index);
+
+		if (!allocated || !SetBatchDescriptorIndices(ViewType::RTV, rtv.index,
+			descriptorIndices, resourceIndices))
+		{
+			DeallocateBatchDescriptors(allocatedIn, descriptorIndices);
+			return false;
+		}
+
+		placedIndices = descriptorIndices.data();
+	}
+
+	if (dsv.index != std::uint8_t(-1))
+	{
+		std::vector<D3D12_DEPTH_STENCIL_VIEW_DESC> descs(nrOfViews);
+		std::vector<DescriptorBatchView<D3D12_DEPTH_STENCIL_VIEW_DESC>> views(nrOfViews);
+		for (size_t i = 0; i < nrOfViews; ++i)
+		{
+			descs[i] = CreateDSV(replacements.ds != std::nullopt ? *replacements.ds :
+				dsv.desc, handles[i]);
+			views[i].resource = handles[i].resource;
+			views[i].desc = &descs[i];
+		}
+
+		bool allocated = descriptorAllocators[dsv.index].AllocateDSVs(views.data(),
+			nrOfViews, descriptorIndices.data(), placedIndices);
+		if (allocated)
+			allocatedIn.push_back(dsv.index);
+
+		if (!allocated || !SetBatchDescriptorIndices(ViewType::DSV, dsv.index,
+			descriptorIndices, resourceIndices))
+		{
+			DeallocateBatchDescriptors(allocatedIn, descriptorIndices);
+			return false;
+		}
+	}
+
+	return true;
+}
+
 Texture2DComponent::Texture2DComponent(Texture2DComponent&& other) noexcept : 
 	TextureComponent(std::move(other))
 {
@@ -226,6 +346,7 @@ ResourceIndex Texture2DComponent::CreateTexture(size_t width, size_t height,
 	TextureHandle handle = textureAllocator.GetHandle(toReturn.allocatorIdentifier);
 	if (!CreateViews(replacementViews, handle, toReturn))
 	{
+		ReleaseBindlessViews(toReturn);
 		textureAllocator.DeallocateTexture(toReturn.allocatorIdentifier);
 		throw std::runtime_error("Cannot create views for texture2D resource");
 	}
@@ -233,6 +354,38 @@ ResourceIndex Texture2DComponent::CreateTexture(size_t width, size_t height,
 	return toReturn;
 }
 
+std::vector<ResourceIndex> Texture2DComponent::CreateTextures(
+	const std::vector<Texture2DCreationInfo>& textures,
+	const Texture2DComponentTemplate::TextureReplacementViews& replacementViews)
+{
+	std::vector<ResourceIndex> toReturn(textures.size());
+	std::vector<TextureHandle> handles(textures.size());
+
+	for (size_t i = 0; i < textures.size(); ++i)
+	{
+		const Texture2DCreationInfo& texture = textures[i];
+		TextureAllocationInfo allocationInfo(this->textureFormat, texelSize,
+			texture.width, texture.height, texture.arraySize, texture.mipLevels,
+			texture.sampleCount, texture.sampleQuality, texture.clearValue);
+
+		toReturn[i].allocatorIdentifier = textureAllocator.AllocateTexture(allocationInfo);
+		handles[i] = textureAllocator.GetHandle(toReturn[i].allocatorIdentifier);
+	}
+
+	if (!CreateViews(replacementViews, handles, toReturn))
+	{
+		for (auto& resourceIndex : toReturn)
+		{
+			ReleaseBindlessViews(resourceIndex);
+			textureAllocator.DeallocateTexture(resourceIndex.allocatorIdentifier);
+		}
+
+		throw std::runtime_error("Cannot create views for texture2D resources");
+	}
+
+	return toReturn;
+}
+
 D3D12_RESOURCE_STATES Texture2DComponent::GetCurrentState(
 	const ResourceIndex& resourceIndex)
 {
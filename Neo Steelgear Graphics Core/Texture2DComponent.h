@@ -51,6 +51,17 @@ struct Texture2DDepthStencilDesc
 	unsigned int arraySize = static_cast<unsigned int>(-1);
 };
 
+struct Texture2DCreationInfo
+{
+	size_t width = 0;
+	size_t height = 0;
+	size_t arraySize = 1;
+	size_t mipLevels = 1;
+	std::uint8_t sampleCount = 1;
+	std::uint8_t sampleQuality = 0;
+	D3D12_CLEAR_VALUE* clearValue = nullptr;
+};
+
 typedef TextureComponent<Texture2DShaderResourceDesc, Texture2DUnorderedAccessDesc,
 	Texture2DRenderTargetDesc, Texture2DDepthStencilDesc> Texture2DComponentTemplate;
 typedef Texture2DComponentTemplate::TextureViewDesc Texture2DViewDesc;
@@ -70,6 +81,10 @@ private:
 	bool CreateViews(
 		const Texture2DComponentTemplate::TextureReplacementViews& replacements,
 		const TextureHandle& handle, ResourceIndex& resourceIndex);
+	bool CreateViews(
+		const Texture2DComponentTemplate::TextureReplacementViews& replacements,
+		const std::vector<TextureHandle>& handles,
+		std::vector<ResourceIndex>& resourceIndices);
 	
 public:
 	Texture2DComponent() = default;
@@ -88,6 +103,10 @@ public:
 		const TextureComponent<Texture2DShaderResourceDesc, 
 		Texture2DUnorderedAccessDesc, Texture2DRenderTargetDesc, 
 		Texture2DDepthStencilDesc>::TextureReplacementViews& replacementViews = {});
+	// Creates the views of each type in one batch, meant for loading many textures at once
+	std::vector<ResourceIndex> CreateTextures(
+		const std::vector<Texture2DCreationInfo>& textures,
+		const Texture2DComponentTemplate::TextureReplacementViews& replacementViews = {});
 
 	D3D12_RESOURCE_STATES GetCurrentState(const ResourceIndex& resourceIndex);
 	D3D12_RESOURCE_BARRIER CreateTransitionBarrier(const ResourceIndex& resourceIndex,
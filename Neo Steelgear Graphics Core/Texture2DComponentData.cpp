@@ -1,26 +1,25 @@
 #include "Texture2DComponentData.h"
 
-void Texture2DComponentData::UpdateExistingSubresourceHeaders(
-	size_t indexOfOriginalChange, std::int16_t entryDifference)
+size_t Texture2DComponentData::AllocateSubresourceSlots(
+	std::uint8_t nrOfSubresources)
 {
-	for (size_t i = indexOfOriginalChange + 1; i < headers.size(); ++i)
-		headers[i].specifics.startSubresource += entryDifference;
+	if (subresourceSlots.GetCurrentMaxIndex() == 0)
+		subresourceSlots.Initialize(subresourceHeaders.size());
 
-	size_t originalEntryEnd =
-		headers[indexOfOriginalChange].specifics.startSubresource +
-		headers[indexOfOriginalChange].specifics.nrOfSubresources;
-	size_t totalEntriesToMove = subresourceHeaders.size() - originalEntryEnd;
+	size_t chunkIndex = subresourceSlots.AllocateChunk(nrOfSubresources,
+		AllocationStrategy::FIRST_FIT, 1);
 
-	if(entryDifference > 0)
-		subresourceHeaders.resize(subresourceHeaders.size() + entryDifference);
-
-	SubresourceHeader* destination = subresourceHeaders.data();
-	destination += headers[indexOfOriginalChange].specifics.startSubresource;
-	destination += headers[indexOfOriginalChange].specifics.nrOfSubresources;
-	SubresourceHeader* source = destination;
-	destination += entryDifference;
+	if (chunkIndex == static_cast<size_t>(-1))
+	{
+		size_t oldSize = subresourceHeaders.size();
+		subresourceHeaders.resize(oldSize * 2 > oldSize + nrOfSubresources ?
+			oldSize * 2 : oldSize + nrOfSubresources);
+		subresourceSlots.AddChunk(subresourceHeaders.size() - oldSize, true);
+		chunkIndex = subresourceSlots.AllocateChunk(nrOfSubresources,
+			AllocationStrategy::FIRST_FIT, 1);
+	}
 
-	std::memmove(destination, source, totalEntriesToMove * sizeof(SubresourceHeader));
+	return chunkIndex;
 }
 
 void Texture2DComponentData::SetSubresourceHeaders(size_t firstIndex,
@@ -40,6 +39,8 @@ void Texture2DComponentData::SetSubresourceHeaders(size_t firstIndex,
 		subresourceHeaders[firstIndex + i].startOffset = currentOffset;
 		subresourceHeaders[firstIndex + i].width = footprint.Footprint.Width;
 		subresourceHeaders[firstIndex + i].height = footprint.Footprint.Height;
+		subresourceHeaders[firstIndex + i].contentHashed = false;
+		subresourceHeaders[firstIndex + i].nrOfDirtyRegions = 0;
 		currentOffset += static_cast<size_t>(nrOfRows * rowSize);
 	}
 }
@@ -64,6 +65,134 @@ std::uint8_t Texture2DComponentData::CalculateSubresourceCount(
 	return static_cast<std::uint8_t>(planeCount * arrayCount * desc.MipLevels);
 }
 
+void Texture2DComponentData::AddDirtyRegion(SubresourceHeader& subresource,
+	const TextureRegion& region)
+{
+	auto getBounds = [](const TextureRegion& first, const TextureRegion& second)
+	{
+		TextureRegion toReturn;
+		toReturn.left = min(first.left, second.left);
+		toReturn.top = min(first.top, second.top);
+		toReturn.right = max(first.right, second.right);
+		toReturn.bottom = max(first.bottom, second.bottom);
+		return toReturn;
+	};
+
+	auto getArea = [](const TextureRegion& toCheck)
+	{
+		return static_cast<std::uint64_t>(toCheck.right - toCheck.left) *
+			(toCheck.bottom - toCheck.top);
+	};
+
+	TextureRegion toAdd = region;
+	bool merging = true;
+	while (merging)
+	{
+		// A merged region can overlap regions it did not overlap before
+		std::uint8_t mergeIndex = MAX_DIRTY_REGIONS;
+		for (std::uint8_t i = 0; i < subresource.nrOfDirtyRegions; ++i)
+		{
+			const TextureRegion& existing = subresource.dirtyRegions[i];
+			if (existing.left < toAdd.right && toAdd.left < existing.right &&
+				existing.top < toAdd.bottom && toAdd.top < existing.bottom)
+			{
+				mergeIndex = i;
+				break;
+			}
+		}
+
+		// Without room left the region that grows the least is merged
+		if (mergeIndex == MAX_DIRTY_REGIONS &&
+			subresource.nrOfDirtyRegions == MAX_DIRTY_REGIONS)
+		{
+			std::uint64_t smallestGrowth = std::uint64_t(-1);
+			for (std::uint8_t i = 0; i < subresource.nrOfDirtyRegions; ++i)
+			{
+				const TextureRegion& existing = subresource.dirtyRegions[i];
+				std::uint64_t growth = getArea(getBounds(existing, toAdd)) -
+					getArea(existing);
+
+				if (growth < smallestGrowth)
+				{
+					smallestGrowth = growth;
+					mergeIndex = i;
+				}
+			}
+		}
+
+		merging = mergeIndex != MAX_DIRTY_REGIONS;
+		if (merging)
+		{
+			toAdd = getBounds(subresource.dirtyRegions[mergeIndex], toAdd);
+			--subresource.nrOfDirtyRegions;
+			subresource.dirtyRegions[mergeIndex] =
+				subresource.dirtyRegions[subresource.nrOfDirtyRegions];
+		}
+	}
+
+	subresource.dirtyRegions[subresource.nrOfDirtyRegions] = toAdd;
+	++subresource.nrOfDirtyRegions;
+}
+
+void Texture2DComponentData::SetFullyDirty(SubresourceHeader& subresource)
+{
+	TextureRegion fullRegion;
+	fullRegion.right = subresource.width;
+	fullRegion.bottom = subresource.height;
+	subresource.dirtyRegions[0] = fullRegion;
+	subresource.nrOfDirtyRegions = 1;
+}
+
+TextureUploadInfo Texture2DComponentData::CreateRegionUploadInfo(
+	const SubresourceHeader& subresource, const TextureRegion& region,
+	std::uint8_t texelSize, DXGI_FORMAT textureFormat) const
+{
+	TextureUploadInfo toReturn;
+	toReturn.texelSizeInBytes = texelSize;
+	toReturn.format = textureFormat;
+	toReturn.width = region.right - region.left;
+	toReturn.height = region.bottom - region.top;
+	toReturn.depth = 1;
+	toReturn.offsetWidth = region.left;
+	toReturn.offsetHeight = region.top;
+	toReturn.sourceRowPitch = static_cast<size_t>(subresource.width) * texelSize;
+	return toReturn;
+}
+
+void Texture2DComponentData::GenerateSubresourceMips(DataHeader& header,
+	std::uint8_t texelSizeInBytes, DXGI_FORMAT textureFormat,
+	MipFilter mipFilter, std::uint8_t subresource)
+{
+	if (subresource % header.specifics.mipLevels != 0)
+		throw std::runtime_error("Mips can only be generated from the most detailed mip");
+
+	MipGenerator generator(textureFormat, mipFilter);
+	if (generator.GetTexelSize() != texelSizeInBytes)
+		throw std::runtime_error("Texel size does not match the texture format");
+
+	unsigned char* componentStart = data.data() + header.startOffset;
+	size_t firstSlot = header.specifics.startSubresource + subresource;
+	std::vector<MipLevel> levels;
+
+	for (std::uint16_t mip = 1; mip < header.specifics.mipLevels; ++mip)
+	{
+		SubresourceHeader& subresourceHeader = subresourceHeaders[firstSlot + mip];
+		MipLevel level;
+		level.data = componentStart + subresourceHeader.startOffset;
+		level.width = subresourceHeader.width;
+		level.height = subresourceHeader.height;
+		levels.push_back(level);
+
+		subresourceHeader.framesLeft = nrOfFrames;
+		subresourceHeader.contentHashed = false;
+		SetFullyDirty(subresourceHeader);
+	}
+
+	SubresourceHeader& mostDetailed = subresourceHeaders[firstSlot];
+	generator.GenerateMips(componentStart + mostDetailed.startOffset,
+		mostDetailed.width, mostDetailed.height, levels);
+}
+
 void Texture2DComponentData::Initialize(ID3D12Device* deviceToUse, 
 	FrameType totalNrOfFrames, UpdateType componentUpdateType,
 	unsigned int initialSize)
@@ -82,44 +211,40 @@ void Texture2DComponentData::AddComponent(const ResourceIndex& resourceIndex,
 	if (type == UpdateType::NONE)
 		return;
 
-	if (usedDataSize + dataSize > data.capacity())
-	{
-		data.reserve(usedDataSize + dataSize);
-		data.resize(usedDataSize + dataSize); // Resize so new data fits
-	}
-
 	std::uint8_t nrOfSubresources = CalculateSubresourceCount(resource);
-	if (type != UpdateType::INITIALISE_ONLY && resourceIndex.descriptorIndex < headers.size())
+	if (type != UpdateType::INITIALISE_ONLY)
 	{
-		std::int64_t sizeDifference = dataSize - headers[resourceIndex.descriptorIndex].dataSize;
-		UpdateExistingHeaders(resourceIndex.descriptorIndex, sizeDifference);
-		headers[resourceIndex.descriptorIndex].dataSize = dataSize;
-
-		std::int16_t entryDifference = static_cast<std::uint16_t>(
-			nrOfSubresources - headers[resourceIndex.descriptorIndex].specifics.nrOfSubresources);
-		UpdateExistingSubresourceHeaders(resourceIndex.descriptorIndex, entryDifference);
-		headers[resourceIndex.descriptorIndex].specifics.nrOfSubresources = nrOfSubresources;
-		headers[resourceIndex.descriptorIndex].specifics.needUpdating = false;
-		SetSubresourceHeaders(headers[resourceIndex.descriptorIndex].specifics.startSubresource,
+		if (headers.size() <= resourceIndex.descriptorIndex)
+			headers.resize(resourceIndex.descriptorIndex + 1);
+
+		RemoveComponent(resourceIndex); // Replacing a component frees its old slots first
+
+		DataHeader& header = headers[resourceIndex.descriptorIndex];
+		header.resourceIndex = resourceIndex;
+		AllocateDataSlot(header, dataSize);
+		header.specifics.subresourceChunk = AllocateSubresourceSlots(nrOfSubresources);
+		header.specifics.startSubresource =
+			subresourceSlots.GetStartOfChunk(header.specifics.subresourceChunk);
+		header.specifics.nrOfSubresources = nrOfSubresources;
+		header.specifics.mipLevels = resource->GetDesc().MipLevels;
+		SetSubresourceHeaders(header.specifics.startSubresource,
 			nrOfSubresources, resource);
 	}
 	else
 	{
+		// Uploaded components free their slots, so staging is reused instead of only growing
 		DataHeader toAdd;
-		toAdd.startOffset = headers.size() == 0 ? 0 :
-			headers.back().startOffset + headers.back().dataSize;
-		toAdd.dataSize = dataSize;
 		toAdd.resourceIndex = resourceIndex;
-		toAdd.specifics.startSubresource = subresourceHeaders.size();
+		AllocateDataSlot(toAdd, dataSize);
+		toAdd.specifics.subresourceChunk = AllocateSubresourceSlots(nrOfSubresources);
+		toAdd.specifics.startSubresource =
+			subresourceSlots.GetStartOfChunk(toAdd.specifics.subresourceChunk);
 		toAdd.specifics.nrOfSubresources = nrOfSubresources;
-		toAdd.specifics.needUpdating = false;
-		subresourceHeaders.resize(subresourceHeaders.size() + nrOfSubresources);
-		headers.push_back(toAdd);
+		toAdd.specifics.mipLevels = resource->GetDesc().MipLevels;
+		AddHeaderSlot(toAdd);
 		SetSubresourceHeaders(toAdd.specifics.startSubresource, nrOfSubresources,
 			resource);
 	}
-
-	usedDataSize += dataSize;
 }
 
 void Texture2DComponentData::RemoveComponent(const ResourceIndex& resourceIndex)
@@ -127,50 +252,25 @@ void Texture2DComponentData::RemoveComponent(const ResourceIndex& resourceIndex)
 	if (type == UpdateType::NONE)
 		return;
 
+	dirtyBits.Clear(resourceIndex.descriptorIndex);
+
 	if (type != UpdateType::INITIALISE_ONLY)
 	{
-		std::int16_t subresourceDifference = 
-			headers[resourceIndex.descriptorIndex].specifics.nrOfSubresources;
-		subresourceDifference = -subresourceDifference;
-		std::int64_t dataDifference = headers[resourceIndex.descriptorIndex].dataSize;
-		dataDifference = -dataDifference;
-		UpdateExistingSubresourceHeaders(resourceIndex.descriptorIndex, subresourceDifference);
-		UpdateExistingHeaders(resourceIndex.descriptorIndex, dataDifference);
-		headers[resourceIndex.descriptorIndex].specifics.nrOfSubresources = 0;
-		headers[resourceIndex.descriptorIndex].dataSize = 0;
-		usedDataSize = dataDifference >= 0 ?
-			usedDataSize + static_cast<size_t>(dataDifference) :
-			usedDataSize - static_cast<size_t>(-dataDifference);
+		DataHeader& header = headers[resourceIndex.descriptorIndex];
+		if (header.specifics.nrOfSubresources != 0)
+			subresourceSlots.DeallocateChunk(header.specifics.subresourceChunk);
+
+		FreeDataSlot(header);
+		header.specifics.nrOfSubresources = 0;
 	}
 	else
 	{
-		for (size_t i = 0; i < headers.size(); ++i)
+		DataHeader* header = FindHeader(resourceIndex);
+		if (header != nullptr)
 		{
-			if (headers[i].resourceIndex.descriptorIndex != resourceIndex.descriptorIndex)
-				continue;
-
-			std::int16_t subresourceDifference = 
-				headers[i].specifics.nrOfSubresources;
-			subresourceDifference = -subresourceDifference;
-			std::int64_t dataDifference = headers[i].dataSize;
-			dataDifference = -dataDifference;
-			UpdateExistingSubresourceHeaders(i, subresourceDifference);
-			UpdateExistingHeaders(i, dataDifference);
-			usedDataSize = dataDifference >= 0 ?
-				usedDataSize + static_cast<size_t>(dataDifference) :
-				usedDataSize - static_cast<size_t>(-dataDifference);
-
-			for (size_t removalCounter = 0;
-				removalCounter < headers[i].specifics.nrOfSubresources;
-				++removalCounter)
-			{
-				subresourceHeaders.pop_back();
-			}
-
-			size_t moveSize = sizeof(DataHeader) * (headers.size() - i - 1);
-			std::memmove(headers.data() + i, headers.data() + i + 1, moveSize);
-			headers.pop_back();
-			return;
+			subresourceSlots.DeallocateChunk(header->specifics.subresourceChunk);
+			FreeDataSlot(*header);
+			RemoveHeaderSlot(static_cast<size_t>(header - headers.data()));
 		}
 	}
 }
@@ -181,43 +281,87 @@ void Texture2DComponentData::UpdateComponentData(const ResourceIndex& resourceIn
 	if (type == UpdateType::NONE)
 		return;
 
-	if (type != UpdateType::INITIALISE_ONLY)
+	DataHeader* header = FindHeader(resourceIndex);
+	if (header == nullptr)
+		return;
+
+	size_t subresourceSlot = header->specifics.startSubresource;
+	subresourceSlot += subresource;
+	unsigned char* destination = data.data();
+	destination += header->startOffset;
+	destination += subresourceHeaders[subresourceSlot].startOffset;
+	size_t dataSize = subresourceHeaders[subresourceSlot].width *
+		subresourceHeaders[subresourceSlot].height * texelSizeInBytes;
+
+	std::memcpy(destination, dataPtr, dataSize);
+	subresourceHeaders[subresourceSlot].framesLeft = nrOfFrames;
+	subresourceHeaders[subresourceSlot].contentHashed = false;
+	SetFullyDirty(subresourceHeaders[subresourceSlot]);
+	dirtyBits.Mark(resourceIndex.descriptorIndex);
+	updateNeeded = true;
+}
+
+void Texture2DComponentData::UpdateComponentData(const ResourceIndex& resourceIndex,
+	void* dataPtr, std::uint8_t texelSizeInBytes, DXGI_FORMAT textureFormat,
+	MipFilter mipFilter, std::uint8_t subresource)
+{
+	if (type == UpdateType::NONE)
+		return;
+
+	UpdateComponentData(resourceIndex, dataPtr, texelSizeInBytes, subresource);
+
+	DataHeader* header = FindHeader(resourceIndex);
+	if (header != nullptr)
 	{
-		size_t subresourceSlot = headers[resourceIndex.descriptorIndex].specifics.startSubresource;
-		subresourceSlot += subresource;
-		unsigned char* destination = data.data();
-		destination += headers[resourceIndex.descriptorIndex].startOffset;
-		destination += subresourceHeaders[subresourceSlot].startOffset;
-		size_t dataSize = subresourceHeaders[subresourceSlot].width *
-			subresourceHeaders[subresourceSlot].height * texelSizeInBytes;
-
-		std::memcpy(destination, dataPtr, dataSize);
-		subresourceHeaders[subresourceSlot].framesLeft = nrOfFrames;
-		headers[resourceIndex.descriptorIndex].specifics.needUpdating = true;
-		updateNeeded = true;
+		GenerateSubresourceMips(*header, texelSizeInBytes, textureFormat,
+			mipFilter, subresource);
 	}
-	else
+}
+
+void Texture2DComponentData::UpdateComponentRegion(
+	const ResourceIndex& resourceIndex, void* dataPtr,
+	std::uint8_t texelSizeInBytes, const TextureRegion& region,
+	std::uint8_t subresource, size_t sourceRowPitch)
+{
+	if (type == UpdateType::NONE)
+		return;
+
+	DataHeader* header = FindHeader(resourceIndex);
+	if (header == nullptr)
+		return;
+
+	size_t subresourceSlot = header->specifics.startSubresource + subresource;
+	SubresourceHeader& subresourceHeader = subresourceHeaders[subresourceSlot];
+	if (region.left >= region.right || region.top >= region.bottom ||
+		region.right > subresourceHeader.width ||
+		region.bottom > subresourceHeader.height)
 	{
-		for (auto& header : headers)
-		{
-			if (header.resourceIndex.descriptorIndex != resourceIndex.descriptorIndex)
-				continue;
+		throw std::runtime_error("Texture region is outside of the subresource");
+	}
 
-			size_t subresourceSlot = header.specifics.startSubresource;
-			subresourceSlot += subresource;
-			unsigned char* destination = data.data();
-			destination += header.startOffset;
-			destination += subresourceHeaders[subresourceSlot].startOffset;
-			size_t dataSize = subresourceHeaders[subresourceSlot].width *
-				subresourceHeaders[subresourceSlot].height * texelSizeInBytes;
-
-			std::memcpy(destination, dataPtr, dataSize);
-			subresourceHeaders[subresourceSlot].framesLeft = nrOfFrames;
-			header.specifics.needUpdating = true;
-			updateNeeded = true;
-			break;
-		}
+	size_t regionRowSize = static_cast<size_t>(region.right - region.left) *
+		texelSizeInBytes;
+	size_t destinationRowPitch = static_cast<size_t>(subresourceHeader.width) *
+		texelSizeInBytes;
+	sourceRowPitch = sourceRowPitch != 0 ? sourceRowPitch : regionRowSize;
+
+	unsigned char* destination = data.data();
+	destination += header->startOffset + subresourceHeader.startOffset;
+	destination += region.top * destinationRowPitch + region.left * texelSizeInBytes;
+	const unsigned char* source = static_cast<const unsigned char*>(dataPtr);
+
+	for (unsigned int y = region.top; y < region.bottom; ++y)
+	{
+		std::memcpy(destination, source, regionRowSize);
+		destination += destinationRowPitch;
+		source += sourceRowPitch;
 	}
+
+	AddDirtyRegion(subresourceHeader, region);
+	subresourceHeader.framesLeft = nrOfFrames;
+	subresourceHeader.contentHashed = false;
+	dirtyBits.Mark(resourceIndex.descriptorIndex);
+	updateNeeded = true;
 }
 
 void Texture2DComponentData::PrepareUpdates(
@@ -227,17 +371,32 @@ void Texture2DComponentData::PrepareUpdates(
 	if (this->updateNeeded == false || type == UpdateType::MAP_UPDATE)
 		return;
 
-	for (auto& header : headers)
+	dirtyIndices.clear();
+	dirtyBits.GetCurrentFrame(dirtyIndices);
+
+	for (size_t descriptorIndex : dirtyIndices)
 	{
-		if (header.specifics.needUpdating)
-		{
-			D3D12_RESOURCE_BARRIER barrier =
-				componentToUpdate.CreateTransitionBarrier(header.resourceIndex,
-					D3D12_RESOURCE_STATE_COPY_DEST);
+		D3D12_RESOURCE_BARRIER barrier =
+			componentToUpdate.CreateTransitionBarrier(
+				FindHeader(descriptorIndex)->resourceIndex,
+				D3D12_RESOURCE_STATE_COPY_DEST);
 
-			if (barrier.Transition.StateBefore != barrier.Transition.StateAfter)
-				barriers.push_back(barrier);
-		}
+		if (barrier.Transition.StateBefore != barrier.Transition.StateAfter)
+			barriers.push_back(barrier);
+	}
+
+	// Uploads left over in the scheduler continue once the frame of their texture returns
+	for (const ScheduledResource& scheduled : scheduledResources)
+	{
+		if (!ScheduledResourceResumes(scheduled))
+			continue;
+
+		D3D12_RESOURCE_BARRIER barrier =
+			componentToUpdate.CreateTransitionBarrier(scheduled.resourceIndex,
+				D3D12_RESOURCE_STATE_COPY_DEST);
+
+		if (barrier.Transition.StateBefore != barrier.Transition.StateAfter)
+			barriers.push_back(barrier);
 	}
 }
 
@@ -245,69 +404,85 @@ void Texture2DComponentData::UpdateComponentResources(
 	ID3D12GraphicsCommandList* commandList, ResourceUploader& uploader,
 	Texture2DComponent& componentToUpdate, std::uint8_t texelSize,
 	DXGI_FORMAT textureFormat)
+{
+	directScheduler.Initialize(&uploader, 0);
+	UpdateComponentResources(directScheduler, UploadPriority::CRITICAL,
+		componentToUpdate, texelSize, textureFormat);
+	directScheduler.ExecuteUploads(commandList);
+}
+
+void Texture2DComponentData::UpdateComponentResources(
+	UploadScheduler& scheduler, UploadPriority priority,
+	Texture2DComponent& componentToUpdate, std::uint8_t texelSize,
+	DXGI_FORMAT textureFormat)
 {
 	if (updateNeeded == false)
 		return;
 
 	updateNeeded = false;
+	UpdateScheduledResources(scheduler);
+	dirtyIndices.clear();
+	dirtyBits.TakeCurrentFrame(dirtyIndices);
 
-	for (size_t i = 0; i < headers.size(); ++i)
+	for (size_t descriptorIndex : dirtyIndices)
 	{
-		if (headers[i].specifics.needUpdating == false)
-			continue;
-
-		headers[i].specifics.needUpdating = false;
-		auto handle = componentToUpdate.GetTextureHandle(headers[i].resourceIndex);
+		DataHeader& header = *FindHeader(descriptorIndex);
+		auto handle = componentToUpdate.GetTextureHandle(header.resourceIndex);
 
-		for (unsigned int j = 0; j < headers[i].specifics.nrOfSubresources; ++j)
+		for (unsigned int j = 0; j < header.specifics.nrOfSubresources; ++j)
 		{
-			size_t subresourceIndex = headers[i].specifics.startSubresource + j;
+			size_t subresourceIndex = header.specifics.startSubresource + j;
 			SubresourceHeader& subresource = subresourceHeaders[subresourceIndex];
 
 			if (subresource.framesLeft == 0)
-			{
 				continue;
-			}
 			else if (subresource.framesLeft > 1)
-			{
-				updateNeeded = true; // At least one update left for next frame
-				headers[i].specifics.needUpdating = true;
-			}
+				dirtyBits.MarkNextFrame(descriptorIndex); // At least one update left for next frame
 
 			unsigned char* source = data.data();
-			source += headers[i].startOffset + subresource.startOffset;
-
-			TextureUploadInfo uploadInfo;
-			uploadInfo.texelSizeInBytes = texelSize;
-			uploadInfo.format = textureFormat;
-			uploadInfo.width = subresource.width;
-			uploadInfo.height = subresource.height;
-			uploadInfo.depth = 1;
-			bool result = uploader.UploadTextureResourceData(handle.resource, commandList,
-				source, uploadInfo, j);
-
-			if (result == false && type == UpdateType::COPY_UPDATE)
-			{
-				updateNeeded = true;
-				headers[i].specifics.needUpdating = true;
-				throw std::runtime_error("Could not update data for texture2D component");
-			}
-			else if (result == false && type == UpdateType::INITIALISE_ONLY)
+			source += header.startOffset + subresource.startOffset;
+
+			for (std::uint8_t k = 0; k < subresource.nrOfDirtyRegions; ++k)
 			{
-				updateNeeded = true;
-				headers[i].specifics.needUpdating = true;
-				subresource.framesLeft += nrOfFrames;
+				const TextureRegion& region = subresource.dirtyRegions[k];
+				TextureUploadInfo uploadInfo = CreateRegionUploadInfo(subresource,
+					region, texelSize, textureFormat);
+				unsigned char* regionSource = source + (static_cast<size_t>(region.top) *
+					subresource.width + region.left) * texelSize;
+
+				// Only whole subresources are worth hashing
+				std::optional<std::uint64_t> contentHash;
+				if (type == UpdateType::INITIALISE_ONLY &&
+					scheduler.ContentDeduplicationEnabled() &&
+					uploadInfo.width == subresource.width &&
+					uploadInfo.height == subresource.height)
+				{
+					if (!subresource.contentHashed)
+					{
+						subresource.contentHash = HashContent(source,
+							static_cast<size_t>(uploadInfo.width) * uploadInfo.height * texelSize);
+						subresource.contentHashed = true;
+					}
+
+					contentHash = subresource.contentHash;
+				}
+
+				scheduler.ScheduleTextureUpload(handle.resource, regionSource,
+					uploadInfo, j, priority, contentHash);
 			}
 
+			AddScheduledResource(handle.resource, header.resourceIndex);
+
 			--subresource.framesLeft;
+			if (subresource.framesLeft == 0)
+				subresource.nrOfDirtyRegions = 0;
 		}
 
-		// If INITIALISE_ONLY is used and all frames are updated then we are finished with this one
-		if (type == UpdateType::INITIALISE_ONLY && !headers[i].specifics.needUpdating)
-		{
-			RemoveComponent(headers[i].resourceIndex);
-			--i;
-		}
+		// The scheduler has its own copy, so once every frame is updated we are finished with this one
+		if (type == UpdateType::INITIALISE_ONLY && !dirtyBits.Marked(descriptorIndex))
+			RemoveComponent(header.resourceIndex);
 	}
-}
 
+	dirtyBits.AdvanceFrame();
+	updateNeeded = !dirtyBits.Empty() || !scheduledResources.empty();
+}
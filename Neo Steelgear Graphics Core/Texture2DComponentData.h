@@ -8,36 +8,63 @@
 #include "ComponentData.h"
 #include "Texture2DComponent.h"
 #include "ResourceUploader.h"
+#include "UploadScheduler.h"
+#include "ContentHash.h"
+#include "MipGeneration.h"
 #include "FrameBased.h"
 
 struct Texture2DSpecific
 {
 	size_t startSubresource;
+	size_t subresourceChunk; // Chunk in subresourceSlots
 	std::uint8_t nrOfSubresources;
-	bool needUpdating;
+	std::uint16_t mipLevels;
+};
+
+struct TextureRegion
+{
+	unsigned int left = 0;
+	unsigned int top = 0;
+	unsigned int right = 0; // Exclusive
+	unsigned int bottom = 0; // Exclusive
 };
 
 class Texture2DComponentData : public ComponentData<Texture2DSpecific>
 {
 private:
+	static const std::uint8_t MAX_DIRTY_REGIONS = 8;
+
 	struct SubresourceHeader
 	{
 		FrameType framesLeft;
 		size_t startOffset;
 		unsigned int width;
 		unsigned int height;
+		bool contentHashed; // Hashed once per update, and only if the uploader deduplicates
+		std::uint64_t contentHash;
+		std::uint8_t nrOfDirtyRegions; // Kept until every frame has been updated
+		TextureRegion dirtyRegions[MAX_DIRTY_REGIONS];
 	};
 
 	std::vector<SubresourceHeader> subresourceHeaders;
+	HeapHelper<size_t> subresourceSlots;
 
-	void UpdateExistingSubresourceHeaders(size_t indexOfOriginalChange,
-		std::int16_t entryDifference);
+	size_t AllocateSubresourceSlots(std::uint8_t nrOfSubresources);
 
 	void SetSubresourceHeaders(size_t firstIndex, std::uint8_t nrOfSubresources,
 		ID3D12Resource* resource);
 
 	std::uint8_t CalculateSubresourceCount(ID3D12Resource* resource);
 
+	void AddDirtyRegion(SubresourceHeader& subresource, const TextureRegion& region);
+	void SetFullyDirty(SubresourceHeader& subresource);
+	TextureUploadInfo CreateRegionUploadInfo(const SubresourceHeader& subresource,
+		const TextureRegion& region, std::uint8_t texelSize,
+		DXGI_FORMAT textureFormat) const;
+
+	void GenerateSubresourceMips(DataHeader& header, std::uint8_t texelSizeInBytes,
+		DXGI_FORMAT textureFormat, MipFilter mipFilter, std::uint8_t subresource);
+
 public:
 	Texture2DComponentData() = default;
 	~Texture2DComponentData() = default;
@@ -54,10 +81,23 @@ public:
 	void RemoveComponent(const ResourceIndex& resourceIndex) override;
 	void UpdateComponentData(const ResourceIndex& resourceIndex, void* dataPtr,
 		std::uint8_t texelSizeInBytes, std::uint8_t subresource = 0);
+	// Only the most detailed mip is passed, the rest of the chain is generated
+	void UpdateComponentData(const ResourceIndex& resourceIndex, void* dataPtr,
+		std::uint8_t texelSizeInBytes, DXGI_FORMAT textureFormat,
+		MipFilter mipFilter, std::uint8_t subresource = 0);
+	// The data only covers the region, with its rows sourceRowPitch bytes apart (0 if tightly packed)
+	void UpdateComponentRegion(const ResourceIndex& resourceIndex, void* dataPtr,
+		std::uint8_t texelSizeInBytes, const TextureRegion& region,
+		std::uint8_t subresource = 0, size_t sourceRowPitch = 0);
 
 	void PrepareUpdates(std::vector<D3D12_RESOURCE_BARRIER>& barriers,
 		Texture2DComponent& componentToUpdate);
+	// Uploads are scheduled as critical and recorded right away. What does not fit in
+	// the uploader continues in later calls, and a component should not mix both overloads
 	void UpdateComponentResources(ID3D12GraphicsCommandList* commandList,
 		ResourceUploader& uploader, Texture2DComponent& componentToUpdate,
 		std::uint8_t texelSize, DXGI_FORMAT textureFormat);
+	void UpdateComponentResources(UploadScheduler& scheduler,
+		UploadPriority priority, Texture2DComponent& componentToUpdate,
+		std::uint8_t texelSize, DXGI_FORMAT textureFormat);
 };
\ No newline at end of file
@@ -25,18 +25,22 @@ D3D12_RESOURCE_DESC TextureAllocator::CreateTextureDesc(
 ResourceIdentifier TextureAllocator::GetAvailableHeapIndex(D3D12_RESOURCE_ALLOCATION_INFO allocationInfo)
 {
 	ResourceIdentifier toReturn;
+	size_t dataSize = static_cast<size_t>(allocationInfo.SizeInBytes);
+	size_t alignment = static_cast<size_t>(allocationInfo.Alignment);
+	size_t chunkIndex = freeBlocks.FindChunk(dataSize);
 
-	for (size_t i = 0; i < memoryChunks.size(); ++i)
+	while (chunkIndex != size_t(-1))
 	{
-		toReturn.internalIndex = memoryChunks[i].textures.AllocateChunk(
-			static_cast<size_t>(allocationInfo.SizeInBytes),
-			AllocationStrategy::FIRST_FIT, static_cast<size_t>(allocationInfo.Alignment));
+		toReturn.internalIndex = memoryChunks[chunkIndex].textures.AllocateChunk(
+			dataSize, AllocationStrategy::FIRST_FIT, alignment);
 	
 		if (toReturn.internalIndex != size_t(-1))
 		{
-			toReturn.heapChunkIndex = i;
+			toReturn.heapChunkIndex = chunkIndex;
 			break;
 		}
+
+		chunkIndex = freeBlocks.FindChunk(dataSize, chunkIndex + 1); // Alignment did not fit
 	}
 
 	if (toReturn.heapChunkIndex == size_t(-1)) // No fit in existing chunks, need to expand
@@ -51,24 +55,58 @@ ResourceIdentifier TextureAllocator::GetAvailableHeapIndex(D3D12_RESOURCE_ALLOCA
 		size_t heapSize = newChunk.heapChunk.endOffset -
 			newChunk.heapChunk.startOffset;
 		newChunk.textures.Initialize(heapSize, newChunk.heapChunk.startOffset);
-		memoryChunks.push_back(std::move(newChunk));
 
-		toReturn.internalIndex = memoryChunks.back().textures.AllocateChunk(
-			static_cast<size_t>(allocationInfo.SizeInBytes),
-			AllocationStrategy::FIRST_FIT, static_cast<size_t>(allocationInfo.Alignment));
-		toReturn.heapChunkIndex = memoryChunks.size() - 1;
+		toReturn.heapChunkIndex = memoryChunks.size();
+		if (!releasedChunks.empty())
+		{
+			toReturn.heapChunkIndex = releasedChunks.back();
+			releasedChunks.pop_back();
+			memoryChunks[toReturn.heapChunkIndex] = std::move(newChunk);
+			freeBlocks.UpdateChunk(toReturn.heapChunkIndex, heapSize);
+		}
+		else
+		{
+			memoryChunks.push_back(std::move(newChunk));
+			freeBlocks.AddChunk(heapSize);
+		}
+
+		toReturn.internalIndex = memoryChunks[toReturn.heapChunkIndex].textures.AllocateChunk(
+			dataSize, AllocationStrategy::FIRST_FIT, alignment);
 
 		if (toReturn.internalIndex == size_t(-1))
 			throw std::runtime_error("Failed to expand memory in texture allocator");
 	}
 
+	memoryChunks[toReturn.heapChunkIndex].emptyTrims = 0;
+	UpdateFreeBlock(toReturn.heapChunkIndex);
 	return toReturn;
 }
 
+void TextureAllocator::UpdateFreeBlock(size_t chunkIndex)
+{
+	freeBlocks.UpdateChunk(chunkIndex,
+		memoryChunks[chunkIndex].textures.GetLargestFreeChunkSize());
+}
+
+void TextureAllocator::ReleaseChunk(size_t chunkIndex)
+{
+	MemoryChunk& memoryChunk = memoryChunks[chunkIndex];
+	memoryChunk.textures = HeapHelper<TextureEntry>();
+	memoryChunk.emptyTrims = 0;
+	heapAllocator->DeallocateChunk(memoryChunk.heapChunk);
+	memoryChunk.heapChunk = HeapChunk(); // Marks the chunk as released
+
+	freeBlocks.UpdateChunk(chunkIndex, 0);
+	releasedChunks.push_back(chunkIndex);
+}
+
 TextureAllocator::~TextureAllocator()
 {
 	for (auto& memoryChunk : memoryChunks)
 	{
+		if (memoryChunk.heapChunk.heap == nullptr)
+			continue; // Already released
+
 		memoryChunk.textures.ClearHeap();
 		heapAllocator->DeallocateChunk(memoryChunk.heapChunk);
 	}
@@ -76,7 +114,8 @@ TextureAllocator::~TextureAllocator()
 
 TextureAllocator::TextureAllocator(TextureAllocator&& other) noexcept : 
 	ResourceAllocator(std::move(other)), device(other.device),
-	memoryChunks(std::move(other.memoryChunks))
+	memoryChunks(std::move(other.memoryChunks)), freeBlocks(std::move(other.freeBlocks)),
+	releasedChunks(std::move(other.releasedChunks))
 {
 	other.device = nullptr;
 }
@@ -89,6 +128,8 @@ TextureAllocator& TextureAllocator::operator=(TextureAllocator&& other) noexcept
 		device = other.device;
 		other.device = nullptr;
 		memoryChunks = std::move(other.memoryChunks);
+		freeBlocks = std::move(other.freeBlocks);
+		releasedChunks = std::move(other.releasedChunks);
 	}
 
 	return *this;
@@ -114,18 +155,27 @@ void TextureAllocator::Initialize(ID3D12Device* deviceToUse,
 		initialChunk.heapChunk.startOffset;
 	initialChunk.textures.Initialize(heapSize, initialChunk.heapChunk.startOffset);
 	memoryChunks.push_back(std::move(initialChunk));
+	freeBlocks.Clear();
+	freeBlocks.AddChunk(heapSize);
 }
 
 void TextureAllocator::ResetAllocator()
 {
 	for (size_t i = 1; i < memoryChunks.size(); ++i)
 	{
+		if (memoryChunks[i].heapChunk.heap == nullptr)
+			continue; // Already released
+
 		memoryChunks[i].textures.ClearHeap();
 		heapAllocator->DeallocateChunk(memoryChunks[i].heapChunk);
 	}
 
 	memoryChunks[0].textures.ClearHeap();
 	memoryChunks.resize(1); // Keep initial chunk
+	memoryChunks[0].emptyTrims = 0;
+	releasedChunks.clear();
+	freeBlocks.Truncate(1);
+	UpdateFreeBlock(0);
 }
 
 ResourceIdentifier TextureAllocator::AllocateTexture(const TextureAllocationInfo& info,
@@ -159,6 +209,31 @@ void TextureAllocator::DeallocateTexture(const ResourceIdentifier& identifier)
 	textureVector[identifier.internalIndex].resource->Release();
 	textureVector[identifier.internalIndex].resource = nullptr;
 	textureVector.DeallocateChunk(identifier.internalIndex);
+	UpdateFreeBlock(identifier.heapChunkIndex);
+}
+
+void TextureAllocator::TrimEmptyChunks()
+{
+	if (emptyChunkReleaseDelay == 0)
+		return;
+
+	bool released = false;
+	for (size_t i = 1; i < memoryChunks.size(); ++i) // The initial chunk is always kept
+	{
+		MemoryChunk& memoryChunk = memoryChunks[i];
+		if (memoryChunk.heapChunk.heap == nullptr)
+			continue;
+
+		if (memoryChunk.textures.NrOfAllocatedChunks() != 0)
+		{
+			memoryChunk.emptyTrims = 0;
+		}
+		else if (++memoryChunk.emptyTrims >= emptyChunkReleaseDelay && !released)
+		{
+			ReleaseChunk(i); // One at a time, in case the load comes back
+			released = true;
+		}
+	}
 }
 
 TextureHandle TextureAllocator::GetHandle(const ResourceIdentifier& identifier)
@@ -238,3 +313,8 @@ void TextureAllocator::TransitionAllTextures(std::vector<D3D12_RESOURCE_BARRIER>
 		}
 	}
 }
+
+size_t TextureAllocator::NrOfMemoryChunks() const
+{
+	return memoryChunks.size() - releasedChunks.size();
+}
@@ -9,6 +9,7 @@
 #include "ResourceAllocator.h"
 #include "HeapHelper.h"
 #include "ResourceUploader.h"
+#include "FreeBlockIndex.h"
 
 struct TextureDimensions
 {
@@ -111,15 +112,20 @@ private:
 	{
 		HeapChunk heapChunk;
 		HeapHelper<TextureEntry> textures;
+		size_t emptyTrims = 0;
 	};
 
 	ID3D12Device* device = nullptr;
 	std::vector<MemoryChunk> memoryChunks;
+	FreeBlockIndex freeBlocks;
+	std::vector<size_t> releasedChunks; // Reused before new chunks are added, so other indices stay the same
 
 	D3D12_RESOURCE_DESC CreateTextureDesc(const TextureAllocationInfo& info,
 		std::optional<D3D12_RESOURCE_FLAGS> replacementBindings);
 
 	ResourceIdentifier GetAvailableHeapIndex(D3D12_RESOURCE_ALLOCATION_INFO allocationInfo);
+	void UpdateFreeBlock(size_t chunkIndex);
+	void ReleaseChunk(size_t chunkIndex);
 
 public:
 	TextureAllocator() = default;
@@ -139,6 +145,8 @@ public:
 		std::optional<D3D12_RESOURCE_FLAGS> replacementBindings = std::nullopt);
 
 	void DeallocateTexture(const ResourceIdentifier& identifier);
+	// Releases at most one expansion chunk that has been empty for long enough, call once per frame
+	void TrimEmptyChunks();
 
 	D3D12_RESOURCE_BARRIER CreateTransitionBarrier(const ResourceIdentifier& identifier,
 		D3D12_RESOURCE_STATES newState,
@@ -152,4 +160,5 @@ public:
 	TextureHandle GetHandle(const ResourceIdentifier& identifier);
 	const TextureHandle GetHandle(const ResourceIdentifier& identifier) const;
 	D3D12_RESOURCE_STATES GetCurrentState(const ResourceIdentifier& identifier);
+	size_t NrOfMemoryChunks() const; // Released chunks are not included
 };
\ No newline at end of file
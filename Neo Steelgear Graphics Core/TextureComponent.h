@@ -122,6 +122,9 @@ public:
 		const std::vector<DescriptorAllocationInfo<TextureViewDesc>>& descriptorInfo);
 
 	void RemoveComponent(const ResourceIndex& indexToRemove) override;
+	// Gives back expansion memory that has been empty for long enough, called once per frame
+	// by the frame components when their previous use of this component has finished
+	void TrimEmptyChunks();
 
 	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapSRV() const override;
 	const D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptorHeapUAV() const override;
@@ -148,6 +151,7 @@ TextureComponent<DescSRV, DescUAV, DescRTV, DescDSV>::InitializeTextureAllocator
 	const auto& memoryInfo = textureInfo.memoryInfo;
 	textureAllocator.Initialize(device, views, memoryInfo.initialMinimumHeapSize,
 		memoryInfo.expansionMinimumSize, memoryInfo.heapAllocator);
+	textureAllocator.SetEmptyChunkReleaseDelay(memoryInfo.emptyChunkReleaseDelay);
 }
 
 template<typename DescSRV, typename DescUAV, typename DescRTV, typename DescDSV>
@@ -274,32 +278,38 @@ inline void TextureComponent<DescSRV, DescUAV, DescRTV, DescDSV>::RemoveComponen
 	textureAllocator.DeallocateTexture(indexToRemove.allocatorIdentifier);
 }
 
+template<typename DescSRV, typename DescUAV, typename DescRTV, typename DescDSV>
+inline void TextureComponent<DescSRV, DescUAV, DescRTV, DescDSV>::TrimEmptyChunks()
+{
+	textureAllocator.TrimEmptyChunks();
+}
+
 template<typename DescSRV, typename DescUAV, typename DescRTV, typename DescDSV>
 inline const D3D12_CPU_DESCRIPTOR_HANDLE 
 TextureComponent<DescSRV, DescUAV, DescRTV, DescDSV>::GetDescriptorHeapSRV() const
 {
-	return descriptorAllocators[srv.index].GetDescriptorHandle(0);
+	return GetHeapStart(srv.index);
 }
 
 template<typename DescSRV, typename DescUAV, typename DescRTV, typename DescDSV>
 inline const D3D12_CPU_DESCRIPTOR_HANDLE 
 TextureComponent<DescSRV, DescUAV, DescRTV, DescDSV>::GetDescriptorHeapUAV() const
 {
-	return descriptorAllocators[uav.index].GetDescriptorHandle(0);
+	return GetHeapStart(uav.index);
 }
 
 template<typename DescSRV, typename DescUAV, typename DescRTV, typename DescDSV>
 inline const D3D12_CPU_DESCRIPTOR_HANDLE 
 TextureComponent<DescSRV, DescUAV, DescRTV, DescDSV>::GetDescriptorHeapRTV() const
 {
-	return descriptorAllocators[rtv.index].GetDescriptorHandle(0);
+	return GetHeapStart(rtv.index);
 }
 
 template<typename DescSRV, typename DescUAV, typename DescRTV, typename DescDSV>
 inline const D3D12_CPU_DESCRIPTOR_HANDLE 
 TextureComponent<DescSRV, DescUAV, DescRTV, DescDSV>::GetDescriptorHeapDSV() const
 {
-	return descriptorAllocators[dsv.index].GetDescriptorHandle(0);
+	return GetHeapStart(dsv.index);
 }
 
 template<typename DescSRV, typename DescUAV, typename DescRTV, typename DescDSV>
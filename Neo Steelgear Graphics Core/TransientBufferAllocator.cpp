@@ -0,0 +1,224 @@
+#include "TransientBufferAllocator.h"
+
+#include <cstring>
+#include <stdexcept>
+
+void TransientBufferAllocator::AllocateBuffer(ID3D12Device* device, size_t totalSize,
+	ID3D12Heap* heap, size_t heapOffset)
+{
+	D3D12_RESOURCE_DESC desc;
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	desc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	desc.Width = totalSize;
+	desc.Height = 1;
+	desc.DepthOrArraySize = 1;
+	desc.MipLevels = 1;
+	desc.Format = DXGI_FORMAT_UNKNOWN;
+	desc.SampleDesc.Count = 1;
+	desc.SampleDesc.Quality = 0;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	buffer = D3DPtr<ID3D12Resource>();
+	HRESULT hr = S_OK;
+
+	if (heap != nullptr)
+	{
+		hr = device->CreatePlacedResource(heap, heapOffset, &desc,
+			D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&buffer));
+	}
+	else
+	{
+		D3D12_HEAP_PROPERTIES heapProperties;
+		heapProperties.Type = D3D12_HEAP_TYPE_UPLOAD;
+		heapProperties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+		heapProperties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+		heapProperties.CreationNodeMask = 0;
+		heapProperties.VisibleNodeMask = 0;
+
+		hr = device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE,
+			&desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&buffer));
+	}
+
+	if (FAILED(hr))
+		throw std::runtime_error("Could not create transient buffer resource");
+
+	D3D12_RANGE nothing = { 0, 0 }; // We only write, we do not read
+	hr = buffer->Map(0, &nothing, reinterpret_cast<void**>(&mappedStart));
+	if (FAILED(hr))
+		throw std::runtime_error("Could not map transient buffer resource");
+
+	gpuStart = buffer->GetGPUVirtualAddress();
+}
+
+void TransientBufferAllocator::InitializeRegions(const BufferInfo& bufferInfoToUse,
+	size_t bytesPerFrame, FrameType nrOfFrames)
+{
+	if (nrOfFrames == 0)
+		throw std::runtime_error("Transient buffer allocator needs at least one frame");
+
+	bufferInfo = bufferInfoToUse;
+	bufferInfo.elementSize = ((bufferInfo.elementSize +
+		(bufferInfo.alignment - 1)) & ~(bufferInfo.alignment - 1));
+
+	// Every region starts aligned so only the head within it needs aligning
+	frameSize = ((bytesPerFrame + (bufferInfo.alignment - 1)) &
+		~(bufferInfo.alignment - 1));
+	frameRegions.clear();
+	frameRegions.resize(nrOfFrames);
+	for (FrameType i = 0; i < nrOfFrames; ++i)
+		frameRegions[i].startOffset = frameSize * i;
+
+	activeFrame = 0;
+}
+
+TransientBufferAllocator::TransientBufferAllocator(
+	TransientBufferAllocator&& other) noexcept : buffer(std::move(other.buffer)),
+	mappedStart(other.mappedStart), gpuStart(other.gpuStart),
+	bufferInfo(other.bufferInfo), frameSize(other.frameSize),
+	frameRegions(std::move(other.frameRegions)), activeFrame(other.activeFrame)
+{
+	other.mappedStart = nullptr;
+	other.gpuStart = 0;
+	other.bufferInfo = BufferInfo();
+	other.frameSize = 0;
+	other.activeFrame = 0;
+}
+
+TransientBufferAllocator& TransientBufferAllocator::operator=(
+	TransientBufferAllocator&& other) noexcept
+{
+	if (this != &other)
+	{
+		buffer = std::move(other.buffer);
+		mappedStart = other.mappedStart;
+		gpuStart = other.gpuStart;
+		bufferInfo = other.bufferInfo;
+		frameSize = other.frameSize;
+		frameRegions = std::move(other.frameRegions);
+		activeFrame = other.activeFrame;
+
+		other.mappedStart = nullptr;
+		other.gpuStart = 0;
+		other.bufferInfo = BufferInfo();
+		other.frameSize = 0;
+		other.activeFrame = 0;
+	}
+
+	return *this;
+}
+
+void TransientBufferAllocator::Initialize(ID3D12Device* device,
+	const BufferInfo& bufferInfoToUse, size_t bytesPerFrame, FrameType nrOfFrames)
+{
+	InitializeRegions(bufferInfoToUse, bytesPerFrame, nrOfFrames);
+	AllocateBuffer(device, frameSize * nrOfFrames, nullptr, 0);
+}
+
+void TransientBufferAllocator::Initialize(ID3D12Device* device,
+	const BufferInfo& bufferInfoToUse, size_t bytesPerFrame, FrameType nrOfFrames,
+	ID3D12Heap* heap, size_t heapOffset)
+{
+	InitializeRegions(bufferInfoToUse, bytesPerFrame, nrOfFrames);
+	AllocateBuffer(device, frameSize * nrOfFrames, heap, heapOffset);
+}
+
+void TransientBufferAllocator::Initialize(const BufferInfo& bufferInfoToUse,
+	unsigned char* mappedMemory, D3D12_GPU_VIRTUAL_ADDRESS gpuAddress,
+	size_t bytesPerFrame, FrameType nrOfFrames)
+{
+	InitializeRegions(bufferInfoToUse, bytesPerFrame, nrOfFrames);
+	buffer = D3DPtr<ID3D12Resource>();
+	mappedStart = mappedMemory;
+	gpuStart = gpuAddress;
+}
+
+std::optional<TransientBufferAllocation> TransientBufferAllocator::Allocate(
+	size_t nrOfElements)
+{
+	FrameRegion& region = frameRegions[activeFrame];
+	if (region.inFlight)
+		return std::nullopt;
+
+	size_t offset = ((region.head + (bufferInfo.alignment - 1)) &
+		~(bufferInfo.alignment - 1));
+	size_t size = nrOfElements * bufferInfo.elementSize;
+	if (offset + size > frameSize)
+		return std::nullopt;
+
+	region.head = offset + size;
+
+	TransientBufferAllocation toReturn;
+	toReturn.handle.resource = buffer;
+	toReturn.handle.startOffset = region.startOffset + offset;
+	toReturn.handle.nrOfElements = nrOfElements;
+	toReturn.mappedPtr = mappedStart + toReturn.handle.startOffset;
+	toReturn.gpuAddress = gpuStart + toReturn.handle.startOffset;
+	return toReturn;
+}
+
+std::optional<TransientBufferAllocation> TransientBufferAllocator::Allocate(
+	size_t nrOfElements, const void* data)
+{
+	auto toReturn = Allocate(nrOfElements);
+	if (toReturn.has_value())
+		std::memcpy(toReturn->mappedPtr, data, nrOfElements * bufferInfo.elementSize);
+
+	return toReturn;
+}
+
+void TransientBufferAllocator::SwapFrame()
+{
+	activeFrame = static_cast<FrameType>((activeFrame + 1) % frameRegions.size());
+	frameRegions[activeFrame].head = 0;
+	frameRegions[activeFrame].inFlight = false;
+}
+
+void TransientBufferAllocator::SubmitFrame(std::uint64_t completionValue)
+{
+	frameRegions[activeFrame].inFlight = true;
+	frameRegions[activeFrame].completionValue = completionValue;
+	activeFrame = static_cast<FrameType>((activeFrame + 1) % frameRegions.size());
+}
+
+void TransientBufferAllocator::UpdateCompletedValue(std::uint64_t newCompletedValue)
+{
+	for (auto& region : frameRegions)
+	{
+		if (region.inFlight && region.completionValue <= newCompletedValue)
+		{
+			region.head = 0;
+			region.inFlight = false;
+		}
+	}
+}
+
+void TransientBufferAllocator::UpdateCompletedValue(ID3D12Fence* fence)
+{
+	UpdateCompletedValue(fence->GetCompletedValue());
+}
+
+ID3D12Resource* TransientBufferAllocator::GetResource() const
+{
+	return buffer;
+}
+
+size_t TransientBufferAllocator::GetElementSize() const
+{
+	return bufferInfo.elementSize;
+}
+
+size_t TransientBufferAllocator::GetFrameSize() const
+{
+	return frameSize;
+}
+
+size_t TransientBufferAllocator::GetUsedFrameMemory() const
+{
+	return frameRegions[activeFrame].head;
+}
+
+FrameType TransientBufferAllocator::GetActiveFrame() const
+{
+	return activeFrame;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <d3d12.h>
+#include <vector>
+#include <optional>
+#include <cstdint>
+
+#include "D3DPtr.h"
+#include "BufferAllocator.h"
+#include "FrameBased.h"
+
+// Only valid for the frame it was allocated in
+struct TransientBufferAllocation
+{
+	BufferHandle handle = { nullptr, 0, 0 };
+	unsigned char* mappedPtr = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+};
+
+// Bump allocates upload memory that is only used for a single frame, such as per draw constants.
+// Every frame has its own region of a persistently mapped buffer that is reset as a whole
+class TransientBufferAllocator
+{
+private:
+	struct FrameRegion
+	{
+		size_t startOffset = 0;
+		size_t head = 0;
+		bool inFlight = false;
+		std::uint64_t completionValue = 0;
+	};
+
+	D3DPtr<ID3D12Resource> buffer;
+	unsigned char* mappedStart = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS gpuStart = 0;
+	BufferInfo bufferInfo;
+	size_t frameSize = 0;
+	std::vector<FrameRegion> frameRegions;
+	FrameType activeFrame = 0;
+
+	void AllocateBuffer(ID3D12Device* device, size_t totalSize,
+		ID3D12Heap* heap, size_t heapOffset);
+	void InitializeRegions(const BufferInfo& bufferInfoToUse,
+		size_t bytesPerFrame, FrameType nrOfFrames);
+
+public:
+	TransientBufferAllocator() = default;
+	~TransientBufferAllocator() = default;
+	TransientBufferAllocator(const TransientBufferAllocator& other) = delete;
+	TransientBufferAllocator& operator=(const TransientBufferAllocator& other) = delete;
+	TransientBufferAllocator(TransientBufferAllocator&& other) noexcept;
+	TransientBufferAllocator& operator=(TransientBufferAllocator&& other) noexcept;
+
+	void Initialize(ID3D12Device* device, const BufferInfo& bufferInfoToUse,
+		size_t bytesPerFrame, FrameType nrOfFrames);
+	void Initialize(ID3D12Device* device, const BufferInfo& bufferInfoToUse,
+		size_t bytesPerFrame, FrameType nrOfFrames, ID3D12Heap* heap, size_t heapOffset);
+	// Without a device, such as when the memory is mapped elsewhere
+	void Initialize(const BufferInfo& bufferInfoToUse, unsigned char* mappedMemory,
+		D3D12_GPU_VIRTUAL_ADDRESS gpuAddress, size_t bytesPerFrame, FrameType nrOfFrames);
+
+	// Nothing if the active frame is out of memory or still in use by the GPU
+	std::optional<TransientBufferAllocation> Allocate(size_t nrOfElements);
+	std::optional<TransientBufferAllocation> Allocate(size_t nrOfElements,
+		const void* data);
+
+	// The next frame is assumed to be finished on the GPU, like the frame based components
+	void SwapFrame();
+	// The next frame is instead reset once the completed value reaches the frame it was submitted as
+	void SubmitFrame(std::uint64_t completionValue);
+	void UpdateCompletedValue(std::uint64_t newCompletedValue);
+	void UpdateCompletedValue(ID3D12Fence* fence);
+
+	ID3D12Resource* GetResource() const;
+	size_t GetElementSize() const;
+	size_t GetFrameSize() const;
+	size_t GetUsedFrameMemory() const;
+	FrameType GetActiveFrame() const;
+};
\ No newline at end of file
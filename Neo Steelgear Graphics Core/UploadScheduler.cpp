@@ -0,0 +1,355 @@
+#include "UploadScheduler.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+size_t UploadScheduler::ScheduleUpload(ScheduledUpload& toSchedule,
+	UploadPriority priority)
+{
+	size_t queueIndex = static_cast<size_t>(priority);
+	auto& queue = scheduledUploads[queueIndex];
+	toSchedule.uploadId = latestUploadId++;
+
+	// Earlier uploads to the same destination may not end up after this one
+	std::vector<ScheduledUpload> promoted;
+	for (size_t i = queueIndex + 1; i < scheduledUploads.size(); ++i)
+	{
+		auto& lowerQueue = scheduledUploads[i];
+		for (auto& upload : lowerQueue)
+		{
+			if (upload.destination == toSchedule.destination)
+				promoted.push_back(std::move(upload));
+		}
+
+		lowerQueue.erase(std::remove_if(lowerQueue.begin(), lowerQueue.end(),
+			[&toSchedule](const ScheduledUpload& upload)
+			{
+				return upload.destination == toSchedule.destination;
+			}), lowerQueue.end());
+	}
+
+	std::sort(promoted.begin(), promoted.end(),
+		[](const ScheduledUpload& first, const ScheduledUpload& second)
+		{
+			return first.uploadId < second.uploadId;
+		});
+
+	for (auto& upload : promoted)
+		queue.push_back(std::move(upload));
+
+	queue.push_back(std::move(toSchedule));
+	ResumeUploads(queue.back().destination);
+
+	return queue.back().uploadId;
+}
+
+size_t UploadScheduler::GetAllowance(bool ignoreBudget, size_t minimumPart) const
+{
+	if (ignoreBudget)
+		return size_t(-1);
+
+	size_t allowance = usedBudget < frameBudget ? frameBudget - usedBudget : 0;
+
+	// Critical uploads or a small budget must not stall the budgeted ones completely
+	if (!budgetedPartRecorded && frameBudget != 0 && allowance < minimumPart)
+		allowance = minimumPart;
+
+	return allowance;
+}
+
+bool UploadScheduler::ContinueBufferUpload(ScheduledUpload& upload,
+	ID3D12GraphicsCommandList* commandList, bool ignoreBudget)
+{
+	size_t totalSize = upload.data.size();
+	if (upload.processedBytes == totalSize)
+		return true;
+
+	size_t dataSize = min(totalSize - upload.processedBytes,
+		GetAllowance(ignoreBudget, frameBudget));
+
+	if (dataSize != 0)
+	{
+		// Only whole uploads can be matched against content staged earlier
+		std::optional<std::uint64_t> contentHash = std::nullopt;
+		if (upload.processedBytes == 0 && dataSize == totalSize)
+			contentHash = upload.contentHash;
+
+		size_t uploadedSize = uploader->UploadBufferParts(upload.destination,
+			commandList, upload.data.data() + upload.processedBytes,
+			upload.offsetFromStart + upload.processedBytes, dataSize,
+			upload.alignment, contentHash);
+
+		upload.processedBytes += uploadedSize;
+		usedBudget += uploadedSize;
+		budgetedPartRecorded = budgetedPartRecorded ||
+			(!ignoreBudget && uploadedSize != 0);
+	}
+
+	return upload.processedBytes == totalSize;
+}
+
+bool UploadScheduler::ContinueTextureUpload(ScheduledUpload& upload,
+	ID3D12GraphicsCommandList* commandList, bool ignoreBudget)
+{
+	if (upload.processedBytes == upload.data.size())
+		return true;
+
+	TextureUploadInfo& uploadInfo = upload.uploadInfo;
+	bool splitOnRows = uploadInfo.depth == 1;
+	size_t rowSize = uploadInfo.width * uploadInfo.texelSizeInBytes;
+	size_t rowPitch = ((rowSize + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) /
+		D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
+	size_t bandSize = splitOnRows ? rowPitch : rowPitch * uploadInfo.height;
+	size_t sourceBandSize = splitOnRows ?
+		ResourceUploader::GetSourceRowPitch(uploadInfo) :
+		ResourceUploader::GetSourceSlicePitch(uploadInfo);
+	size_t bandsLeft = splitOnRows ? uploadInfo.height : uploadInfo.depth;
+	size_t bandsToUpload = min(bandsLeft,
+		GetAllowance(ignoreBudget, bandSize) / bandSize);
+
+	if (bandsToUpload != 0)
+	{
+		TextureUploadInfo partInfo = uploadInfo;
+		if (splitOnRows)
+			partInfo.height = static_cast<unsigned int>(bandsToUpload);
+		else
+			partInfo.depth = static_cast<unsigned int>(bandsToUpload);
+
+		// Only whole uploads can be matched against content staged earlier
+		std::optional<std::uint64_t> contentHash = std::nullopt;
+		if (upload.processedBytes == 0 && bandsToUpload == bandsLeft)
+			contentHash = upload.contentHash;
+
+		unsigned int uploadedBands = uploader->UploadTextureParts(
+			upload.destination, commandList, upload.data.data() + upload.processedBytes,
+			partInfo, upload.subresourceIndex, contentHash);
+
+		if (splitOnRows)
+		{
+			uploadInfo.height -= uploadedBands;
+			uploadInfo.offsetHeight += uploadedBands;
+		}
+		else
+		{
+			uploadInfo.depth -= uploadedBands;
+			uploadInfo.offsetDepth += uploadedBands;
+		}
+
+		upload.processedBytes += sourceBandSize * uploadedBands;
+		usedBudget += bandSize * uploadedBands;
+		budgetedPartRecorded = budgetedPartRecorded ||
+			(!ignoreBudget && uploadedBands != 0);
+	}
+
+	return upload.processedBytes == upload.data.size();
+}
+
+UploadScheduler::UploadScheduler(UploadScheduler&& other) noexcept :
+	uploader(other.uploader), frameBudget(other.frameBudget),
+	usedBudget(other.usedBudget), budgetedPartRecorded(other.budgetedPartRecorded),
+	latestUploadId(other.latestUploadId),
+	scheduledUploads(std::move(other.scheduledUploads))
+{
+	other.uploader = nullptr;
+	other.frameBudget = 0;
+	other.usedBudget = 0;
+	other.budgetedPartRecorded = false;
+	other.latestUploadId = 0;
+}
+
+UploadScheduler& UploadScheduler::operator=(UploadScheduler&& other) noexcept
+{
+	if (this != &other)
+	{
+		uploader = other.uploader;
+		frameBudget = other.frameBudget;
+		usedBudget = other.usedBudget;
+		budgetedPartRecorded = other.budgetedPartRecorded;
+		latestUploadId = other.latestUploadId;
+		scheduledUploads = std::move(other.scheduledUploads);
+
+		other.uploader = nullptr;
+		other.frameBudget = 0;
+		other.usedBudget = 0;
+		other.budgetedPartRecorded = false;
+		other.latestUploadId = 0;
+	}
+
+	return *this;
+}
+
+void UploadScheduler::Initialize(ResourceUploader* uploaderToUse,
+	size_t frameBudgetInBytes)
+{
+	uploader = uploaderToUse;
+	frameBudget = frameBudgetInBytes;
+}
+
+size_t UploadScheduler::ScheduleBufferUpload(ID3D12Resource* toUploadTo,
+	const void* data, size_t offsetFromStart, size_t dataSize, size_t alignment,
+	UploadPriority priority, std::optional<std::uint64_t> contentHash)
+{
+	const unsigned char* source = static_cast<const unsigned char*>(data);
+
+	ScheduledUpload toSchedule;
+	toSchedule.destination = toUploadTo;
+	toSchedule.data.assign(source, source + dataSize);
+	toSchedule.contentHash = contentHash;
+	toSchedule.offsetFromStart = offsetFromStart;
+	toSchedule.alignment = alignment;
+
+	return ScheduleUpload(toSchedule, priority);
+}
+
+size_t UploadScheduler::ScheduleTextureUpload(ID3D12Resource* toUploadTo,
+	const void* data, const TextureUploadInfo& uploadInfo,
+	unsigned int subresourceIndex, UploadPriority priority,
+	std::optional<std::uint64_t> contentHash)
+{
+	const unsigned char* source = static_cast<const unsigned char*>(data);
+	size_t rowSize = ResourceUploader::GetSourceRowSize(uploadInfo);
+	size_t sourceRowPitch = ResourceUploader::GetSourceRowPitch(uploadInfo);
+	size_t sourceSlicePitch = ResourceUploader::GetSourceSlicePitch(uploadInfo);
+
+	ScheduledUpload toSchedule;
+	toSchedule.destination = toUploadTo;
+	toSchedule.data.resize(rowSize * uploadInfo.height * uploadInfo.depth);
+	toSchedule.contentHash = contentHash;
+	toSchedule.isTexture = true;
+	toSchedule.uploadInfo = uploadInfo;
+	toSchedule.uploadInfo.sourceRowPitch = 0;
+	toSchedule.uploadInfo.sourceSlicePitch = 0;
+	toSchedule.subresourceIndex = subresourceIndex;
+
+	unsigned char* destination = toSchedule.data.data();
+	for (size_t z = 0; z < uploadInfo.depth; ++z)
+	{
+		for (size_t y = 0; y < uploadInfo.height; ++y)
+		{
+			memcpy(destination, source + z * sourceSlicePitch + y * sourceRowPitch,
+				rowSize);
+			destination += rowSize;
+		}
+	}
+
+	return ScheduleUpload(toSchedule, priority);
+}
+
+void UploadScheduler::ExecuteUploads(ID3D12GraphicsCommandList* commandList)
+{
+	if (uploader == nullptr)
+		throw std::runtime_error("Cannot execute uploads without an uploader");
+
+	usedBudget = 0;
+	budgetedPartRecorded = false;
+	std::vector<ID3D12Resource*> blockedDestinations;
+
+	for (size_t i = 0; i < scheduledUploads.size(); ++i)
+	{
+		bool ignoreBudget = i == static_cast<size_t>(UploadPriority::CRITICAL);
+
+		for (auto& upload : scheduledUploads[i])
+		{
+			bool blocked = upload.paused || std::find(blockedDestinations.begin(),
+				blockedDestinations.end(), upload.destination) !=
+				blockedDestinations.end();
+
+			bool finished = !blocked && (upload.isTexture ?
+				ContinueTextureUpload(upload, commandList, ignoreBudget) :
+				ContinueBufferUpload(upload, commandList, ignoreBudget));
+
+			// Later uploads to the same destination have to wait for this one
+			if (!finished)
+				blockedDestinations.push_back(upload.destination);
+		}
+
+		auto& queue = scheduledUploads[i];
+		queue.erase(std::remove_if(queue.begin(), queue.end(),
+			[](const ScheduledUpload& upload)
+			{
+				return upload.processedBytes == upload.data.size();
+			}), queue.end());
+	}
+}
+
+void UploadScheduler::PauseUploads(ID3D12Resource* resource)
+{
+	for (auto& queue : scheduledUploads)
+	{
+		for (auto& upload : queue)
+		{
+			if (resource == nullptr || upload.destination == resource)
+				upload.paused = true;
+		}
+	}
+}
+
+void UploadScheduler::ResumeUploads(ID3D12Resource* resource)
+{
+	for (auto& queue : scheduledUploads)
+	{
+		for (auto& upload : queue)
+		{
+			if (resource == nullptr || upload.destination == resource)
+				upload.paused = false;
+		}
+	}
+}
+
+void UploadScheduler::CancelUploads(ID3D12Resource* resource)
+{
+	for (auto& queue : scheduledUploads)
+	{
+		queue.erase(std::remove_if(queue.begin(), queue.end(),
+			[resource](const ScheduledUpload& upload)
+			{
+				return resource == nullptr || upload.destination == resource;
+			}), queue.end());
+	}
+}
+
+bool UploadScheduler::UploadFinished(size_t uploadId) const
+{
+	if (uploadId >= latestUploadId)
+		return false;
+
+	for (auto& queue : scheduledUploads)
+	{
+		for (auto& upload : queue)
+		{
+			if (upload.uploadId == uploadId)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool UploadScheduler::HasScheduledUploads(ID3D12Resource* resource) const
+{
+	for (auto& queue : scheduledUploads)
+	{
+		for (auto& upload : queue)
+		{
+			if (resource == nullptr || upload.destination == resource)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+bool UploadScheduler::ContentDeduplicationEnabled() const
+{
+	return uploader != nullptr && uploader->ContentDeduplicationEnabled();
+}
+
+void UploadScheduler::SetFrameBudget(size_t frameBudgetInBytes)
+{
+	frameBudget = frameBudgetInBytes;
+}
+
+size_t UploadScheduler::GetUsedBudget() const
+{
+	return usedBudget;
+}
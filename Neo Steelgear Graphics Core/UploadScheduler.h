@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <optional>
+#include <cstdint>
+
+#include <d3d12.h>
+
+#include "ResourceUploader.h"
+
+enum class UploadPriority
+{
+	CRITICAL, // Ignores the frame budget
+	NORMAL,
+	BACKGROUND
+};
+
+class UploadScheduler
+{
+private:
+	struct ScheduledUpload
+	{
+		size_t uploadId = size_t(-1);
+		ID3D12Resource* destination = nullptr;
+		std::vector<unsigned char> data; // Copied when scheduled, textures tightly packed
+		size_t processedBytes = 0;
+		bool paused = false;
+		std::optional<std::uint64_t> contentHash;
+
+		bool isTexture = false;
+		size_t offsetFromStart = 0;
+		size_t alignment = 1;
+		TextureUploadInfo uploadInfo;
+		unsigned int subresourceIndex = 0;
+	};
+
+	ResourceUploader* uploader = nullptr;
+	size_t frameBudget = 0;
+	size_t usedBudget = 0;
+	bool budgetedPartRecorded = false;
+	size_t latestUploadId = 0;
+	std::array<std::vector<ScheduledUpload>, 3> scheduledUploads;
+
+	size_t ScheduleUpload(ScheduledUpload& toSchedule, UploadPriority priority);
+
+	size_t GetAllowance(bool ignoreBudget, size_t minimumPart) const;
+	bool ContinueBufferUpload(ScheduledUpload& upload,
+		ID3D12GraphicsCommandList* commandList, bool ignoreBudget);
+	bool ContinueTextureUpload(ScheduledUpload& upload,
+		ID3D12GraphicsCommandList* commandList, bool ignoreBudget);
+
+public:
+	UploadScheduler() = default;
+	~UploadScheduler() = default;
+	UploadScheduler(const UploadScheduler& other) = delete;
+	UploadScheduler& operator=(const UploadScheduler& other) = delete;
+	UploadScheduler(UploadScheduler&& other) noexcept;
+	UploadScheduler& operator=(UploadScheduler&& other) noexcept;
+
+	// A budget of 0 only lets critical uploads through. Otherwise the first budgeted upload
+	// of a frame may always record one part, a budget's worth of a buffer or one band of rows
+	// or slices of a texture, so uploads larger than the budget still finish
+	void Initialize(ResourceUploader* uploaderToUse, size_t frameBudgetInBytes);
+
+	// The data is copied, so it can change as soon as the call returns. With a content hash
+	// and deduplication enabled in the uploader, content staged earlier can be reused
+	size_t ScheduleBufferUpload(ID3D12Resource* toUploadTo, const void* data,
+		size_t offsetFromStart, size_t dataSize, size_t alignment,
+		UploadPriority priority = UploadPriority::NORMAL,
+		std::optional<std::uint64_t> contentHash = std::nullopt);
+	size_t ScheduleTextureUpload(ID3D12Resource* toUploadTo, const void* data,
+		const TextureUploadInfo& uploadInfo, unsigned int subresourceIndex = 0,
+		UploadPriority priority = UploadPriority::NORMAL,
+		std::optional<std::uint64_t> contentHash = std::nullopt);
+
+	// Unfinished uploads carry over to the next call, so their destinations must stay
+	// in a copy destination state or be paused until they are back in one
+	void ExecuteUploads(ID3D12GraphicsCommandList* commandList);
+	void PauseUploads(ID3D12Resource* resource = nullptr);
+	void ResumeUploads(ID3D12Resource* resource = nullptr);
+	void CancelUploads(ID3D12Resource* resource = nullptr);
+
+	bool UploadFinished(size_t uploadId) const;
+	bool HasScheduledUploads(ID3D12Resource* resource = nullptr) const;
+	bool ContentDeduplicationEnabled() const;
+
+	void SetFrameBudget(size_t frameBudgetInBytes);
+	size_t GetUsedBudget() const;
+};
\ No newline at end of file
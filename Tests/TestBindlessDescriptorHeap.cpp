@@ -0,0 +1,146 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "../Neo Steelgear Graphics Core/BindlessDescriptorHeap.h"
+#include "../Neo Steelgear Graphics Core/BufferComponent.h"
+#include "../Neo Steelgear Graphics Core/MultiHeapAllocatorGPU.h"
+
+#include "D3D12Helper.h"
+
+const size_t BINDLESS_STUB_DESCRIPTOR_SIZE = 32;
+
+void InitializeStubBindlessHeap(BindlessDescriptorHeap& heap, size_t startIndex,
+	size_t nrOfDescriptors, FrameType framesInFlight, std::vector<SIZE_T>& destinations)
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE cpuStart = { 0x10000 };
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuStart = { 0x900000 };
+	heap.Initialize(cpuStart, gpuStart, BINDLESS_STUB_DESCRIPTOR_SIZE, startIndex,
+		nrOfDescriptors, framesInFlight,
+		[&destinations](UINT nrOfDescriptors, D3D12_CPU_DESCRIPTOR_HANDLE destination,
+			D3D12_CPU_DESCRIPTOR_HANDLE)
+		{
+			for (UINT i = 0; i < nrOfDescriptors; ++i)
+				destinations.push_back(destination.ptr + i * BINDLESS_STUB_DESCRIPTOR_SIZE);
+		});
+}
+
+TEST(BindlessDescriptorHeapTest, DefaultInitialisable)
+{
+	BindlessDescriptorHeap heap;
+}
+
+TEST(BindlessDescriptorHeapTest, AllocatesStableIndices)
+{
+	std::vector<SIZE_T> destinations;
+	BindlessDescriptorHeap heap;
+	InitializeStubBindlessHeap(heap, 100, 4, 2, destinations);
+
+	std::vector<BindlessHandle> handles;
+	for (unsigned int i = 0; i < 4; ++i)
+	{
+		auto handle = heap.Allocate({ 0x500000 });
+		ASSERT_TRUE(handle.has_value());
+		EXPECT_EQ(heap.GetShaderIndex(*handle), 100 + i);
+		EXPECT_EQ(destinations.back(), 0x10000 + (100 + i) * BINDLESS_STUB_DESCRIPTOR_SIZE);
+		EXPECT_EQ(heap.GetGPUHandle(*handle).ptr,
+			0x900000 + (100 + i) * BINDLESS_STUB_DESCRIPTOR_SIZE);
+		handles.push_back(*handle);
+	}
+
+	EXPECT_EQ(heap.Allocate({ 0x500000 }).has_value(), false);
+	EXPECT_EQ(heap.GetNrOfAllocatedSlots(), 4);
+
+	heap.Update(handles[2], { 0x600000 });
+	EXPECT_EQ(destinations.size(), 5);
+	EXPECT_EQ(destinations.back(), 0x10000 + 102 * BINDLESS_STUB_DESCRIPTOR_SIZE);
+
+	BindlessHandle outOfRange;
+	outOfRange.shaderIndex = 99;
+	EXPECT_EQ(heap.IsValid(outOfRange), false);
+	EXPECT_EQ(heap.IsValid(BindlessHandle()), false);
+}
+
+TEST(BindlessDescriptorHeapTest, ReusesSlotsAfterFramesInFlight)
+{
+	std::vector<SIZE_T> destinations;
+	BindlessDescriptorHeap heap;
+	InitializeStubBindlessHeap(heap, 0, 2, 3, destinations);
+
+	auto first = heap.Allocate({ 0x500000 });
+	auto second = heap.Allocate({ 0x500000 });
+	ASSERT_TRUE(first.has_value() && second.has_value());
+
+	heap.Release(*first);
+	EXPECT_EQ(heap.IsValid(*first), false);
+	EXPECT_THROW(heap.GetShaderIndex(*first), std::runtime_error);
+	EXPECT_THROW(heap.Release(*first), std::runtime_error);
+	EXPECT_THROW(heap.Update(*first, { 0x500000 }), std::runtime_error);
+	EXPECT_EQ(heap.GetNrOfRetiredSlots(), 1);
+
+	// The slot can still be read by frames in flight until three frames have passed
+	for (unsigned int frame = 0; frame < 2; ++frame)
+	{
+		heap.AdvanceFrame();
+		EXPECT_EQ(heap.Allocate({ 0x500000 }).has_value(), false);
+	}
+
+	heap.AdvanceFrame();
+	EXPECT_EQ(heap.GetNrOfRetiredSlots(), 0);
+	auto reused = heap.Allocate({ 0x500000 });
+	ASSERT_TRUE(reused.has_value());
+	EXPECT_EQ(reused->shaderIndex, first->shaderIndex);
+	EXPECT_NE(reused->generation, first->generation);
+	EXPECT_EQ(heap.IsValid(*first), false);
+	EXPECT_EQ(heap.IsValid(*reused), true);
+	EXPECT_EQ(heap.IsValid(*second), true);
+}
+
+TEST(BindlessDescriptorHeapTest, RegistersComponentViews)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	BindlessDescriptorHeap bindlessHeap;
+	bindlessHeap.Initialize(device, 1000, 2);
+	ASSERT_NE(bindlessHeap.GetHeap(), nullptr);
+
+	MultiHeapAllocatorGPU heapAllocator;
+	heapAllocator.Initialize(device);
+	ResourceComponentMemoryInfo memoryInfo;
+	memoryInfo.initialMinimumHeapSize = 64 * 1024;
+	memoryInfo.expansionMinimumSize = 0;
+	memoryInfo.heapAllocator = &heapAllocator;
+	BufferComponentInfo componentInfo = { { 256, 256 }, false, memoryInfo };
+
+	BufferViewDesc srvDesc(ViewType::SRV);
+	BufferViewDesc uavDesc(ViewType::UAV);
+	std::vector<DescriptorAllocationInfo<BufferViewDesc>> descriptorAllocationInfo =
+	{
+		DescriptorAllocationInfo<BufferViewDesc>(ViewType::SRV, srvDesc, 10),
+		DescriptorAllocationInfo<BufferViewDesc>(ViewType::UAV, uavDesc, 10)
+	};
+
+	BufferComponent component;
+	component.Initialize(device, componentInfo, descriptorAllocationInfo);
+	component.SetBindlessHeap(&bindlessHeap);
+
+	ResourceIndex first = component.CreateBuffer(1);
+	ResourceIndex second = component.CreateBuffer(1);
+	const size_t SRV = static_cast<size_t>(ViewType::SRV);
+	const size_t UAV = static_cast<size_t>(ViewType::UAV);
+	EXPECT_EQ(first.bindlessHandles[static_cast<size_t>(ViewType::CBV)].shaderIndex,
+		std::uint32_t(-1));
+	EXPECT_EQ(bindlessHeap.GetShaderIndex(first.bindlessHandles[SRV]), 0);
+	EXPECT_EQ(bindlessHeap.GetShaderIndex(first.bindlessHandles[UAV]), 1);
+	EXPECT_EQ(bindlessHeap.GetShaderIndex(second.bindlessHandles[SRV]), 2);
+	EXPECT_EQ(bindlessHeap.GetNrOfAllocatedSlots(), 4);
+
+	component.RemoveComponent(first);
+	EXPECT_EQ(bindlessHeap.IsValid(first.bindlessHandles[SRV]), false);
+	EXPECT_EQ(bindlessHeap.IsValid(second.bindlessHandles[SRV]), true);
+	EXPECT_EQ(bindlessHeap.GetNrOfRetiredSlots(), 2);
+
+	device->Release();
+}
\ No newline at end of file
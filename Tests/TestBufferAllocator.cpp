@@ -375,5 +375,70 @@ TEST(BufferAllocatorTest, ExpandsCorrectly)
 	}
 	readbackBuffer->Release();
 	fence->Release();
+	device->Release();
+}
+
+TEST(BufferAllocatorTest, ReleasesEmptyChunks)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	MultiHeapAllocatorGPU heapAllocator;
+	heapAllocator.Initialize(device);
+
+	BufferAllocator bufferAllocator;
+	bufferAllocator.Initialize({ 256, 256 }, device, true, {}, 4096, 4096,
+		&heapAllocator);
+	bufferAllocator.SetEmptyChunkReleaseDelay(3);
+	EXPECT_EQ(bufferAllocator.EmptyChunkReleaseDelay(), 3);
+
+	std::vector<ResourceIdentifier> identifiers;
+	while (identifiers.empty() || identifiers.back().heapChunkIndex < 2)
+		identifiers.push_back(bufferAllocator.AllocateBuffer(1));
+	ASSERT_EQ(bufferAllocator.NrOfMemoryChunks(), 3);
+	BufferHandle lastHandle = bufferAllocator.GetHandle(identifiers.back());
+
+	for (auto& identifier : identifiers)
+	{
+		if (identifier.heapChunkIndex == 1)
+			bufferAllocator.DeallocateBuffer(identifier);
+	}
+
+	bufferAllocator.TrimEmptyChunks();
+	bufferAllocator.TrimEmptyChunks();
+	EXPECT_EQ(bufferAllocator.NrOfMemoryChunks(), 3);
+	bufferAllocator.TrimEmptyChunks();
+	EXPECT_EQ(bufferAllocator.NrOfMemoryChunks(), 2);
+
+	// Chunks after the released one keep their index
+	BufferHandle currentHandle = bufferAllocator.GetHandle(identifiers.back());
+	EXPECT_EQ(currentHandle.resource, lastHandle.resource);
+	EXPECT_EQ(currentHandle.startOffset, lastHandle.startOffset);
+
+	// Using a chunk again restarts its countdown
+	bufferAllocator.DeallocateBuffer(identifiers.back());
+	bufferAllocator.TrimEmptyChunks();
+	bufferAllocator.TrimEmptyChunks();
+	ResourceIdentifier reused = bufferAllocator.AllocateBuffer(1);
+	ASSERT_EQ(reused.heapChunkIndex, 2);
+	bufferAllocator.DeallocateBuffer(reused);
+	bufferAllocator.TrimEmptyChunks();
+	bufferAllocator.TrimEmptyChunks();
+	EXPECT_EQ(bufferAllocator.NrOfMemoryChunks(), 2);
+	bufferAllocator.TrimEmptyChunks();
+	EXPECT_EQ(bufferAllocator.NrOfMemoryChunks(), 1);
+
+	// Expanding again fills the released slots before adding new ones
+	identifiers.clear();
+	while (identifiers.empty() || identifiers.back().heapChunkIndex == 0)
+		identifiers.push_back(bufferAllocator.AllocateBuffer(1));
+	EXPECT_LT(identifiers.back().heapChunkIndex, 3);
+	EXPECT_EQ(bufferAllocator.NrOfMemoryChunks(), 2);
+
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	bufferAllocator.CreateTransitionBarrier(D3D12_RESOURCE_STATE_COPY_SOURCE, barriers);
+	EXPECT_EQ(barriers.size(), 2);
+
 	device->Release();
 }
\ No newline at end of file
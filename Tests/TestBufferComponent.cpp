@@ -172,6 +172,45 @@ TEST(BufferComponentTest, CorrectlyRemovesSimpleBuffers)
 	InitializationWrapper(func);
 }
 
+TEST(BufferComponentTest, CorrectlyCreatesBufferBatches)
+{
+	auto func = [](ID3D12Device* device, BufferComponentInfo& componentInfo,
+		std::vector<DescriptorAllocationInfo<BufferViewDesc>>& descriptorAllocationInfo,
+		AllowedViews& views, BufferInfo& info, size_t maxAllocations)
+	{
+		std::array<size_t, 3> elementsPerAllocation = { 1, 8, 64 };
+
+		for (auto& nrOfElements : elementsPerAllocation)
+		{
+			BufferComponent component;
+			component.Initialize(device, componentInfo, descriptorAllocationInfo);
+
+			size_t nrOfBuffers = maxAllocations / nrOfElements;
+			std::vector<size_t> batch(nrOfBuffers, nrOfElements);
+			auto indices = component.CreateBuffers(batch);
+			ASSERT_EQ(indices.size(), nrOfBuffers);
+
+			for (size_t i = 0; i < nrOfBuffers; ++i)
+			{
+				ASSERT_EQ(indices[i].allocatorIdentifier.heapChunkIndex, 0);
+				ASSERT_EQ(indices[i].allocatorIdentifier.internalIndex, i);
+				ASSERT_EQ(indices[i].descriptorIndex, i);
+			}
+
+			// Freed descriptors are reused by the next batch
+			for (size_t i = 0; i < nrOfBuffers; i += 2)
+				component.RemoveComponent(indices[i]);
+
+			batch.resize(nrOfBuffers / 2);
+			auto newIndices = component.CreateBuffers(batch);
+			for (auto& index : newIndices)
+				ASSERT_LT(index.descriptorIndex, nrOfBuffers);
+		}
+	};
+
+	InitializationWrapper(func);
+}
+
 TEST(BufferComponentTest, CorrectlyUpdatesMappedBuffers)
 {
 	auto func = [](ID3D12Device* device, BufferComponentInfo& componentInfo,
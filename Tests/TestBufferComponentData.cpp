@@ -690,5 +690,208 @@ TEST(BufferComponentDataTest, ExpandsCorrectly)
 		}
 	}
 
+	device->Release();
+}
+
+TEST(BufferComponentDataTest, PerformsSpanUpdatesCorrectly)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device))
+		FAIL() << "Cannot proceed with tests as command structure cannot be created";
+
+	UINT64 currentFenceValue = 0;
+	ID3D12Fence* fence = CreateFence(device, currentFenceValue,
+		D3D12_FENCE_FLAG_NONE);
+
+	const size_t NR_OF_COMPONENTS = 4;
+	const size_t COMPONENT_SIZE = 256;
+	ID3D12Resource* readbackBuffer = CreateBuffer(device,
+		NR_OF_COMPONENTS * COMPONENT_SIZE, true);
+	if (readbackBuffer == nullptr)
+		FAIL() << "Cannot proceed with tests as readback buffer cannot be created";
+
+	ResourceUploader uploader;
+	uploader.Initialize(device, 64 * 1024, AllocationStrategy::FIRST_FIT);
+
+	std::array<UpdateType, 2> updateTypes = { UpdateType::MAP_UPDATE,
+		UpdateType::COPY_UPDATE };
+
+	for (auto& updateType : updateTypes)
+	{
+		for (unsigned int frames = 1; frames < 4; ++frames)
+		{
+			MultiHeapAllocatorGPU heapAllocator;
+			heapAllocator.Initialize(device);
+
+			ResourceComponentMemoryInfo memoryInfo;
+			memoryInfo.initialMinimumHeapSize = 64 * 1024;
+			memoryInfo.expansionMinimumSize = 0;
+			memoryInfo.heapAllocator = &heapAllocator;
+			BufferComponentInfo componentInfo = { { 256, COMPONENT_SIZE },
+				updateType == UpdateType::MAP_UPDATE, memoryInfo };
+
+			BufferComponentData componentData;
+			componentData.Initialize(device, frames, updateType,
+				NR_OF_COMPONENTS * COMPONENT_SIZE, 0);
+
+			std::vector<BufferComponent> components(frames);
+			std::vector<ResourceIndex> resourceIndices(NR_OF_COMPONENTS);
+			for (unsigned int currentFrame = 0; currentFrame < frames; ++currentFrame)
+			{
+				components[currentFrame].Initialize(device, componentInfo, {});
+				for (size_t i = 0; i < NR_OF_COMPONENTS; ++i)
+					resourceIndices[i] = components[currentFrame].CreateBuffer(1);
+			}
+
+			unsigned char expected[NR_OF_COMPONENTS * COMPONENT_SIZE] = {};
+			for (size_t i = 0; i < NR_OF_COMPONENTS; ++i)
+			{
+				auto handle = components[0].GetBufferHandle(resourceIndices[i]);
+				componentData.AddComponent(resourceIndices[i], handle.startOffset,
+					COMPONENT_SIZE, expected + i * COMPONENT_SIZE);
+			}
+
+			EXPECT_THROW(componentData.BeginUpdate(resourceIndices[0],
+				components[0], COMPONENT_SIZE - 8, 16), std::runtime_error);
+
+			for (unsigned int currentFrame = 0; currentFrame < frames * 2; ++currentFrame)
+			{
+				BufferComponent& component = components[currentFrame % frames];
+
+				// Only part of every other component is written each round
+				for (size_t i = currentFrame % 2; i < NR_OF_COMPONENTS; i += 2)
+				{
+					size_t offset = (currentFrame * 24) % (COMPONENT_SIZE - 32);
+					WritableSpan span = componentData.BeginUpdate(
+						resourceIndices[i], component, offset, 32);
+					ASSERT_NE(span.data, nullptr);
+					ASSERT_EQ(span.size, 32);
+
+					unsigned char value = static_cast<unsigned char>(currentFrame + i + 1);
+					memset(span.data, value, span.size);
+					memset(expected + i * COMPONENT_SIZE + offset, value, span.size);
+				}
+
+				componentData.UpdateComponentResources(commandStructure.list,
+					uploader, component, 256);
+
+				for (size_t i = 0; i < NR_OF_COMPONENTS; ++i)
+				{
+					auto handle = component.GetBufferHandle(resourceIndices[i]);
+					commandStructure.list->CopyBufferRegion(readbackBuffer,
+						i * COMPONENT_SIZE, handle.resource, handle.startOffset,
+						COMPONENT_SIZE);
+				}
+
+				ExecuteGraphicsCommandList(commandStructure.list,
+					commandStructure.queue);
+				FlushCommandQueue(currentFenceValue, commandStructure.queue, fence);
+
+				// Older frames only catch up once they are updated again
+				if (frames == 1 || currentFrame >= frames)
+				{
+					CheckResourceData(readbackBuffer, 0, expected, 0,
+						NR_OF_COMPONENTS * COMPONENT_SIZE);
+				}
+
+				// Staging has to match as well, even when the writes went straight to the buffer
+				for (size_t i = 0; i < NR_OF_COMPONENTS; ++i)
+				{
+					EXPECT_EQ(memcmp(componentData.GetComponentData(resourceIndices[i]),
+						expected + i * COMPONENT_SIZE, COMPONENT_SIZE), 0);
+				}
+
+				uploader.RestoreUsedMemory();
+
+				if (FAILED(commandStructure.allocator->Reset()))
+					FAIL() << "Cannot proceed with tests as command allocator cannot be reset";
+
+				if (FAILED(commandStructure.list->Reset(commandStructure.allocator, nullptr)))
+					FAIL() << "Cannot proceed with tests as command list cannot be reset";
+			}
+		}
+	}
+
+	readbackBuffer->Release();
+	fence->Release();
+	device->Release();
+}
+
+TEST(BufferComponentDataTest, FindsInitializeOnlyComponentsAfterRemovals)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	const size_t NR_OF_COMPONENTS = 1000;
+	const unsigned int COMPONENT_SIZE = 16;
+
+	BufferComponentData componentData;
+	componentData.Initialize(device, 1, UpdateType::INITIALISE_ONLY, 0, 0);
+
+	std::vector<ResourceIndex> resourceIndices(NR_OF_COMPONENTS);
+	for (size_t i = 0; i < NR_OF_COMPONENTS; ++i)
+	{
+		unsigned char initialData[COMPONENT_SIZE];
+		memset(initialData, static_cast<unsigned char>(i), COMPONENT_SIZE);
+		resourceIndices[i].allocatorIdentifier.heapChunkIndex = 0;
+		resourceIndices[i].allocatorIdentifier.internalIndex = i;
+		resourceIndices[i].descriptorIndex = i;
+		componentData.AddComponent(resourceIndices[i], i * COMPONENT_SIZE,
+			COMPONENT_SIZE, initialData);
+	}
+
+	// Removing in an order unrelated to the insertion order shuffles the headers
+	for (size_t i = 0; i < NR_OF_COMPONENTS; i += 3)
+		componentData.RemoveComponent(resourceIndices[i]);
+	for (size_t i = 0; i < NR_OF_COMPONENTS; i += 7)
+		componentData.RemoveComponent(resourceIndices[NR_OF_COMPONENTS - 1 - i]);
+
+	for (size_t i = 0; i < NR_OF_COMPONENTS; ++i)
+	{
+		unsigned char* componentPtr = static_cast<unsigned char*>(
+			componentData.GetComponentData(resourceIndices[i]));
+		bool removed = i % 3 == 0 || (NR_OF_COMPONENTS - 1 - i) % 7 == 0;
+
+		if (removed)
+		{
+			ASSERT_EQ(componentPtr, nullptr);
+			continue;
+		}
+
+		ASSERT_NE(componentPtr, nullptr);
+		for (unsigned int j = 0; j < COMPONENT_SIZE; ++j)
+			ASSERT_EQ(componentPtr[j], static_cast<unsigned char>(i));
+	}
+
+	// Components added after removals reuse the freed staging, so nothing has to grow or move
+	void* keptPtr = componentData.GetComponentData(resourceIndices[1]);
+	for (size_t i = 0; i < NR_OF_COMPONENTS; ++i)
+	{
+		if (componentData.GetComponentData(resourceIndices[i]) != nullptr)
+			continue;
+
+		unsigned char initialData[COMPONENT_SIZE];
+		memset(initialData, static_cast<unsigned char>(i + 1), COMPONENT_SIZE);
+		componentData.AddComponent(resourceIndices[i], i * COMPONENT_SIZE,
+			COMPONENT_SIZE, initialData);
+	}
+
+	EXPECT_EQ(componentData.GetComponentData(resourceIndices[1]), keptPtr);
+	for (size_t i = 0; i < NR_OF_COMPONENTS; ++i)
+	{
+		unsigned char* componentPtr = static_cast<unsigned char*>(
+			componentData.GetComponentData(resourceIndices[i]));
+		bool readded = i % 3 == 0 || (NR_OF_COMPONENTS - 1 - i) % 7 == 0;
+
+		ASSERT_NE(componentPtr, nullptr);
+		for (unsigned int j = 0; j < COMPONENT_SIZE; ++j)
+			ASSERT_EQ(componentPtr[j], static_cast<unsigned char>(readded ? i + 1 : i));
+	}
+
 	device->Release();
 }
\ No newline at end of file
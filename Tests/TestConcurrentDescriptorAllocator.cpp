@@ -0,0 +1,354 @@
+#include "pch.h"
+
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <iostream>
+
+#include "../Neo Steelgear Graphics Core/ConcurrentDescriptorAllocator.h"
+
+#include "D3D12Helper.h"
+
+TEST(ConcurrentDescriptorAllocatorTest, DefaultInitialisable)
+{
+	ConcurrentDescriptorAllocator allocator;
+	DescriptorThreadCache cache;
+	EXPECT_EQ(cache.AllocateIndex(), size_t(-1));
+	EXPECT_THROW(cache.DeallocateIndex(0), std::runtime_error);
+	cache.Rebalance();
+}
+
+TEST(ConcurrentDescriptorAllocatorTest, RuntimeInitialisable)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	ConcurrentDescriptorAllocator ownedAllocator;
+	ownedAllocator.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, device, 1000);
+	EXPECT_NE(ownedAllocator.GetHeap(), nullptr);
+	EXPECT_EQ(ownedAllocator.GetTotalDescriptors(), 1000);
+	EXPECT_EQ(ownedAllocator.NrOfPooledIndices(), 1000);
+
+	ID3D12DescriptorHeap* heap = CreateDescriptorHeap(device,
+		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 1000, false);
+	if (heap == nullptr)
+		FAIL() << "Cannot proceed with tests as a descriptor heap could not be created";
+
+	ConcurrentDescriptorAllocator externalAllocator;
+	externalAllocator.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, device,
+		heap, 200, 800, 16);
+	EXPECT_EQ(externalAllocator.GetHeap(), heap);
+	EXPECT_EQ(externalAllocator.GetBatchSize(), 16);
+
+	// Indices reserved from a descriptor allocator are indices of that allocator
+	DescriptorAllocator descriptorAllocator;
+	descriptorAllocator.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, device, 100);
+	ASSERT_EQ(descriptorAllocator.AllocateRange(10), 0);
+	{
+		ConcurrentDescriptorAllocator backedAllocator;
+		backedAllocator.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, device,
+			descriptorAllocator, 50, 8);
+
+		DescriptorThreadCache cache = backedAllocator.CreateThreadCache();
+		size_t index = cache.AllocateIndex();
+		EXPECT_EQ(index, 10);
+		EXPECT_EQ(cache.GetDescriptorHandle(index).ptr,
+			descriptorAllocator.GetDescriptorHandle(index).ptr);
+		EXPECT_THROW(cache.DeallocateIndex(5), std::runtime_error);
+		cache.DeallocateIndex(index);
+	}
+	EXPECT_EQ(descriptorAllocator.AllocateRange(50), 10); // Released with the allocator
+
+	heap->Release();
+	device->Release();
+}
+
+TEST(ConcurrentDescriptorAllocatorTest, HandsOutEveryIndexOnce)
+{
+	const size_t NR_OF_DESCRIPTORS = 100;
+	const size_t BATCH_SIZE = 16;
+	const size_t DESCRIPTOR_SIZE = 32;
+
+	ConcurrentDescriptorAllocator allocator;
+	allocator.Initialize({ 4096 }, DESCRIPTOR_SIZE, NR_OF_DESCRIPTORS, BATCH_SIZE);
+	DescriptorThreadCache cache = allocator.CreateThreadCache();
+
+	for (size_t i = 0; i < NR_OF_DESCRIPTORS; ++i)
+	{
+		ASSERT_EQ(cache.AllocateIndex(), i);
+		EXPECT_EQ(cache.GetDescriptorHandle(i).ptr, 4096 + i * DESCRIPTOR_SIZE);
+	}
+
+	EXPECT_EQ(cache.AllocateIndex(), size_t(-1));
+	EXPECT_EQ(allocator.NrOfPooledIndices(), 0);
+	EXPECT_THROW(cache.DeallocateIndex(NR_OF_DESCRIPTORS), std::runtime_error);
+
+	// Twice the batch size in the cache sends the oldest batch back
+	for (size_t i = 0; i < BATCH_SIZE * 2; ++i)
+		cache.DeallocateIndex(i);
+
+	EXPECT_EQ(cache.NrOfCachedIndices(), BATCH_SIZE);
+	EXPECT_EQ(allocator.NrOfPooledIndices(), BATCH_SIZE);
+
+	cache.Flush();
+	EXPECT_EQ(cache.NrOfCachedIndices(), 0);
+	EXPECT_EQ(allocator.NrOfPooledIndices(), BATCH_SIZE * 2);
+
+	std::vector<bool> seen(NR_OF_DESCRIPTORS, false);
+	for (size_t i = 0; i < BATCH_SIZE * 2; ++i)
+	{
+		size_t index = cache.AllocateIndex();
+		ASSERT_LT(index, BATCH_SIZE * 2);
+		EXPECT_FALSE(seen[index]);
+		seen[index] = true;
+	}
+
+	EXPECT_EQ(cache.AllocateIndex(), size_t(-1));
+}
+
+TEST(ConcurrentDescriptorAllocatorTest, RebalancesBetweenCaches)
+{
+	const size_t NR_OF_DESCRIPTORS = 256;
+	const size_t BATCH_SIZE = 32;
+
+	ConcurrentDescriptorAllocator allocator;
+	allocator.Initialize({ 0 }, 1, NR_OF_DESCRIPTORS, BATCH_SIZE);
+	DescriptorThreadCache allocatingCache = allocator.CreateThreadCache();
+	DescriptorThreadCache freeingCache = allocator.CreateThreadCache();
+
+	std::vector<size_t> indices;
+	for (size_t i = 0; i < NR_OF_DESCRIPTORS; ++i)
+		indices.push_back(allocatingCache.AllocateIndex());
+
+	// Just below the threshold where batches are returned on their own
+	for (size_t i = 0; i < BATCH_SIZE * 2 - 1; ++i)
+		freeingCache.DeallocateIndex(indices[i]);
+
+	EXPECT_EQ(allocatingCache.AllocateIndex(), size_t(-1));
+	freeingCache.Rebalance();
+	EXPECT_EQ(freeingCache.NrOfCachedIndices(), BATCH_SIZE - 1);
+	EXPECT_EQ(allocator.NrOfPooledIndices(), BATCH_SIZE);
+
+	for (size_t i = 0; i < BATCH_SIZE; ++i)
+		EXPECT_NE(allocatingCache.AllocateIndex(), size_t(-1));
+	EXPECT_EQ(allocatingCache.AllocateIndex(), size_t(-1));
+
+	{
+		DescriptorThreadCache movedCache = std::move(freeingCache);
+		EXPECT_EQ(movedCache.NrOfCachedIndices(), BATCH_SIZE - 1);
+	}
+
+	EXPECT_EQ(allocator.NrOfPooledIndices(), BATCH_SIZE - 1);
+}
+
+TEST(ConcurrentDescriptorAllocatorTest, AllocatesConcurrently)
+{
+	const size_t NR_OF_DESCRIPTORS = 4096;
+	const unsigned int NR_OF_THREADS = 8;
+	const size_t NR_OF_ROUNDS = 2000;
+	const size_t MAX_HELD = 96;
+
+	ConcurrentDescriptorAllocator allocator;
+	allocator.Initialize({ 0 }, 1, NR_OF_DESCRIPTORS, 16);
+
+	std::vector<std::atomic<bool>> inUse(NR_OF_DESCRIPTORS);
+	for (auto& flag : inUse)
+		flag.store(false);
+	std::atomic<size_t> nrOfDoubleAllocations = 0;
+
+	// Every thread both allocates and frees an uneven amount, so batches keep moving between them
+	auto worker = [&](unsigned int threadIndex)
+	{
+		DescriptorThreadCache cache = allocator.CreateThreadCache();
+		std::vector<size_t> held;
+
+		for (size_t round = 0; round < NR_OF_ROUNDS; ++round)
+		{
+			size_t toAllocate = (round * 7 + threadIndex * 13) % MAX_HELD;
+			for (size_t i = 0; i < toAllocate; ++i)
+			{
+				size_t index = cache.AllocateIndex();
+				if (index == size_t(-1))
+					break;
+
+				if (inUse[index].exchange(true))
+					++nrOfDoubleAllocations;
+				held.push_back(index);
+			}
+
+			size_t toKeep = (round + threadIndex) % 8;
+			while (held.size() > toKeep)
+			{
+				inUse[held.back()].store(false);
+				cache.DeallocateIndex(held.back());
+				held.pop_back();
+			}
+
+			if (round % 100 == 0)
+				cache.Rebalance();
+		}
+
+		for (size_t index : held)
+		{
+			inUse[index].store(false);
+			cache.DeallocateIndex(index);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int threadIndex = 0; threadIndex < NR_OF_THREADS; ++threadIndex)
+		threads.push_back(std::thread(worker, threadIndex));
+
+	for (auto& thread : threads)
+		thread.join();
+
+	EXPECT_EQ(nrOfDoubleAllocations.load(), 0);
+	ASSERT_EQ(allocator.NrOfPooledIndices(), NR_OF_DESCRIPTORS);
+
+	DescriptorThreadCache cache = allocator.CreateThreadCache();
+	std::vector<bool> seen(NR_OF_DESCRIPTORS, false);
+	for (size_t i = 0; i < NR_OF_DESCRIPTORS; ++i)
+	{
+		size_t index = cache.AllocateIndex();
+		ASSERT_LT(index, NR_OF_DESCRIPTORS);
+		EXPECT_FALSE(seen[index]);
+		seen[index] = true;
+	}
+}
+
+TEST(ConcurrentDescriptorAllocatorTest, ScalesAcrossThreads)
+{
+	const size_t NR_OF_DESCRIPTORS = 65536;
+	const size_t NR_OF_ROUNDS = 20000;
+	const size_t VIEWS_PER_ROUND = 32; // Roughly what a pass records before its views are released
+	const unsigned int MAX_THREADS = 16;
+
+	ConcurrentDescriptorAllocator allocator;
+	allocator.Initialize({ 0 }, 1, NR_OF_DESCRIPTORS);
+
+	// The same work against a single locked free list, as a baseline
+	std::mutex lockedListMutex;
+	std::vector<size_t> lockedList;
+	for (size_t i = NR_OF_DESCRIPTORS; i > 0; --i)
+		lockedList.push_back(i - 1);
+
+	for (unsigned int nrOfThreads = 1; nrOfThreads <= MAX_THREADS; nrOfThreads *= 2)
+	{
+		auto cachedWorker = [&]()
+		{
+			DescriptorThreadCache cache = allocator.CreateThreadCache();
+			size_t indices[VIEWS_PER_ROUND];
+
+			for (size_t round = 0; round < NR_OF_ROUNDS; ++round)
+			{
+				for (size_t i = 0; i < VIEWS_PER_ROUND; ++i)
+					indices[i] = cache.AllocateIndex();
+				for (size_t i = 0; i < VIEWS_PER_ROUND; ++i)
+					cache.DeallocateIndex(indices[i]);
+			}
+		};
+
+		auto lockedWorker = [&]()
+		{
+			size_t indices[VIEWS_PER_ROUND];
+
+			for (size_t round = 0; round < NR_OF_ROUNDS; ++round)
+			{
+				for (size_t i = 0; i < VIEWS_PER_ROUND; ++i)
+				{
+					std::lock_guard<std::mutex> lock(lockedListMutex);
+					indices[i] = lockedList.back();
+					lockedList.pop_back();
+				}
+
+				for (size_t i = 0; i < VIEWS_PER_ROUND; ++i)
+				{
+					std::lock_guard<std::mutex> lock(lockedListMutex);
+					lockedList.push_back(indices[i]);
+				}
+			}
+		};
+
+		auto timeThreads = [nrOfThreads](const std::function<void()>& worker)
+		{
+			auto startTime = std::chrono::steady_clock::now();
+			std::vector<std::thread> threads;
+			for (unsigned int threadIndex = 0; threadIndex < nrOfThreads; ++threadIndex)
+				threads.push_back(std::thread(worker));
+
+			for (auto& thread : threads)
+				thread.join();
+
+			std::chrono::duration<double, std::milli> duration =
+				std::chrono::steady_clock::now() - startTime;
+			return duration.count();
+		};
+
+		double cachedTime = timeThreads(cachedWorker);
+		double lockedTime = timeThreads(lockedWorker);
+		std::cout << "[          ] " << nrOfThreads << " threads: " << cachedTime <<
+			" ms with thread caches, " << lockedTime << " ms with a locked free list for " <<
+			NR_OF_ROUNDS * VIEWS_PER_ROUND * nrOfThreads << " allocations" << std::endl;
+
+		EXPECT_EQ(allocator.NrOfPooledIndices(), NR_OF_DESCRIPTORS);
+	}
+}
+
+TEST(ConcurrentDescriptorAllocatorTest, CreatesViewsConcurrently)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	ID3D12Resource* buffer = CreateBuffer(device, 65536, false);
+	if (buffer == nullptr)
+		FAIL() << "Cannot proceed with tests as a buffer could not be created";
+
+	const unsigned int NR_OF_THREADS = 4;
+	const size_t VIEWS_PER_THREAD = 250;
+
+	ConcurrentDescriptorAllocator allocator;
+	allocator.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, device,
+		NR_OF_THREADS * VIEWS_PER_THREAD, 32);
+
+	std::vector<std::vector<size_t>> createdIndices(NR_OF_THREADS);
+	auto worker = [&](unsigned int threadIndex)
+	{
+		DescriptorThreadCache cache = allocator.CreateThreadCache();
+		D3D12_SHADER_RESOURCE_VIEW_DESC desc = {};
+		desc.Format = DXGI_FORMAT_UNKNOWN;
+		desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+		desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		desc.Buffer.FirstElement = threadIndex;
+		desc.Buffer.NumElements = 1;
+		desc.Buffer.StructureByteStride = 4;
+		desc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
+
+		for (size_t i = 0; i < VIEWS_PER_THREAD; ++i)
+			createdIndices[threadIndex].push_back(cache.AllocateSRV(buffer, &desc));
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int threadIndex = 0; threadIndex < NR_OF_THREADS; ++threadIndex)
+		threads.push_back(std::thread(worker, threadIndex));
+
+	for (auto& thread : threads)
+		thread.join();
+
+	std::vector<bool> seen(NR_OF_THREADS * VIEWS_PER_THREAD, false);
+	for (auto& indices : createdIndices)
+	{
+		for (size_t index : indices)
+		{
+			ASSERT_LT(index, seen.size());
+			EXPECT_FALSE(seen[index]);
+			seen[index] = true;
+		}
+	}
+
+	buffer->Release();
+	device->Release();
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "pch.h"
+
+#include <cstring>
+#include <vector>
+
+#include "../Neo Steelgear Graphics Core/ContentHash.h"
+
+TEST(ContentHashTest, MatchesReferenceValues)
+{
+	const char* empty = "";
+	const char* shortText = "abc";
+	const char* longText = "Nobody inspects the spammish repetition";
+
+	EXPECT_EQ(HashContent(empty, 0), 0xEF46DB3751D8E999ULL);
+	EXPECT_EQ(HashContent(shortText, std::strlen(shortText)), 0x44BC2CF5AD770999ULL);
+	EXPECT_EQ(HashContent(longText, std::strlen(longText)), 0xFBCEA83C8A378BF1ULL);
+}
+
+TEST(ContentHashTest, DetectsDifferentContent)
+{
+	std::vector<unsigned char> first(1000, 0);
+	std::vector<unsigned char> second(1000, 0);
+	EXPECT_EQ(HashContent(first.data(), first.size()),
+		HashContent(second.data(), second.size()));
+	EXPECT_NE(HashContent(first.data(), first.size()),
+		HashContent(first.data(), first.size() - 1));
+	EXPECT_NE(HashContent(first.data(), first.size(), 0),
+		HashContent(first.data(), first.size(), 1));
+
+	for (size_t i = 0; i < second.size(); i += 97)
+	{
+		second[i] = 1;
+		EXPECT_NE(HashContent(first.data(), first.size()),
+			HashContent(second.data(), second.size()));
+		second[i] = 0;
+	}
+}
\ No newline at end of file
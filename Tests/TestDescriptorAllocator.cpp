@@ -1,6 +1,7 @@
 #include "pch.h"
 
 #include <array>
+#include <vector>
 #include <utility>
 
 #include "../Neo Steelgear Graphics Core/DescriptorAllocator.h"
@@ -59,13 +60,16 @@ void MassAllocateDescriptors(DescriptorAllocator& allocator, UINT nrOfDescriptor
 		switch (type)
 		{
 		case DescriptorType::CBV:
-			D3D12_CONSTANT_BUFFER_VIEW_DESC cbDesc;
+		{
+			D3D12_CONSTANT_BUFFER_VIEW_DESC cbDesc = {};
 			cbDesc.BufferLocation = resourceToAllocateFor->GetGPUVirtualAddress();
 			cbDesc.SizeInBytes = 256;
 			ASSERT_EQ(allocator.AllocateCBV(&cbDesc, i), i);
 			break;
+		}
 		case DescriptorType::SRV:
-			D3D12_SHADER_RESOURCE_VIEW_DESC srDesc;
+		{
+			D3D12_SHADER_RESOURCE_VIEW_DESC srDesc = {};
 			srDesc.Format = DXGI_FORMAT_UNKNOWN;
 			srDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
 			srDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
@@ -75,8 +79,10 @@ void MassAllocateDescriptors(DescriptorAllocator& allocator, UINT nrOfDescriptor
 			srDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
 			ASSERT_EQ(allocator.AllocateSRV(resourceToAllocateFor, &srDesc, i), i);
 			break;
+		}
 		case DescriptorType::UAV:
-			D3D12_UNORDERED_ACCESS_VIEW_DESC uaDesc;
+		{
+			D3D12_UNORDERED_ACCESS_VIEW_DESC uaDesc = {};
 			uaDesc.Format = DXGI_FORMAT_UNKNOWN;
 			uaDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
 			uaDesc.Buffer.FirstElement = 0;
@@ -87,6 +93,7 @@ void MassAllocateDescriptors(DescriptorAllocator& allocator, UINT nrOfDescriptor
 			ASSERT_EQ(allocator.AllocateUAV(resourceToAllocateFor, &uaDesc,
 				nullptr, i), i);
 			break;
+		}
 		case DescriptorType::RTV:
 			ASSERT_EQ(allocator.AllocateRTV(resourceToAllocateFor, nullptr, i), i);
 			break;
@@ -293,4 +300,407 @@ TEST(DescriptorAllocatorTest, ExpandsCorrectly)
 	device->Release();
 	infoQueue->Release();
 	resource->Release();
+}
+
+TEST(DescriptorAllocatorTest, AllocatesRangesCorrectly)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	ID3D12InfoQueue* infoQueue = nullptr;
+	HRESULT hr = device->QueryInterface(IID_PPV_ARGS(&infoQueue));
+	if (FAILED(hr))
+		FAIL() << "Cannot proceed with tests as a info queue interface could not be queried";
+
+	ID3D12DescriptorHeap* descriptorHeap = CreateDescriptorHeap(device,
+		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 100, false);
+	if (descriptorHeap == nullptr)
+		FAIL() << "Cannot proceed with tests as a descriptor heap could not be created";
+
+	ID3D12Resource* resource = CreateBuffer(device, 256, false);
+	if (resource == nullptr)
+		FAIL() << "Cannot proceed with tests as resource could not be created";
+
+	DescriptorAllocator descriptorAllocator;
+	descriptorAllocator.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+		device, descriptorHeap, 0, 100);
+	MassAllocateDescriptors(descriptorAllocator, 50, DescriptorType::SRV,
+		resource, 0);
+
+	for (size_t i = 10; i < 20; ++i)
+		descriptorAllocator.DeallocateDescriptor(i);
+
+	for (size_t i = 30; i < 35; ++i)
+		descriptorAllocator.DeallocateDescriptor(i);
+
+	// Free runs are now 10-19, 30-34 and 50-99
+	ASSERT_EQ(descriptorAllocator.AllocateRange(8), 10);
+	ASSERT_EQ(descriptorAllocator.AllocateRange(5, AllocationStrategy::BEST_FIT), 30);
+	ASSERT_EQ(descriptorAllocator.AllocateRange(20, AllocationStrategy::WORST_FIT), 50);
+	ASSERT_EQ(descriptorAllocator.AllocateRange(40), size_t(-1));
+	ASSERT_EQ(descriptorAllocator.AllocateRange(2, AllocationStrategy::BEST_FIT), 18);
+
+	// Freed ranges merge with the free indices around them
+	descriptorAllocator.DeallocateRange(10);
+	descriptorAllocator.DeallocateRange(18);
+	ASSERT_EQ(descriptorAllocator.AllocateRange(10), 10);
+	ASSERT_THROW(descriptorAllocator.DeallocateRange(11), std::runtime_error);
+
+	D3D12_CPU_DESCRIPTOR_HANDLE sources[4];
+	for (size_t i = 0; i < 4; ++i)
+		sources[i] = descriptorAllocator.GetDescriptorHandle(i * 2);
+
+	UINT64 nrOfMessagesBefore = infoQueue->GetNumMessagesAllowedByStorageFilter();
+	descriptorAllocator.CopyToRange(50, sources, 4);
+	descriptorAllocator.CopyToRange(50, sources, 4, 16);
+	UINT64 nrOfMessagesAfter = infoQueue->GetNumMessagesAllowedByStorageFilter();
+	ASSERT_EQ(nrOfMessagesAfter, nrOfMessagesBefore);
+	ASSERT_THROW(descriptorAllocator.CopyToRange(50, sources, 4, 17),
+		std::runtime_error);
+
+	DescriptorAllocator expandingAllocator;
+	expandingAllocator.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+		device, 16);
+	MassAllocateDescriptors(expandingAllocator, 10, DescriptorType::SRV,
+		resource, 0);
+	ASSERT_EQ(expandingAllocator.AllocateRange(20), 10);
+	ASSERT_EQ(expandingAllocator.NrOfStoredDescriptors(), 30);
+
+	descriptorHeap->Release();
+	resource->Release();
+	infoQueue->Release();
+	device->Release();
+}
+
+TEST(DescriptorAllocatorTest, DeduplicatesViews)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	ID3D12Resource* firstResource = CreateBuffer(device, 1024, false);
+	ID3D12Resource* secondResource = CreateBuffer(device, 1024, false);
+	if (firstResource == nullptr || secondResource == nullptr)
+		FAIL() << "Cannot proceed with tests as resources could not be created";
+
+	DescriptorAllocator descriptorAllocator;
+	descriptorAllocator.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+		device, 16);
+	ASSERT_EQ(descriptorAllocator.ViewDeduplicationEnabled(), false);
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srDesc = {};
+	srDesc.Format = DXGI_FORMAT_UNKNOWN;
+	srDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+	srDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srDesc.Buffer.FirstElement = 0;
+	srDesc.Buffer.NumElements = 4;
+	srDesc.Buffer.StructureByteStride = 256;
+	srDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
+
+	// Without deduplication every request is a new descriptor
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(firstResource, &srDesc), 0);
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(firstResource, &srDesc), 1);
+	descriptorAllocator.Reset();
+
+	descriptorAllocator.SetViewDeduplication(true);
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(firstResource, &srDesc), 0);
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(firstResource, &srDesc), 0);
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(secondResource, &srDesc), 1);
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(firstResource, nullptr), 2);
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(firstResource, nullptr), 2);
+	ASSERT_EQ(descriptorAllocator.AllocateUAV(firstResource, nullptr), 3);
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(firstResource, &srDesc, 5), 5);
+	ASSERT_EQ(descriptorAllocator.NrOfViewReferences(0), 2);
+	ASSERT_EQ(descriptorAllocator.NrOfViewReferences(5), 1);
+
+	srDesc.Buffer.NumElements = 2;
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(firstResource, &srDesc), 4);
+	srDesc.Buffer.NumElements = 4;
+
+	// Shared views are only released by their last deallocation
+	descriptorAllocator.DeallocateDescriptor(0);
+	ASSERT_EQ(descriptorAllocator.NrOfViewReferences(0), 1);
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(firstResource, &srDesc), 0);
+	descriptorAllocator.DeallocateDescriptor(0);
+	descriptorAllocator.DeallocateDescriptor(0);
+	ASSERT_EQ(descriptorAllocator.NrOfViewReferences(0), 0);
+
+	srDesc.Buffer.NumElements = 3;
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(firstResource, &srDesc), 0);
+	ASSERT_EQ(descriptorAllocator.NrOfViewReferences(0), 1);
+
+	// A reallocated view keeps its references but is no longer matched
+	descriptorAllocator.ReallocateView(2, secondResource);
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(firstResource, nullptr), 6);
+	descriptorAllocator.DeallocateDescriptor(2);
+	descriptorAllocator.DeallocateDescriptor(2);
+	ASSERT_EQ(descriptorAllocator.NrOfViewReferences(2), 0);
+
+	firstResource->Release();
+	secondResource->Release();
+	device->Release();
+}
+
+TEST(DescriptorAllocatorTest, GrowsByPagesWithoutCopying)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	ID3D12InfoQueue* infoQueue = nullptr;
+	HRESULT hr = device->QueryInterface(IID_PPV_ARGS(&infoQueue));
+	if (FAILED(hr))
+		FAIL() << "Cannot proceed with tests as a info queue interface could not be queried";
+
+	ID3D12Resource* resource = CreateBuffer(device, 256, false);
+	if (resource == nullptr)
+		FAIL() << "Cannot proceed with tests as resource could not be created";
+
+	const size_t DESCRIPTORS_PER_PAGE = 8;
+	DescriptorAllocator descriptorAllocator;
+	descriptorAllocator.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+		device, 10, DESCRIPTORS_PER_PAGE);
+	ASSERT_TRUE(descriptorAllocator.DescriptorsArePaged());
+
+	MassAllocateDescriptors(descriptorAllocator, 4, DescriptorType::SRV,
+		resource, 0);
+	D3D12_CPU_DESCRIPTOR_HANDLE firstHandle = descriptorAllocator.GetDescriptorHandle(0);
+	for (size_t i = 1; i < DESCRIPTORS_PER_PAGE; ++i)
+	{
+		ASSERT_EQ(descriptorAllocator.GetDescriptorHandle(i).ptr, firstHandle.ptr +
+			i * device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
+	}
+
+	// Growing adds pages, existing descriptors stay where they are
+	UINT64 nrOfMessagesBefore = infoQueue->GetNumMessagesAllowedByStorageFilter();
+	MassAllocateDescriptors(descriptorAllocator, 16, DescriptorType::SRV,
+		resource, 4);
+	UINT64 nrOfMessagesAfter = infoQueue->GetNumMessagesAllowedByStorageFilter();
+	ASSERT_EQ(nrOfMessagesAfter, nrOfMessagesBefore);
+	ASSERT_EQ(descriptorAllocator.NrOfStoredDescriptors(), 20);
+	ASSERT_EQ(descriptorAllocator.GetDescriptorHandle(0).ptr, firstHandle.ptr);
+
+	// Indices 20-23 are free but too few for the range, which starts on a new page
+	ASSERT_EQ(descriptorAllocator.AllocateRange(6), 24);
+	ASSERT_EQ(descriptorAllocator.AllocateRange(4), 20);
+	ASSERT_THROW(descriptorAllocator.AllocateRange(DESCRIPTORS_PER_PAGE + 1),
+		std::runtime_error);
+
+	D3D12_CPU_DESCRIPTOR_HANDLE sources[6];
+	for (size_t i = 0; i < 6; ++i)
+		sources[i] = descriptorAllocator.GetDescriptorHandle(i);
+
+	nrOfMessagesBefore = infoQueue->GetNumMessagesAllowedByStorageFilter();
+	descriptorAllocator.CopyToRange(24, sources, 6);
+	nrOfMessagesAfter = infoQueue->GetNumMessagesAllowedByStorageFilter();
+	ASSERT_EQ(nrOfMessagesAfter, nrOfMessagesBefore);
+
+	resource->Release();
+	infoQueue->Release();
+	device->Release();
+}
+
+TEST(DescriptorAllocatorTest, SkipsStoringDescriptions)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	ID3D12Resource* resource = CreateBuffer(device, 256, false);
+	if (resource == nullptr)
+		FAIL() << "Cannot proceed with tests as resource could not be created";
+
+	DescriptorAllocator descriptorAllocator;
+	descriptorAllocator.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+		device, 16);
+	ASSERT_EQ(descriptorAllocator.DescriptionStorageEnabled(), true);
+	MassAllocateDescriptors(descriptorAllocator, 2, DescriptorType::SRV,
+		resource, 0);
+
+	descriptorAllocator.SetDescriptionStorage(false);
+	descriptorAllocator.SetViewDeduplication(true);
+	MassAllocateDescriptors(descriptorAllocator, 2, DescriptorType::UAV,
+		resource, 2);
+
+	// Views without a stored description can neither be recreated nor shared
+	descriptorAllocator.ReallocateView(0, resource);
+	ASSERT_THROW(descriptorAllocator.ReallocateView(2, resource), std::runtime_error);
+
+	D3D12_CONSTANT_BUFFER_VIEW_DESC cbDesc = {};
+	cbDesc.BufferLocation = resource->GetGPUVirtualAddress();
+	cbDesc.SizeInBytes = 256;
+	ASSERT_EQ(descriptorAllocator.AllocateCBV(&cbDesc), 4);
+	ASSERT_EQ(descriptorAllocator.AllocateCBV(&cbDesc), 5);
+
+	descriptorAllocator.DeallocateDescriptor(1);
+	descriptorAllocator.DeallocateDescriptor(3);
+	descriptorAllocator.SetDescriptionStorage(true);
+	MassAllocateDescriptors(descriptorAllocator, 1, DescriptorType::SRV,
+		resource, 1);
+	descriptorAllocator.ReallocateView(1, resource);
+
+	resource->Release();
+	device->Release();
+}
+
+TEST(DescriptorAllocatorTest, AllocatesBatchesCorrectly)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	ID3D12InfoQueue* infoQueue = nullptr;
+	HRESULT hr = device->QueryInterface(IID_PPV_ARGS(&infoQueue));
+	if (FAILED(hr))
+		FAIL() << "Cannot proceed with tests as a info queue interface could not be queried";
+
+	ID3D12Resource* resource = CreateBuffer(device, 256 * 64, false);
+	if (resource == nullptr)
+		FAIL() << "Cannot proceed with tests as resource could not be created";
+
+	const size_t NR_OF_VIEWS = 64;
+	std::vector<D3D12_SHADER_RESOURCE_VIEW_DESC> srDescs(NR_OF_VIEWS);
+	std::vector<D3D12_UNORDERED_ACCESS_VIEW_DESC> uaDescs(NR_OF_VIEWS);
+	std::vector<DescriptorBatchView<D3D12_SHADER_RESOURCE_VIEW_DESC>> srViews(NR_OF_VIEWS);
+	std::vector<DescriptorBatchView<D3D12_UNORDERED_ACCESS_VIEW_DESC>> uaViews(NR_OF_VIEWS);
+	for (size_t i = 0; i < NR_OF_VIEWS; ++i)
+	{
+		srDescs[i].Format = DXGI_FORMAT_UNKNOWN;
+		srDescs[i].ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+		srDescs[i].Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		srDescs[i].Buffer.FirstElement = i;
+		srDescs[i].Buffer.NumElements = 1;
+		srDescs[i].Buffer.StructureByteStride = 256;
+		srDescs[i].Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
+		srViews[i].resource = resource;
+		srViews[i].desc = &srDescs[i];
+
+		uaDescs[i].Format = DXGI_FORMAT_UNKNOWN;
+		uaDescs[i].ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+		uaDescs[i].Buffer.FirstElement = i;
+		uaDescs[i].Buffer.NumElements = 1;
+		uaDescs[i].Buffer.StructureByteStride = 256;
+		uaDescs[i].Buffer.CounterOffsetInBytes = 0;
+		uaDescs[i].Buffer.Flags = D3D12_BUFFER_UAV_FLAG_NONE;
+		uaViews[i].resource = resource;
+		uaViews[i].desc = &uaDescs[i];
+	}
+
+	DescriptorAllocator descriptorAllocator;
+	descriptorAllocator.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+		device, 16);
+
+	// The owned heap grows once to fit the whole batch
+	std::vector<size_t> indices(NR_OF_VIEWS);
+	UINT64 nrOfMessagesBefore = infoQueue->GetNumMessagesAllowedByStorageFilter();
+	ASSERT_TRUE(descriptorAllocator.AllocateSRVs(srViews.data(), NR_OF_VIEWS,
+		indices.data()));
+	for (size_t i = 0; i < NR_OF_VIEWS; ++i)
+		ASSERT_EQ(indices[i], i);
+
+	for (size_t i = 40; i < 56; ++i)
+		descriptorAllocator.DeallocateDescriptor(i);
+
+	for (size_t i = 0; i < 16; ++i)
+		indices[i] = 40 + i;
+	ASSERT_TRUE(descriptorAllocator.AllocateSRVs(srViews.data(), 16, indices.data(),
+		indices.data()));
+	ASSERT_FALSE(descriptorAllocator.AllocateSRVs(srViews.data(), 16, indices.data(),
+		indices.data()));
+
+	for (size_t i = 0; i < 32; i += 2)
+		descriptorAllocator.DeallocateDescriptor(i);
+
+	// Without a free run the batch fills the scattered free indices
+	ASSERT_TRUE(descriptorAllocator.AllocateUAVs(uaViews.data(), 16, indices.data()));
+	for (size_t i = 0; i < 16; ++i)
+		ASSERT_EQ(indices[i], i * 2);
+
+	ASSERT_EQ(descriptorAllocator.NrOfStoredDescriptors(), NR_OF_VIEWS);
+	UINT64 nrOfMessagesAfter = infoQueue->GetNumMessagesAllowedByStorageFilter();
+	ASSERT_EQ(nrOfMessagesAfter, nrOfMessagesBefore);
+
+	ID3D12DescriptorHeap* descriptorHeap = CreateDescriptorHeap(device,
+		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 32, false);
+	if (descriptorHeap == nullptr)
+		FAIL() << "Cannot proceed with tests as a descriptor heap could not be created";
+
+	DescriptorAllocator externalAllocator;
+	externalAllocator.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+		device, descriptorHeap, 0, 32);
+	ASSERT_TRUE(externalAllocator.AllocateSRVs(srViews.data(), 20, indices.data()));
+	ASSERT_FALSE(externalAllocator.AllocateSRVs(srViews.data(), 20, indices.data()));
+	ASSERT_EQ(externalAllocator.NrOfStoredDescriptors(), 20);
+
+	// Duplicated indices are rejected without reserving any of them
+	std::vector<size_t> duplicatedIndices = { 20, 21, 20 };
+	ASSERT_FALSE(externalAllocator.AllocateSRVs(srViews.data(), 3, indices.data(),
+		duplicatedIndices.data()));
+	ASSERT_EQ(externalAllocator.NrOfStoredDescriptors(), 20);
+	ASSERT_TRUE(externalAllocator.AllocateSRVs(srViews.data(), 2, indices.data(),
+		duplicatedIndices.data()));
+	ASSERT_EQ(externalAllocator.NrOfStoredDescriptors(), 22);
+
+	descriptorHeap->Release();
+	resource->Release();
+	infoQueue->Release();
+	device->Release();
+}
+
+TEST(DescriptorAllocatorTest, RetiresDescriptorsAfterCompletion)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	ID3D12Resource* resource = CreateBuffer(device, 256, false);
+	if (resource == nullptr)
+		FAIL() << "Cannot proceed with tests as resource could not be created";
+
+	ID3D12Fence* fence = CreateFence(device, 0, D3D12_FENCE_FLAG_NONE);
+	if (fence == nullptr)
+		FAIL() << "Cannot proceed with tests as fence could not be created";
+
+	DescriptorAllocator descriptorAllocator;
+	descriptorAllocator.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+		device, 16);
+	MassAllocateDescriptors(descriptorAllocator, 8, DescriptorType::SRV,
+		resource, 0);
+
+	descriptorAllocator.RetireDescriptor(1);
+	descriptorAllocator.RetireDescriptor(2);
+	descriptorAllocator.SubmitRetirements(1);
+	descriptorAllocator.RetireDescriptor(5);
+	descriptorAllocator.SubmitRetirements(2);
+	ASSERT_EQ(descriptorAllocator.NrOfRetiredDescriptors(), 3);
+
+	// Retired descriptors are not reused before their work has completed
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(resource), 8);
+	descriptorAllocator.UpdateCompletedValue(1);
+	ASSERT_EQ(descriptorAllocator.NrOfRetiredDescriptors(), 1);
+	size_t firstReused = descriptorAllocator.AllocateSRV(resource);
+	size_t secondReused = descriptorAllocator.AllocateSRV(resource);
+	ASSERT_TRUE((firstReused == 1 && secondReused == 2) ||
+		(firstReused == 2 && secondReused == 1));
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(resource), 9);
+
+	fence->Signal(2);
+	descriptorAllocator.UpdateCompletedValue(fence);
+	ASSERT_EQ(descriptorAllocator.NrOfRetiredDescriptors(), 0);
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(resource), 5);
+
+	// Shared views are retired by their last reference only
+	descriptorAllocator.SetViewDeduplication(true);
+	size_t sharedIndex = descriptorAllocator.AllocateSRV(resource);
+	ASSERT_EQ(descriptorAllocator.AllocateSRV(resource), sharedIndex);
+	descriptorAllocator.RetireDescriptor(sharedIndex);
+	ASSERT_EQ(descriptorAllocator.NrOfRetiredDescriptors(), 0);
+	descriptorAllocator.RetireDescriptor(sharedIndex);
+	ASSERT_EQ(descriptorAllocator.NrOfRetiredDescriptors(), 1);
+	ASSERT_NE(descriptorAllocator.AllocateSRV(resource), sharedIndex);
+
+	fence->Release();
+	resource->Release();
+	device->Release();
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include <array>
 #include <utility>
 #include <functional>
+#include <thread>
+#include <chrono>
+#include <iostream>
 
 #include "../Neo Steelgear Graphics Core/FrameBufferComponent.h"
 #include "../Neo Steelgear Graphics Core/MultiHeapAllocatorGPU.h"
@@ -378,4 +381,130 @@ TEST(FrameBufferComponentTest, CorrectlyUpdatesBuffers)
 	InitializationHelper(UpdateBuffers<2>);
 	InitializationHelper(UpdateBuffers<3>);
 	InitializationHelper(UpdateBuffers<4>);
+}
+
+void CheckConcurrentUpdates(ID3D12Device* device,
+	FrameBufferComponent<2>& bufferComponent, const std::vector<ResourceIndex>& indices,
+	unsigned char* data, size_t bufferSize)
+{
+	size_t totalSize = indices.size() * bufferSize;
+
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device,
+		D3D12_COMMAND_LIST_TYPE_COPY))
+	{
+		FAIL() << "Cannot proceed with tests as command structure could not be created";
+	}
+
+	ResourceUploader uploader;
+	uploader.Initialize(device, totalSize, AllocationStrategy::FIRST_FIT);
+	UINT64 fenceValue = 0;
+	ID3D12Fence* fence = CreateFence(device, fenceValue, D3D12_FENCE_FLAG_NONE);
+	ID3D12Resource* readbackBuffer = CreateBuffer(device, totalSize, true);
+	if (readbackBuffer == nullptr)
+		FAIL() << "Cannot proceed with tests as readback buffer cannot be created";
+
+	for (unsigned int frame = 0; frame < 2; ++frame)
+	{
+		bufferComponent.PerformUpdates(commandStructure.list, uploader);
+		ExecuteGraphicsCommandList(commandStructure.list, commandStructure.queue);
+		FlushCommandQueue(fenceValue, commandStructure.queue, fence);
+		uploader.RestoreUsedMemory();
+		commandStructure.allocator->Reset();
+		commandStructure.list->Reset(commandStructure.allocator, nullptr);
+
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			auto handle = bufferComponent.GetBufferHandle(indices[i]);
+			commandStructure.list->CopyBufferRegion(readbackBuffer, i * bufferSize,
+				handle.resource, handle.startOffset, bufferSize);
+		}
+
+		ExecuteGraphicsCommandList(commandStructure.list, commandStructure.queue);
+		FlushCommandQueue(fenceValue, commandStructure.queue, fence);
+		CheckResourceData(readbackBuffer, 0, data, 0, static_cast<int>(totalSize));
+		commandStructure.allocator->Reset();
+		commandStructure.list->Reset(commandStructure.allocator, nullptr);
+		bufferComponent.SwapFrame();
+	}
+
+	readbackBuffer->Release();
+	fence->Release();
+}
+
+TEST(FrameBufferComponentTest, ScalesConcurrentUpdates)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	const unsigned int NR_OF_BUFFERS = 16384;
+	const size_t BUFFER_SIZE = 256;
+	const unsigned int NR_OF_ROUNDS = 20;
+	const unsigned int MAX_THREADS = 16;
+
+	MultiHeapAllocatorGPU heapAllocator;
+	heapAllocator.Initialize(device);
+
+	ResourceComponentMemoryInfo memoryInfo;
+	memoryInfo.initialMinimumHeapSize = NR_OF_BUFFERS * BUFFER_SIZE;
+	memoryInfo.expansionMinimumSize = 0;
+	memoryInfo.heapAllocator = &heapAllocator;
+	BufferComponentInfo componentInfo = { { BUFFER_SIZE, BUFFER_SIZE },
+		false, memoryInfo };
+
+	BufferViewDesc bufferSRVDesc(ViewType::SRV);
+	std::vector<DescriptorAllocationInfo<BufferViewDesc>> descriptorAllocationInfo =
+		{ DescriptorAllocationInfo<BufferViewDesc>(ViewType::SRV,
+			bufferSRVDesc, NR_OF_BUFFERS) };
+
+	FrameBufferComponent<2> bufferComponent;
+	bufferComponent.Initialize(device, UpdateType::COPY_UPDATE, componentInfo,
+		descriptorAllocationInfo);
+
+	std::vector<ResourceIndex> indices;
+	for (unsigned int i = 0; i < NR_OF_BUFFERS; ++i)
+		indices.push_back(bufferComponent.CreateBuffer(1));
+
+	std::vector<unsigned char> data(NR_OF_BUFFERS * BUFFER_SIZE);
+
+	for (unsigned int nrOfThreads = 1; nrOfThreads <= MAX_THREADS; nrOfThreads *= 2)
+	{
+		// Each producer owns a contiguous range of buffers, like a job system splitting its objects
+		auto producer = [&](unsigned int threadIndex)
+		{
+			unsigned int start = NR_OF_BUFFERS / nrOfThreads * threadIndex;
+			unsigned int end = NR_OF_BUFFERS / nrOfThreads * (threadIndex + 1);
+
+			for (unsigned int round = 0; round < NR_OF_ROUNDS; ++round)
+			{
+				for (unsigned int i = start; i < end; ++i)
+				{
+					unsigned char* bufferData = data.data() + i * BUFFER_SIZE;
+					memset(bufferData, static_cast<unsigned char>(i + round + nrOfThreads),
+						BUFFER_SIZE);
+					bufferComponent.SetUpdateData(indices[i], bufferData);
+				}
+			}
+		};
+
+		auto startTime = std::chrono::steady_clock::now();
+		std::vector<std::thread> threads;
+		for (unsigned int threadIndex = 0; threadIndex < nrOfThreads; ++threadIndex)
+			threads.push_back(std::thread(producer, threadIndex));
+
+		for (auto& thread : threads)
+			thread.join();
+
+		std::chrono::duration<double, std::milli> duration =
+			std::chrono::steady_clock::now() - startTime;
+		std::cout << "[          ] " << nrOfThreads << " producer threads: " <<
+			duration.count() << " ms for " << NR_OF_BUFFERS * NR_OF_ROUNDS <<
+			" updates" << std::endl;
+
+		CheckConcurrentUpdates(device, bufferComponent, indices, data.data(),
+			BUFFER_SIZE);
+	}
+
+	device->Release();
 }
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "pch.h"
+
+#include <thread>
+#include <algorithm>
+
+#include "../Neo Steelgear Graphics Core/FrameDirtyBits.h"
+
+TEST(FrameDirtyBitsTest, DefaultInitialisable)
+{
+	FrameDirtyBits dirtyBits;
+	EXPECT_EQ(dirtyBits.Empty(), true);
+}
+
+TEST(FrameDirtyBitsTest, MarksFramesInFlight)
+{
+	FrameDirtyBits dirtyBits;
+	dirtyBits.Initialize(3);
+	dirtyBits.Mark(5, 3);
+	dirtyBits.Mark(700);
+	EXPECT_EQ(dirtyBits.Marked(5), true);
+	EXPECT_EQ(dirtyBits.Marked(700), true);
+	EXPECT_EQ(dirtyBits.Marked(6), false);
+	EXPECT_EQ(dirtyBits.Marked(100000), false);
+
+	std::vector<size_t> indices;
+	dirtyBits.GetCurrentFrame(indices);
+	EXPECT_EQ(indices, std::vector<size_t>({ 5, 700 }));
+
+	indices.clear();
+	dirtyBits.TakeCurrentFrame(indices);
+	EXPECT_EQ(indices, std::vector<size_t>({ 5, 700 }));
+	EXPECT_EQ(dirtyBits.Marked(700), false);
+
+	// Index 5 was marked for every frame in flight, so it is returned once per frame
+	for (unsigned int frame = 0; frame < 2; ++frame)
+	{
+		dirtyBits.AdvanceFrame();
+		indices.clear();
+		dirtyBits.TakeCurrentFrame(indices);
+		EXPECT_EQ(indices, std::vector<size_t>({ 5 }));
+	}
+
+	EXPECT_EQ(dirtyBits.Empty(), true);
+	dirtyBits.AdvanceFrame();
+	indices.clear();
+	dirtyBits.TakeCurrentFrame(indices);
+	EXPECT_EQ(indices.empty(), true);
+}
+
+TEST(FrameDirtyBitsTest, MarksNextFrameAndClears)
+{
+	FrameDirtyBits dirtyBits;
+	dirtyBits.Initialize(2);
+	dirtyBits.MarkNextFrame(64);
+	dirtyBits.Mark(63, 2);
+
+	std::vector<size_t> indices;
+	dirtyBits.TakeCurrentFrame(indices);
+	EXPECT_EQ(indices, std::vector<size_t>({ 63 }));
+
+	dirtyBits.Clear(63);
+	dirtyBits.AdvanceFrame();
+	indices.clear();
+	dirtyBits.TakeCurrentFrame(indices);
+	EXPECT_EQ(indices, std::vector<size_t>({ 64 }));
+	EXPECT_EQ(dirtyBits.Empty(), true);
+
+	FrameDirtyBits singleFrame;
+	singleFrame.Initialize(1);
+	singleFrame.MarkNextFrame(3);
+	indices.clear();
+	singleFrame.TakeCurrentFrame(indices);
+	EXPECT_EQ(indices, std::vector<size_t>({ 3 }));
+}
+
+TEST(FrameDirtyBitsTest, FindsSparseBitsInLargeSets)
+{
+	const size_t NR_OF_BITS = 100000;
+	FrameDirtyBits dirtyBits;
+	dirtyBits.Initialize(2);
+	dirtyBits.Reserve(NR_OF_BITS);
+
+	std::vector<size_t> expected = { 0, 1, 255, 256, 4097, 50000, 99999 };
+	for (size_t index : expected)
+		dirtyBits.Mark(index);
+
+	std::vector<size_t> indices;
+	dirtyBits.TakeCurrentFrame(indices);
+	EXPECT_EQ(indices, expected);
+	EXPECT_EQ(dirtyBits.Empty(), true);
+
+	// Growing keeps bits that were already marked
+	dirtyBits.Mark(12, 2);
+	dirtyBits.Mark(NR_OF_BITS * 4);
+	indices.clear();
+	dirtyBits.TakeCurrentFrame(indices);
+	EXPECT_EQ(indices, std::vector<size_t>({ 12, NR_OF_BITS * 4 }));
+	dirtyBits.AdvanceFrame();
+	indices.clear();
+	dirtyBits.TakeCurrentFrame(indices);
+	EXPECT_EQ(indices, std::vector<size_t>({ 12 }));
+}
+
+TEST(FrameDirtyBitsTest, MarksConcurrently)
+{
+	const size_t NR_OF_BITS = 64 * 1024;
+	const unsigned int NR_OF_THREADS = 8;
+	FrameDirtyBits dirtyBits;
+	dirtyBits.Initialize(2);
+	dirtyBits.Reserve(NR_OF_BITS);
+
+	// Interleaved indices make every thread write to the same words
+	std::vector<std::thread> threads;
+	for (unsigned int threadIndex = 0; threadIndex < NR_OF_THREADS; ++threadIndex)
+	{
+		threads.push_back(std::thread([&dirtyBits, threadIndex]()
+		{
+			for (size_t i = threadIndex; i < NR_OF_BITS; i += NR_OF_THREADS)
+			{
+				dirtyBits.Mark(i, 2);
+				if (i % 3 == 0)
+					dirtyBits.Clear(i);
+			}
+		}));
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	std::vector<size_t> expected;
+	for (size_t i = 0; i < NR_OF_BITS; ++i)
+	{
+		if (i % 3 != 0)
+			expected.push_back(i);
+	}
+
+	for (unsigned int frame = 0; frame < 2; ++frame)
+	{
+		std::vector<size_t> indices;
+		dirtyBits.TakeCurrentFrame(indices);
+		EXPECT_EQ(indices, expected);
+		dirtyBits.AdvanceFrame();
+	}
+
+	EXPECT_EQ(dirtyBits.Empty(), true);
+}
\ No newline at end of file
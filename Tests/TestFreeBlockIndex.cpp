@@ -0,0 +1,106 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "../Neo Steelgear Graphics Core/FreeBlockIndex.h"
+
+TEST(FreeBlockIndexTest, DefaultInitialisable)
+{
+	FreeBlockIndex index;
+	EXPECT_EQ(index.NrOfChunks(), 0);
+	EXPECT_EQ(index.FindChunk(1), size_t(-1));
+	EXPECT_EQ(index.FindChunk(0), size_t(-1));
+}
+
+TEST(FreeBlockIndexTest, FindsFirstChunkThatFits)
+{
+	FreeBlockIndex index;
+	index.AddChunk(100);
+	index.AddChunk(500);
+	index.AddChunk(200);
+	index.AddChunk(1000);
+	index.AddChunk(300);
+	EXPECT_EQ(index.NrOfChunks(), 5);
+
+	EXPECT_EQ(index.FindChunk(50), 0);
+	EXPECT_EQ(index.FindChunk(150), 1);
+	EXPECT_EQ(index.FindChunk(600), 3);
+	EXPECT_EQ(index.FindChunk(1001), size_t(-1));
+	EXPECT_EQ(index.FindChunk(0, 4), 4);
+
+	// Later chunks are searched if an earlier one fit by size but not by alignment
+	EXPECT_EQ(index.FindChunk(150, 2), 2);
+	EXPECT_EQ(index.FindChunk(250, 2), 3);
+	EXPECT_EQ(index.FindChunk(250, 4), 4);
+	EXPECT_EQ(index.FindChunk(250, 5), size_t(-1));
+
+	index.UpdateChunk(1, 0);
+	index.UpdateChunk(3, 50);
+	EXPECT_EQ(index.GetLargestFreeBlock(3), 50);
+	EXPECT_EQ(index.FindChunk(150), 2);
+	EXPECT_EQ(index.FindChunk(250), 4);
+	EXPECT_EQ(index.FindChunk(400), size_t(-1));
+
+	index.UpdateChunk(0, 2000);
+	EXPECT_EQ(index.FindChunk(1500), 0);
+	EXPECT_THROW(index.UpdateChunk(5, 10), std::runtime_error);
+}
+
+TEST(FreeBlockIndexTest, TruncatesAndClears)
+{
+	FreeBlockIndex index;
+	for (size_t i = 0; i < 9; ++i)
+		index.AddChunk(i * 10);
+
+	EXPECT_EQ(index.FindChunk(80), 8);
+	index.Truncate(3);
+	EXPECT_EQ(index.NrOfChunks(), 3);
+	EXPECT_EQ(index.FindChunk(30), size_t(-1));
+	EXPECT_EQ(index.FindChunk(0, 3), size_t(-1));
+	EXPECT_EQ(index.FindChunk(20), 2);
+
+	index.AddChunk(500);
+	EXPECT_EQ(index.FindChunk(30), 3);
+
+	FreeBlockIndex moved = std::move(index);
+	EXPECT_EQ(moved.NrOfChunks(), 4);
+	EXPECT_EQ(index.NrOfChunks(), 0);
+
+	moved.Clear();
+	EXPECT_EQ(moved.NrOfChunks(), 0);
+	EXPECT_EQ(moved.FindChunk(0), size_t(-1));
+}
+
+TEST(FreeBlockIndexTest, MatchesLinearSearch)
+{
+	const size_t NR_OF_CHUNKS = 37;
+	FreeBlockIndex index;
+	std::vector<size_t> largestBlocks;
+
+	for (size_t i = 0; i < NR_OF_CHUNKS; ++i)
+	{
+		largestBlocks.push_back((i * 7919) % 1000);
+		index.AddChunk(largestBlocks.back());
+	}
+
+	for (size_t round = 0; round < 500; ++round)
+	{
+		size_t chunk = (round * 31) % NR_OF_CHUNKS;
+		largestBlocks[chunk] = (round * 104729) % 1000;
+		index.UpdateChunk(chunk, largestBlocks[chunk]);
+
+		size_t blockSize = (round * 7) % 1000;
+		size_t startChunk = round % NR_OF_CHUNKS;
+		size_t expected = size_t(-1);
+		for (size_t i = startChunk; i < NR_OF_CHUNKS; ++i)
+		{
+			if (largestBlocks[i] >= blockSize)
+			{
+				expected = i;
+				break;
+			}
+		}
+
+		ASSERT_EQ(index.FindChunk(blockSize, startChunk), expected);
+	}
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <array>
+#include <vector>
 
 #include "../Neo Steelgear Graphics Core/HeapHelper.h"
 
@@ -54,6 +55,8 @@ void TestAllocation(HeapHelper<T>& helper, size_t allocationSize,
 
 	if(index != size_t(-1))
 		ASSERT_EQ(expectedChunkStart, helper.GetStartOfChunk(index));
+
+	ASSERT_EQ(helper.GetLargestFreeChunkSize(), helper.GetLargestAvailableSize(1));
 }
 
 TEST(HeapHelperTest, HandlesSimpleAllocations)
@@ -167,6 +170,7 @@ void TestDeallocation(HeapHelper<T>& helper, size_t indexToRemove)
 	size_t totalSizeBefore = helper.TotalSize();
 	helper.DeallocateChunk(indexToRemove);
 	ASSERT_EQ(totalSizeBefore, helper.TotalSize());
+	ASSERT_EQ(helper.GetLargestFreeChunkSize(), helper.GetLargestAvailableSize(1));
 }
 
 TEST(HeapHelperTest, HandlesDeallocations)
@@ -315,6 +319,39 @@ TEST(HeapHelperTest, HandlesAdvancedCombinedAllocationsAndDeallocations)
 	TestAllocation(stringHelper, 64, strategy, 256, 9, 768);
 }
 
+TEST(HeapHelperTest, TracksLargestFreeChunk)
+{
+	HeapHelper<int> helper;
+	helper.Initialize(1000);
+	EXPECT_EQ(helper.GetLargestFreeChunkSize(), 1000);
+
+	std::vector<size_t> allocated;
+	for (size_t i = 0; i < 200; ++i)
+	{
+		size_t index = helper.AllocateChunk((i * 37) % 50 + 1,
+			AllocationStrategy::FIRST_FIT, size_t(1) << (i % 4));
+		if (index != size_t(-1))
+			allocated.push_back(index);
+
+		// Every third round frees an allocation from the middle to fragment the heap
+		if (i % 3 == 2 && !allocated.empty())
+		{
+			size_t toFree = (i * 7919) % allocated.size();
+			helper.DeallocateChunk(allocated[toFree]);
+			allocated.erase(allocated.begin() + toFree);
+		}
+
+		ASSERT_EQ(helper.GetLargestFreeChunkSize(), helper.GetLargestAvailableSize(1));
+	}
+
+	helper.AddChunk(2000, true);
+	EXPECT_GE(helper.GetLargestFreeChunkSize(), 2000);
+	EXPECT_EQ(helper.GetLargestFreeChunkSize(), helper.GetLargestAvailableSize(1));
+
+	helper.ClearHeap();
+	EXPECT_EQ(helper.GetLargestFreeChunkSize(), 3000);
+}
+
 template<typename T>
 void CompareMovedHelpers(const HeapHelper<T>& toCompareTo, const HeapHelper<T>& movedTo,
 	const HeapHelper<T>& movedFrom, size_t expectedNrOfChunks)
@@ -0,0 +1,139 @@
+#include "pch.h"
+
+#include <vector>
+#include <cstring>
+
+#include "../Neo Steelgear Graphics Core/MipGeneration.h"
+
+std::vector<MipLevel> CreateMipLevels(std::vector<std::vector<unsigned char>>& storage,
+	unsigned int width, unsigned int height, size_t texelSize)
+{
+	std::vector<MipLevel> toReturn;
+	while (width > 1 || height > 1)
+	{
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+		storage.push_back(std::vector<unsigned char>(width * height * texelSize));
+
+		MipLevel level;
+		level.data = storage.back().data();
+		level.width = width;
+		level.height = height;
+		toReturn.push_back(level);
+	}
+
+	return toReturn;
+}
+
+TEST(MipGenerationTest, DefaultInitialisable)
+{
+	MipGenerator generator;
+}
+
+TEST(MipGenerationTest, ReportsSupportedFormats)
+{
+	EXPECT_EQ(MipGenerator::FormatSupported(DXGI_FORMAT_R8G8B8A8_UNORM), true);
+	EXPECT_EQ(MipGenerator::FormatSupported(DXGI_FORMAT_B8G8R8A8_UNORM_SRGB), true);
+	EXPECT_EQ(MipGenerator::FormatSupported(DXGI_FORMAT_R32_FLOAT), true);
+	EXPECT_EQ(MipGenerator::FormatSupported(DXGI_FORMAT_R32_UINT), false);
+	EXPECT_THROW(MipGenerator(DXGI_FORMAT_R16G16_FLOAT, MipFilter::BOX),
+		std::runtime_error);
+
+	EXPECT_EQ(MipGenerator(DXGI_FORMAT_R8G8_UNORM, MipFilter::BOX).GetTexelSize(), 2);
+	EXPECT_EQ(MipGenerator(DXGI_FORMAT_R32G32B32A32_FLOAT,
+		MipFilter::KAISER).GetTexelSize(), 16);
+}
+
+TEST(MipGenerationTest, AveragesWithBoxFilter)
+{
+	const unsigned int WIDTH = 4;
+	const unsigned int HEIGHT = 2;
+	float source[WIDTH * HEIGHT] = { 1.0f, 3.0f, 5.0f, 7.0f,
+		3.0f, 5.0f, 7.0f, 9.0f };
+
+	std::vector<std::vector<unsigned char>> storage;
+	auto levels = CreateMipLevels(storage, WIDTH, HEIGHT, sizeof(float));
+	ASSERT_EQ(levels.size(), 2);
+
+	MipGenerator generator(DXGI_FORMAT_R32_FLOAT, MipFilter::BOX);
+	generator.GenerateMips(reinterpret_cast<unsigned char*>(source), WIDTH,
+		HEIGHT, levels);
+
+	float firstLevel[2];
+	float secondLevel;
+	std::memcpy(firstLevel, levels[0].data, sizeof(firstLevel));
+	std::memcpy(&secondLevel, levels[1].data, sizeof(secondLevel));
+	EXPECT_FLOAT_EQ(firstLevel[0], 3.0f);
+	EXPECT_FLOAT_EQ(firstLevel[1], 7.0f);
+	EXPECT_FLOAT_EQ(secondLevel, 5.0f);
+}
+
+TEST(MipGenerationTest, AveragesSRGBInLinearSpace)
+{
+	unsigned char source[] = { 0, 0, 0, 0, 255, 255, 255, 255 };
+	std::vector<std::vector<unsigned char>> storage;
+	auto levels = CreateMipLevels(storage, 2, 1, 4);
+
+	MipGenerator linearGenerator(DXGI_FORMAT_R8G8B8A8_UNORM, MipFilter::BOX);
+	linearGenerator.GenerateMips(source, 2, 1, levels);
+	for (size_t i = 0; i < 4; ++i)
+		EXPECT_EQ(levels[0].data[i], 128);
+
+	MipGenerator sRGBGenerator(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, MipFilter::BOX);
+	sRGBGenerator.GenerateMips(source, 2, 1, levels);
+	for (size_t i = 0; i < 3; ++i)
+		EXPECT_EQ(levels[0].data[i], 188);
+
+	EXPECT_EQ(levels[0].data[3], 128); // Alpha is always linear
+}
+
+TEST(MipGenerationTest, PreservesConstantImages)
+{
+	const unsigned int WIDTH = 37;
+	const unsigned int HEIGHT = 20;
+	std::vector<unsigned char> source(WIDTH * HEIGHT * 4);
+	for (size_t i = 0; i < source.size(); ++i)
+		source[i] = static_cast<unsigned char>(40 + (i % 4) * 50);
+
+	for (auto filter : { MipFilter::BOX, MipFilter::KAISER })
+	{
+		for (auto format : { DXGI_FORMAT_R8G8B8A8_UNORM,
+			DXGI_FORMAT_B8G8R8A8_UNORM_SRGB })
+		{
+			std::vector<std::vector<unsigned char>> storage;
+			auto levels = CreateMipLevels(storage, WIDTH, HEIGHT, 4);
+			MipGenerator generator(format, filter);
+			generator.GenerateMips(source.data(), WIDTH, HEIGHT, levels);
+
+			for (auto& level : levels)
+			{
+				for (size_t i = 0; i < level.width * level.height * 4; ++i)
+					ASSERT_EQ(level.data[i], source[i % 4]);
+			}
+		}
+	}
+}
+
+TEST(MipGenerationTest, ThreadingDoesNotChangeResults)
+{
+	const unsigned int WIDTH = 512;
+	const unsigned int HEIGHT = 256;
+	std::vector<unsigned char> source(WIDTH * HEIGHT * 4);
+	for (size_t i = 0; i < source.size(); ++i)
+		source[i] = static_cast<unsigned char>((i * 31) ^ (i >> 7));
+
+	for (auto filter : { MipFilter::BOX, MipFilter::KAISER })
+	{
+		std::vector<std::vector<unsigned char>> singleStorage;
+		std::vector<std::vector<unsigned char>> multiStorage;
+		auto singleLevels = CreateMipLevels(singleStorage, WIDTH, HEIGHT, 4);
+		auto multiLevels = CreateMipLevels(multiStorage, WIDTH, HEIGHT, 4);
+
+		MipGenerator singleThreaded(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, filter, 1);
+		MipGenerator multiThreaded(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, filter, 8);
+		singleThreaded.GenerateMips(source.data(), WIDTH, HEIGHT, singleLevels);
+		multiThreaded.GenerateMips(source.data(), WIDTH, HEIGHT, multiLevels);
+
+		EXPECT_EQ(singleStorage, multiStorage);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "pch.h"
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#include "../Neo Steelgear Graphics Core/PixelConversion.h"
+
+const InstructionSet INSTRUCTION_SETS[] = { InstructionSet::SCALAR,
+	InstructionSet::SSE, InstructionSet::AVX2 };
+
+std::vector<unsigned char> ConvertTestRow(SourceFormat sourceFormat,
+	DXGI_FORMAT destinationFormat, size_t destinationTexelSize,
+	InstructionSet instructionSet, const std::vector<unsigned char>& source,
+	size_t nrOfTexels)
+{
+	std::vector<unsigned char> toReturn(nrOfTexels * destinationTexelSize + 1, 0xCD);
+	PixelConverter converter(sourceFormat, destinationFormat,
+		destinationTexelSize, instructionSet);
+	EXPECT_EQ(converter.ConversionNeeded(), true);
+	converter.ConvertRow(toReturn.data(), source.data(), nrOfTexels);
+
+	// Nothing may be written past the end of the row
+	EXPECT_EQ(toReturn.back(), 0xCD);
+	toReturn.pop_back();
+	return toReturn;
+}
+
+TEST(PixelConversionTest, DefaultInitialisable)
+{
+	PixelConverter converter;
+	EXPECT_EQ(converter.ConversionNeeded(), false);
+}
+
+TEST(PixelConversionTest, ReportsSourceTexelSizes)
+{
+	EXPECT_EQ(GetSourceTexelSize(SourceFormat::SAME_AS_DESTINATION, 16), 16);
+	EXPECT_EQ(GetSourceTexelSize(SourceFormat::R8G8B8A8, 4), 4);
+	EXPECT_EQ(GetSourceTexelSize(SourceFormat::B8G8R8A8, 4), 4);
+	EXPECT_EQ(GetSourceTexelSize(SourceFormat::R8G8B8, 4), 3);
+	EXPECT_EQ(GetSourceTexelSize(SourceFormat::FLOAT32, 8), 16);
+}
+
+TEST(PixelConversionTest, SkipsMatchingFormats)
+{
+	EXPECT_EQ(PixelConverter(SourceFormat::SAME_AS_DESTINATION,
+		DXGI_FORMAT_R32_UINT, 4).ConversionNeeded(), false);
+	EXPECT_EQ(PixelConverter(SourceFormat::R8G8B8A8,
+		DXGI_FORMAT_R8G8B8A8_UNORM, 4).ConversionNeeded(), false);
+	EXPECT_EQ(PixelConverter(SourceFormat::B8G8R8A8,
+		DXGI_FORMAT_B8G8R8A8_UNORM_SRGB, 4).ConversionNeeded(), false);
+}
+
+TEST(PixelConversionTest, ThrowsOnUnsupportedFormats)
+{
+	EXPECT_THROW(PixelConverter(SourceFormat::R8G8B8,
+		DXGI_FORMAT_R32_UINT, 4), std::runtime_error);
+	EXPECT_THROW(PixelConverter(SourceFormat::B8G8R8A8,
+		DXGI_FORMAT_R16G16_FLOAT, 4), std::runtime_error);
+	EXPECT_THROW(PixelConverter(SourceFormat::FLOAT32,
+		DXGI_FORMAT_R8G8B8A8_UNORM, 4), std::runtime_error);
+}
+
+TEST(PixelConversionTest, SwapsRedAndBlue)
+{
+	for (auto instructionSet : INSTRUCTION_SETS)
+	{
+		for (size_t nrOfTexels = 0; nrOfTexels < 70; ++nrOfTexels)
+		{
+			std::vector<unsigned char> source(nrOfTexels * 4);
+			for (size_t i = 0; i < source.size(); ++i)
+				source[i] = static_cast<unsigned char>(i * 7 + 3);
+
+			auto result = ConvertTestRow(SourceFormat::R8G8B8A8,
+				DXGI_FORMAT_B8G8R8A8_UNORM, 4, instructionSet, source, nrOfTexels);
+			auto swappedBack = ConvertTestRow(SourceFormat::B8G8R8A8,
+				DXGI_FORMAT_R8G8B8A8_UNORM, 4, instructionSet, result, nrOfTexels);
+
+			for (size_t i = 0; i < nrOfTexels; ++i)
+			{
+				ASSERT_EQ(result[i * 4 + 0], source[i * 4 + 2]);
+				ASSERT_EQ(result[i * 4 + 1], source[i * 4 + 1]);
+				ASSERT_EQ(result[i * 4 + 2], source[i * 4 + 0]);
+				ASSERT_EQ(result[i * 4 + 3], source[i * 4 + 3]);
+			}
+
+			ASSERT_EQ(swappedBack, source);
+		}
+	}
+}
+
+TEST(PixelConversionTest, ExpandsRGBToRGBA)
+{
+	for (auto instructionSet : INSTRUCTION_SETS)
+	{
+		for (size_t nrOfTexels = 0; nrOfTexels < 70; ++nrOfTexels)
+		{
+			std::vector<unsigned char> source(nrOfTexels * 3);
+			for (size_t i = 0; i < source.size(); ++i)
+				source[i] = static_cast<unsigned char>(i * 5 + 1);
+
+			auto rgba = ConvertTestRow(SourceFormat::R8G8B8,
+				DXGI_FORMAT_R8G8B8A8_UNORM, 4, instructionSet, source, nrOfTexels);
+			auto bgra = ConvertTestRow(SourceFormat::R8G8B8,
+				DXGI_FORMAT_B8G8R8A8_UNORM, 4, instructionSet, source, nrOfTexels);
+
+			for (size_t i = 0; i < nrOfTexels; ++i)
+			{
+				ASSERT_EQ(rgba[i * 4 + 0], source[i * 3 + 0]);
+				ASSERT_EQ(rgba[i * 4 + 1], source[i * 3 + 1]);
+				ASSERT_EQ(rgba[i * 4 + 2], source[i * 3 + 2]);
+				ASSERT_EQ(rgba[i * 4 + 3], 0xFF);
+				ASSERT_EQ(bgra[i * 4 + 0], source[i * 3 + 2]);
+				ASSERT_EQ(bgra[i * 4 + 1], source[i * 3 + 1]);
+				ASSERT_EQ(bgra[i * 4 + 2], source[i * 3 + 0]);
+				ASSERT_EQ(bgra[i * 4 + 3], 0xFF);
+			}
+		}
+	}
+}
+
+std::vector<std::uint16_t> ConvertFloats(const std::vector<float>& floats,
+	InstructionSet instructionSet)
+{
+	std::vector<unsigned char> source(floats.size() * sizeof(float));
+	std::memcpy(source.data(), floats.data(), source.size());
+	auto converted = ConvertTestRow(SourceFormat::FLOAT32,
+		DXGI_FORMAT_R16_FLOAT, 2, instructionSet, source, floats.size());
+
+	std::vector<std::uint16_t> toReturn(floats.size());
+	std::memcpy(toReturn.data(), converted.data(), converted.size());
+	return toReturn;
+}
+
+TEST(PixelConversionTest, ConvertsFloatsToHalves)
+{
+	// Enough copies that every path handles them both vectorized and in the tail
+	std::vector<std::pair<float, std::uint16_t>> expected = { { 0.0f, 0x0000 },
+		{ -0.0f, 0x8000 }, { 1.0f, 0x3C00 }, { -2.0f, 0xC000 },
+		{ 0.5f, 0x3800 }, { 65504.0f, 0x7BFF }, { 65520.0f, 0x7C00 },
+		{ 1.0e10f, 0x7C00 }, { -INFINITY, 0xFC00 }, { 5.9604645e-8f, 0x0001 },
+		{ 6.1035156e-5f, 0x0400 }, { 1.00048828125f, 0x3C00 },
+		{ 1.00146484375f, 0x3C02 }, { 2.9802322e-8f, 0x0000 } };
+
+	std::vector<float> floats;
+	for (size_t copy = 0; copy < 3; ++copy)
+	{
+		for (auto& value : expected)
+			floats.push_back(value.first);
+	}
+
+	for (auto instructionSet : INSTRUCTION_SETS)
+	{
+		auto halves = ConvertFloats(floats, instructionSet);
+		for (size_t i = 0; i < halves.size(); ++i)
+			ASSERT_EQ(halves[i], expected[i % expected.size()].second) << i;
+	}
+}
+
+TEST(PixelConversionTest, MatchesScalarFloatConversion)
+{
+	std::vector<float> floats;
+	std::uint32_t state = 12345;
+	for (size_t i = 0; i < 10007; ++i)
+	{
+		state = state * 1664525u + 1013904223u;
+		std::uint32_t bits = state;
+
+		// Keep the exponents near the half range so all rounding paths are hit
+		bits = (bits & 0x807FFFFF) | (((bits >> 23) % 48 + 95) << 23);
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		floats.push_back(value);
+	}
+
+	floats.push_back(NAN);
+	auto scalar = ConvertFloats(floats, InstructionSet::SCALAR);
+
+	for (auto instructionSet : INSTRUCTION_SETS)
+	{
+		auto halves = ConvertFloats(floats, instructionSet);
+		for (size_t i = 0; i + 1 < halves.size(); ++i)
+			ASSERT_EQ(halves[i], scalar[i]) << i;
+
+		EXPECT_EQ(halves.back() & 0x7C00, 0x7C00);
+		EXPECT_NE(halves.back() & 0x03FF, 0);
+	}
+
+	std::vector<unsigned char> source(8 * sizeof(float));
+	std::memcpy(source.data(), floats.data(), source.size());
+	auto fourComponents = ConvertTestRow(SourceFormat::FLOAT32,
+		DXGI_FORMAT_R16G16B16A16_FLOAT, 8, InstructionSet::AVX2, source, 2);
+	EXPECT_EQ(std::memcmp(fourComponents.data(), scalar.data(), 16), 0);
+}
\ No newline at end of file
@@ -0,0 +1,234 @@
+#include "pch.h"
+
+#include "../Neo Steelgear Graphics Core/ResourceReadback.h"
+#include "../Neo Steelgear Graphics Core/ResourceUploader.h"
+
+#include "D3D12Helper.h"
+
+TEST(ResourceReadbackTest, DefaultInitialisable)
+{
+	ResourceReadback readback;
+}
+
+TEST(ResourceReadbackTest, RuntimeInitialisable)
+{
+	ID3D12Device* device = nullptr;
+	device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device cannot be created";
+
+	ResourceReadback readback;
+	readback.Initialize(device, 4096);
+	EXPECT_EQ(readback.GetUsedMemory(), 0);
+
+	ID3D12Heap* heap = CreateResourceHeap(device, 65536,
+		D3D12_HEAP_TYPE_READBACK, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
+	if (heap == nullptr)
+		FAIL() << "Cannot proceed with tests as a heap could not be created";
+
+	ResourceReadback placedReadback;
+	placedReadback.Initialize(device, heap, 0, 65536);
+
+	heap->Release();
+	device->Release();
+}
+
+TEST(ResourceReadbackTest, CalculatesFootprints)
+{
+	ReadbackFootprint bufferFootprint = ResourceReadback::CalculateBufferFootprint(100);
+	EXPECT_EQ(bufferFootprint.totalSize, 100);
+	EXPECT_EQ(bufferFootprint.rowPitch, 100);
+
+	TextureReadbackInfo readbackInfo;
+	readbackInfo.width = 10;
+	readbackInfo.height = 3;
+	readbackInfo.depth = 2;
+	readbackInfo.texelSizeInBytes = 4;
+	ReadbackFootprint textureFootprint =
+		ResourceReadback::CalculateTextureFootprint(readbackInfo);
+
+	EXPECT_EQ(textureFootprint.rowSize, 40);
+	EXPECT_EQ(textureFootprint.rowPitch, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+	EXPECT_EQ(textureFootprint.slicePitch, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT * 3);
+	EXPECT_EQ(textureFootprint.totalSize,
+		D3D12_TEXTURE_DATA_PITCH_ALIGNMENT * 5 + 40);
+	EXPECT_EQ(textureFootprint.alignment, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+	readbackInfo.width = 64;
+	readbackInfo.depth = 1;
+	textureFootprint = ResourceReadback::CalculateTextureFootprint(readbackInfo);
+	EXPECT_EQ(textureFootprint.rowPitch, 256);
+	EXPECT_EQ(textureFootprint.totalSize, 768);
+}
+
+void UploadReadbackSource(ID3D12Device* device,
+	SimpleCommandStructure& commandStructure, ID3D12Resource* resource,
+	void* data, const TextureUploadInfo* uploadInfo, size_t dataSize,
+	UINT64& currentFenceValue, ID3D12Fence* fence)
+{
+	ResourceUploader uploader;
+	uploader.Initialize(device, 65536, AllocationStrategy::FIRST_FIT);
+
+	bool result = uploadInfo == nullptr ?
+		uploader.UploadBufferResourceData(resource, commandStructure.list,
+			data, 0, dataSize, 4) :
+		uploader.UploadTextureResourceData(resource, commandStructure.list,
+			data, *uploadInfo);
+	ASSERT_TRUE(result);
+
+	TransitionResource(commandStructure.list, resource,
+		D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE);
+	ExecuteGraphicsCommandList(commandStructure.list, commandStructure.queue);
+	FlushCommandQueue(currentFenceValue, commandStructure.queue, fence);
+	commandStructure.allocator->Reset();
+	commandStructure.list->Reset(commandStructure.allocator, nullptr);
+}
+
+TEST(ResourceReadbackTest, HandlesBufferReadbacks)
+{
+	ID3D12Device* device = nullptr;
+	device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device cannot be created";
+
+	const int NR_OF_INTS = 1000;
+	ID3D12Resource* sourceBuffer = CreateBuffer(device, sizeof(int) * NR_OF_INTS, false);
+	if (sourceBuffer == nullptr)
+		FAIL() << "Cannot proceed with tests as resources could not be created";
+
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device))
+		FAIL() << "Cannot proceed with tests as command structure could not be created";
+
+	ID3D12Fence* fence = nullptr;
+	UINT64 currentFenceValue = 0;
+	if (FAILED(device->CreateFence(currentFenceValue,
+		D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	{
+		FAIL() << "Cannot proceed with tests as fence could not be created";
+	}
+
+	int data[NR_OF_INTS];
+	for (int i = 0; i < NR_OF_INTS; ++i)
+		data[i] = i * 3;
+
+	UploadReadbackSource(device, commandStructure, sourceBuffer, data, nullptr,
+		sizeof(data), currentFenceValue, fence);
+
+	ResourceReadback readback;
+	readback.Initialize(device, 3 * sizeof(data));
+
+	auto firstId = readback.ReadbackBufferData(sourceBuffer,
+		commandStructure.list, 0, sizeof(data));
+	auto secondId = readback.ReadbackBufferData(sourceBuffer,
+		commandStructure.list, sizeof(int) * 500, sizeof(int) * 500);
+	ASSERT_TRUE(firstId.has_value() && secondId.has_value());
+	EXPECT_EQ(readback.ReadbackBufferData(sourceBuffer, commandStructure.list,
+		0, 3 * sizeof(data)).has_value(), false);
+
+	readback.SubmitReadbacks(currentFenceValue + 1);
+	EXPECT_EQ(readback.ReadbackFinished(*firstId), false);
+	EXPECT_EQ(readback.GetReadbackData(*firstId).has_value(), false);
+
+	ExecuteGraphicsCommandList(commandStructure.list, commandStructure.queue);
+	FlushCommandQueue(currentFenceValue, commandStructure.queue, fence);
+	readback.UpdateCompletedValue(fence);
+
+	ASSERT_EQ(readback.ReadbackFinished(*firstId), true);
+	ASSERT_EQ(readback.ReadbackFinished(*secondId), true);
+	auto firstData = readback.GetReadbackData(*firstId);
+	auto secondData = readback.GetReadbackData(*secondId);
+	ASSERT_TRUE(firstData.has_value() && secondData.has_value());
+	EXPECT_EQ(firstData->size, sizeof(data));
+	EXPECT_EQ(memcmp(firstData->data, data, sizeof(data)), 0);
+	EXPECT_EQ(memcmp(secondData->data, data + 500, sizeof(int) * 500), 0);
+
+	readback.ReleaseReadback(*firstId);
+	readback.ReleaseReadback(*secondId);
+	EXPECT_EQ(readback.GetUsedMemory(), 0);
+	EXPECT_THROW(readback.ReleaseReadback(*firstId), std::runtime_error);
+
+	sourceBuffer->Release();
+	fence->Release();
+	device->Release();
+}
+
+TEST(ResourceReadbackTest, HandlesTextureReadbacks)
+{
+	ID3D12Device* device = nullptr;
+	device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device cannot be created";
+
+	const UINT WIDTH = 70;
+	const UINT HEIGHT = 20;
+	const size_t TEXEL_SIZE = 4;
+	ID3D12Resource* sourceTexture = CreateTexture2D(device, false, WIDTH, HEIGHT);
+	if (sourceTexture == nullptr)
+		FAIL() << "Cannot proceed with tests as resources could not be created";
+
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device))
+		FAIL() << "Cannot proceed with tests as command structure could not be created";
+
+	ID3D12Fence* fence = nullptr;
+	UINT64 currentFenceValue = 0;
+	if (FAILED(device->CreateFence(currentFenceValue,
+		D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	{
+		FAIL() << "Cannot proceed with tests as fence could not be created";
+	}
+
+	unsigned char data[WIDTH * HEIGHT * TEXEL_SIZE];
+	for (size_t i = 0; i < sizeof(data); ++i)
+		data[i] = static_cast<unsigned char>(i * 13);
+
+	TextureUploadInfo uploadInfo;
+	uploadInfo.width = WIDTH;
+	uploadInfo.height = HEIGHT;
+	uploadInfo.texelSizeInBytes = TEXEL_SIZE;
+	uploadInfo.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	UploadReadbackSource(device, commandStructure, sourceTexture, data,
+		&uploadInfo, sizeof(data), currentFenceValue, fence);
+
+	ResourceReadback readback;
+	readback.Initialize(device, 65536);
+
+	TextureReadbackInfo readbackInfo;
+	readbackInfo.width = 30;
+	readbackInfo.height = 10;
+	readbackInfo.offsetWidth = 25;
+	readbackInfo.offsetHeight = 7;
+	readbackInfo.texelSizeInBytes = TEXEL_SIZE;
+	readbackInfo.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	auto readbackId = readback.ReadbackTextureData(sourceTexture,
+		commandStructure.list, readbackInfo);
+	ASSERT_TRUE(readbackId.has_value());
+
+	// Frame numbers work just as well as fence values
+	const std::uint64_t FRAME_NUMBER = 5;
+	readback.SubmitReadbacks(FRAME_NUMBER);
+	ExecuteGraphicsCommandList(commandStructure.list, commandStructure.queue);
+	FlushCommandQueue(currentFenceValue, commandStructure.queue, fence);
+	readback.UpdateCompletedValue(FRAME_NUMBER - 1);
+	EXPECT_EQ(readback.ReadbackFinished(*readbackId), false);
+	readback.UpdateCompletedValue(FRAME_NUMBER);
+
+	auto readbackData = readback.GetReadbackData(*readbackId);
+	ASSERT_TRUE(readbackData.has_value());
+	EXPECT_EQ(readbackData->rowPitch, 256);
+
+	for (UINT y = 0; y < readbackInfo.height; ++y)
+	{
+		const unsigned char* row = readbackData->data + y * readbackData->rowPitch;
+		const unsigned char* expected = data +
+			((y + readbackInfo.offsetHeight) * WIDTH + readbackInfo.offsetWidth) * TEXEL_SIZE;
+		ASSERT_EQ(memcmp(row, expected, readbackInfo.width * TEXEL_SIZE), 0);
+	}
+
+	readback.ReleaseReadback(*readbackId);
+
+	sourceTexture->Release();
+	fence->Release();
+	device->Release();
+}
\ No newline at end of file
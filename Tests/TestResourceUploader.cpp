@@ -4,6 +4,7 @@
 #include <utility>
 
 #include "../Neo Steelgear Graphics Core/ResourceUploader.h"
+#include "../Neo Steelgear Graphics Core/ContentHash.h"
 
 #include "D3D12Helper.h"
 
@@ -217,6 +218,69 @@ TEST(ResourceUploaderTest, HandlesAdvancedBufferUploads)
 	fence->Release();
 }
 
+void ExecutePendingUploads(SimpleCommandStructure& commandStructure,
+	ResourceUploader& uploader, UINT64& currentFenceValue, ID3D12Fence* fence)
+{
+	while (uploader.HasPendingUploads())
+	{
+		ExecuteGraphicsCommandList(commandStructure.list, commandStructure.queue);
+		FlushCommandQueue(currentFenceValue, commandStructure.queue, fence);
+		PrepareForNextBatch(commandStructure, nullptr);
+		uploader.RestoreUsedMemory();
+		uploader.UploadPendingData(commandStructure.list);
+	}
+}
+
+TEST(ResourceUploaderTest, HandlesOversizedBufferUploads)
+{
+	ID3D12Device* device = nullptr;
+	device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device cannot be created";
+
+	ResourceUploader uploader;
+	if (!InitialiseUploader(uploader, device, 1024))
+		FAIL() << "Cannot proceed with tests as a device cannot be created for the system";
+
+	const int NR_OF_INTS = 4000;
+	ID3D12Resource* targetBuffer = CreateBuffer(device,
+		sizeof(int) * NR_OF_INTS, false);
+	ID3D12Resource* readbackBuffer = CreateBuffer(device,
+		sizeof(int) * NR_OF_INTS, true);
+
+	if (targetBuffer == nullptr || readbackBuffer == nullptr)
+		FAIL() << "Cannot proceed with tests as resources could not be created";
+
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device))
+		FAIL() << "Cannot proceed with tests as command structure could not be created";
+
+	ID3D12Fence* fence = nullptr;
+	UINT64 currentFenceValue = 0;
+	if (FAILED(device->CreateFence(currentFenceValue,
+		D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	{
+		FAIL() << "Cannot proceed with tests as fence could not be created";
+	}
+
+	int* data = new int[NR_OF_INTS];
+	FillBufferData(data, 0, NR_OF_INTS);
+	ASSERT_EQ(uploader.UploadBufferResourceData(targetBuffer,
+		commandStructure.list, data, 0, sizeof(int) * NR_OF_INTS,
+		alignof(int)), true);
+	ASSERT_TRUE(uploader.HasPendingUploads(targetBuffer));
+
+	ExecutePendingUploads(commandStructure, uploader, currentFenceValue, fence);
+	ExecuteBufferCopy(commandStructure, targetBuffer, readbackBuffer,
+		data, NR_OF_INTS, currentFenceValue, fence);
+
+	delete[] data;
+	device->Release();
+	targetBuffer->Release();
+	readbackBuffer->Release();
+	fence->Release();
+}
+
 unsigned int FillTexture2DData(unsigned char* data, unsigned int width,
 	unsigned int height, unsigned int bytesPerTexel, unsigned int mipLevels,
 	unsigned int offsetInData)
@@ -543,4 +607,344 @@ TEST(ResourceUploaderTest, HandlesAdvancedTextureUploads)
 
 	device->Release();
 	fence->Release();
+}
+
+TEST(ResourceUploaderTest, HandlesOversizedTextureUploads)
+{
+	ID3D12Device* device = nullptr;
+	device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device cannot be created";
+
+	std::vector<std::pair<short, DXGI_FORMAT>> formats = {
+		{4, DXGI_FORMAT_R8G8B8A8_UNORM}, {16, DXGI_FORMAT_R32G32B32A32_UINT},
+		{8, DXGI_FORMAT_R32G32_UINT}, {12, DXGI_FORMAT_R32G32B32_UINT} };
+	std::vector<std::pair<UINT, UINT>> dimensions = { {256, 256}, {512, 128},
+		{100, 100}, {333, 333}, {123, 456} };
+
+	ResourceUploader uploader;
+	if (!InitialiseUploader(uploader, device, 16384))
+		FAIL() << "Cannot proceed with tests as a device cannot be created for the system";
+
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device))
+		FAIL() << "Cannot proceed with tests as command structure could not be created";
+
+	ID3D12Fence* fence = nullptr;
+	UINT64 currentFenceValue = 0;
+	if (FAILED(device->CreateFence(currentFenceValue,
+		D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	{
+		FAIL() << "Cannot proceed with tests as fence could not be created";
+	}
+
+	for (auto& format : formats)
+	{
+		for (auto& dimension : dimensions)
+		{
+			ID3D12Resource* targetTexture = CreateTexture2D(device, false,
+				dimension.first, dimension.second, 1, 1, format.second);
+			if (targetTexture == nullptr)
+				FAIL() << "Cannot proceed with tests as resources could not be created";
+
+			unsigned char* data = new unsigned char[dimension.first *
+				dimension.second * format.first];
+			FillTexture2DData(data, dimension.first, dimension.second,
+				format.first, 1, 0);
+
+			TextureUploadInfo uploadInfo;
+			uploadInfo.width = dimension.first;
+			uploadInfo.height = dimension.second;
+			uploadInfo.texelSizeInBytes = format.first;
+			uploadInfo.format = format.second;
+
+			ASSERT_TRUE(uploader.UploadTextureResourceData(targetTexture,
+				commandStructure.list, data, uploadInfo, 0));
+			ASSERT_TRUE(uploader.HasPendingUploads(targetTexture));
+
+			ExecutePendingUploads(commandStructure, uploader, currentFenceValue, fence);
+			ExecuteTexture2DCopy(device, commandStructure, targetTexture,
+				data, 1, currentFenceValue, fence);
+			PrepareForNextBatch(commandStructure, nullptr);
+			uploader.RestoreUsedMemory();
+			targetTexture->Release();
+			delete[] data;
+		}
+	}
+
+	device->Release();
+	fence->Release();
+}
+
+TEST(ResourceUploaderTest, HandlesOversizedTextureSlices)
+{
+	ID3D12Device* device = nullptr;
+	device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device cannot be created";
+
+	const UINT WIDTH = 64;
+	const UINT HEIGHT = 64;
+	const UINT16 DEPTH = 4;
+	const size_t TEXEL_SIZE = 4;
+
+	D3D12_RESOURCE_DESC resourceDesc;
+	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+	resourceDesc.Alignment = 0;
+	resourceDesc.Width = WIDTH;
+	resourceDesc.Height = HEIGHT;
+	resourceDesc.DepthOrArraySize = DEPTH;
+	resourceDesc.MipLevels = 1;
+	resourceDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	resourceDesc.SampleDesc.Count = 1;
+	resourceDesc.SampleDesc.Quality = 0;
+	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+	resourceDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	ID3D12Resource* targetTexture = CreateTexture2D(device, resourceDesc);
+	if (targetTexture == nullptr)
+		FAIL() << "Cannot proceed with tests as resources could not be created";
+
+	// A single slice is twice the size of the staging memory
+	ResourceUploader uploader;
+	if (!InitialiseUploader(uploader, device, WIDTH * HEIGHT * TEXEL_SIZE / 2))
+		FAIL() << "Cannot proceed with tests as a device cannot be created for the system";
+
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device))
+		FAIL() << "Cannot proceed with tests as command structure could not be created";
+
+	ID3D12Fence* fence = nullptr;
+	UINT64 currentFenceValue = 0;
+	if (FAILED(device->CreateFence(currentFenceValue,
+		D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	{
+		FAIL() << "Cannot proceed with tests as fence could not be created";
+	}
+
+	std::vector<unsigned char> data(WIDTH * HEIGHT * DEPTH * TEXEL_SIZE);
+	for (size_t i = 0; i < data.size(); ++i)
+		data[i] = static_cast<unsigned char>(i / TEXEL_SIZE + i / (WIDTH * HEIGHT));
+
+	TextureUploadInfo uploadInfo;
+	uploadInfo.width = WIDTH;
+	uploadInfo.height = HEIGHT;
+	uploadInfo.depth = DEPTH;
+	uploadInfo.texelSizeInBytes = TEXEL_SIZE;
+	uploadInfo.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	EXPECT_FALSE(uploader.TextureSlicesFit(uploadInfo));
+
+	ASSERT_TRUE(uploader.UploadTextureResourceData(targetTexture,
+		commandStructure.list, data.data(), uploadInfo));
+	ASSERT_TRUE(uploader.HasPendingUploads(targetTexture));
+	ExecutePendingUploads(commandStructure, uploader, currentFenceValue, fence);
+	ASSERT_FALSE(uploader.HasPendingUploads(targetTexture));
+
+	TransitionResource(commandStructure.list, targetTexture,
+		D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE);
+
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(1);
+	std::vector<UINT> rows(1);
+	std::vector<UINT64> rowSizes(1);
+	UINT64 readbackBufferSize = 0;
+	device->GetCopyableFootprints(&resourceDesc, 0, 1, 0, footprints.data(),
+		rows.data(), rowSizes.data(), &readbackBufferSize);
+	rows[0] *= DEPTH; // Slices of the footprint follow each other without padding
+
+	ID3D12Resource* readbackBuffer = CreateBuffer(device, readbackBufferSize, true);
+	if (readbackBuffer == nullptr)
+		FAIL() << "Cannot proceed with tests as resources could not be created";
+
+	D3D12_TEXTURE_COPY_LOCATION destination;
+	destination.pResource = readbackBuffer;
+	destination.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+	destination.PlacedFootprint = footprints[0];
+
+	D3D12_TEXTURE_COPY_LOCATION source;
+	source.pResource = targetTexture;
+	source.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+	source.SubresourceIndex = 0;
+
+	commandStructure.list->CopyTextureRegion(&destination, 0, 0, 0, &source, nullptr);
+	ExecuteGraphicsCommandList(commandStructure.list, commandStructure.queue);
+	FlushCommandQueue(currentFenceValue, commandStructure.queue, fence);
+	CheckResourceData(readbackBuffer, footprints, rows, rowSizes, data.data());
+
+	// Rows that can never fit the staging memory are rejected rather than left pending
+	TextureUploadInfo wideInfo = uploadInfo;
+	wideInfo.width = WIDTH * HEIGHT;
+	wideInfo.height = 1;
+	wideInfo.depth = 1;
+	EXPECT_THROW(uploader.UploadTextureParts(targetTexture, commandStructure.list,
+		data.data(), wideInfo, 0), std::runtime_error);
+
+	readbackBuffer->Release();
+	targetTexture->Release();
+	device->Release();
+	fence->Release();
+}
+
+TEST(ResourceUploaderTest, HandlesPitchedTextureUploads)
+{
+	ID3D12Device* device = nullptr;
+	device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device cannot be created";
+
+	const UINT WIDTH = 100;
+	const UINT HEIGHT = 60;
+	const size_t TEXEL_SIZE = 4;
+	const size_t SOURCE_ROW_PITCH = WIDTH * TEXEL_SIZE + 52;
+
+	ID3D12Resource* targetTexture = CreateTexture2D(device, false, WIDTH, HEIGHT);
+	if (targetTexture == nullptr)
+		FAIL() << "Cannot proceed with tests as resources could not be created";
+
+	// Small enough that the texture has to be split over several batches
+	ResourceUploader uploader;
+	if (!InitialiseUploader(uploader, device, 16384))
+		FAIL() << "Cannot proceed with tests as a device cannot be created for the system";
+
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device))
+		FAIL() << "Cannot proceed with tests as command structure could not be created";
+
+	ID3D12Fence* fence = nullptr;
+	UINT64 currentFenceValue = 0;
+	if (FAILED(device->CreateFence(currentFenceValue,
+		D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	{
+		FAIL() << "Cannot proceed with tests as fence could not be created";
+	}
+
+	unsigned char* packedData = new unsigned char[WIDTH * HEIGHT * TEXEL_SIZE];
+	FillTexture2DData(packedData, WIDTH, HEIGHT, TEXEL_SIZE, 1, 0);
+	unsigned char* pitchedData = new unsigned char[SOURCE_ROW_PITCH * HEIGHT];
+	for (UINT y = 0; y < HEIGHT; ++y)
+	{
+		memcpy(pitchedData + y * SOURCE_ROW_PITCH,
+			packedData + y * WIDTH * TEXEL_SIZE, WIDTH * TEXEL_SIZE);
+	}
+
+	TextureUploadInfo uploadInfo;
+	uploadInfo.width = WIDTH;
+	uploadInfo.height = HEIGHT;
+	uploadInfo.texelSizeInBytes = TEXEL_SIZE;
+	uploadInfo.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	uploadInfo.sourceRowPitch = SOURCE_ROW_PITCH;
+	EXPECT_EQ(ResourceUploader::GetSourceSize(uploadInfo),
+		SOURCE_ROW_PITCH * (HEIGHT - 1) + WIDTH * TEXEL_SIZE);
+
+	ASSERT_TRUE(uploader.UploadTextureResourceData(targetTexture,
+		commandStructure.list, pitchedData, uploadInfo));
+	delete[] pitchedData; // Queued data has to be owned by the uploader
+
+	ExecutePendingUploads(commandStructure, uploader, currentFenceValue, fence);
+	ExecuteTexture2DCopy(device, commandStructure, targetTexture,
+		packedData, 1, currentFenceValue, fence);
+
+	delete[] packedData;
+	targetTexture->Release();
+	device->Release();
+	fence->Release();
+}
+
+TEST(ResourceUploaderTest, DeduplicatesIdenticalContent)
+{
+	ID3D12Device* device = nullptr;
+	device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device cannot be created";
+
+	// Only room for one copy of the data, so the second has to reuse it
+	const int NR_OF_INTS = 1000;
+	ResourceUploader uploader;
+	if (!InitialiseUploader(uploader, device, sizeof(int) * NR_OF_INTS))
+		FAIL() << "Cannot proceed with tests as a device cannot be created for the system";
+
+	uploader.SetContentDeduplication(true);
+	EXPECT_EQ(uploader.ContentDeduplicationEnabled(), true);
+
+	ID3D12Resource* firstBuffer = CreateBuffer(device,
+		sizeof(int) * NR_OF_INTS, false);
+	ID3D12Resource* secondBuffer = CreateBuffer(device,
+		sizeof(int) * NR_OF_INTS, false);
+	ID3D12Resource* readbackBuffer = CreateBuffer(device,
+		sizeof(int) * NR_OF_INTS, true);
+
+	if (firstBuffer == nullptr || secondBuffer == nullptr ||
+		readbackBuffer == nullptr)
+	{
+		FAIL() << "Cannot proceed with tests as resources could not be created";
+	}
+
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device))
+		FAIL() << "Cannot proceed with tests as command structure could not be created";
+
+	ID3D12Fence* fence = nullptr;
+	UINT64 currentFenceValue = 0;
+	if (FAILED(device->CreateFence(currentFenceValue,
+		D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	{
+		FAIL() << "Cannot proceed with tests as fence could not be created";
+	}
+
+	int data[NR_OF_INTS];
+	FillBufferData(data, 0, NR_OF_INTS);
+	std::uint64_t contentHash = HashContent(data, sizeof(int) * NR_OF_INTS);
+
+	ASSERT_EQ(uploader.UploadBufferResourceData(firstBuffer, commandStructure.list,
+		data, 0, sizeof(int) * NR_OF_INTS, alignof(int), contentHash), true);
+	ASSERT_EQ(uploader.UploadBufferResourceData(secondBuffer, commandStructure.list,
+		data, 0, sizeof(int) * NR_OF_INTS, alignof(int), contentHash), true);
+	EXPECT_EQ(uploader.HasPendingUploads(), false);
+
+	const UploadStatistics& statistics = uploader.GetStatistics();
+	EXPECT_EQ(statistics.deduplicationLookups, 2);
+	EXPECT_EQ(statistics.deduplicationHits, 1);
+	EXPECT_EQ(statistics.bytesSaved, sizeof(int) * NR_OF_INTS);
+	EXPECT_FLOAT_EQ(uploader.GetDeduplicationHitRate(), 0.5f);
+
+	ExecuteBufferCopy(commandStructure, firstBuffer, readbackBuffer,
+		data, NR_OF_INTS, currentFenceValue, fence);
+	PrepareForNextBatch(commandStructure, nullptr);
+	ExecuteBufferCopy(commandStructure, secondBuffer, readbackBuffer,
+		data, NR_OF_INTS, currentFenceValue, fence);
+
+	// Staged content is forgotten once the staging memory is restored
+	PrepareForNextBatch(commandStructure, firstBuffer);
+	uploader.RestoreUsedMemory();
+	uploader.ResetStatistics();
+	ASSERT_EQ(uploader.UploadBufferResourceData(firstBuffer, commandStructure.list,
+		data, 0, sizeof(int) * NR_OF_INTS, alignof(int), contentHash), true);
+	EXPECT_EQ(uploader.GetStatistics().deduplicationHits, 0);
+	EXPECT_EQ(uploader.GetDeduplicationHitRate(), 0.0f);
+
+	ExecuteBufferCopy(commandStructure, firstBuffer, readbackBuffer,
+		data, NR_OF_INTS, currentFenceValue, fence);
+
+	// Different content that happens to have the same hash is not reused
+	PrepareForNextBatch(commandStructure, secondBuffer);
+	uploader.RestoreUsedMemory();
+	uploader.ResetStatistics();
+	int otherData[NR_OF_INTS / 2];
+	FillBufferData(otherData, 0, NR_OF_INTS / 2);
+	otherData[0] = -1;
+	ASSERT_EQ(uploader.UploadBufferResourceData(secondBuffer, commandStructure.list,
+		data, sizeof(int) * NR_OF_INTS / 2, sizeof(int) * NR_OF_INTS / 2,
+		alignof(int), contentHash), true);
+	ASSERT_EQ(uploader.UploadBufferResourceData(secondBuffer, commandStructure.list,
+		otherData, 0, sizeof(int) * NR_OF_INTS / 2, alignof(int), contentHash), true);
+	EXPECT_EQ(uploader.GetStatistics().deduplicationLookups, 2);
+	EXPECT_EQ(uploader.GetStatistics().deduplicationHits, 0);
+
+	ExecuteBufferCopy(commandStructure, secondBuffer, readbackBuffer,
+		otherData, NR_OF_INTS / 2, currentFenceValue, fence);
+
+	device->Release();
+	firstBuffer->Release();
+	secondBuffer->Release();
+	readbackBuffer->Release();
+	fence->Release();
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "pch.h"
+
+#include "../Neo Steelgear Graphics Core/RingAllocator.h"
+
+TEST(RingAllocatorTest, DefaultInitialisable)
+{
+	RingAllocator ring;
+	EXPECT_EQ(ring.Empty(), true);
+}
+
+TEST(RingAllocatorTest, AllocatesInOrder)
+{
+	RingAllocator ring;
+	ring.Initialize(1024);
+	EXPECT_EQ(ring.GetTotalSize(), 1024);
+
+	auto first = ring.Allocate(100, 1);
+	auto second = ring.Allocate(100, 256);
+	auto third = ring.Allocate(10, 16);
+	ASSERT_TRUE(first.has_value() && second.has_value() && third.has_value());
+
+	EXPECT_EQ(first->offset, 0);
+	EXPECT_EQ(second->offset, 256);
+	EXPECT_EQ(third->offset, 368);
+	EXPECT_EQ(second->allocationId, first->allocationId + 1);
+	EXPECT_EQ(third->allocationId, second->allocationId + 1);
+	EXPECT_EQ(ring.GetUsedSize(), 378);
+
+	EXPECT_EQ(ring.Allocate(1024, 1).has_value(), false);
+	EXPECT_EQ(ring.Allocate(0, 1).has_value(), false);
+	EXPECT_THROW(ring.Allocate(1, 3), std::runtime_error);
+}
+
+TEST(RingAllocatorTest, ReclaimsMemoryInOrder)
+{
+	RingAllocator ring;
+	ring.Initialize(1000);
+
+	auto first = ring.Allocate(400, 1);
+	auto second = ring.Allocate(400, 1);
+	ASSERT_TRUE(first.has_value() && second.has_value());
+	EXPECT_EQ(ring.Allocate(400, 1).has_value(), false);
+
+	// Out of order frees wait for everything allocated before them
+	ring.Free(second->allocationId);
+	EXPECT_EQ(ring.GetUsedSize(), 800);
+	EXPECT_EQ(ring.Allocate(400, 1).has_value(), false);
+
+	ring.Free(first->allocationId);
+	EXPECT_EQ(ring.GetUsedSize(), 0);
+	EXPECT_EQ(ring.Empty(), true);
+	EXPECT_THROW(ring.Free(first->allocationId), std::runtime_error);
+
+	auto third = ring.Allocate(1000, 1);
+	ASSERT_TRUE(third.has_value());
+	EXPECT_EQ(third->offset, 0);
+}
+
+TEST(RingAllocatorTest, WrapsAround)
+{
+	RingAllocator ring;
+	ring.Initialize(1000);
+
+	auto first = ring.Allocate(300, 1);
+	auto second = ring.Allocate(300, 1);
+	auto third = ring.Allocate(300, 1);
+	ASSERT_TRUE(first.has_value() && second.has_value() && third.has_value());
+	ring.Free(first->allocationId);
+
+	// The 100 bytes at the end are skipped and count as used until the wrap is freed
+	EXPECT_EQ(ring.Allocate(400, 1).has_value(), false);
+	auto wrapped = ring.Allocate(250, 1);
+	ASSERT_TRUE(wrapped.has_value());
+	EXPECT_EQ(wrapped->offset, 0);
+	EXPECT_EQ(ring.GetUsedSize(), 950);
+
+	auto filler = ring.Allocate(50, 1);
+	ASSERT_TRUE(filler.has_value());
+	EXPECT_EQ(filler->offset, 250);
+	EXPECT_EQ(ring.GetUsedSize(), 1000);
+	EXPECT_EQ(ring.Allocate(1, 1).has_value(), false);
+
+	ring.Free(second->allocationId);
+	ring.Free(third->allocationId);
+	EXPECT_EQ(ring.GetUsedSize(), 400);
+
+	ring.Free(wrapped->allocationId);
+	ring.Free(filler->allocationId);
+	EXPECT_EQ(ring.Empty(), true);
+	EXPECT_EQ(ring.GetUsedSize(), 0);
+}
+
+TEST(RingAllocatorTest, NeverOverlapsLiveAllocations)
+{
+	struct LiveAllocation
+	{
+		size_t allocationId;
+		size_t offset;
+		size_t size;
+	};
+
+	RingAllocator ring;
+	ring.Initialize(4096);
+	std::vector<LiveAllocation> live;
+
+	for (size_t i = 0; i < 10000; ++i)
+	{
+		size_t size = 1 + (i * 97) % 700;
+		auto allocation = ring.Allocate(size, 16);
+
+		if (!allocation.has_value())
+		{
+			ASSERT_EQ(live.empty(), false);
+			ring.Free(live.front().allocationId);
+			live.erase(live.begin());
+			continue;
+		}
+
+		ASSERT_EQ(allocation->offset % 16, 0);
+		ASSERT_LE(allocation->offset + size, 4096);
+		for (auto& other : live)
+		{
+			ASSERT_EQ(allocation->offset < other.offset + other.size &&
+				other.offset < allocation->offset + size, false);
+		}
+
+		live.push_back({ allocation->allocationId, allocation->offset, size });
+		ASSERT_LE(ring.GetUsedSize(), 4096);
+	}
+
+	for (auto& allocation : live)
+		ring.Free(allocation.allocationId);
+
+	EXPECT_EQ(ring.GetUsedSize(), 0);
+}
\ No newline at end of file
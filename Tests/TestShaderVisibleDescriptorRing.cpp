@@ -0,0 +1,139 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "../Neo Steelgear Graphics Core/ShaderVisibleDescriptorRing.h"
+
+#include "D3D12Helper.h"
+
+struct RecordedDescriptorCopy
+{
+	UINT nrOfDescriptors = 0;
+	SIZE_T destination = 0;
+	SIZE_T source = 0;
+};
+
+const size_t STUB_DESCRIPTOR_SIZE = 32;
+const SIZE_T STUB_CPU_START = 0x10000;
+const UINT64 STUB_GPU_START = 0x900000;
+
+void InitializeStubRing(ShaderVisibleDescriptorRing& ring, size_t nrOfDescriptors,
+	std::vector<RecordedDescriptorCopy>& copies)
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE cpuStart = { STUB_CPU_START };
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuStart = { STUB_GPU_START };
+	ring.Initialize(cpuStart, gpuStart, STUB_DESCRIPTOR_SIZE, nrOfDescriptors,
+		[&copies](UINT nrOfDescriptors, D3D12_CPU_DESCRIPTOR_HANDLE destination,
+			D3D12_CPU_DESCRIPTOR_HANDLE source)
+		{
+			copies.push_back({ nrOfDescriptors, destination.ptr, source.ptr });
+		});
+}
+
+TEST(ShaderVisibleDescriptorRingTest, DefaultInitialisable)
+{
+	ShaderVisibleDescriptorRing ring;
+}
+
+TEST(ShaderVisibleDescriptorRingTest, RuntimeInitialisable)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	ShaderVisibleDescriptorRing ring;
+	ring.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, device, 1000);
+	ASSERT_NE(ring.GetHeap(), nullptr);
+	EXPECT_EQ(ring.GetTotalDescriptors(), 1000);
+
+	ID3D12DescriptorHeap* descriptorHeap = CreateDescriptorHeap(device,
+		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 3000, true);
+	if (descriptorHeap == nullptr)
+		FAIL() << "Cannot proceed with tests as a descriptor heap could not be created";
+
+	ShaderVisibleDescriptorRing placedRing;
+	placedRing.Initialize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, device,
+		descriptorHeap, 1000, 1000);
+	auto allocation = placedRing.Allocate(10);
+	ASSERT_TRUE(allocation.has_value());
+	EXPECT_EQ(allocation->gpuHandle.ptr,
+		descriptorHeap->GetGPUDescriptorHandleForHeapStart().ptr + 1000 *
+		device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
+
+	descriptorHeap->Release();
+	device->Release();
+}
+
+TEST(ShaderVisibleDescriptorRingTest, AllocatesLinearlyAndRetires)
+{
+	std::vector<RecordedDescriptorCopy> copies;
+	ShaderVisibleDescriptorRing ring;
+	InitializeStubRing(ring, 100, copies);
+
+	auto first = ring.Allocate(30);
+	auto second = ring.Allocate(30);
+	ASSERT_TRUE(first.has_value() && second.has_value());
+	EXPECT_EQ(first->startIndex, 0);
+	EXPECT_EQ(second->startIndex, 30);
+	EXPECT_EQ(second->cpuHandle.ptr, STUB_CPU_START + 30 * STUB_DESCRIPTOR_SIZE);
+	EXPECT_EQ(second->gpuHandle.ptr, STUB_GPU_START + 30 * STUB_DESCRIPTOR_SIZE);
+	EXPECT_EQ(ring.Allocate(0).has_value(), false);
+	EXPECT_EQ(ring.Allocate(101).has_value(), false);
+	ring.SubmitFrame(1);
+
+	auto third = ring.Allocate(30);
+	ASSERT_TRUE(third.has_value());
+	EXPECT_EQ(third->startIndex, 60);
+	// Would have to wrap around into descriptors the first frame still uses
+	EXPECT_EQ(ring.Allocate(20).has_value(), false);
+
+	ring.UpdateCompletedValue(1);
+	EXPECT_EQ(ring.GetUsedDescriptors(), 30);
+	auto wrapped = ring.Allocate(20);
+	ASSERT_TRUE(wrapped.has_value());
+	EXPECT_EQ(wrapped->startIndex, 0);
+	EXPECT_EQ(ring.GetUsedDescriptors(), 60); // The skipped descriptors are held by the frame
+
+	ring.SubmitFrame(2);
+	ring.UpdateCompletedValue(1);
+	EXPECT_EQ(ring.GetUsedDescriptors(), 60);
+	ring.UpdateCompletedValue(2);
+	EXPECT_EQ(ring.GetUsedDescriptors(), 0);
+
+	auto afterIdle = ring.Allocate(100);
+	ASSERT_TRUE(afterIdle.has_value());
+	EXPECT_EQ(afterIdle->startIndex, 0);
+}
+
+TEST(ShaderVisibleDescriptorRingTest, BatchesCopies)
+{
+	std::vector<RecordedDescriptorCopy> copies;
+	ShaderVisibleDescriptorRing ring;
+	InitializeStubRing(ring, 64, copies);
+
+	ring.Allocate(4);
+	auto allocation = ring.Allocate(8);
+	ASSERT_TRUE(allocation.has_value());
+
+	const SIZE_T SOURCE_HEAP = 0x500000;
+	const SIZE_T OTHER_SOURCE_HEAP = 0x700000;
+	ring.QueueCopy(*allocation, 0, { SOURCE_HEAP }, 2);
+	ring.QueueCopy(*allocation, 2, { SOURCE_HEAP + 2 * STUB_DESCRIPTOR_SIZE }, 3);
+	EXPECT_EQ(ring.GetNrOfPendingCopies(), 1);
+	ring.QueueCopy(*allocation, 5, { OTHER_SOURCE_HEAP });
+	ring.QueueCopy(*allocation, 7, { OTHER_SOURCE_HEAP + STUB_DESCRIPTOR_SIZE });
+	EXPECT_EQ(ring.GetNrOfPendingCopies(), 3);
+	EXPECT_THROW(ring.QueueCopy(*allocation, 7, { SOURCE_HEAP }, 2), std::runtime_error);
+	EXPECT_EQ(copies.size(), 0);
+
+	ring.FlushCopies();
+	EXPECT_EQ(ring.GetNrOfPendingCopies(), 0);
+	ASSERT_EQ(copies.size(), 3);
+	EXPECT_EQ(copies[0].nrOfDescriptors, 5);
+	EXPECT_EQ(copies[0].destination, STUB_CPU_START + 4 * STUB_DESCRIPTOR_SIZE);
+	EXPECT_EQ(copies[0].source, SOURCE_HEAP);
+	EXPECT_EQ(copies[1].nrOfDescriptors, 1);
+	EXPECT_EQ(copies[1].destination, STUB_CPU_START + 9 * STUB_DESCRIPTOR_SIZE);
+	EXPECT_EQ(copies[2].destination, STUB_CPU_START + 11 * STUB_DESCRIPTOR_SIZE);
+	EXPECT_EQ(copies[2].source, OTHER_SOURCE_HEAP + STUB_DESCRIPTOR_SIZE);
+}
\ No newline at end of file
@@ -235,6 +235,94 @@ TEST(StableVectorTest, HandlesExplicitIndicesCorrectly)
 	}
 }
 
+TEST(StableVectorTest, AddsRangesCorrectly)
+{
+	StableVector<int> intVector;
+
+	for (int i = 0; i < 100; ++i)
+		intVector.Add(i);
+
+	for (size_t i = 10; i < 30; ++i)
+		intVector.Remove(i);
+
+	intVector.AddRange(-1, 15, 10);
+	TestSizes(intVector, 90, 100);
+
+	for (size_t i = 15; i < 25; ++i)
+	{
+		ASSERT_TRUE(intVector.CheckIfActive(i));
+		ASSERT_EQ(intVector[i], -1);
+	}
+
+	// Only the indices outside the range are left to reuse
+	for (size_t i = 0; i < 10; ++i)
+	{
+		size_t index = intVector.Add(static_cast<int>(i));
+		ASSERT_TRUE((index >= 10 && index < 15) || (index >= 25 && index < 30));
+	}
+
+	ASSERT_EQ(intVector.Add(100), 100);
+
+	intVector.AddRange(-2, 150, 5);
+	TestSizes(intVector, 106, 155);
+	ASSERT_EQ(intVector.CheckIfActive(149), false);
+	ASSERT_EQ(intVector[154], -2);
+	ASSERT_EQ(intVector.Add(101), 149);
+}
+
+TEST(StableVectorTest, AddsIndicesCorrectly)
+{
+	StableVector<int> intVector;
+
+	for (int i = 0; i < 20; ++i)
+		intVector.Add(i);
+
+	for (size_t i = 5; i < 15; ++i)
+		intVector.Remove(i);
+
+	size_t indices[] = { 12, 6, 30, 9 };
+	intVector.AddIndices(-1, indices, 4);
+	TestSizes(intVector, 14, 31);
+
+	for (size_t index : indices)
+	{
+		ASSERT_TRUE(intVector.CheckIfActive(index));
+		ASSERT_EQ(intVector[index], -1);
+	}
+
+	// Every other free index is still reused before the vector grows
+	for (size_t i = 0; i < 17; ++i)
+	{
+		size_t index = intVector.Add(static_cast<int>(i));
+		ASSERT_TRUE(index != 6 && index != 9 && index != 12 && index < 30);
+	}
+
+	ASSERT_EQ(intVector.Add(100), 31);
+}
+
+TEST(StableVectorTest, RemovesIndicesCorrectly)
+{
+	StableVector<int> intVector;
+
+	for (int i = 0; i < 20; ++i)
+		intVector.Add(i);
+
+	intVector.Remove(3);
+	size_t indices[] = { 15, 4, 11 };
+	intVector.RemoveIndices(indices, 3);
+	TestSizes(intVector, 16, 20);
+
+	for (size_t index : indices)
+		ASSERT_FALSE(intVector.CheckIfActive(index));
+
+	// The removed indices are reused before the ones freed earlier
+	ASSERT_EQ(intVector.Add(100), 15);
+	ASSERT_EQ(intVector.Add(101), 4);
+	ASSERT_EQ(intVector.Add(102), 11);
+	ASSERT_EQ(intVector.Add(103), 3);
+	ASSERT_EQ(intVector.Add(104), 20);
+}
+
 TEST(StableVectorTest, MoveConstructsCorrectly)
 {
 	StableVector<int> intVectorToCompareAgainst;
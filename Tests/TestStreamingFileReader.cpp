@@ -0,0 +1,137 @@
+#include "pch.h"
+
+#include <fstream>
+#include <filesystem>
+
+#include "../Neo Steelgear Graphics Core/StreamingFileReader.h"
+
+#include "D3D12Helper.h"
+
+const wchar_t* STREAMING_TEST_FILE = L"StreamingFileReaderTest.bin";
+
+void WriteStreamingTestFile(int* data, int nrOfInts)
+{
+	for (int i = 0; i < nrOfInts; ++i)
+		data[i] = i;
+
+	std::ofstream file(std::filesystem::path(STREAMING_TEST_FILE),
+		std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(data), sizeof(int) * nrOfInts);
+}
+
+TEST(MappedFileTest, DefaultInitialisable)
+{
+	MappedFile file;
+	EXPECT_EQ(file.IsOpen(), false);
+	EXPECT_EQ(file.GetSize(), 0);
+}
+
+TEST(MappedFileTest, MapsFileContents)
+{
+	const int NR_OF_INTS = 1000;
+	int data[NR_OF_INTS];
+	WriteStreamingTestFile(data, NR_OF_INTS);
+
+	MappedFile file;
+	ASSERT_NO_THROW(file.Open(STREAMING_TEST_FILE));
+	EXPECT_EQ(file.IsOpen(), true);
+	ASSERT_EQ(file.GetSize(), sizeof(int) * NR_OF_INTS);
+	EXPECT_EQ(memcmp(file.GetData(), data, sizeof(int) * NR_OF_INTS), 0);
+	EXPECT_EQ(memcmp(file.GetData(sizeof(int) * 10), data + 10, sizeof(int)), 0);
+	EXPECT_THROW(file.GetData(file.GetSize() + 1), std::runtime_error);
+
+	MappedFile movedFile = std::move(file);
+	EXPECT_EQ(file.IsOpen(), false);
+	EXPECT_EQ(movedFile.GetSize(), sizeof(int) * NR_OF_INTS);
+
+	movedFile.Close();
+	EXPECT_EQ(movedFile.IsOpen(), false);
+	EXPECT_THROW(movedFile.Open(L"FileThatDoesNotExist.bin"), std::runtime_error);
+}
+
+TEST(StreamingFileReaderTest, DefaultInitialisable)
+{
+	StreamingFileReader reader;
+	EXPECT_EQ(reader.HasRegions(), false);
+	EXPECT_EQ(reader.GetStreamedBytes(), 0);
+}
+
+TEST(StreamingFileReaderTest, HandlesBufferRegions)
+{
+	ID3D12Device* device = nullptr;
+	device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device cannot be created";
+
+	// The staging memory only fits part of the file at a time
+	const int NR_OF_INTS = 4000;
+	ResourceUploader uploader;
+	uploader.Initialize(device, 1024, AllocationStrategy::BEST_FIT);
+
+	ID3D12Resource* targetBuffer = CreateBuffer(device,
+		sizeof(int) * NR_OF_INTS, false);
+	ID3D12Resource* readbackBuffer = CreateBuffer(device,
+		sizeof(int) * NR_OF_INTS, true);
+
+	if (targetBuffer == nullptr || readbackBuffer == nullptr)
+		FAIL() << "Cannot proceed with tests as resources could not be created";
+
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device))
+		FAIL() << "Cannot proceed with tests as command structure could not be created";
+
+	ID3D12Fence* fence = nullptr;
+	UINT64 currentFenceValue = 0;
+	if (FAILED(device->CreateFence(currentFenceValue,
+		D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	{
+		FAIL() << "Cannot proceed with tests as fence could not be created";
+	}
+
+	int* data = new int[NR_OF_INTS];
+	WriteStreamingTestFile(data, NR_OF_INTS);
+	MappedFile file;
+	file.Open(STREAMING_TEST_FILE);
+
+	// Two regions to the same buffer, streamed in order
+	const size_t HALF_SIZE = sizeof(int) * NR_OF_INTS / 2;
+	StreamingFileReader reader;
+	reader.AddBufferRegion(file, 0, HALF_SIZE, targetBuffer, 0, alignof(int));
+	reader.AddBufferRegion(file, HALF_SIZE, HALF_SIZE, targetBuffer, HALF_SIZE,
+		alignof(int));
+	EXPECT_THROW(reader.AddBufferRegion(file, HALF_SIZE, HALF_SIZE + 1,
+		targetBuffer, 0, alignof(int)), std::runtime_error);
+	ASSERT_EQ(reader.HasRegions(targetBuffer), true);
+
+	size_t nrOfBatches = 0;
+	while (!reader.StreamRegions(uploader, commandStructure.list))
+	{
+		ExecuteGraphicsCommandList(commandStructure.list, commandStructure.queue);
+		FlushCommandQueue(currentFenceValue, commandStructure.queue, fence);
+		ASSERT_TRUE(SUCCEEDED(commandStructure.allocator->Reset()));
+		ASSERT_TRUE(SUCCEEDED(commandStructure.list->Reset(
+			commandStructure.allocator, nullptr)));
+		uploader.RestoreUsedMemory();
+		++nrOfBatches;
+	}
+
+	EXPECT_EQ(nrOfBatches, (sizeof(int) * NR_OF_INTS + 1023) / 1024 - 1);
+	EXPECT_EQ(reader.GetStreamedBytes(), sizeof(int) * NR_OF_INTS);
+	EXPECT_EQ(reader.HasRegions(), false);
+
+	TransitionResource(commandStructure.list, targetBuffer,
+		D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE);
+	commandStructure.list->CopyBufferRegion(readbackBuffer, 0,
+		targetBuffer, 0, sizeof(int) * NR_OF_INTS);
+	ExecuteGraphicsCommandList(commandStructure.list, commandStructure.queue);
+	FlushCommandQueue(currentFenceValue, commandStructure.queue, fence);
+	CheckResourceData(readbackBuffer, 0, reinterpret_cast<unsigned char*>(data),
+		0, sizeof(int) * NR_OF_INTS);
+
+	file.Close();
+	delete[] data;
+	device->Release();
+	targetBuffer->Release();
+	readbackBuffer->Release();
+	fence->Release();
+}
\ No newline at end of file
@@ -146,6 +146,43 @@ TEST(Texture2DComponentTest, CreatesTexturesCorrectly)
 	InitializationHelper(lambda);
 }
 
+TEST(Texture2DComponentTest, CreatesTextureBatchesCorrectly)
+{
+	auto lambda = [](ID3D12Device* device, const TextureComponentInfo& textureInfo,
+		const std::vector<DescriptorAllocationInfo<Texture2DViewDesc>>&
+		descriptorAllocationInfo)
+	{
+		Texture2DComponent textureComponent;
+		textureComponent.Initialize(device, textureInfo,
+			descriptorAllocationInfo);
+
+		std::vector<Texture2DCreationInfo> batch(8);
+		for (size_t i = 0; i < batch.size(); ++i)
+		{
+			batch[i].width = 32;
+			batch[i].height = 16 + i;
+		}
+
+		std::vector<ResourceIndex> indices = textureComponent.CreateTextures(batch);
+		ASSERT_EQ(indices.size(), batch.size());
+
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			ASSERT_EQ(indices[i].allocatorIdentifier.heapChunkIndex, 0);
+			ASSERT_EQ(indices[i].allocatorIdentifier.internalIndex, i);
+			ASSERT_EQ(indices[i].descriptorIndex, i);
+			ASSERT_EQ(textureComponent.GetTextureHandle(indices[i]).dimensions.height,
+				16 + i);
+		}
+
+		// Single textures continue after the batch
+		ResourceIndex index = textureComponent.CreateTexture(32, 32);
+		ASSERT_EQ(index.descriptorIndex, batch.size());
+	};
+
+	InitializationHelper(lambda);
+}
+
 struct TextureAllocationHelpStruct
 {
 	UINT width;
@@ -5,6 +5,7 @@
 
 #include "../Neo Steelgear Graphics Core/Texture2DComponentData.h"
 #include "../Neo Steelgear Graphics Core/MultiHeapAllocatorGPU.h"
+#include "../Neo Steelgear Graphics Core/ResourceReadback.h"
 
 #include "D3D12Helper.h"
 
@@ -617,4 +618,278 @@ TEST(Texture2DComponentDataTest, ExpandsCorrectly)
 	};
 
 	InitializationHelper(lambda);
-}
\ No newline at end of file
+}
+
+TEST(Texture2DComponentDataTest, PerformsRegionUpdatesCorrectly)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	const UINT DIMENSION = 256;
+	const std::uint8_t TEXEL_SIZE = 4;
+	MultiHeapAllocatorGPU heapAllocator;
+	heapAllocator.Initialize(device);
+
+	ResourceComponentMemoryInfo memoryInfo;
+	memoryInfo.initialMinimumHeapSize = 1000000;
+	memoryInfo.expansionMinimumSize = 0;
+	memoryInfo.heapAllocator = &heapAllocator;
+	TextureComponentInfo componentInfo(DXGI_FORMAT_R8G8B8A8_UNORM,
+		TEXEL_SIZE, memoryInfo);
+	Texture2DViewDesc viewDesc(ViewType::SRV);
+	DescriptorAllocationInfo<Texture2DViewDesc> dai(ViewType::SRV,
+		viewDesc, 1);
+	Texture2DComponent component;
+	component.Initialize(device, componentInfo, { dai });
+
+	Texture2DComponentData componentData;
+	componentData.Initialize(device, 1, UpdateType::COPY_UPDATE, 1000000);
+	auto index = component.CreateTexture(DIMENSION, DIMENSION);
+	auto handle = component.GetTextureHandle(index);
+	componentData.AddComponent(index, DIMENSION * DIMENSION * TEXEL_SIZE,
+		handle.resource);
+
+	size_t currentFenceValue = 0;
+	ID3D12Fence* fence = CreateFence(device, currentFenceValue,
+		D3D12_FENCE_FLAG_NONE);
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device))
+		FAIL() << "Cannot proceed with tests as command structure could not be created";
+
+	ResourceUploader uploader;
+	uploader.Initialize(device, 1000000, AllocationStrategy::FIRST_FIT);
+	ResourceReadback readback;
+	readback.Initialize(device, 1000000);
+
+	std::vector<unsigned char> expected(DIMENSION * DIMENSION * TEXEL_SIZE, 0);
+	componentData.UpdateComponentData(index, expected.data(), TEXEL_SIZE);
+
+	auto updateRegion = [&](const TextureRegion& region, unsigned char value)
+	{
+		size_t rowSize = (region.right - region.left) * TEXEL_SIZE;
+		std::vector<unsigned char> regionData(rowSize * (region.bottom - region.top), value);
+		componentData.UpdateComponentRegion(index, regionData.data(),
+			TEXEL_SIZE, region);
+
+		for (unsigned int y = region.top; y < region.bottom; ++y)
+		{
+			memset(expected.data() + (y * DIMENSION + region.left) * TEXEL_SIZE,
+				value, rowSize);
+		}
+	};
+
+	for (unsigned int round = 0; round < 2; ++round)
+	{
+		std::vector<D3D12_RESOURCE_BARRIER> barriers;
+		componentData.PrepareUpdates(barriers, component);
+		if (!barriers.empty())
+			commandStructure.list->ResourceBarrier(static_cast<UINT>(barriers.size()),
+				barriers.data());
+
+		componentData.UpdateComponentResources(commandStructure.list,
+			uploader, component, TEXEL_SIZE, DXGI_FORMAT_R8G8B8A8_UNORM);
+
+		TransitionResource(commandStructure.list, handle.resource,
+			D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE);
+		TextureReadbackInfo readbackInfo;
+		readbackInfo.width = DIMENSION;
+		readbackInfo.height = DIMENSION;
+		readbackInfo.texelSizeInBytes = TEXEL_SIZE;
+		readbackInfo.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		auto readbackId = readback.ReadbackTextureData(handle.resource,
+			commandStructure.list, readbackInfo);
+		ASSERT_TRUE(readbackId.has_value());
+		TransitionResource(commandStructure.list, handle.resource,
+			D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COPY_DEST);
+
+		ExecuteGraphicsCommandList(commandStructure.list, commandStructure.queue);
+		FlushCommandQueue(currentFenceValue, commandStructure.queue, fence);
+		readback.SubmitReadbacks(currentFenceValue);
+		readback.UpdateCompletedValue(fence);
+		auto readbackData = readback.GetReadbackData(*readbackId);
+		ASSERT_TRUE(readbackData.has_value());
+
+		for (UINT y = 0; y < DIMENSION; ++y)
+		{
+			ASSERT_EQ(memcmp(readbackData->data + y * readbackData->rowPitch,
+				expected.data() + y * DIMENSION * TEXEL_SIZE,
+				DIMENSION * TEXEL_SIZE), 0);
+		}
+
+		readback.ReleaseReadback(*readbackId);
+		uploader.RestoreUsedMemory();
+		commandStructure.allocator->Reset();
+		commandStructure.list->Reset(commandStructure.allocator, nullptr);
+
+		// Overlapping tiles are merged, and more tiles than can be tracked are combined
+		updateRegion({ 0, 0, 64, 64 }, 10);
+		updateRegion({ 32, 32, 96, 96 }, 20);
+		for (unsigned int tile = 0; tile < 12; ++tile)
+			updateRegion({ tile * 20, 200, tile * 20 + 8, 208 }, 30);
+	}
+
+	fence->Release();
+	device->Release();
+}
+
+TEST(Texture2DComponentDataTest, RemovesWithoutMovingOtherComponents)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	const size_t NR_OF_TEXTURES = 64;
+	const UINT DIMENSION = 16;
+	const std::uint8_t TEXEL_SIZE = 4;
+	const unsigned int TEXTURE_SIZE = DIMENSION * DIMENSION * TEXEL_SIZE;
+
+	Texture2DComponentData componentData;
+	componentData.Initialize(device, 1, UpdateType::COPY_UPDATE,
+		NR_OF_TEXTURES * TEXTURE_SIZE);
+
+	std::vector<ID3D12Resource*> textures(NR_OF_TEXTURES);
+	std::vector<ResourceIndex> indices(NR_OF_TEXTURES);
+	std::vector<unsigned char*> dataPointers(NR_OF_TEXTURES);
+	for (size_t i = 0; i < NR_OF_TEXTURES; ++i)
+	{
+		textures[i] = CreateTexture2D(device, false, DIMENSION, DIMENSION);
+		if (textures[i] == nullptr)
+			FAIL() << "Cannot proceed with tests as resources could not be created";
+
+		indices[i].allocatorIdentifier.heapChunkIndex = 0;
+		indices[i].allocatorIdentifier.internalIndex = i;
+		indices[i].descriptorIndex = i;
+		componentData.AddComponent(indices[i], TEXTURE_SIZE, textures[i]);
+
+		std::vector<unsigned char> textureData(TEXTURE_SIZE,
+			static_cast<unsigned char>(i));
+		componentData.UpdateComponentData(indices[i], textureData.data(),
+			TEXEL_SIZE);
+	}
+
+	for (size_t i = 0; i < NR_OF_TEXTURES; ++i)
+	{
+		dataPointers[i] = static_cast<unsigned char*>(
+			componentData.GetComponentData(indices[i]));
+	}
+
+	for (size_t i = 0; i < NR_OF_TEXTURES; i += 2)
+		componentData.RemoveComponent(indices[i]);
+
+	// Freed memory is reused, so the staging memory neither grows nor moves
+	for (size_t i = 0; i < NR_OF_TEXTURES; i += 2)
+	{
+		componentData.AddComponent(indices[i], TEXTURE_SIZE, textures[i]);
+		std::vector<unsigned char> textureData(TEXTURE_SIZE,
+			static_cast<unsigned char>(i));
+		componentData.UpdateComponentData(indices[i], textureData.data(),
+			TEXEL_SIZE);
+	}
+
+	for (size_t i = 0; i < NR_OF_TEXTURES; ++i)
+	{
+		unsigned char* current = static_cast<unsigned char*>(
+			componentData.GetComponentData(indices[i]));
+		if (i % 2 == 1)
+			ASSERT_EQ(current, dataPointers[i]);
+
+		ASSERT_GE(current, dataPointers[0]);
+		ASSERT_LE(current + TEXTURE_SIZE, dataPointers[0] + NR_OF_TEXTURES * TEXTURE_SIZE);
+		for (unsigned int j = 0; j < TEXTURE_SIZE; ++j)
+			ASSERT_EQ(current[j], static_cast<unsigned char>(i));
+	}
+
+	for (auto& texture : textures)
+		texture->Release();
+
+	device->Release();
+}
+TEST(Texture2DComponentDataTest, RemovesInitialiseOnlyComponentsOnceUpdated)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	const UINT DIMENSION = 16;
+	const std::uint8_t TEXEL_SIZE = 4;
+	const unsigned int TEXTURE_SIZE = DIMENSION * DIMENSION * TEXEL_SIZE;
+
+	MultiHeapAllocatorGPU heapAllocator;
+	heapAllocator.Initialize(device);
+
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device,
+		D3D12_COMMAND_LIST_TYPE_COPY))
+	{
+		FAIL() << "Cannot proceed with tests as command structure cannot be created";
+	}
+
+	commandStructure.list->Close();
+	size_t currentFenceValue = 0;
+	ID3D12Fence* fence = CreateFence(device, currentFenceValue,
+		D3D12_FENCE_FLAG_NONE);
+
+	for (unsigned int totalNrOfFrames = 1; totalNrOfFrames < 4; ++totalNrOfFrames)
+	{
+		ResourceUploader uploader;
+		uploader.Initialize(device, 4 * TEXTURE_SIZE, AllocationStrategy::FIRST_FIT);
+
+		ResourceComponentMemoryInfo memoryInfo;
+		memoryInfo.initialMinimumHeapSize = 1000000;
+		memoryInfo.expansionMinimumSize = 0;
+		memoryInfo.heapAllocator = &heapAllocator;
+		TextureComponentInfo componentInfo(DXGI_FORMAT_R8G8B8A8_UNORM,
+			TEXEL_SIZE, memoryInfo);
+		Texture2DViewDesc viewDesc(ViewType::SRV);
+		DescriptorAllocationInfo<Texture2DViewDesc> dai(ViewType::SRV,
+			viewDesc, 1);
+		Texture2DComponent component;
+		component.Initialize(device, componentInfo, { dai });
+
+		Texture2DComponentData componentData;
+		componentData.Initialize(device, totalNrOfFrames,
+			UpdateType::INITIALISE_ONLY, TEXTURE_SIZE);
+
+		auto index = component.CreateTexture(DIMENSION, DIMENSION, 1, 1);
+		ASSERT_NE(index.descriptorIndex, size_t(-1));
+		auto handle = component.GetTextureHandle(index);
+		componentData.AddComponent(index, TEXTURE_SIZE, handle.resource);
+
+		std::vector<unsigned char> textureData(TEXTURE_SIZE, 1);
+		componentData.UpdateComponentData(index, textureData.data(), TEXEL_SIZE);
+
+		// Every frame needs its own update, the last one finishes the component
+		for (unsigned int currentFrame = 0; currentFrame < totalNrOfFrames;
+			++currentFrame)
+		{
+			ASSERT_NE(componentData.GetComponentData(index), nullptr);
+
+			if (FAILED(commandStructure.allocator->Reset()))
+				FAIL() << "Cannot proceed with tests as command allocator cannot be reset";
+
+			if (FAILED(commandStructure.list->Reset(commandStructure.allocator, nullptr)))
+				FAIL() << "Cannot proceed with tests as command list cannot be reset";
+
+			std::vector<D3D12_RESOURCE_BARRIER> barriers;
+			componentData.PrepareUpdates(barriers, component);
+			if (!barriers.empty())
+			{
+				commandStructure.list->ResourceBarrier(
+					static_cast<UINT>(barriers.size()), barriers.data());
+			}
+
+			componentData.UpdateComponentResources(commandStructure.list,
+				uploader, component, TEXEL_SIZE, DXGI_FORMAT_R8G8B8A8_UNORM);
+
+			ExecuteGraphicsCommandList(commandStructure.list, commandStructure.queue);
+			FlushCommandQueue(currentFenceValue, commandStructure.queue, fence);
+			uploader.RestoreUsedMemory();
+		}
+
+		ASSERT_EQ(componentData.GetComponentData(index), nullptr);
+	}
+
+	fence->Release();
+	device->Release();
+}
@@ -255,4 +255,49 @@ TEST(TextureAllocatorTest, CorrectlyExpands)
 	};
 
 	InitializationHelper(lambda);
+}
+
+TEST(TextureAllocatorTest, ReleasesEmptyChunks)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	MultiHeapAllocatorGPU heapAllocator;
+	heapAllocator.Initialize(device);
+
+	TextureAllocator textureAllocator;
+	textureAllocator.Initialize(device, {}, 65536, 65536, &heapAllocator);
+	textureAllocator.SetEmptyChunkReleaseDelay(2);
+
+	TextureAllocationInfo allocationInfo(DXGI_FORMAT_R8G8B8A8_UNORM, 4, 128, 128);
+	std::vector<ResourceIdentifier> identifiers;
+	while (identifiers.empty() || identifiers.back().heapChunkIndex < 2)
+		identifiers.push_back(textureAllocator.AllocateTexture(allocationInfo));
+	ASSERT_EQ(textureAllocator.NrOfMemoryChunks(), 3);
+	ID3D12Resource* lastTexture = textureAllocator.GetHandle(identifiers.back()).resource;
+
+	for (auto& identifier : identifiers)
+	{
+		if (identifier.heapChunkIndex == 1)
+			textureAllocator.DeallocateTexture(identifier);
+	}
+
+	textureAllocator.TrimEmptyChunks();
+	EXPECT_EQ(textureAllocator.NrOfMemoryChunks(), 3);
+	textureAllocator.TrimEmptyChunks();
+	EXPECT_EQ(textureAllocator.NrOfMemoryChunks(), 2);
+	EXPECT_EQ(textureAllocator.GetHandle(identifiers.back()).resource, lastTexture);
+
+	// Expanding again reuses the released slot instead of adding a new one
+	ResourceIdentifier reused = textureAllocator.AllocateTexture(allocationInfo);
+	while (reused.heapChunkIndex == 0 || reused.heapChunkIndex == 2)
+		reused = textureAllocator.AllocateTexture(allocationInfo);
+	EXPECT_EQ(reused.heapChunkIndex, 1);
+	EXPECT_EQ(textureAllocator.NrOfMemoryChunks(), 3);
+
+	textureAllocator.ResetAllocator();
+	EXPECT_EQ(textureAllocator.NrOfMemoryChunks(), 1);
+
+	device->Release();
 }
\ No newline at end of file
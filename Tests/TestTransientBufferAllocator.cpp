@@ -0,0 +1,165 @@
+#include "pch.h"
+
+#include "../Neo Steelgear Graphics Core/TransientBufferAllocator.h"
+
+#include "D3D12Helper.h"
+
+TEST(TransientBufferAllocatorTest, DefaultInitialisable)
+{
+	TransientBufferAllocator allocator;
+}
+
+TEST(TransientBufferAllocatorTest, RuntimeInitialisable)
+{
+	ID3D12Device* device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device could not be created";
+
+	BufferInfo bufferInfo;
+	bufferInfo.alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+	bufferInfo.elementSize = 64;
+
+	TransientBufferAllocator committedAllocator;
+	committedAllocator.Initialize(device, bufferInfo, 65536, 3);
+	ASSERT_NE(committedAllocator.GetResource(), nullptr);
+	EXPECT_EQ(committedAllocator.GetElementSize(),
+		D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
+	auto allocation = committedAllocator.Allocate(2);
+	ASSERT_TRUE(allocation.has_value());
+	EXPECT_EQ(allocation->handle.resource, committedAllocator.GetResource());
+	EXPECT_EQ(allocation->gpuAddress,
+		committedAllocator.GetResource()->GetGPUVirtualAddress());
+	memset(allocation->mappedPtr, 1, 2 * committedAllocator.GetElementSize());
+
+	ID3D12Heap* heap = CreateResourceHeap(device, 65536 * 2,
+		D3D12_HEAP_TYPE_UPLOAD, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
+	if (heap == nullptr)
+		FAIL() << "Cannot proceed with tests as a heap could not be created";
+
+	TransientBufferAllocator placedAllocator;
+	placedAllocator.Initialize(device, bufferInfo, 65536, 2, heap, 0);
+	EXPECT_TRUE(placedAllocator.Allocate(1).has_value());
+
+	heap->Release();
+	device->Release();
+}
+
+TEST(TransientBufferAllocatorTest, AllocatesLinearlyWithAlignment)
+{
+	const size_t FRAME_SIZE = 1000; // Rounded up to 1024 by the alignment
+	const D3D12_GPU_VIRTUAL_ADDRESS GPU_START = 65536;
+	std::vector<unsigned char> memory(1024 * 2);
+
+	BufferInfo bufferInfo;
+	bufferInfo.alignment = 256;
+	bufferInfo.elementSize = 20;
+
+	TransientBufferAllocator allocator;
+	allocator.Initialize(bufferInfo, memory.data(), GPU_START, FRAME_SIZE, 2);
+	EXPECT_EQ(allocator.GetElementSize(), 256);
+	EXPECT_EQ(allocator.GetFrameSize(), 1024);
+
+	int data[4] = { 1, 2, 3, 4 };
+	auto first = allocator.Allocate(1, data);
+	ASSERT_TRUE(first.has_value());
+	EXPECT_EQ(first->handle.resource, nullptr);
+	EXPECT_EQ(first->handle.startOffset, 0);
+	EXPECT_EQ(first->handle.nrOfElements, 1);
+	EXPECT_EQ(first->mappedPtr, memory.data());
+	EXPECT_EQ(first->gpuAddress, GPU_START);
+	EXPECT_EQ(memcmp(memory.data(), data, sizeof(data)), 0);
+
+	auto second = allocator.Allocate(2);
+	ASSERT_TRUE(second.has_value());
+	EXPECT_EQ(second->handle.startOffset, 256);
+	EXPECT_EQ(allocator.GetUsedFrameMemory(), 768);
+
+	EXPECT_FALSE(allocator.Allocate(2).has_value());
+	EXPECT_TRUE(allocator.Allocate(1).has_value());
+	EXPECT_FALSE(allocator.Allocate(1).has_value());
+
+	// The next frame has its own region
+	allocator.SwapFrame();
+	auto third = allocator.Allocate(4);
+	ASSERT_TRUE(third.has_value());
+	EXPECT_EQ(third->handle.startOffset, 1024);
+	EXPECT_EQ(third->mappedPtr, memory.data() + 1024);
+	EXPECT_EQ(third->gpuAddress, GPU_START + 1024);
+
+	// Swapping back resets the first region in bulk
+	allocator.SwapFrame();
+	EXPECT_EQ(allocator.GetActiveFrame(), 0);
+	EXPECT_EQ(allocator.GetUsedFrameMemory(), 0);
+	auto fourth = allocator.Allocate(1);
+	ASSERT_TRUE(fourth.has_value());
+	EXPECT_EQ(fourth->handle.startOffset, 0);
+}
+
+TEST(TransientBufferAllocatorTest, ResetsOnCompletion)
+{
+	std::vector<unsigned char> memory(512 * 2);
+	BufferInfo bufferInfo;
+	bufferInfo.alignment = 256;
+	bufferInfo.elementSize = 256;
+
+	TransientBufferAllocator allocator;
+	allocator.Initialize(bufferInfo, memory.data(), 0, 512, 2);
+
+	// Frame numbers work just as well as fence values
+	ASSERT_TRUE(allocator.Allocate(2).has_value());
+	allocator.SubmitFrame(1);
+	ASSERT_TRUE(allocator.Allocate(1).has_value());
+	allocator.SubmitFrame(2);
+
+	EXPECT_EQ(allocator.GetActiveFrame(), 0);
+	EXPECT_FALSE(allocator.Allocate(1).has_value()); // Still used by the GPU
+
+	allocator.UpdateCompletedValue(1);
+	EXPECT_EQ(allocator.GetUsedFrameMemory(), 0);
+	auto allocation = allocator.Allocate(2);
+	ASSERT_TRUE(allocation.has_value());
+	EXPECT_EQ(allocation->handle.startOffset, 0);
+	allocator.SubmitFrame(3);
+
+	EXPECT_FALSE(allocator.Allocate(1).has_value());
+	allocator.UpdateCompletedValue(3);
+	allocation = allocator.Allocate(2);
+	ASSERT_TRUE(allocation.has_value());
+	EXPECT_EQ(allocation->handle.startOffset, 512);
+}
+
+TEST(TransientBufferAllocatorTest, ReusesFramesAfterSwapping)
+{
+	const size_t NR_OF_DRAWS = 64;
+	const size_t NR_OF_FRAMES = 6;
+	const size_t CONSTANTS_SIZE = 192; // A couple of matrices and some material data
+	const size_t FRAME_SIZE = NR_OF_DRAWS * 256;
+	std::vector<unsigned char> memory(FRAME_SIZE * 2);
+
+	BufferInfo bufferInfo;
+	bufferInfo.alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+	bufferInfo.elementSize = CONSTANTS_SIZE;
+
+	TransientBufferAllocator allocator;
+	allocator.Initialize(bufferInfo, memory.data(), 0, FRAME_SIZE, 2);
+
+	unsigned char constants[CONSTANTS_SIZE] = {};
+
+	for (size_t frame = 0; frame < NR_OF_FRAMES; ++frame)
+	{
+		// Every frame starts from the beginning of its own region and fits every draw
+		for (size_t draw = 0; draw < NR_OF_DRAWS; ++draw)
+		{
+			constants[0] = static_cast<unsigned char>(frame * NR_OF_DRAWS + draw);
+			auto allocation = allocator.Allocate(1, constants);
+			ASSERT_TRUE(allocation.has_value());
+			EXPECT_EQ(allocation->handle.startOffset,
+				(frame % 2) * FRAME_SIZE + draw * 256);
+			EXPECT_EQ(allocation->mappedPtr[0], constants[0]);
+		}
+
+		EXPECT_FALSE(allocator.Allocate(1, constants).has_value());
+		allocator.SwapFrame();
+	}
+}
\ No newline at end of file
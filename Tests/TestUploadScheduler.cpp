@@ -0,0 +1,210 @@
+#include "pch.h"
+
+#include "../Neo Steelgear Graphics Core/UploadScheduler.h"
+
+#include "D3D12Helper.h"
+
+TEST(UploadSchedulerTest, DefaultInitialisable)
+{
+	UploadScheduler scheduler;
+}
+
+TEST(UploadSchedulerTest, RuntimeInitialisable)
+{
+	ID3D12Device* device = nullptr;
+	device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device cannot be created";
+
+	ResourceUploader uploader;
+	uploader.Initialize(device, 1024, AllocationStrategy::BEST_FIT);
+	UploadScheduler scheduler;
+	scheduler.Initialize(&uploader, 512);
+	EXPECT_EQ(scheduler.HasScheduledUploads(), false);
+	EXPECT_EQ(scheduler.GetUsedBudget(), 0);
+
+	device->Release();
+}
+
+void FillScheduledData(int arr[], int nrOfValues)
+{
+	for (int i = 0; i < nrOfValues; ++i)
+		arr[i] = i;
+}
+
+void ResetScheduledCommandList(SimpleCommandStructure& commandStructure)
+{
+	if (FAILED(commandStructure.allocator->Reset()))
+		throw std::runtime_error("Could not reset command allocator");
+
+	if (FAILED(commandStructure.list->Reset(commandStructure.allocator, nullptr)))
+		throw std::runtime_error("Could not reset command list");
+}
+
+void ExecuteScheduledFrame(SimpleCommandStructure& commandStructure,
+	ResourceUploader& uploader, UploadScheduler& scheduler,
+	UINT64& currentFenceValue, ID3D12Fence* fence)
+{
+	scheduler.ExecuteUploads(commandStructure.list);
+	ExecuteGraphicsCommandList(commandStructure.list, commandStructure.queue);
+	FlushCommandQueue(currentFenceValue, commandStructure.queue, fence);
+	ResetScheduledCommandList(commandStructure);
+	uploader.RestoreUsedMemory();
+	scheduler.ResumeUploads();
+}
+
+void CheckScheduledBuffer(SimpleCommandStructure& commandStructure,
+	ID3D12Resource* targetBuffer, ID3D12Resource* readbackBuffer,
+	int* data, int nrOfInts, UINT64& currentFenceValue, ID3D12Fence* fence)
+{
+	TransitionResource(commandStructure.list, targetBuffer,
+		D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE);
+	commandStructure.list->CopyBufferRegion(readbackBuffer, 0,
+		targetBuffer, 0, sizeof(int) * nrOfInts);
+	ExecuteGraphicsCommandList(commandStructure.list, commandStructure.queue);
+	FlushCommandQueue(currentFenceValue, commandStructure.queue, fence);
+	CheckResourceData(readbackBuffer, 0, reinterpret_cast<unsigned char*>(data),
+		0, nrOfInts * sizeof(int));
+}
+
+TEST(UploadSchedulerTest, HandlesCriticalUploads)
+{
+	ID3D12Device* device = nullptr;
+	device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device cannot be created";
+
+	const int NR_OF_INTS = 1000;
+	ResourceUploader uploader;
+	uploader.Initialize(device, sizeof(int) * NR_OF_INTS, AllocationStrategy::BEST_FIT);
+	UploadScheduler scheduler;
+	scheduler.Initialize(&uploader, 0);
+
+	ID3D12Resource* targetBuffer = CreateBuffer(device,
+		sizeof(int) * NR_OF_INTS, false);
+	ID3D12Resource* readbackBuffer = CreateBuffer(device,
+		sizeof(int) * NR_OF_INTS, true);
+
+	if (targetBuffer == nullptr || readbackBuffer == nullptr)
+		FAIL() << "Cannot proceed with tests as resources could not be created";
+
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device))
+		FAIL() << "Cannot proceed with tests as command structure could not be created";
+
+	ID3D12Fence* fence = nullptr;
+	UINT64 currentFenceValue = 0;
+	if (FAILED(device->CreateFence(currentFenceValue,
+		D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	{
+		FAIL() << "Cannot proceed with tests as fence could not be created";
+	}
+
+	int data[NR_OF_INTS];
+	FillScheduledData(data, NR_OF_INTS);
+	size_t normalId = scheduler.ScheduleBufferUpload(targetBuffer, data, 0,
+		sizeof(int) * NR_OF_INTS, alignof(int), UploadPriority::NORMAL);
+	scheduler.ExecuteUploads(commandStructure.list);
+	EXPECT_EQ(scheduler.UploadFinished(normalId), false);
+	EXPECT_EQ(scheduler.GetUsedBudget(), 0);
+
+	scheduler.CancelUploads(targetBuffer);
+	size_t criticalId = scheduler.ScheduleBufferUpload(targetBuffer, data, 0,
+		sizeof(int) * NR_OF_INTS, alignof(int), UploadPriority::CRITICAL);
+	scheduler.ExecuteUploads(commandStructure.list);
+	EXPECT_EQ(scheduler.UploadFinished(criticalId), true);
+	EXPECT_EQ(scheduler.GetUsedBudget(), sizeof(int) * NR_OF_INTS);
+
+	CheckScheduledBuffer(commandStructure, targetBuffer, readbackBuffer,
+		data, NR_OF_INTS, currentFenceValue, fence);
+
+	device->Release();
+	targetBuffer->Release();
+	readbackBuffer->Release();
+	fence->Release();
+}
+
+TEST(UploadSchedulerTest, HandlesBudgetedUploads)
+{
+	ID3D12Device* device = nullptr;
+	device = CreateDevice();
+	if (device == nullptr)
+		FAIL() << "Cannot proceed with tests as a device cannot be created";
+
+	const int NR_OF_INTS = 4000;
+	const size_t FRAME_BUDGET = 1024;
+	ResourceUploader uploader;
+	uploader.Initialize(device, sizeof(int) * NR_OF_INTS, AllocationStrategy::BEST_FIT);
+	UploadScheduler scheduler;
+	scheduler.Initialize(&uploader, FRAME_BUDGET);
+
+	ID3D12Resource* firstBuffer = CreateBuffer(device,
+		sizeof(int) * NR_OF_INTS, false);
+	ID3D12Resource* secondBuffer = CreateBuffer(device,
+		sizeof(int) * NR_OF_INTS, false);
+	ID3D12Resource* readbackBuffer = CreateBuffer(device,
+		sizeof(int) * NR_OF_INTS, true);
+
+	if (firstBuffer == nullptr || secondBuffer == nullptr ||
+		readbackBuffer == nullptr)
+	{
+		FAIL() << "Cannot proceed with tests as resources could not be created";
+	}
+
+	SimpleCommandStructure commandStructure;
+	if (!CreateSimpleCommandStructure(commandStructure, device))
+		FAIL() << "Cannot proceed with tests as command structure could not be created";
+
+	ID3D12Fence* fence = nullptr;
+	UINT64 currentFenceValue = 0;
+	if (FAILED(device->CreateFence(currentFenceValue,
+		D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence))))
+	{
+		FAIL() << "Cannot proceed with tests as fence could not be created";
+	}
+
+	int* data = new int[NR_OF_INTS];
+	FillScheduledData(data, NR_OF_INTS);
+	size_t backgroundId = scheduler.ScheduleBufferUpload(firstBuffer, data, 0,
+		sizeof(int) * NR_OF_INTS, alignof(int), UploadPriority::BACKGROUND);
+	size_t normalId = scheduler.ScheduleBufferUpload(secondBuffer, data, 0,
+		sizeof(int) * NR_OF_INTS, alignof(int), UploadPriority::NORMAL);
+
+	// The data is copied when scheduled, so the caller data can be released right away
+	ExecuteScheduledFrame(commandStructure, uploader, scheduler,
+		currentFenceValue, fence);
+	EXPECT_EQ(scheduler.GetUsedBudget(), FRAME_BUDGET);
+	int* copiedData = new int[NR_OF_INTS];
+	memcpy(copiedData, data, sizeof(int) * NR_OF_INTS);
+	memset(data, 0, sizeof(int) * NR_OF_INTS);
+
+	size_t nrOfFrames = 1;
+	while (scheduler.HasScheduledUploads())
+	{
+		EXPECT_EQ(scheduler.UploadFinished(normalId) ||
+			!scheduler.UploadFinished(backgroundId), true);
+		ExecuteScheduledFrame(commandStructure, uploader, scheduler,
+			currentFenceValue, fence);
+		EXPECT_LE(scheduler.GetUsedBudget(), FRAME_BUDGET);
+		++nrOfFrames;
+	}
+
+	EXPECT_EQ(nrOfFrames,
+		(2 * sizeof(int) * NR_OF_INTS + FRAME_BUDGET - 1) / FRAME_BUDGET);
+	EXPECT_EQ(scheduler.UploadFinished(normalId), true);
+	EXPECT_EQ(scheduler.UploadFinished(backgroundId), true);
+
+	CheckScheduledBuffer(commandStructure, firstBuffer, readbackBuffer,
+		copiedData, NR_OF_INTS, currentFenceValue, fence);
+	ResetScheduledCommandList(commandStructure);
+	CheckScheduledBuffer(commandStructure, secondBuffer, readbackBuffer,
+		copiedData, NR_OF_INTS, currentFenceValue, fence);
+
+	delete[] data;
+	delete[] copiedData;
+	device->Release();
+	firstBuffer->Release();
+	secondBuffer->Release();
+	readbackBuffer->Release();
+	fence->Release();
+}
\ No newline at end of file